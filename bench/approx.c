@@ -0,0 +1,183 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Report speed and accuracy of approximations of predefined functions
+ * selected by EVALUATOR_APPROXIMATE and EVALUATOR_APPROXIMATE_COARSE
+ * flags: time of single point evaluation (scalar path) and of batch
+ * evaluation per point with bytecode engine (vector path) for exact
+ * function and both approximations, and largest relative error of
+ * approximations, for both paths, over arguments uniformly spread over
+ * [-10,10] interval and with magnitudes logarithmically spread from
+ * 2^-50 to 2^50.  */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+#include "timer.h"
+
+/* Number of points evaluated in single call of measured functions and
+ * in accuracy check.  */
+#define POINTS 4096
+
+/* Number of calls and repetitions of measurement.  */
+#define CALLS 50
+#define REPETITIONS 7
+
+/* Data of measured functions.  */
+typedef struct {
+	void           *evaluator;	/* Evaluator of function.  */
+	double         *values;	/* Arguments.  */
+	double         *results;	/* Function values.  */
+	double          sum;	/* Sum of results, to keep them alive.  */
+} Data;
+
+/* Evaluate function at all points one by one.  */
+static void     evaluate_point(void *data);
+
+/* Evaluate function at all points as batch.  */
+static void     evaluate_batch(void *data);
+
+/* Functions approximated.  */
+static char    *functions[] = {
+	"sin", "cos", "tan", "cot", "sec", "csc", "atan", "acot", "sinh",
+	"cosh", "tanh", "coth", "sech", "csch", "erf"
+};
+
+/* Evaluator flags: exact functions and approximations.  */
+static int      flags[] = {
+	0, EVALUATOR_APPROXIMATE, EVALUATOR_APPROXIMATE_COARSE
+};
+
+int
+main(void)
+{
+	char           *names[] = { "x" };	/* Variable names.  */
+	char            string[16];	/* Function string.  */
+	Data            data;	/* Data of measured functions.  */
+	double         *expected;	/* Exact results.  */
+	double          point[3];	/* Times of single point
+					 * evaluation.  */
+	double          batch[3];	/* Times of batch evaluation.  */
+	double          worst[3];	/* Largest relative errors.  */
+	double          result;	/* Single point result.  */
+	double          error;	/* Relative error.  */
+	int             i,
+	                j,
+	                k;	/* Loop counters.  */
+
+	/* Generate arguments, half of them uniformly spread, other half
+	 * with logarithmically spread magnitudes and alternating signs. */
+	data.values = malloc(POINTS * sizeof(double));
+	data.results = malloc(POINTS * sizeof(double));
+	expected = malloc(POINTS * sizeof(double));
+	for (j = 0; j < POINTS / 2; j++)
+		data.values[j] = -10 + 20.0 * j / (POINTS / 2);
+	for (j = POINTS / 2; j < POINTS; j++)
+		data.values[j] =
+		    ((j & 1) ? -1 : 1) * pow(2,
+					     -50 + 100.0 * (j - POINTS / 2) /
+					     (POINTS / 2));
+
+	printf("%-6s %26s %26s %20s\n", "", "point ns", "batch ns",
+	       "max relative error");
+	printf("%-6s %8s %8s %8s %8s %8s %8s %10s %10s\n", "", "exact",
+	       "1e-7", "1e-4", "exact", "1e-7", "1e-4", "1e-7", "1e-4");
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0]));
+	     i++) {
+		sprintf(string, "%s(x)", functions[i]);
+		for (k = 0; k < (int) (sizeof(flags) / sizeof(flags[0]));
+		     k++) {
+			data.evaluator =
+			    evaluator_create_flags(string, flags[k]);
+			evaluator_set_engine(data.evaluator,
+					     EVALUATOR_ENGINE_BYTECODE);
+
+			/* Find largest relative error of single point and
+			 * batch results, with exact results calculated
+			 * first. */
+			evaluator_evaluate_batch(data.evaluator, 1, names,
+						 &data.values, POINTS,
+						 k ? data.results : expected);
+			worst[k] = 0;
+			for (j = 0; k && j < POINTS; j++) {
+				if (!isfinite(expected[j])
+				    || fabs(expected[j]) < DBL_MIN)
+					continue;
+				result =
+				    evaluator_evaluate(data.evaluator, 1,
+						       names, &data.values[j]);
+				error =
+				    fmax(fabs(result - expected[j]),
+					 fabs(data.results[j] -
+					      expected[j])) /
+				    fabs(expected[j]);
+				if (!(error <= worst[k]))
+					worst[k] = error;
+			}
+
+			/* Measure times per point. */
+			data.sum = 0;
+			point[k] =
+			    timer_measure(evaluate_point, &data, CALLS,
+					  REPETITIONS) / POINTS;
+			batch[k] =
+			    timer_measure(evaluate_batch, &data, CALLS,
+					  REPETITIONS) / POINTS;
+			evaluator_destroy(data.evaluator);
+		}
+		printf
+		    ("%-6s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %10.2e %10.2e\n",
+		     functions[i], point[0], point[1], point[2], batch[0],
+		     batch[1], batch[2], worst[1], worst[2]);
+	}
+	free(data.values);
+	free(data.results);
+	free(expected);
+
+	return EXIT_SUCCESS;
+}
+
+static void
+evaluate_point(void *data)
+{
+	Data           *this = data;	/* Data of measured function.  */
+	char           *names[] = { "x" };	/* Variable names.  */
+	int             i;	/* Loop counter.  */
+
+	for (i = 0; i < POINTS; i++)
+		this->sum +=
+		    evaluator_evaluate(this->evaluator, 1, names,
+				       &this->values[i]);
+}
+
+static void
+evaluate_batch(void *data)
+{
+	Data           *this = data;	/* Data of measured function.  */
+	char           *names[] = { "x" };	/* Variable names.  */
+
+	evaluator_evaluate_batch(this->evaluator, 1, names, &this->values,
+				 POINTS, this->results);
+	this->sum += this->results[0];
+}
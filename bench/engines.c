@@ -0,0 +1,192 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Compare engines on corpus of functions: report time of compilation
+ * (selecting engine), of single point evaluation and of batch
+ * evaluation per point, as well as largest relative difference of
+ * results from ones of EVALUATOR_ENGINE_TREE.  Engines not available
+ * in library as configured are reported as such.  */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+#include "timer.h"
+
+/* Number of points evaluated in single call of measured functions.  */
+#define POINTS 1024
+
+/* Number of calls and repetitions of measurement.  */
+#define CALLS 100
+#define REPETITIONS 7
+
+/* Data of measured functions.  */
+typedef struct {
+	void           *evaluator;	/* Evaluator of function.  */
+	double         *values[3];	/* Variable values.  */
+	double         *results;	/* Function values.  */
+	double          sum;	/* Sum of results, to keep them alive.  */
+} Data;
+
+/* Evaluate function at all points one by one.  */
+static void     evaluate_point(void *data);
+
+/* Evaluate function at all points as batch.  */
+static void     evaluate_batch(void *data);
+
+/* Engines compared, with their names.  */
+static int      engines[] = {
+	EVALUATOR_ENGINE_TREE, EVALUATOR_ENGINE_JIT, EVALUATOR_ENGINE_LLVM,
+	EVALUATOR_ENGINE_C, EVALUATOR_ENGINE_BYTECODE,
+	EVALUATOR_ENGINE_CLOSURE
+};
+static char    *engine_names[] = {
+	"tree", "jit", "llvm", "c", "bytecode", "closure"
+};
+
+/* Corpus of functions.  */
+static char    *corpus[] = {
+	"x*y+z",
+	"sin(x)*cos(y)+z",
+	"1+2*x+3*x^2+4*x^3+5*x^4+6*x^5+7*x^6+8*x^7",
+	"exp(-(x^2+y^2)/2)*sqrt(z^2+1)",
+	"(x+y)/(y+z+3)+(y+z)/(z+x+3)+(z+x)/(x+y+3)",
+	"log(1+x^2)*atan(y)-tanh(z)*erf(x*y)"
+};
+
+int
+main(void)
+{
+	char           *names[] = { "x", "y", "z" };	/* Variable names. 
+							 */
+	Data            data;	/* Data of measured functions.  */
+	double         *reference;	/* Results of tree engine.  */
+	double          start;	/* Start of compilation.  */
+	double          compile;	/* Time of compilation.  */
+	double          point;	/* Time of single point evaluation.  */
+	double          batch;	/* Time of batch evaluation.  */
+	double          error;	/* Relative difference of results.  */
+	double          worst;	/* Largest relative difference.  */
+	int             i,
+	                j,
+	                k;	/* Loop counters.  */
+
+	/* Initialize points. */
+	for (k = 0; k < 3; k++)
+		data.values[k] = malloc(POINTS * sizeof(double));
+	for (j = 0; j < POINTS; j++) {
+		data.values[0][j] = sin(j);
+		data.values[1][j] = cos(0.7 * j);
+		data.values[2][j] = sin(1.3 * j + 0.2);
+	}
+	data.results = malloc(POINTS * sizeof(double));
+	reference = malloc(POINTS * sizeof(double));
+
+	for (i = 0; i < (int) (sizeof(corpus) / sizeof(corpus[0])); i++) {
+		printf("%s\n  %-10s %12s %12s %12s %12s\n", corpus[i],
+		       "engine", "compile us", "point ns", "batch ns",
+		       "difference");
+		for (k = 0;
+		     k < (int) (sizeof(engines) / sizeof(engines[0]));
+		     k++) {
+			/* Create evaluator and select engine, skipping
+			 * engines not available. */
+			data.evaluator = evaluator_create(corpus[i]);
+			start = timer_now();
+			if (evaluator_set_engine(data.evaluator, engines[k]) !=
+			    engines[k]) {
+				printf("  %-10s %12s\n", engine_names[k],
+				       "n/a");
+				evaluator_destroy(data.evaluator);
+				continue;
+			}
+			compile = (timer_now() - start) * 1e6;
+
+			/* Compare results with ones of tree engine. */
+			evaluator_evaluate_batch(data.evaluator, 3, names,
+						 data.values, POINTS,
+						 data.results);
+			if (engines[k] == EVALUATOR_ENGINE_TREE)
+				for (j = 0; j < POINTS; j++)
+					reference[j] = data.results[j];
+			worst = 0;
+			for (j = 0; j < POINTS; j++)
+				if (data.results[j] != reference[j]) {
+					error =
+					    fabs(data.results[j] -
+						 reference[j]) /
+					    fabs(reference[j]);
+					if (!(error <= worst))
+						worst = error;
+				}
+
+			/* Measure and report times per point. */
+			data.sum = 0;
+			point =
+			    timer_measure(evaluate_point, &data, CALLS,
+					  REPETITIONS) / POINTS;
+			batch =
+			    timer_measure(evaluate_batch, &data, CALLS,
+					  REPETITIONS) / POINTS;
+			printf("  %-10s %12.1f %12.2f %12.2f %12.3g\n",
+			       engine_names[k], compile, point, batch, worst);
+			evaluator_destroy(data.evaluator);
+		}
+	}
+
+	for (k = 0; k < 3; k++)
+		free(data.values[k]);
+	free(data.results);
+	free(reference);
+
+	return EXIT_SUCCESS;
+}
+
+static void
+evaluate_point(void *data)
+{
+	Data           *this = data;	/* Data of measured function.  */
+	char           *names[] = { "x", "y", "z" };	/* Variable names. 
+							 */
+	double          values[3];	/* Variable values.  */
+	int             i;	/* Loop counter.  */
+
+	for (i = 0; i < POINTS; i++) {
+		values[0] = this->values[0][i];
+		values[1] = this->values[1][i];
+		values[2] = this->values[2][i];
+		this->sum +=
+		    evaluator_evaluate(this->evaluator, 3, names, values);
+	}
+}
+
+static void
+evaluate_batch(void *data)
+{
+	Data           *this = data;	/* Data of measured function.  */
+	char           *names[] = { "x", "y", "z" };	/* Variable names. 
+							 */
+
+	evaluator_evaluate_batch(this->evaluator, 3, names, this->values,
+				 POINTS, this->results);
+	this->sum += this->results[0];
+}
@@ -0,0 +1,195 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Report latency of single point evaluation of small functions, as
+ * 50th and 99th percentile of times of single evaluations by
+ * EVALUATOR_ENGINE_TREE (node_evaluate() of tree representation) and
+ * by compiled functions of engines aimed at low latency, called
+ * directly.  Each evaluation is timed separately with processor time
+ * stamp counter, with median time of reading counter subtracted.  Last
+ * column reports median time added by evaluator_evaluate() (assigning
+ * variable values by name) on top of tree evaluation.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <matheval.h>
+#include "engine.h"
+#include "timer.h"
+
+/* Number of evaluations timed for each function and engine.  */
+#define SAMPLES 200000
+
+/* Compare two times, for sorting.  */
+static int      compare(const void *first, const void *second);
+
+/* Engines compared, with their names.  */
+static int      engines[] = {
+	EVALUATOR_ENGINE_TREE, EVALUATOR_ENGINE_CLOSURE,
+	EVALUATOR_ENGINE_JIT
+};
+static char    *engine_names[] = { "tree", "closure", "jit" };
+
+/* Small functions, typical for low latency use.  */
+static char    *corpus[] = {
+	"x*3.5",
+	"sin(x)",
+	"x*y+2",
+	"(x+1)*(y-2)/z",
+	"x^2+3*x-1",
+	"sin(x)*cos(y)+exp(z/5)",
+	"(x*y+z)/(x*x+y*y+1)-x*z*0.5+y/3"
+};
+
+/* Sink for results, to keep evaluations from being optimized away.  */
+static volatile double sink;
+
+int
+main(void)
+{
+	char           *names[] = { "x", "y", "z" };	/* Variable names. 
+							 */
+	double          values[3];	/* Variable values.  */
+	double          point[3];	/* Variable values, ordered as
+					 * evaluator variables.  */
+	int             map[3];	/* Indices of evaluator variables among
+				 * above names.  */
+	char          **variables;	/* Evaluator variable names.  */
+	Record        **records;	/* Evaluator variable records.  */
+	Node           *root;	/* Tree representation of function.  */
+	Engine         *engine;	/* Compiled function.  */
+	double         *times;	/* Times of evaluations, in ticks.  */
+	double          tick;	/* Duration of tick, in nanoseconds.  */
+	double          overhead;	/* Time of reading counter.  */
+	double          start;	/* Start of evaluation.  */
+	double          tree;	/* Median time of tree evaluation.  */
+	void           *evaluator;	/* Evaluator of function.  */
+	int             count;	/* Number of evaluator variables.  */
+	int             i,
+	                j,
+	                k,
+	                l;	/* Loop counters.  */
+
+	/* Measure duration of tick and time of reading counter. */
+	tick = timer_tick_ns();
+	times = malloc(SAMPLES * sizeof(double));
+	for (j = 0; j < SAMPLES; j++) {
+		start = timer_ticks();
+		times[j] = timer_ticks() - start;
+	}
+	qsort(times, SAMPLES, sizeof(double), compare);
+	overhead = times[SAMPLES / 2];
+	printf("counter overhead %.1f ns subtracted\n%-32s",
+	       overhead * tick, "p50/p99 ns");
+	for (k = 0; k < (int) (sizeof(engines) / sizeof(engines[0])); k++)
+		printf(" %11s", engine_names[k]);
+	printf(" %11s\n", "evaluate()");
+
+	for (i = 0; i < (int) (sizeof(corpus) / sizeof(corpus[0])); i++) {
+		printf("%-32s", corpus[i]);
+		tree = 0;
+		for (k = 0;
+		     k < (int) (sizeof(engines) / sizeof(engines[0]));
+		     k++) {
+			/* Create evaluator and select engine, skipping
+			 * engines not available. */
+			evaluator = evaluator_create(corpus[i]);
+			if (evaluator_set_engine(evaluator, engines[k]) !=
+			    engines[k]) {
+				printf(" %11s", "n/a");
+				evaluator_destroy(evaluator);
+				continue;
+			}
+
+			/* Find evaluator variables among variable names. */
+			evaluator_get_variables(evaluator, &variables,
+						&count);
+			engine =
+			    evaluator_get_internals(evaluator, &root,
+						    &records, &count);
+			for (l = 0; l < count; l++)
+				for (map[l] = 0;
+				     strcmp(variables[l], names[map[l]]);
+				     map[l]++);
+
+			/* Time each evaluation separately, with variable
+			 * values changing from evaluation to evaluation,
+			 * by compiled function if any or by evaluating
+			 * tree otherwise. */
+			for (j = 0; j < SAMPLES; j++) {
+				values[0] = j * 1e-6;
+				values[1] = 0.5;
+				values[2] = 0.25 + j * 1e-7;
+				for (l = 0; l < count; l++)
+					point[l] = values[map[l]];
+				if (engine) {
+					start = timer_ticks();
+					sink =
+					    engine->evaluate(engine->code,
+							     point);
+				} else {
+					for (l = 0; l < count; l++)
+						records[l]->data.value =
+						    point[l];
+					start = timer_ticks();
+					sink = node_evaluate(root);
+				}
+				times[j] = timer_ticks() - start - overhead;
+			}
+
+			/* Report percentiles. */
+			qsort(times, SAMPLES, sizeof(double), compare);
+			printf(" %5.1f/%5.1f", times[SAMPLES / 2] * tick,
+			       times[SAMPLES * 99 / 100] * tick);
+			if (engines[k] == EVALUATOR_ENGINE_TREE)
+				tree = times[SAMPLES / 2];
+			evaluator_destroy(evaluator);
+		}
+
+		/* Time evaluator_evaluate() calls with tree engine, and
+		 * report median time added to tree evaluation. */
+		evaluator = evaluator_create(corpus[i]);
+		for (j = 0; j < SAMPLES; j++) {
+			values[0] = j * 1e-6;
+			values[1] = 0.5;
+			values[2] = 0.25 + j * 1e-7;
+			start = timer_ticks();
+			sink = evaluator_evaluate(evaluator, 3, names, values);
+			times[j] = timer_ticks() - start - overhead;
+		}
+		qsort(times, SAMPLES, sizeof(double), compare);
+		printf(" %+11.1f\n", (times[SAMPLES / 2] - tree) * tick);
+		evaluator_destroy(evaluator);
+	}
+	free(times);
+
+	return EXIT_SUCCESS;
+}
+
+static int
+compare(const void *first, const void *second)
+{
+	double          a = *(double *) first,
+	    b = *(double *) second;	/* Times compared.  */
+
+	return (a > b) - (a < b);
+}
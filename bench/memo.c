@@ -0,0 +1,133 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Report hit rate, evictions and time per call of memoized evaluation,
+ * compared with evaluation without memoization, for points drawn
+ * uniformly from grids of several sizes, with memoization tables of
+ * several sizes.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+#include "timer.h"
+
+/* Function evaluated.  */
+#define FUNCTION "sin(x)*exp(-y^2/3)+log(1+z^2)*atan(x*y)+erf(z-x)"
+
+/* Number of points drawn for single call of measured functions.  */
+#define POINTS 4096
+
+/* Number of calls and repetitions of measurement.  */
+#define CALLS 50
+#define REPETITIONS 5
+
+/* Data of measured functions.  */
+typedef struct {
+	void           *evaluator;	/* Evaluator of function.  */
+	double         *values;	/* Variable values of points, three
+				 * for each point.  */
+	double          sum;	/* Sum of results, to keep them alive.  */
+} Data;
+
+/* Evaluate function at all points.  */
+static void     evaluate(void *data);
+
+int
+main(void)
+{
+	int             tables[] = { 256, 4096 };	/* Table sizes.  */
+	int             grids[] = { 64, 1024, 16384 };	/* Numbers of grid 
+							 * points.  */
+	Data            data;	/* Data of measured functions.  */
+	double          plain;	/* Time without memoization.  */
+	double          memoized;	/* Time with memoization.  */
+	long            hits,
+	                misses,
+	                evictions;	/* Memoization statistics.  */
+	unsigned long   state;	/* State of pseudo-random number
+				 * generator.  */
+	int             index;	/* Index of grid point.  */
+	int             i,
+	                j,
+	                k;	/* Loop counters.  */
+
+	data.values = malloc(3 * POINTS * sizeof(double));
+	printf("%8s %8s %10s %14s %12s %12s\n", "table", "grid", "hit rate",
+	       "evictions", "memo ns", "plain ns");
+	for (i = 0; i < (int) (sizeof(grids) / sizeof(grids[0])); i++) {
+		/* Draw points from grid, with 16 values of first two
+		 * variables, and rest of points spread over values of
+		 * third one. */
+		state = 1;
+		for (k = 0; k < POINTS; k++) {
+			state =
+			    (state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+			index = (state >> 4) % grids[i];
+			data.values[3 * k] = index % 16 * 0.25;
+			data.values[3 * k + 1] = index / 16 % 16 * 0.5 - 4;
+			data.values[3 * k + 2] = index / 256 * 0.125;
+		}
+
+		/* Measure evaluation without memoization. */
+		data.evaluator = evaluator_create(FUNCTION);
+		data.sum = 0;
+		plain =
+		    timer_measure(evaluate, &data, CALLS,
+				  REPETITIONS) / POINTS;
+		evaluator_destroy(data.evaluator);
+
+		for (j = 0; j < (int) (sizeof(tables) / sizeof(tables[0]));
+		     j++) {
+			/* Measure evaluation with memoization, and report
+			 * statistics over all calls. */
+			data.evaluator = evaluator_create(FUNCTION);
+			evaluator_set_memo(data.evaluator, tables[j]);
+			memoized =
+			    timer_measure(evaluate, &data, CALLS,
+					  REPETITIONS) / POINTS;
+			evaluator_get_memo_statistics(data.evaluator, &hits,
+						      &misses, &evictions);
+			printf("%8d %8d %9.1f%% %14ld %12.2f %12.2f\n",
+			       tables[j], grids[i],
+			       100.0 * hits / (hits + misses), evictions,
+			       memoized, plain);
+			evaluator_destroy(data.evaluator);
+		}
+	}
+	free(data.values);
+
+	return EXIT_SUCCESS;
+}
+
+static void
+evaluate(void *data)
+{
+	Data           *this = data;	/* Data of measured function.  */
+	char           *names[] = { "x", "y", "z" };	/* Variable names. 
+							 */
+	int             i;	/* Loop counter.  */
+
+	for (i = 0; i < POINTS; i++)
+		this->sum +=
+		    evaluator_evaluate(this->evaluator, 3, names,
+				       &this->values[3 * i]);
+}
@@ -0,0 +1,143 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Report speedup of evaluating polynomials, written as sums of c*x^k
+ * terms, thanks to their recognition and evaluation from packed
+ * coefficients in Horner or Estrin form, over term by term evaluation
+ * with pow() that such trees were evaluated with before (written in C,
+ * so that reported speedup does not include overhead of traversing
+ * tree of terms).  */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <matheval.h>
+#include "timer.h"
+
+/* Number of points evaluated in single call of measured functions.  */
+#define POINTS 1024
+
+/* Number of calls and repetitions of measurement.  */
+#define CALLS 200
+#define REPETITIONS 7
+
+/* Data of measured functions.  */
+typedef struct {
+	void           *evaluator;	/* Evaluator of polynomial.  */
+	double         *coefficients;	/* Polynomial coefficients.  */
+	int             degree;	/* Polynomial degree.  */
+	double         *points;	/* Values of variable.  */
+	double          sum;	/* Sum of results, to keep them alive.  */
+} Data;
+
+/* Evaluate polynomial at all points through library.  */
+static void     evaluate_library(void *data);
+
+/* Evaluate polynomial at all points term by term with pow().  */
+static void     evaluate_terms(void *data);
+
+int
+main(void)
+{
+	int             degrees[] = { 5, 10, 20, 30, 40, 50 };	/* Measured 
+								 * degrees. 
+								 */
+	Data            data;	/* Data of measured functions.  */
+	char           *string;	/* Polynomial string.  */
+	int             length;	/* Length of above string.  */
+	double          library;	/* Time of library evaluation.  */
+	double          terms;	/* Time of term by term evaluation.  */
+	int             i,
+	                k;	/* Loop counters.  */
+
+	/* Initialize points spread over interval where polynomials are
+	 * well conditioned. */
+	data.points = malloc(POINTS * sizeof(double));
+	for (i = 0; i < POINTS; i++)
+		data.points[i] = -0.9 + 1.8 * i / POINTS;
+
+	printf("%-8s %14s %14s %9s\n", "degree", "library ns", "terms ns",
+	       "speedup");
+	for (i = 0; i < (int) (sizeof(degrees) / sizeof(degrees[0])); i++) {
+		/* Write polynomial with coefficients 1/(k+1) as sum of
+		 * terms. */
+		data.degree = degrees[i];
+		data.coefficients = malloc((data.degree + 1) * sizeof(double));
+		string = malloc((data.degree + 1) * 40);
+		for (k = length = 0; k <= data.degree; k++) {
+			data.coefficients[k] = 1.0 / (k + 1);
+			length +=
+			    sprintf(string + length, "%s%.17g*x^%d",
+				    k ? "+" : "", data.coefficients[k], k);
+		}
+		data.evaluator = evaluator_create(string);
+
+		/* Measure and report time of evaluation per point. */
+		data.sum = 0;
+		library =
+		    timer_measure(evaluate_library, &data, CALLS,
+				  REPETITIONS) / POINTS;
+		terms =
+		    timer_measure(evaluate_terms, &data, CALLS,
+				  REPETITIONS) / POINTS;
+		printf("%-8d %14.2f %14.2f %8.2fx\n", data.degree, library,
+		       terms, terms / library);
+
+		evaluator_destroy(data.evaluator);
+		free(string);
+		free(data.coefficients);
+	}
+	free(data.points);
+
+	return EXIT_SUCCESS;
+}
+
+static void
+evaluate_library(void *data)
+{
+	Data           *this = data;	/* Data of measured function.  */
+	char           *names[] = { "x" };	/* Variable names.  */
+	int             i;	/* Loop counter.  */
+
+	for (i = 0; i < POINTS; i++)
+		this->sum +=
+		    evaluator_evaluate(this->evaluator, 1, names,
+				       &this->points[i]);
+}
+
+static void
+evaluate_terms(void *data)
+{
+	Data           *this = data;	/* Data of measured function.  */
+	double          value;	/* Polynomial value.  */
+	int             i,
+	                k;	/* Loop counters.  */
+
+	for (i = 0; i < POINTS; i++) {
+		value = 0;
+		for (k = 0; k <= this->degree; k++)
+			value +=
+			    this->coefficients[k] * pow(this->points[i], k);
+		this->sum += value;
+	}
+}
@@ -0,0 +1,85 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "timer.h"
+
+double
+timer_now(void)
+{
+	struct timespec time;	/* Current time.  */
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+double
+timer_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int    processor;	/* Processor identifier (unused).  */
+
+	return __rdtscp(&processor);
+#else
+	return timer_now() * 1e9;
+#endif
+}
+
+double
+timer_tick_ns(void)
+{
+	double          start;	/* Start of calibration, in seconds.  */
+	double          ticks;	/* Counter at start of calibration.  */
+
+	/* Count ticks during 20 milliseconds. */
+	start = timer_now();
+	ticks = timer_ticks();
+	while (timer_now() - start < 0.02);
+	return (timer_now() - start) * 1e9 / (timer_ticks() - ticks);
+}
+
+double
+timer_measure(void (*function) (void *data), void *data, int calls,
+	      int repetitions)
+{
+	double          start;	/* Start of repetition.  */
+	double          elapsed;	/* Time of repetition.  */
+	double          best;	/* Shortest time of repetition.  */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* Repeat calls, keeping shortest time, in order to filter out
+	 * interference of other processes. */
+	best = 0;
+	for (i = 0; i < repetitions; i++) {
+		start = timer_now();
+		for (j = 0; j < calls; j++)
+			function(data);
+		elapsed = timer_now() - start;
+		if (i == 0 || elapsed < best)
+			best = elapsed;
+	}
+	return best / calls * 1e9;
+}
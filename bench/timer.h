@@ -0,0 +1,44 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TIMER_H
+#define TIMER_H 1
+
+/* Return current time of monotonic clock, in seconds.  */
+double          timer_now(void);
+
+/* Return current value of processor time stamp counter, read after
+ * preceding instructions completed, or current time of monotonic clock
+ * in nanoseconds where counter not available.  Reading is much cheaper
+ * than timer_now(), so that it is suitable for timing single calls.  */
+double          timer_ticks(void);
+
+/* Return duration of single tick of above counter, in nanoseconds.  */
+double          timer_tick_ns(void);
+
+/* Return time, in nanoseconds, of single call of given function for
+ * given data, as smallest average over given number of repetitions of
+ * given number of calls.  */
+double          timer_measure(void (*function) (void *data), void *data,
+			      int calls, int repetitions);
+
+#endif
@@ -0,0 +1,45 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef APPROX_H
+#define APPROX_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* Return approximation of given function of one argument (one of
+ * functions predefined in symbol table), with relative error below
+ * 1e-7, or below 1e-4 if second argument non-zero.  Function itself is
+ * returned if not approximated (functions for which C library
+ * implementation is not slower, like exponential function, logarithm
+ * and inverse functions except inverse tangent and cotangent, cheap
+ * functions like square root, and functions not predefined);
+ * approximation of other tier is replaced by requested one.  */
+double          (*approx_function(double (*function) (double),
+				  int coarse)) (double);
+
+/* Return function approximated by given function, or function itself if
+ * not approximation.  */
+double          (*approx_exact(double (*function) (double))) (double);
+
+#endif
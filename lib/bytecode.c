@@ -0,0 +1,1112 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include "bytecode.h"
+#include "common.h"
+#include "isa.h"
+#include "matheval.h"
+#include "xmath.h"
+
+/* Default, minimal and maximal number of points in tile.  */
+#define TILE_DEFAULT 512
+#define TILE_MIN 16
+#define TILE_MAX 65536
+
+/* Number of points processed at once by vector loops (64 bytes, that is
+ * one AVX-512, two AVX or four SSE registers).  */
+#define VECTOR_SIZE 8
+
+#if defined __GNUC__
+/* Vector of values processed at once; alignment is lowered to that of
+ * double, so that vector could start at any point of tile.  */
+typedef double  Vector
+    __attribute__ ((vector_size(VECTOR_SIZE * sizeof(double)),
+		    aligned(sizeof(double)), may_alias));
+
+/* Same as above for single precision values (twice as many of them
+ * fitting into same registers).  */
+typedef float   FloatVector
+    __attribute__ ((vector_size(VECTOR_SIZE * sizeof(double)),
+		    aligned(sizeof(float)), may_alias));
+#define FLOAT_VECTOR_SIZE (2 * VECTOR_SIZE)
+
+/* Vector lvalue of values at current point of given tile-sized vector. */
+#define V(vector) (*(Vector *) ((vector) + j))
+#define F(vector) (*(FloatVector *) ((vector) + j))
+
+/* Loop over tile, using first statement for vectors of points and second 
+ * statement for remaining points.  */
+#define ELEMENTWISE(vector, scalar) \
+	do { \
+		for (j = 0; j + VECTOR_SIZE <= length; j += VECTOR_SIZE) \
+			vector; \
+		for (; j < length; j++) \
+			scalar; \
+	} while (0)
+#define ELEMENTWISE_FLOAT(vector, scalar) \
+	do { \
+		for (j = 0; j + FLOAT_VECTOR_SIZE <= length; \
+		     j += FLOAT_VECTOR_SIZE) \
+			vector; \
+		for (; j < length; j++) \
+			scalar; \
+	} while (0)
+#else
+#define ELEMENTWISE(vector, scalar) \
+	do { \
+		for (j = 0; j < length; j++) \
+			scalar; \
+	} while (0)
+#define ELEMENTWISE_FLOAT ELEMENTWISE
+#endif
+
+/* Instruction opcodes.  Suffix C denotes constant right operand, prefix
+ * C constant left operand.  */
+enum {
+	OP_COPY, OP_FILL, OP_NEG, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+	OP_ADDC, OP_SUBC, OP_CSUB, OP_MULC, OP_DIVC, OP_CDIV, OP_POWC,
+	OP_CPOW, OP_POWI, OP_HORNER, OP_ESTRIN, OP_FMA, OP_SQRT, OP_ABS,
+	OP_CALL
+};
+
+/* Operand kinds.  */
+enum {
+	OPERAND_VECTOR, OPERAND_CONSTANT
+};
+
+/* Data structure representing operand during bytecode generation.  */
+typedef struct {
+	int             kind;	/* Operand kind. */
+	int             index;	/* Index of vector holding operand
+				 * values. */
+	double          value;	/* Constant value. */
+} Operand;
+
+/* Data structure representing instruction.  Operands and destination are 
+ * indices of vectors: first come variables, then scratch vectors and
+ * finally results.  */
+typedef struct {
+	int             opcode;	/* Instruction opcode. */
+	int             destination;	/* Destination vector. */
+	int             left;	/* First operand vector. */
+	int             right;	/* Second operand vector, or scratch
+				 * vector for integer power. */
+	int             addend;	/* Third operand vector. */
+	double          constant;	/* Constant operand. */
+	int             exponent;	/* Integer exponent. */
+	double         *coefficients;	/* Polynomial coefficients. */
+	float          *coefficients_float;	/* Polynomial coefficients
+						 * in single precision. */
+	int             degree;	/* Polynomial degree. */
+	double          (*function) (double);	/* Called function. */
+	float           (*function_float) (float);	/* Single precision 
+							 * version of
+							 * called function,
+							 * if known. */
+} Instruction;
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	Instruction    *instructions;	/* Instructions. */
+	int             length;	/* Number of instructions. */
+	int             capacity;	/* Capacity of instructions array. */
+	int             count;	/* Number of function variables. */
+	int             depth;	/* Number of scratch vectors in use
+				 * during generation. */
+	int             scratch;	/* Number of scratch vectors. */
+	int             tile;	/* Number of points in tile. */
+	int             isa;	/* Execution kernel variant. */
+	double         *memory;	/* Memory for scratch vectors. */
+	double        **vectors;	/* Pointers to variables values,
+					 * scratch vectors and results for
+					 * current tile. */
+	float          *memory_float;	/* Memory for single precision
+					 * scratch vectors, or null pointer 
+					 * if not used yet. */
+	float         **vectors_float;	/* Same as vectors above, for
+					 * single precision evaluation. */
+} Bytecode;
+
+/* Generate instructions calculating value of subtree rooted at given
+ * node, and store operand holding this value.  */
+static void     generate(Bytecode * bytecode, Node * node,
+			 Record ** records, Operand * operand);
+
+/* Append instruction with given opcode, destination and operands to
+ * program, and return pointer to it.  */
+static Instruction *emit(Bytecode * bytecode, int opcode, int destination,
+			 int left, int right);
+
+/* Return vector holding value of given operand, filling scratch vector
+ * with constant if needed.  */
+static int      vector_operand(Bytecode * bytecode, Operand * operand);
+
+/* Allocate scratch vector for result of operation on given operands
+ * (reusing scratch vector of one of operands if possible), releasing
+ * operands scratch vectors.  */
+static int      allocate(Bytecode * bytecode, Operand * first,
+			 Operand * second, Operand * third);
+
+/* Execute program for given number of points, with vectors already set 
+ * up.  Function is inlined into kernel variants below, each compiled for
+ * different instruction set.  */
+static inline void execute(Bytecode * bytecode, int length)
+#if defined __GNUC__
+    __attribute__ ((always_inline))
+#endif
+;
+
+/* Same as above, in single precision.  */
+static inline void execute_float(Bytecode * bytecode, int length)
+#if defined __GNUC__
+    __attribute__ ((always_inline))
+#endif
+;
+
+/* Kernel variants, executing program in single precision if last
+ * argument non-zero. */
+static void     execute_generic(Bytecode * bytecode, int length,
+				int single);
+#if ISA_DISPATCH
+static void     execute_sse42(Bytecode * bytecode, int length,
+			      int single) ISA_TARGET("sse4.2");
+static void     execute_avx2(Bytecode * bytecode, int length,
+			     int single) ISA_TARGET("avx2");
+static void     execute_avx512f(Bytecode * bytecode, int length,
+				int single) ISA_TARGET("avx512f");
+#endif
+
+#if defined __GNUC__
+/* Set all elements of given vector to value given.  */
+static inline void broadcast(Vector * vector, double value);
+static inline void broadcast_float(FloatVector * vector, float value);
+#endif
+
+/* Calculate function value using bytecode.  */
+static double   bytecode_evaluate(void *code, double *values);
+
+/* Calculate function values for batch of points using bytecode.  */
+static void     bytecode_evaluate_batch(void *code, double **values,
+					int length, double *results);
+
+/* Destroy bytecode.  */
+static void     bytecode_destroy(void *code);
+
+/* Kernel variants, indexed by instruction set variant.  */
+static void     (*kernels[]) (Bytecode *, int, int) = {
+#if ISA_DISPATCH
+	execute_avx512f, execute_avx2, execute_sse42,
+#endif
+	execute_generic
+};
+
+Engine         *
+bytecode_create(Node * root, Record ** records, int count)
+{
+	Bytecode       *bytecode;	/* Compiled function. */
+	Engine         *engine;	/* Engine data structure. */
+	Operand         operand;	/* Operand holding function value. */
+	char           *tile;	/* Tile size given by environment. */
+	int             result;	/* Index of results vector. */
+	int             i;	/* Loop counter. */
+
+	/* Initialize bytecode data structure. */
+	bytecode = XMALLOC(Bytecode, 1);
+	bytecode->capacity = 16;
+	bytecode->instructions = XMALLOC(Instruction, bytecode->capacity);
+	bytecode->length = 0;
+	bytecode->count = count;
+	bytecode->depth = bytecode->scratch = 0;
+	bytecode->isa = isa_select();
+	tile = getenv("MATHEVAL_TILE");
+	bytecode->tile = tile ? atoi(tile) : TILE_DEFAULT;
+	if (bytecode->tile < TILE_MIN)
+		bytecode->tile = TILE_MIN;
+	if (bytecode->tile > TILE_MAX)
+		bytecode->tile = TILE_MAX;
+
+	/* Generate instructions, and make last of them store function
+	 * values into results vector (copying or filling results vector
+	 * if function is single variable or constant).  As results
+	 * vector index depends on number of scratch vectors, instructions 
+	 * use placeholder index -1 for it. */
+	generate(bytecode, root, records, &operand);
+	if (operand.kind == OPERAND_CONSTANT)
+		emit(bytecode, OP_FILL, -1, 0, 0)->constant = operand.value;
+	else if (operand.index < count || bytecode->length == 0)
+		emit(bytecode, OP_COPY, -1, operand.index, 0);
+	else
+		bytecode->instructions[bytecode->length - 1].destination = -1;
+	result = count + bytecode->scratch;
+	for (i = 0; i < bytecode->length; i++)
+		if (bytecode->instructions[i].destination < 0)
+			bytecode->instructions[i].destination = result;
+
+	/* Allocate scratch vectors, and set up their pointers. */
+	bytecode->memory =
+	    XMALLOC(double, (size_t) bytecode->scratch * bytecode->tile + 1);
+	bytecode->vectors = XMALLOC(double *, result + 1);
+	bytecode->memory_float = NULL;
+	bytecode->vectors_float = NULL;
+	for (i = 0; i < bytecode->scratch; i++)
+		bytecode->vectors[count + i] =
+		    bytecode->memory + (size_t) i *bytecode->tile;
+
+	/* Create engine data structure. */
+	engine = XMALLOC(Engine, 1);
+	engine->type = EVALUATOR_ENGINE_BYTECODE;
+	engine->count = count;
+	engine->code = bytecode;
+	engine->evaluate = bytecode_evaluate;
+	engine->evaluate_batch = bytecode_evaluate_batch;
+	engine->destroy = bytecode_destroy;
+	engine->scalar_code = engine->batch_code = NULL;
+	engine->scalar_size = engine->batch_size = 0;
+
+	return engine;
+}
+
+void
+bytecode_evaluate_batch_float(void *code, float **values, int length,
+			      float *results)
+{
+	Bytecode       *bytecode;	/* Compiled function. */
+	int             tile;	/* Number of points in current tile. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Allocate single precision scratch vectors on first use. */
+	bytecode = code;
+	if (!bytecode->memory_float) {
+		bytecode->memory_float =
+		    XMALLOC(float,
+			    (size_t) bytecode->scratch * bytecode->tile + 1);
+		bytecode->vectors_float =
+		    XMALLOC(float *,
+			    bytecode->count + bytecode->scratch + 1);
+		for (i = 0; i < bytecode->scratch; i++)
+			bytecode->vectors_float[bytecode->count + i] =
+			    bytecode->memory_float +
+			    (size_t) i *bytecode->tile;
+	}
+
+	/* Execute program for each tile of points, as in double precision 
+	 * batch evaluation. */
+	for (j = 0; j < length; j += bytecode->tile) {
+		tile =
+		    (length - j <
+		     bytecode->tile) ? length - j : bytecode->tile;
+		for (i = 0; i < bytecode->count; i++)
+			bytecode->vectors_float[i] = values[i] + j;
+		bytecode->vectors_float[bytecode->count +
+					bytecode->scratch] = results + j;
+		kernels[bytecode->isa] (bytecode, tile, TRUE);
+	}
+}
+
+static void
+generate(Bytecode * bytecode, Node * node, Record ** records,
+	 Operand * operand)
+{
+	static struct {
+		char            operation;	/* Operation. */
+		int             opcode;	/* Opcode for vector operands. */
+		int             opcode_right;	/* Opcode for constant
+						 * right operand. */
+		int             opcode_left;	/* Opcode for constant left 
+						 * operand. */
+	} operations[] = {
+		{
+		'+', OP_ADD, OP_ADDC, OP_ADDC}, {
+		'-', OP_SUB, OP_SUBC, OP_CSUB}, {
+		'*', OP_MUL, OP_MULC, OP_MULC}, {
+		'/', OP_DIV, OP_DIVC, OP_CDIV}, {
+		'^', OP_POW, OP_POWC, OP_CPOW}
+	};			/* Opcodes for binary operations. */
+	Operand         left,
+	                right,
+	                addend;	/* Operands. */
+	Instruction    *instruction;	/* Instruction emitted. */
+	int             destination;	/* Destination vector. */
+	int             i;	/* Loop counter. */
+
+	/* According to node type, generate instructions calculating value 
+	 * of subtree rooted at node. */
+	switch (node->type) {
+	case 'n':
+	case 'c':
+		/* Numbers and constants are constant operands. */
+		operand->kind = OPERAND_CONSTANT;
+		operand->value =
+		    (node->type == 'n') ? node->data.number : node->data.
+		    constant->data.value;
+		break;
+
+	case 'v':
+		/* Variables are read directly from vectors of variable
+		 * values. */
+		operand->kind = OPERAND_VECTOR;
+		for (i = 0; i < bytecode->count; i++)
+			if (records[i] == node->data.variable)
+				break;
+		operand->index = i;
+		break;
+
+	case 'f':
+		/* Square root and absolute value get own opcodes, so that
+		 * loops over tile could be vectorized; other functions
+		 * are called for each point. */
+		generate(bytecode, node->data.function.child, records, &left);
+		left.index = vector_operand(bytecode, &left);
+		destination = allocate(bytecode, &left, NULL, NULL);
+		if (node->data.function.record->data.function == sqrt)
+			emit(bytecode, OP_SQRT, destination, left.index, 0);
+		else if (node->data.function.record->data.function == fabs)
+			emit(bytecode, OP_ABS, destination, left.index, 0);
+		else {
+			instruction =
+			    emit(bytecode, OP_CALL, destination,
+				 left.index, 0);
+			instruction->function =
+			    node->data.function.record->data.function;
+			instruction->function_float =
+			    math_float_function(instruction->function);
+		}
+		operand->kind = OPERAND_VECTOR;
+		operand->index = destination;
+		break;
+
+	case 'u':
+		/* Negate operand. */
+		generate(bytecode, node->data.un_op.child, records, &left);
+		if (left.kind == OPERAND_CONSTANT) {
+			operand->kind = OPERAND_CONSTANT;
+			operand->value = -left.value;
+			break;
+		}
+		destination = allocate(bytecode, &left, NULL, NULL);
+		emit(bytecode, OP_NEG, destination, left.index, 0);
+		operand->kind = OPERAND_VECTOR;
+		operand->index = destination;
+		break;
+
+	case 'b':
+		/* Use opcode for vector operands, or for one of operands
+		 * constant if possible. */
+		generate(bytecode, node->data.bin_op.left, records, &left);
+		generate(bytecode, node->data.bin_op.right, records, &right);
+		for (i = 0; operations[i].operation != node->data.bin_op.operation;
+		     i++);
+		if (left.kind == OPERAND_CONSTANT
+		    && right.kind == OPERAND_CONSTANT)
+			left.index = vector_operand(bytecode, &left);
+		destination = allocate(bytecode, &left, &right, NULL);
+		if (right.kind == OPERAND_CONSTANT)
+			emit(bytecode, operations[i].opcode_right,
+			     destination, left.index, 0)->constant =
+			    right.value;
+		else if (left.kind == OPERAND_CONSTANT)
+			emit(bytecode, operations[i].opcode_left,
+			     destination, right.index, 0)->constant =
+			    left.value;
+		else
+			emit(bytecode, operations[i].opcode, destination,
+			     left.index, right.index);
+		operand->kind = OPERAND_VECTOR;
+		operand->index = destination;
+		break;
+
+	case 'p':
+		/* Integer power uses additional scratch vector for
+		 * successive squares of base. */
+		generate(bytecode, node->data.power.child, records, &left);
+		left.index = vector_operand(bytecode, &left);
+		destination = allocate(bytecode, &left, NULL, NULL);
+		right.kind = OPERAND_VECTOR;
+		right.index = allocate(bytecode, NULL, NULL, NULL);
+		emit(bytecode, OP_POWI, destination, left.index,
+		     right.index)->exponent = node->data.power.exponent;
+		bytecode->depth--;
+		operand->kind = OPERAND_VECTOR;
+		operand->index = destination;
+		break;
+
+	case 'h':
+		/* Polynomial is evaluated in Horner or Estrin form, as in
+		 * tree representation; Horner form uses additional scratch
+		 * vector for copy of argument. */
+		generate(bytecode, node->data.polynomial.child, records,
+			 &left);
+		left.index = vector_operand(bytecode, &left);
+		destination = allocate(bytecode, &left, NULL, NULL);
+		right.kind = OPERAND_VECTOR;
+		right.index = allocate(bytecode, NULL, NULL, NULL);
+		instruction =
+		    emit(bytecode,
+			 (node->data.polynomial.degree >=
+			  MATH_ESTRIN_MIN) ? OP_ESTRIN : OP_HORNER,
+			 destination, left.index, right.index);
+		instruction->coefficients =
+		    node->data.polynomial.coefficients;
+		instruction->degree = node->data.polynomial.degree;
+		instruction->coefficients_float =
+		    XMALLOC(float, instruction->degree + 1);
+		for (i = 0; i <= instruction->degree; i++)
+			instruction->coefficients_float[i] =
+			    instruction->coefficients[i];
+		bytecode->depth--;
+		operand->kind = OPERAND_VECTOR;
+		operand->index = destination;
+		break;
+
+	case 'm':
+		/* Fused multiply-add has all operands as vectors. */
+		generate(bytecode, node->data.muladd.left, records, &left);
+		left.index = vector_operand(bytecode, &left);
+		generate(bytecode, node->data.muladd.right, records, &right);
+		right.index = vector_operand(bytecode, &right);
+		generate(bytecode, node->data.muladd.addend, records,
+			 &addend);
+		addend.index = vector_operand(bytecode, &addend);
+		destination = allocate(bytecode, &left, &right, &addend);
+		emit(bytecode, OP_FMA, destination, left.index,
+		     right.index)->addend = addend.index;
+		operand->kind = OPERAND_VECTOR;
+		operand->index = destination;
+		break;
+	}
+}
+
+static Instruction *
+emit(Bytecode * bytecode, int opcode, int destination, int left, int right)
+{
+	Instruction    *instruction;	/* Instruction appended. */
+
+	/* Grow instructions array if needed, and append instruction. */
+	if (bytecode->length == bytecode->capacity) {
+		bytecode->capacity *= 2;
+		bytecode->instructions =
+		    XREALLOC(Instruction, bytecode->instructions,
+			     bytecode->capacity);
+	}
+	instruction = &bytecode->instructions[bytecode->length++];
+	memset(instruction, 0, sizeof(Instruction));
+	instruction->opcode = opcode;
+	instruction->destination = destination;
+	instruction->left = left;
+	instruction->right = right;
+	return instruction;
+}
+
+static int
+vector_operand(Bytecode * bytecode, Operand * operand)
+{
+	int             destination;	/* Scratch vector filled. */
+
+	/* Fill scratch vector with constant operand value. */
+	if (operand->kind == OPERAND_CONSTANT) {
+		destination = allocate(bytecode, NULL, NULL, NULL);
+		emit(bytecode, OP_FILL, destination, 0, 0)->constant =
+		    operand->value;
+		operand->kind = OPERAND_VECTOR;
+		operand->index = destination;
+	}
+	return operand->index;
+}
+
+static int
+allocate(Bytecode * bytecode, Operand * first, Operand * second,
+	 Operand * third)
+{
+	Operand        *operands[3];	/* Operands. */
+	int             released;	/* Number of scratch vectors
+					 * released. */
+	int             i;	/* Loop counter. */
+
+	/* Release scratch vectors of operands; as scratch vectors are
+	 * used in stack order, these are topmost ones. */
+	operands[0] = first;
+	operands[1] = second;
+	operands[2] = third;
+	released = 0;
+	for (i = 0; i < 3; i++)
+		if (operands[i] && operands[i]->kind == OPERAND_VECTOR
+		    && operands[i]->index >= bytecode->count)
+			released++;
+	bytecode->depth -= released;
+
+	/* Allocate topmost scratch vector (same as first operand scratch
+	 * vector if any, as operations read operand value for a point
+	 * before storing result for it). */
+	if (++bytecode->depth > bytecode->scratch)
+		bytecode->scratch = bytecode->depth;
+	return bytecode->count + bytecode->depth - 1;
+}
+
+static inline void
+execute(Bytecode * bytecode, int length)
+{
+#if defined __clang__
+#pragma clang fp contract(off)
+#endif
+	Instruction    *instruction;	/* Current instruction. */
+	double         *destination;	/* Destination vector. */
+	double         *left,
+	               *right,
+	               *addend;	/* Operand vectors. */
+	double          constant;	/* Constant operand. */
+#if defined __GNUC__
+	Vector          fill;	/* Vector of constant operand or
+				 * coefficient. */
+#endif
+	unsigned        m;	/* Absolute value of exponent. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Execute each instruction as loop over points; arithmetic
+	 * operations are done on vectors of points explicitly, so that
+	 * each kernel variant uses vector instructions of its own
+	 * instruction set. */
+	for (instruction = bytecode->instructions;
+	     instruction < bytecode->instructions + bytecode->length;
+	     instruction++) {
+		destination = bytecode->vectors[instruction->destination];
+		left = bytecode->vectors[instruction->left];
+		right = bytecode->vectors[instruction->right];
+		constant = instruction->constant;
+		switch (instruction->opcode) {
+		case OP_COPY:
+			ELEMENTWISE(V(destination) = V(left),
+				    destination[j] = left[j]);
+			break;
+
+		case OP_FILL:
+#if defined __GNUC__
+			broadcast(&fill, constant);
+#endif
+			ELEMENTWISE(V(destination) = fill,
+				    destination[j] = constant);
+			break;
+
+		case OP_NEG:
+			ELEMENTWISE(V(destination) = -V(left),
+				    destination[j] = -left[j]);
+			break;
+
+		case OP_ADD:
+			ELEMENTWISE(V(destination) = V(left) + V(right),
+				    destination[j] = left[j] + right[j]);
+			break;
+
+		case OP_SUB:
+			ELEMENTWISE(V(destination) = V(left) - V(right),
+				    destination[j] = left[j] - right[j]);
+			break;
+
+		case OP_MUL:
+			ELEMENTWISE(V(destination) = V(left) * V(right),
+				    destination[j] = left[j] * right[j]);
+			break;
+
+		case OP_DIV:
+			ELEMENTWISE(V(destination) = V(left) / V(right),
+				    destination[j] = left[j] / right[j]);
+			break;
+
+		case OP_POW:
+			for (j = 0; j < length; j++)
+				destination[j] = math_pow(left[j], right[j]);
+			break;
+
+		case OP_ADDC:
+			ELEMENTWISE(V(destination) = V(left) + constant,
+				    destination[j] = left[j] + constant);
+			break;
+
+		case OP_SUBC:
+			ELEMENTWISE(V(destination) = V(left) - constant,
+				    destination[j] = left[j] - constant);
+			break;
+
+		case OP_CSUB:
+			ELEMENTWISE(V(destination) = constant - V(left),
+				    destination[j] = constant - left[j]);
+			break;
+
+		case OP_MULC:
+			ELEMENTWISE(V(destination) = V(left) * constant,
+				    destination[j] = left[j] * constant);
+			break;
+
+		case OP_DIVC:
+			ELEMENTWISE(V(destination) = V(left) / constant,
+				    destination[j] = left[j] / constant);
+			break;
+
+		case OP_CDIV:
+			ELEMENTWISE(V(destination) = constant / V(left),
+				    destination[j] = constant / left[j]);
+			break;
+
+		case OP_POWC:
+			for (j = 0; j < length; j++)
+				destination[j] = math_pow(left[j], constant);
+			break;
+
+		case OP_CPOW:
+			for (j = 0; j < length; j++)
+				destination[j] = math_pow(constant, left[j]);
+			break;
+
+		case OP_POWI:
+			/* Repeated squaring as in math_powi(), with loop
+			 * over exponent bits outside loops over points
+			 * (right vector holds successive squares). */
+			m = (instruction->exponent <
+			     0) ? -(unsigned) instruction->exponent :
+			    (unsigned) instruction->exponent;
+#if defined __GNUC__
+			broadcast(&fill, 1);
+#endif
+			ELEMENTWISE((V(right) = V(left), V(destination) =
+				     fill), (right[j] = left[j],
+					     destination[j] = 1));
+			for (; m; m >>= 1) {
+				if (m & 1)
+					ELEMENTWISE(V(destination) *= V(right),
+						    destination[j] *= right[j]);
+				if (m > 1)
+					ELEMENTWISE(V(right) *= V(right),
+						    right[j] *= right[j]);
+			}
+			if (instruction->exponent < 0)
+				ELEMENTWISE(V(destination) =
+					    1 / V(destination),
+					    destination[j] =
+					    1 / destination[j]);
+			break;
+
+		case OP_HORNER:
+			/* Nested multiplication as in math_horner(), with
+			 * loop over coefficients outside loops over points
+			 * (argument is copied to right vector first if
+			 * destination is same as argument). */
+			if (destination == left) {
+				ELEMENTWISE(V(right) = V(left),
+					    right[j] = left[j]);
+				left = right;
+			}
+			constant =
+			    instruction->coefficients[instruction->degree];
+#if defined __GNUC__
+			broadcast(&fill, constant);
+#endif
+			ELEMENTWISE(V(destination) = fill,
+				    destination[j] = constant);
+			for (i = instruction->degree - 1; i >= 0; i--) {
+				constant = instruction->coefficients[i];
+				ELEMENTWISE(V(destination) =
+					    V(destination) * V(left) +
+					    constant, destination[j] =
+					    destination[j] * left[j] +
+					    constant);
+			}
+			break;
+
+		case OP_ESTRIN:
+			for (j = 0; j < length; j++)
+				destination[j] =
+				    math_estrin(left[j],
+						instruction->coefficients,
+						instruction->degree);
+			break;
+
+		case OP_FMA:
+			addend = bytecode->vectors[instruction->addend];
+			for (j = 0; j < length; j++)
+				destination[j] =
+				    fma(left[j], right[j], addend[j]);
+			break;
+
+		case OP_SQRT:
+			for (j = 0; j < length; j++)
+				destination[j] = sqrt(left[j]);
+			break;
+
+		case OP_ABS:
+			for (j = 0; j < length; j++)
+				destination[j] = fabs(left[j]);
+			break;
+
+		case OP_CALL:
+			for (j = 0; j < length; j++)
+				destination[j] =
+				    instruction->function(left[j]);
+			break;
+		}
+	}
+}
+
+static inline void
+execute_float(Bytecode * bytecode, int length)
+{
+#if defined __clang__
+#pragma clang fp contract(off)
+#endif
+	Instruction    *instruction;	/* Current instruction. */
+	float          *destination;	/* Destination vector. */
+	float          *left,
+	               *right,
+	               *addend;	/* Operand vectors. */
+	float           constant;	/* Constant operand. */
+#if defined __GNUC__
+	FloatVector     fill;	/* Vector of constant operand or
+				 * coefficient. */
+#endif
+	unsigned        m;	/* Absolute value of exponent. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Execute each instruction as in double precision, with constants
+	 * rounded to single precision and single precision versions of
+	 * functions called. */
+	for (instruction = bytecode->instructions;
+	     instruction < bytecode->instructions + bytecode->length;
+	     instruction++) {
+		destination =
+		    bytecode->vectors_float[instruction->destination];
+		left = bytecode->vectors_float[instruction->left];
+		right = bytecode->vectors_float[instruction->right];
+		constant = instruction->constant;
+		switch (instruction->opcode) {
+		case OP_COPY:
+			ELEMENTWISE_FLOAT(F(destination) = F(left),
+					  destination[j] = left[j]);
+			break;
+
+		case OP_FILL:
+#if defined __GNUC__
+			broadcast_float(&fill, constant);
+#endif
+			ELEMENTWISE_FLOAT(F(destination) = fill,
+					  destination[j] = constant);
+			break;
+
+		case OP_NEG:
+			ELEMENTWISE_FLOAT(F(destination) = -F(left),
+					  destination[j] = -left[j]);
+			break;
+
+		case OP_ADD:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) + F(right),
+					  destination[j] = left[j] + right[j]);
+			break;
+
+		case OP_SUB:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) - F(right),
+					  destination[j] = left[j] - right[j]);
+			break;
+
+		case OP_MUL:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) * F(right),
+					  destination[j] = left[j] * right[j]);
+			break;
+
+		case OP_DIV:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) / F(right),
+					  destination[j] = left[j] / right[j]);
+			break;
+
+		case OP_POW:
+			for (j = 0; j < length; j++)
+				destination[j] = math_powf(left[j], right[j]);
+			break;
+
+		case OP_ADDC:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) + constant,
+					  destination[j] = left[j] + constant);
+			break;
+
+		case OP_SUBC:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) - constant,
+					  destination[j] = left[j] - constant);
+			break;
+
+		case OP_CSUB:
+			ELEMENTWISE_FLOAT(F(destination) = constant - F(left),
+					  destination[j] = constant - left[j]);
+			break;
+
+		case OP_MULC:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) * constant,
+					  destination[j] = left[j] * constant);
+			break;
+
+		case OP_DIVC:
+			ELEMENTWISE_FLOAT(F(destination) = F(left) / constant,
+					  destination[j] = left[j] / constant);
+			break;
+
+		case OP_CDIV:
+			ELEMENTWISE_FLOAT(F(destination) = constant / F(left),
+					  destination[j] = constant / left[j]);
+			break;
+
+		case OP_POWC:
+			for (j = 0; j < length; j++)
+				destination[j] = math_powf(left[j], constant);
+			break;
+
+		case OP_CPOW:
+			for (j = 0; j < length; j++)
+				destination[j] = math_powf(constant, left[j]);
+			break;
+
+		case OP_POWI:
+			/* Repeated squaring as in math_powi(), with loop
+			 * over exponent bits outside loops over points
+			 * (right vector holds successive squares). */
+			m = (instruction->exponent <
+			     0) ? -(unsigned) instruction->exponent :
+			    (unsigned) instruction->exponent;
+#if defined __GNUC__
+			broadcast_float(&fill, 1);
+#endif
+			ELEMENTWISE_FLOAT((F(right) = F(left),
+					   F(destination) = fill),
+					  (right[j] = left[j],
+					   destination[j] = 1));
+			for (; m; m >>= 1) {
+				if (m & 1)
+					ELEMENTWISE_FLOAT(F(destination) *=
+							  F(right),
+							  destination[j] *=
+							  right[j]);
+				if (m > 1)
+					ELEMENTWISE_FLOAT(F(right) *= F(right),
+							  right[j] *=
+							  right[j]);
+			}
+			if (instruction->exponent < 0)
+				ELEMENTWISE_FLOAT(F(destination) =
+						  1 / F(destination),
+						  destination[j] =
+						  1 / destination[j]);
+			break;
+
+		case OP_HORNER:
+			/* Nested multiplication as in math_horner(), with
+			 * loop over coefficients outside loops over points
+			 * (argument is copied to right vector first if
+			 * destination is same as argument). */
+			if (destination == left) {
+				ELEMENTWISE_FLOAT(F(right) = F(left),
+						  right[j] = left[j]);
+				left = right;
+			}
+			constant =
+			    instruction->
+			    coefficients_float[instruction->degree];
+#if defined __GNUC__
+			broadcast_float(&fill, constant);
+#endif
+			ELEMENTWISE_FLOAT(F(destination) = fill,
+					  destination[j] = constant);
+			for (i = instruction->degree - 1; i >= 0; i--) {
+				constant = instruction->coefficients_float[i];
+				ELEMENTWISE_FLOAT(F(destination) =
+						  F(destination) * F(left) +
+						  constant, destination[j] =
+						  destination[j] * left[j] +
+						  constant);
+			}
+			break;
+
+		case OP_ESTRIN:
+			for (j = 0; j < length; j++)
+				destination[j] =
+				    math_estrinf(left[j],
+						 instruction->
+						 coefficients_float,
+						 instruction->degree);
+			break;
+
+		case OP_FMA:
+			addend = bytecode->vectors_float[instruction->addend];
+			for (j = 0; j < length; j++)
+				destination[j] =
+				    fmaf(left[j], right[j], addend[j]);
+			break;
+
+		case OP_SQRT:
+			for (j = 0; j < length; j++)
+				destination[j] = sqrtf(left[j]);
+			break;
+
+		case OP_ABS:
+			for (j = 0; j < length; j++)
+				destination[j] = fabsf(left[j]);
+			break;
+
+		case OP_CALL:
+			if (instruction->function_float)
+				for (j = 0; j < length; j++)
+					destination[j] =
+					    instruction->
+					    function_float(left[j]);
+			else
+				for (j = 0; j < length; j++)
+					destination[j] =
+					    instruction->function(left[j]);
+			break;
+		}
+	}
+}
+
+static double
+bytecode_evaluate(void *code, double *values)
+{
+	Bytecode       *bytecode;	/* Compiled function. */
+	double          result;	/* Function value. */
+	int             i;	/* Loop counter. */
+
+	/* Execute program for single point, with variable vectors
+	 * pointing to variable values. */
+	bytecode = code;
+	for (i = 0; i < bytecode->count; i++)
+		bytecode->vectors[i] = values + i;
+	bytecode->vectors[bytecode->count + bytecode->scratch] = &result;
+	kernels[bytecode->isa] (bytecode, 1, FALSE);
+	return result;
+}
+
+static void
+bytecode_evaluate_batch(void *code, double **values, int length,
+			double *results)
+{
+	Bytecode       *bytecode;	/* Compiled function. */
+	int             tile;	/* Number of points in current tile. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Execute program for each tile of points, with vectors pointing
+	 * to respective parts of variable values and results arrays. */
+	bytecode = code;
+	for (j = 0; j < length; j += bytecode->tile) {
+		tile =
+		    (length - j <
+		     bytecode->tile) ? length - j : bytecode->tile;
+		for (i = 0; i < bytecode->count; i++)
+			bytecode->vectors[i] = values[i] + j;
+		bytecode->vectors[bytecode->count + bytecode->scratch] =
+		    results + j;
+		kernels[bytecode->isa] (bytecode, tile, FALSE);
+	}
+}
+
+static void
+bytecode_destroy(void *code)
+{
+	Bytecode       *bytecode;	/* Compiled function. */
+	int             i;	/* Loop counter. */
+
+	/* Free instructions, scratch vectors and compiled function data
+	 * structure. */
+	bytecode = code;
+	for (i = 0; i < bytecode->length; i++)
+		XFREE(bytecode->instructions[i].coefficients_float);
+	XFREE(bytecode->instructions);
+	XFREE(bytecode->memory);
+	XFREE(bytecode->vectors);
+	XFREE(bytecode->memory_float);
+	XFREE(bytecode->vectors_float);
+	XFREE(bytecode);
+}
+
+static void
+execute_generic(Bytecode * bytecode, int length, int single)
+{
+	/* Execute program using baseline instruction set. */
+	if (single)
+		execute_float(bytecode, length);
+	else
+		execute(bytecode, length);
+}
+
+#if ISA_DISPATCH
+static void
+execute_sse42(Bytecode * bytecode, int length, int single)
+{
+	/* Execute program using SSE4.2 instructions. */
+	if (single)
+		execute_float(bytecode, length);
+	else
+		execute(bytecode, length);
+}
+
+static void
+execute_avx2(Bytecode * bytecode, int length, int single)
+{
+	/* Execute program using AVX2 instructions. */
+	if (single)
+		execute_float(bytecode, length);
+	else
+		execute(bytecode, length);
+}
+
+static void
+execute_avx512f(Bytecode * bytecode, int length, int single)
+{
+	/* Execute program using AVX-512 foundation instructions. */
+	if (single)
+		execute_float(bytecode, length);
+	else
+		execute(bytecode, length);
+}
+#endif
+
+#if defined __GNUC__
+static inline void
+broadcast(Vector * vector, double value)
+{
+	int             i;	/* Loop counter. */
+
+	/* Set each vector element to value. */
+	for (i = 0; i < VECTOR_SIZE; i++)
+		(*vector)[i] = value;
+}
+
+static inline void
+broadcast_float(FloatVector * vector, float value)
+{
+	int             i;	/* Loop counter. */
+
+	/* Set each vector element to value. */
+	for (i = 0; i < FLOAT_VECTOR_SIZE; i++)
+		(*vector)[i] = value;
+}
+#endif
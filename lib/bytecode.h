@@ -0,0 +1,51 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BYTECODE_H
+#define BYTECODE_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "engine.h"
+
+/* Compile function represented by tree rooted at given node into
+ * bytecode, interpreted for tile of points at a time: each instruction
+ * is executed as loop over tile-sized vectors of values, so that
+ * dispatch cost is paid once per tile and loops could be vectorized.
+ * Further arguments are array of symbol table records of function
+ * variables and its length.  Tile size is taken from MATHEVAL_TILE
+ * environment variable, if set (default is 512 points).  Function
+ * returns pointer to compiled function.  */
+Engine         *bytecode_create(Node * root, Record ** records, int count);
+
+/* Calculate function values in single precision for batch of points,
+ * using function compiled by bytecode_create() (code member of engine
+ * data structure).  Arguments are as for evaluate_batch member of
+ * engine data structure, with single precision values and results.
+ * Constants are rounded to single precision, and single precision
+ * versions of functions are used.  */
+void            bytecode_evaluate_batch_float(void *code, float **values,
+					      int length, float *results);
+
+#endif
@@ -0,0 +1,458 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include "closure.h"
+#include "common.h"
+#include "matheval.h"
+#include "xmath.h"
+
+/* Operand kinds.  */
+enum {
+	KIND_VARIABLE, KIND_CONSTANT, KIND_EXPRESSION
+};
+
+typedef struct Closure Closure;
+
+/* Handler calculating value of given closure for given array of
+ * variable values.  */
+typedef double  (*Handler) (Closure * closure, double *values);
+
+/* Data structure representing closure, that is function tree node
+ * along with handler evaluating it.  Depending on handler, operands are
+ * read from variable values, taken from constant, or calculated by
+ * handlers of child closures.  */
+struct Closure {
+	Handler         handler;	/* Handler. */
+	Closure        *left,
+	               *right,
+	               *addend;	/* Child closures. */
+	int             left_index,
+	                right_index;	/* Indices of variable operands. */
+	double          constant;	/* Constant operand. */
+	double          (*function) (double);	/* Called function. */
+	double         *coefficients;	/* Polynomial coefficients. */
+	int             degree;	/* Polynomial degree or integer
+				 * exponent. */
+};
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	Closure        *closures;	/* Closures, root first. */
+	int             length;	/* Number of closures used. */
+	int             count;	/* Number of function variables. */
+} Program;
+
+/* Operand value for each operand kind, given operand side.  */
+#define OPERAND_v(side) values[closure->side##_index]
+#define OPERAND_c(side) closure->constant
+#define OPERAND_e(side) closure->side->handler(closure->side, values)
+
+/* Binary operations.  */
+#define ADD(x, y) ((x) + (y))
+#define SUB(x, y) ((x) - (y))
+#define MUL(x, y) ((x) * (y))
+#define DIV(x, y) ((x) / (y))
+#define POW(x, y) math_pow((x), (y))
+
+/* Define handler for binary operation with given operand kinds.  */
+#define BINARY_HANDLER(name, operation, left_kind, right_kind) \
+static double \
+name##_##left_kind##right_kind(Closure * closure, double *values) \
+{ \
+	return operation(OPERAND_##left_kind(left), \
+			 OPERAND_##right_kind(right)); \
+}
+
+/* Define handlers for binary operation with all operand kinds (except
+ * both operands constant, when right one is treated as subexpression).  */
+#define BINARY_HANDLERS(name, operation) \
+	BINARY_HANDLER(name, operation, v, v) \
+	BINARY_HANDLER(name, operation, v, c) \
+	BINARY_HANDLER(name, operation, v, e) \
+	BINARY_HANDLER(name, operation, c, v) \
+	BINARY_HANDLER(name, operation, c, e) \
+	BINARY_HANDLER(name, operation, e, v) \
+	BINARY_HANDLER(name, operation, e, c) \
+	BINARY_HANDLER(name, operation, e, e)
+
+BINARY_HANDLERS(add, ADD)
+BINARY_HANDLERS(sub, SUB)
+BINARY_HANDLERS(mul, MUL)
+BINARY_HANDLERS(div, DIV)
+BINARY_HANDLERS(pow, POW)
+
+/* Handlers for binary operation, indexed by left and right operand
+ * kinds.  */
+#define BINARY_TABLE(name) { \
+	{name##_vv, name##_vc, name##_ve}, \
+	{name##_cv, NULL, name##_ce}, \
+	{name##_ev, name##_ec, name##_ee} \
+}
+
+/* Binary operations, in order of handlers below.  */
+static char     operations[] = "+-*/^";
+
+/* Handlers for binary operations.  */
+static Handler  binary_handlers[][3][3] = {
+	BINARY_TABLE(add), BINARY_TABLE(sub), BINARY_TABLE(mul),
+	BINARY_TABLE(div), BINARY_TABLE(pow)
+};
+
+/* Return number of nodes in subtree rooted at given node.  */
+static int      count_nodes(Node * node);
+
+/* Create closure evaluating subtree rooted at given node, using given
+ * array of symbol table records of function variables, and return
+ * pointer to it.  */
+static Closure *compile(Program * program, Node * node,
+			Record ** records);
+
+/* Classify given node as operand: store index of variable, constant
+ * value or pointer to closure created for subexpression into locations
+ * given, and return operand kind.  */
+static int      operand(Program * program, Node * node,
+			Record ** records, Closure ** child, int *index,
+			double *constant);
+
+/* Set up single operand of given closure, read directly if variable
+ * or calculated by child closure otherwise, and return operand kind.  */
+static int      unary(Program * program, Node * node, Record ** records,
+		      Closure * closure);
+
+/* Handlers for leaves, unary operations, functions, integer powers,
+ * polynomials and multiply-add, with operand kind as suffix.  */
+static double   constant(Closure * closure, double *values);
+static double   variable(Closure * closure, double *values);
+static double   neg_v(Closure * closure, double *values);
+static double   neg_e(Closure * closure, double *values);
+static double   function_v(Closure * closure, double *values);
+static double   function_e(Closure * closure, double *values);
+static double   powi_v(Closure * closure, double *values);
+static double   powi_e(Closure * closure, double *values);
+static double   polynomial_v(Closure * closure, double *values);
+static double   polynomial_e(Closure * closure, double *values);
+static double   muladd_e(Closure * closure, double *values);
+
+/* Calculate function value using closures.  */
+static double   closure_evaluate(void *code, double *values);
+
+/* Destroy closures.  */
+static void     closure_destroy(void *code);
+
+Engine         *
+closure_create(Node * root, Record ** records, int count)
+{
+	Program        *program;	/* Compiled function. */
+	Engine         *engine;	/* Engine data structure. */
+
+	/* Allocate closures, at most one per node, in single array so
+	 * that closures evaluated one after another are adjacent in
+	 * memory, and create them starting from root. */
+	program = XMALLOC(Program, 1);
+	program->closures = XMALLOC(Closure, count_nodes(root));
+	program->length = 0;
+	program->count = count;
+	compile(program, root, records);
+
+	/* Create engine data structure; batch evaluation goes point by
+	 * point. */
+	engine = XMALLOC(Engine, 1);
+	engine->type = EVALUATOR_ENGINE_CLOSURE;
+	engine->count = count;
+	engine->code = program;
+	engine->evaluate = closure_evaluate;
+	engine->evaluate_batch = NULL;
+	engine->destroy = closure_destroy;
+	engine->scalar_code = engine->batch_code = NULL;
+	engine->scalar_size = engine->batch_size = 0;
+
+	return engine;
+}
+
+static int
+count_nodes(Node * node)
+{
+	/* Count node and nodes of its subtrees. */
+	switch (node->type) {
+	case 'f':
+		return 1 + count_nodes(node->data.function.child);
+
+	case 'u':
+		return 1 + count_nodes(node->data.un_op.child);
+
+	case 'b':
+		return 1 + count_nodes(node->data.bin_op.left) +
+		    count_nodes(node->data.bin_op.right);
+
+	case 'p':
+		return 1 + count_nodes(node->data.power.child);
+
+	case 'h':
+		return 1 + count_nodes(node->data.polynomial.child);
+
+	case 'm':
+		return 1 + count_nodes(node->data.muladd.left) +
+		    count_nodes(node->data.muladd.right) +
+		    count_nodes(node->data.muladd.addend);
+	}
+
+	return 1;
+}
+
+static Closure *
+compile(Program * program, Node * node, Record ** records)
+{
+	Closure        *closure;	/* Closure created. */
+	int             left,
+	                right;	/* Operand kinds. */
+
+	/* Take next closure from array. */
+	closure = &program->closures[program->length++];
+	memset(closure, 0, sizeof(Closure));
+
+	/* According to node type, select handler specialized for kinds
+	 * of node operands, and set up operands. */
+	switch (node->type) {
+	case 'n':
+	case 'c':
+	case 'v':
+		/* Leaves are evaluated by own handlers only if whole
+		 * function or operand of generic handler. */
+		closure->handler =
+		    operand(program, node, records, NULL,
+			    &closure->left_index,
+			    &closure->constant) ==
+		    KIND_VARIABLE ? variable : constant;
+		break;
+
+	case 'f':
+		closure->function =
+		    node->data.function.record->data.function;
+		closure->handler =
+		    unary(program, node->data.function.child, records,
+			  closure) == KIND_VARIABLE ? function_v : function_e;
+		break;
+
+	case 'u':
+		closure->handler =
+		    unary(program, node->data.un_op.child, records,
+			  closure) == KIND_VARIABLE ? neg_v : neg_e;
+		break;
+
+	case 'b':
+		/* If both operands constant, right one is evaluated as
+		 * subexpression, as there is single constant operand. */
+		left =
+		    operand(program, node->data.bin_op.left, records,
+			    &closure->left, &closure->left_index,
+			    &closure->constant);
+		if (left == KIND_CONSTANT
+		    && (node->data.bin_op.right->type == 'n'
+			|| node->data.bin_op.right->type == 'c')) {
+			closure->right =
+			    compile(program, node->data.bin_op.right,
+				    records);
+			right = KIND_EXPRESSION;
+		} else
+			right =
+			    operand(program, node->data.bin_op.right,
+				    records, &closure->right,
+				    &closure->right_index,
+				    &closure->constant);
+		closure->handler =
+		    binary_handlers[strchr(operations,
+					   node->data.bin_op.operation) -
+				    operations][left][right];
+		break;
+
+	case 'p':
+		closure->degree = node->data.power.exponent;
+		closure->handler =
+		    unary(program, node->data.power.child, records,
+			  closure) == KIND_VARIABLE ? powi_v : powi_e;
+		break;
+
+	case 'h':
+		closure->coefficients = node->data.polynomial.coefficients;
+		closure->degree = node->data.polynomial.degree;
+		closure->handler =
+		    unary(program, node->data.polynomial.child, records,
+			  closure) == KIND_VARIABLE ? polynomial_v : polynomial_e;
+		break;
+
+	case 'm':
+		/* Multiply-add evaluates all operands as subexpressions. */
+		closure->handler = muladd_e;
+		closure->left =
+		    compile(program, node->data.muladd.left, records);
+		closure->right =
+		    compile(program, node->data.muladd.right, records);
+		closure->addend =
+		    compile(program, node->data.muladd.addend, records);
+		break;
+	}
+
+	return closure;
+}
+
+static int
+operand(Program * program, Node * node, Record ** records,
+	Closure ** child, int *index, double *constant)
+{
+	int             i;	/* Loop counter. */
+
+	/* Variables and constants are used directly, other operands
+	 * are evaluated by closures of their own. */
+	switch (node->type) {
+	case 'n':
+		*constant = node->data.number;
+		return KIND_CONSTANT;
+
+	case 'c':
+		*constant = node->data.constant->data.value;
+		return KIND_CONSTANT;
+
+	case 'v':
+		for (i = 0; i < program->count; i++)
+			if (records[i] == node->data.variable)
+				break;
+		*index = i;
+		return KIND_VARIABLE;
+	}
+
+	*child = compile(program, node, records);
+	return KIND_EXPRESSION;
+}
+
+static int
+unary(Program * program, Node * node, Record ** records,
+      Closure * closure)
+{
+	/* Use variable directly, otherwise create child closure (also
+	 * for constant, as simplification leaves few of these). */
+	if (node->type == 'v')
+		return operand(program, node, records, NULL,
+			       &closure->left_index, NULL);
+	closure->left = compile(program, node, records);
+	return KIND_EXPRESSION;
+}
+
+static double
+constant(Closure * closure, double *values)
+{
+	/* Return constant (variable values not needed). */
+	(void) values;
+	return closure->constant;
+}
+
+static double
+variable(Closure * closure, double *values)
+{
+	/* Return variable value. */
+	return values[closure->left_index];
+}
+
+static double
+neg_v(Closure * closure, double *values)
+{
+	/* Negate variable. */
+	return -OPERAND_v(left);
+}
+
+static double
+neg_e(Closure * closure, double *values)
+{
+	/* Negate subexpression. */
+	return -OPERAND_e(left);
+}
+
+static double
+function_v(Closure * closure, double *values)
+{
+	/* Call function for variable. */
+	return closure->function(OPERAND_v(left));
+}
+
+static double
+function_e(Closure * closure, double *values)
+{
+	/* Call function for subexpression. */
+	return closure->function(OPERAND_e(left));
+}
+
+static double
+powi_v(Closure * closure, double *values)
+{
+	/* Raise variable to integer power. */
+	return math_powi(OPERAND_v(left), closure->degree);
+}
+
+static double
+powi_e(Closure * closure, double *values)
+{
+	/* Raise subexpression to integer power. */
+	return math_powi(OPERAND_e(left), closure->degree);
+}
+
+static double
+polynomial_v(Closure * closure, double *values)
+{
+	/* Evaluate polynomial of variable. */
+	return math_polynomial(OPERAND_v(left), closure->coefficients,
+			       closure->degree);
+}
+
+static double
+polynomial_e(Closure * closure, double *values)
+{
+	/* Evaluate polynomial of subexpression. */
+	return math_polynomial(OPERAND_e(left), closure->coefficients,
+			       closure->degree);
+}
+
+static double
+muladd_e(Closure * closure, double *values)
+{
+	/* Multiply and add subexpressions with single rounding. */
+	return fma(OPERAND_e(left), OPERAND_e(right), OPERAND_e(addend));
+}
+
+static double
+closure_evaluate(void *code, double *values)
+{
+	/* Call handler of root closure. */
+	return ((Program *) code)->closures->handler(((Program *) code)->
+						     closures, values);
+}
+
+static void
+closure_destroy(void *code)
+{
+	/* Free closures and compiled function data structure. */
+	XFREE(((Program *) code)->closures);
+	XFREE(code);
+}
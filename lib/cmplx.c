@@ -0,0 +1,601 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <complex.h>
+#include "approx.h"
+#include "common.h"
+#include "cmplx.h"
+#include "postfix.h"
+#include "xmath.h"
+
+/* Number of points evaluated at once.  */
+#define TILE 64
+
+/* Smallest real part of argument for which error function is
+ * calculated from continued fraction for complementary error function
+ * instead of power series, and number of terms of continued fraction
+ * used.  */
+#define ERF_FRACTION 1.5
+#define ERF_FRACTION_TERMS 80
+
+/* Largest number of terms of power series for error function, and
+ * relative magnitude of term at which summation is stopped.  */
+#define ERF_SERIES_TERMS 4000
+#define ERF_EPSILON 5.55111512312578e-17
+
+/* Value of 2/sqrt(pi).  */
+#define TWO_SQRTPI 1.1283791670955126
+
+/* Complex version of function of one argument.  */
+typedef double  complex(*Function) (double complex);
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	Postfix        *postfix;	/* Postfix form of function. */
+	double complex *numbers;	/* Values of numbers and constants, 
+					 * indexed by step. */
+	Function       *functions;	/* Complex versions of called
+					 * functions, indexed by step (null 
+					 * pointer if not known). */
+	double complex *stack;	/* Evaluation stack, consisting of
+				 * tile-sized vectors. */
+} Code;
+
+/* Evaluate compiled function for given number (at most tile size) of
+ * points starting at given offset into arrays of variable values, and
+ * leave function values in first vector of evaluation stack.  */
+static void     evaluate(Code * code, double **values, int offset,
+			 int length);
+
+/* Return complex version of given function of one argument (one of
+ * functions predefined in symbol table), or null pointer if not
+ * known.  */
+static Function function_complex(double (*function) (double));
+
+/* Return complex number with given real and imaginary parts (without
+ * multiplication by imaginary unit, that would turn infinite parts into 
+ * not-a-number values).  */
+static inline double complex complex_pack(double re, double im);
+
+/* Calculate function of one argument defined for real numbers only:
+ * function value for real number, and not-a-number value otherwise.  */
+static double complex complex_real(double (*function) (double),
+				   double complex a);
+
+/* Calculate complex number raised to integer power, raised to power
+ * given by another complex number, and value of polynomial with real
+ * coefficients.  */
+static double complex complex_powi(double complex a, int n);
+static double complex complex_pow(double complex a, double complex b);
+static double complex complex_polynomial(double complex a,
+					 double *coefficients, int degree);
+
+/* Complex versions of functions predefined in symbol table, that are
+ * not provided by C library.  */
+static double complex complex_cot(double complex a);
+static double complex complex_sec(double complex a);
+static double complex complex_csc(double complex a);
+static double complex complex_acot(double complex a);
+static double complex complex_asec(double complex a);
+static double complex complex_acsc(double complex a);
+static double complex complex_coth(double complex a);
+static double complex complex_sech(double complex a);
+static double complex complex_csch(double complex a);
+static double complex complex_acoth(double complex a);
+static double complex complex_asech(double complex a);
+static double complex complex_acsch(double complex a);
+static double complex complex_abs(double complex a);
+static double complex complex_step(double complex a);
+static double complex complex_delta(double complex a);
+static double complex complex_nandelta(double complex a);
+static double complex complex_erf(double complex a);
+
+void           *
+cmplx_create(Node * root, Record ** records, int count)
+{
+	Code           *code;	/* Compiled function. */
+	Node           *node;	/* Node evaluated by step. */
+	int             i;	/* Loop counter. */
+
+	/* Create postfix form of function and allocate memory for
+	 * evaluation. */
+	code = XMALLOC(Code, 1);
+	code->postfix = postfix_create(root, records, count);
+	code->numbers = XMALLOC(double complex, code->postfix->length);
+	code->functions = XMALLOC(Function, code->postfix->length);
+	code->stack =
+	    XMALLOC(double complex, code->postfix->depth * TILE);
+
+	/* Convert numbers and constants to complex numbers, and look up
+	 * complex versions of functions. */
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		code->numbers[i] = complex_pack(0, 0);
+		code->functions[i] = NULL;
+		switch (node->type) {
+		case 'n':
+			code->numbers[i] =
+			    complex_pack(node->data.number, 0);
+			break;
+
+		case 'c':
+			code->numbers[i] =
+			    complex_pack(node->data.constant->data.value, 0);
+			break;
+
+		case 'f':
+			code->functions[i] =
+			    function_complex(approx_exact
+					     (node->data.function.record->
+					      data.function));
+			break;
+		}
+	}
+
+	return code;
+}
+
+void
+cmplx_destroy(void *code)
+{
+	/* Free postfix form, arrays used for evaluation and data
+	 * structure representing compiled function. */
+	if (!code)
+		return;
+	postfix_destroy(((Code *) code)->postfix);
+	XFREE(((Code *) code)->numbers);
+	XFREE(((Code *) code)->functions);
+	XFREE(((Code *) code)->stack);
+	XFREE(code);
+}
+
+void
+cmplx_evaluate_batch(void *code, double **values, int length,
+		     double *results)
+{
+	int             offset;	/* Offset of tile. */
+	int             n;	/* Number of points in tile. */
+	int             j;	/* Loop counter. */
+
+	/* Evaluate function tile by tile, and store real and imaginary
+	 * parts of results. */
+	for (offset = 0; offset < length; offset += TILE) {
+		n = (length - offset < TILE) ? length - offset : TILE;
+		evaluate(code, values, offset, n);
+		for (j = 0; j < n; j++) {
+			results[2 * (offset + j)] =
+			    creal(((Code *) code)->stack[j]);
+			results[2 * (offset + j) + 1] =
+			    cimag(((Code *) code)->stack[j]);
+		}
+	}
+}
+
+static void
+evaluate(Code * code, double **values, int offset, int length)
+{
+	double complex *stack;	/* Top vector of evaluation stack. */
+	Node           *node;	/* Node evaluated by step. */
+	double          (*function) (double);	/* Function called by
+						 * step. */
+	double         *value;	/* Variable values. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Evaluate steps in order, each of them replacing vectors of
+	 * values of its children on top of stack by vector of its own
+	 * values. */
+	stack = code->stack - TILE;
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		switch (node->type) {
+		case 'n':
+		case 'c':
+			stack += TILE;
+			for (j = 0; j < length; j++)
+				stack[j] = code->numbers[i];
+			break;
+
+		case 'v':
+			stack += TILE;
+			value =
+			    values[code->postfix->steps[i].index] +
+			    2 * offset;
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    complex_pack(value[2 * j],
+						 value[2 * j + 1]);
+			break;
+
+		case 'f':
+			/* Functions without complex version are
+			 * calculated for real arguments only (exactly, even
+			 * if approximation selected for evaluator). */
+			function =
+			    approx_exact(node->data.function.record->data.
+					 function);
+			if (code->functions[i])
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    code->functions[i] (stack[j]);
+			else
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    complex_real(function, stack[j]);
+			break;
+
+		case 'u':
+			for (j = 0; j < length; j++)
+				stack[j] = -stack[j];
+			break;
+
+		case 'b':
+			stack -= TILE;
+			switch (node->data.bin_op.operation) {
+			case '+':
+				for (j = 0; j < length; j++)
+					stack[j] += stack[TILE + j];
+				break;
+
+			case '-':
+				for (j = 0; j < length; j++)
+					stack[j] -= stack[TILE + j];
+				break;
+
+			case '*':
+				for (j = 0; j < length; j++)
+					stack[j] *= stack[TILE + j];
+				break;
+
+			case '/':
+				for (j = 0; j < length; j++)
+					stack[j] /= stack[TILE + j];
+				break;
+
+			case '^':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    complex_pow(stack[j],
+							stack[TILE + j]);
+				break;
+			}
+			break;
+
+		case 'p':
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    complex_powi(stack[j],
+						 node->data.power.exponent);
+			break;
+
+		case 'h':
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    complex_polynomial(stack[j],
+						       node->data.polynomial.
+						       coefficients,
+						       node->data.polynomial.
+						       degree);
+			break;
+
+		case 'm':
+			stack -= 2 * TILE;
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    stack[j] * stack[TILE + j] +
+				    stack[2 * TILE + j];
+			break;
+		}
+	}
+}
+
+static          Function
+function_complex(double (*function) (double))
+{
+	static struct {
+		double          (*function) (double);	/* Function. */
+		Function        function_complex;	/* Complex version. 
+							 */
+	} functions[] = {
+		{
+		exp, cexp}, {
+		log, clog}, {
+		sqrt, csqrt}, {
+		sin, csin}, {
+		cos, ccos}, {
+		tan, ctan}, {
+		math_cot, complex_cot}, {
+		math_sec, complex_sec}, {
+		math_csc, complex_csc}, {
+		asin, casin}, {
+		acos, cacos}, {
+		atan, catan}, {
+		math_acot, complex_acot}, {
+		math_asec, complex_asec}, {
+		math_acsc, complex_acsc}, {
+		sinh, csinh}, {
+		cosh, ccosh}, {
+		tanh, ctanh}, {
+		math_coth, complex_coth}, {
+		math_sech, complex_sech}, {
+		math_csch, complex_csch}, {
+		math_asinh, casinh}, {
+		math_acosh, cacosh}, {
+		math_atanh, catanh}, {
+		math_acoth, complex_acoth}, {
+		math_asech, complex_asech}, {
+		math_acsch, complex_acsch}, {
+		fabs, complex_abs}, {
+		math_step, complex_step}, {
+		math_delta, complex_delta}, {
+		math_nandelta, complex_nandelta}, {
+		erf, complex_erf}
+	};			/* Functions and their complex versions. */
+	int             i;	/* Loop counter. */
+
+	/* Look up function among predefined functions. */
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0])); i++)
+		if (functions[i].function == function)
+			return functions[i].function_complex;
+	return NULL;
+}
+
+static inline double complex
+complex_pack(double re, double im)
+{
+	double complex  a;	/* Complex number. */
+
+	/* Complex number is laid out as array of its real and imaginary
+	 * parts. */
+	((double *) &a)[0] = re;
+	((double *) &a)[1] = im;
+	return a;
+}
+
+static double   complex
+complex_real(double (*function) (double), double complex a)
+{
+	/* Apply function to real numbers only. */
+	return (cimag(a) == 0) ? complex_pack((*function) (creal(a)),
+					      0) : complex_pack(MATH_NAN,
+								MATH_NAN);
+}
+
+static double   complex
+complex_powi(double complex a, int n)
+{
+	double complex  result;	/* Accumulated power. */
+	unsigned        m;	/* Absolute value of exponent. */
+
+	/* Multiply together squares of number corresponding to bits set
+	 * in absolute value of exponent, and take reciprocal for negative
+	 * exponent, as math_powi() does. */
+	m = (n < 0) ? -(unsigned) n : (unsigned) n;
+	for (result = complex_pack(1, 0); m; m >>= 1) {
+		if (m & 1)
+			result *= a;
+		if (m > 1)
+			a *= a;
+	}
+	return (n < 0) ? 1 / result : result;
+}
+
+static double   complex
+complex_pow(double complex a, double complex b)
+{
+	/* Use repeated squaring if exponent is small integer, as
+	 * math_pow() does, and real exponentiation if both numbers are
+	 * real and result is real too. */
+	if (cimag(b) == 0) {
+		if (fabs(creal(b)) <= MATH_POWI_MAX
+		    && creal(b) == (int) creal(b))
+			return complex_powi(a, (int) creal(b));
+		if (cimag(a) == 0 && creal(a) >= 0)
+			return complex_pack(pow(creal(a), creal(b)), 0);
+		if (creal(b) == 0.5)
+			return csqrt(a);
+	}
+
+	/* Otherwise use principal value of power. */
+	return cpow(a, b);
+}
+
+static double   complex
+complex_polynomial(double complex a, double *coefficients, int degree)
+{
+	double complex  result;	/* Accumulated polynomial value. */
+	int             i;	/* Loop counter. */
+
+	/* Calculate polynomial value by nested multiplication. */
+	result = complex_pack(coefficients[degree], 0);
+	for (i = degree - 1; i >= 0; i--)
+		result = result * a + coefficients[i];
+	return result;
+}
+
+static double   complex
+complex_cot(double complex a)
+{
+	/* Calculate cotangent as reciprocal of tangent. */
+	return 1 / ctan(a);
+}
+
+static double   complex
+complex_sec(double complex a)
+{
+	/* Calculate secant as reciprocal of cosine. */
+	return 1 / ccos(a);
+}
+
+static double   complex
+complex_csc(double complex a)
+{
+	/* Calculate cosecant as reciprocal of sine. */
+	return 1 / csin(a);
+}
+
+static double   complex
+complex_acot(double complex a)
+{
+	/* Calculate inverse cotangent as inverse tangent of reciprocal,
+	 * as math_acot() does. */
+	return catan(1 / a);
+}
+
+static double   complex
+complex_asec(double complex a)
+{
+	/* Calculate inverse secant as inverse cosine of reciprocal. */
+	return cacos(1 / a);
+}
+
+static double   complex
+complex_acsc(double complex a)
+{
+	/* Calculate inverse cosecant as inverse sine of reciprocal. */
+	return casin(1 / a);
+}
+
+static double   complex
+complex_coth(double complex a)
+{
+	/* Calculate hyperbolic cotangent as reciprocal of hyperbolic
+	 * tangent. */
+	return 1 / ctanh(a);
+}
+
+static double   complex
+complex_sech(double complex a)
+{
+	/* Calculate hyperbolic secant as reciprocal of hyperbolic
+	 * cosine. */
+	return 1 / ccosh(a);
+}
+
+static double   complex
+complex_csch(double complex a)
+{
+	/* Calculate hyperbolic cosecant as reciprocal of hyperbolic
+	 * sine. */
+	return 1 / csinh(a);
+}
+
+static double   complex
+complex_acoth(double complex a)
+{
+	/* Calculate inverse hyperbolic cotangent as inverse hyperbolic
+	 * tangent of reciprocal. */
+	return catanh(1 / a);
+}
+
+static double   complex
+complex_asech(double complex a)
+{
+	/* Calculate inverse hyperbolic secant as inverse hyperbolic
+	 * cosine of reciprocal, as math_asech() does. */
+	return cacosh(1 / a);
+}
+
+static double   complex
+complex_acsch(double complex a)
+{
+	/* Calculate inverse hyperbolic cosecant as inverse hyperbolic
+	 * sine of reciprocal, as math_acsch() does. */
+	return casinh(1 / a);
+}
+
+static double   complex
+complex_abs(double complex a)
+{
+	/* Absolute value is modulus of number. */
+	return complex_pack(cabs(a), 0);
+}
+
+static double   complex
+complex_step(double complex a)
+{
+	/* Step function is defined for real numbers only. */
+	return complex_real(math_step, a);
+}
+
+static double   complex
+complex_delta(double complex a)
+{
+	/* Delta function is defined for real numbers only. */
+	return complex_real(math_delta, a);
+}
+
+static double   complex
+complex_nandelta(double complex a)
+{
+	/* Delta function is defined for real numbers only. */
+	return complex_real(math_nandelta, a);
+}
+
+static double   complex
+complex_erf(double complex a)
+{
+	double complex  z;	/* Argument, with non-negative real
+				 * part. */
+	double complex  z2;	/* Square of argument. */
+	double complex  s;	/* Series sum or continued fraction. */
+	double complex  term;	/* Power series term. */
+	double complex  result;	/* Error function of argument. */
+	int             i;	/* Loop counter. */
+
+	/* Use real error function for real numbers, and odd symmetry of
+	 * error function otherwise. */
+	if (cimag(a) == 0)
+		return complex_pack(erf(creal(a)), 0);
+	z = (creal(a) < 0) ? -a : a;
+	z2 = z * z;
+
+	if (creal(z) < ERF_FRACTION) {
+		/* Sum power series erf(z) = 2/sqrt(pi) * sum((-1)^n *
+		 * z^(2n+1) / (n! * (2n+1))), with terms growing at most
+		 * exp(2*re(z)^2) times larger than function value. */
+		term = s = z;
+		for (i = 1; i < ERF_SERIES_TERMS; i++) {
+			term *= -z2 / i;
+			s += term / (2 * i + 1);
+			if (i > cabs(z2)
+			    && cabs(term) <= ERF_EPSILON * cabs(s))
+				break;
+		}
+		result = TWO_SQRTPI * s;
+	} else {
+		/* Evaluate continued fraction erfc(z) = exp(-z^2) /
+		 * sqrt(pi) / (z + 1/2 / (z + 1 / (z + 3/2 / (z + ...)))),
+		 * converging quickly for argument with large real part,
+		 * from its tail. */
+		s = z;
+		for (i = ERF_FRACTION_TERMS; i >= 1; i--)
+			s = z + 0.5 * i / s;
+		result = 1 - cexp(-z2) * (0.5 * TWO_SQRTPI) / s;
+	}
+
+	return (creal(a) < 0) ? -result : result;
+}
@@ -0,0 +1,49 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CMPLX_H
+#define CMPLX_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+
+/* Compile function represented by tree rooted at given node for
+ * evaluation in complex arithmetic.  Further arguments are array of
+ * symbol table records of function variables and its length.  Function
+ * returns pointer to compiled function.  */
+void           *cmplx_create(Node * root, Record ** records, int count);
+
+/* Destroy compiled function.  */
+void            cmplx_destroy(void *code);
+
+/* Calculate function values for batch of points, given by arrays of
+ * variable values (ordered as records passed to cmplx_create(), each
+ * consisting of given number of pairs of real and imaginary parts, laid
+ * out as array of C99 double complex numbers), and store results as
+ * pairs of real and imaginary parts into given array.  */
+void            cmplx_evaluate_batch(void *code, double **values,
+				     int length, double *results);
+
+#endif
@@ -0,0 +1,385 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <ctype.h>
+#include "approx.h"
+#include "common.h"
+#include "codegen.h"
+#include "xmath.h"
+
+/* Names of functions supported by generated code, and expressions in "x" 
+ * calculating their values (mirroring xmath.c).  */
+static char    *functions[][2] = {
+	{"exp", "exp(x)"},
+	{"log", "log(x)"},
+	{"sqrt", "sqrt(x)"},
+	{"sin", "sin(x)"},
+	{"cos", "cos(x)"},
+	{"tan", "tan(x)"},
+	{"cot", "1 / tan(x)"},
+	{"sec", "1 / cos(x)"},
+	{"csc", "1 / sin(x)"},
+	{"asin", "asin(x)"},
+	{"acos", "acos(x)"},
+	{"atan", "atan(x)"},
+	{"acot", "atan(1 / x)"},
+	{"asec", "acos(1 / x)"},
+	{"acsc", "asin(1 / x)"},
+	{"sinh", "sinh(x)"},
+	{"cosh", "cosh(x)"},
+	{"tanh", "tanh(x)"},
+	{"coth", "1 / tanh(x)"},
+	{"sech", "1 / cosh(x)"},
+	{"csch", "1 / sinh(x)"},
+	{"asinh", "log(x + sqrt(x * x + 1))"},
+	{"acosh", "log(x + sqrt(x * x - 1))"},
+	{"atanh", "0.5 * log((1 + x) / (1 - x))"},
+	{"acoth", "0.5 * log((x + 1) / (x - 1))"},
+	{"asech", "matheval_acosh(1 / x)"},
+	{"acsch", "matheval_asinh(1 / x)"},
+	{"abs", "fabs(x)"},
+	{"step", "isnan(x) ? x : ((x < 0) ? 0 : 1)"},
+	{"delta", "isnan(x) ? x : ((x == 0) ? INFINITY : 0)"},
+	{"nandelta", "isnan(x) ? x : ((x == 0) ? NAN : 0)"},
+	{"erf", "erf(x)"}
+};
+
+/* Definitions of helper functions for exponentiation (mirroring
+ * xmath.c), with limit as format argument.  */
+static char    *helpers =
+    "static inline double\n"
+    "matheval_powi(double x, int n)\n"
+    "{\n"
+    "\tdouble base, result;\n"
+    "\tunsigned m;\n"
+    "\n"
+    "\tbase = x;\n"
+    "\tm = (n < 0) ? -(unsigned) n : (unsigned) n;\n"
+    "\tfor (result = 1; m; m >>= 1) {\n"
+    "\t\tif (m & 1)\n"
+    "\t\t\tresult *= x;\n"
+    "\t\tif (m > 1)\n"
+    "\t\t\tx *= x;\n"
+    "\t}\n"
+    "\tif (n >= 0)\n"
+    "\t\treturn result;\n"
+    "\tif (!isnormal(result) && !isnan(result))\n"
+    "\t\treturn pow(base, n);\n"
+    "\treturn 1 / result;\n"
+    "}\n"
+    "\n"
+    "static inline double\n"
+    "matheval_pow(double x, double y)\n"
+    "{\n"
+    "\tif (fabs(y) <= %d && y == (int) y)\n"
+    "\t\treturn matheval_powi(x, (int) y);\n"
+    "\treturn pow(x, y);\n"
+    "}\n";
+
+/* Keywords of C and C++, that could not be used as argument names of
+ * generated functions.  */
+static char    *keywords[] = {
+	"_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic",
+	"_Imaginary", "_Noreturn", "_Static_assert", "_Thread_local",
+	"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand",
+	"bitor", "bool", "break", "case", "catch", "char", "char16_t",
+	"char32_t", "class", "compl", "const", "const_cast", "constexpr",
+	"continue", "decltype", "default", "delete", "do", "double",
+	"dynamic_cast", "else", "enum", "explicit", "export", "extern",
+	"false", "float", "for", "friend", "goto", "if", "inline", "int",
+	"long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+	"nullptr", "operator", "or", "or_eq", "private", "protected",
+	"public", "register", "reinterpret_cast", "restrict", "return",
+	"short", "signed", "sizeof", "static", "static_assert",
+	"static_cast", "struct", "switch", "template", "this",
+	"thread_local", "throw", "true", "try", "typedef", "typeid",
+	"typename", "union", "unsigned", "using", "virtual", "void",
+	"volatile", "wchar_t", "while", "xor", "xor_eq"
+};
+
+/* Macros defined by <math.h> as constants (that would be expanded if
+ * used as argument names), and prefixes of such macros.  */
+static char    *macros[] = {
+	"HUGE_VAL", "HUGE_VALF", "HUGE_VALL", "INFINITY", "NAN",
+	"math_errhandling", "errno"
+};
+static char    *macro_prefixes[] = { "FP_", "M_", "MATH_ERR" };
+
+/* Write to file static inline function with given name suffixed by
+ * "_point", calculating function represented by tree rooted at given
+ * node for single point, with variable values (ordered as array of
+ * symbol table records given) as arguments.  */
+static void     codegen_write_point(FILE * file, char *name, Node * root,
+				    Record ** records, int count);
+
+/* Check if all functions used in subtree rooted at given node are
+ * supported by generated code.  */
+static int      codegen_supported(Node * node);
+
+void
+codegen_write_prelude(FILE * file)
+{
+	int             i;	/* Loop counter. */
+
+	/* Write inclusion of header declaring mathematical functions,
+	 * restrict qualifier usable from C++ too, definitions of
+	 * supported functions, as well as helper functions definitions. */
+	fprintf(file, "%s",
+		"#include <math.h>\n\n#ifdef __cplusplus\n#define matheval_restrict __restrict\n#else\n#define matheval_restrict restrict\n#endif\n\n");
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0])); i++)
+		fprintf(file,
+			"static inline double\nmatheval_%s(double x)\n{\n\treturn %s;\n}\n\n",
+			functions[i][0], functions[i][1]);
+	fprintf(file, helpers, MATH_POWI_MAX);
+}
+
+int
+codegen_write_function(FILE * file, char *name, Node * root,
+		       Record ** records, int count)
+{
+	int             i;	/* Loop counter. */
+
+	/* Check if function could be written, and write function
+	 * calculating value for single point. */
+	if (!codegen_supported(root))
+		return FALSE;
+	codegen_write_point(file, name, root, records, count);
+
+	/* Write scalar function, taking array of variable values. */
+	fprintf(file, "\ndouble\n%s(const double *values)\n{\n", name);
+	fprintf(file, "\treturn %s_point(", name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "%svalues[%d]", (i > 0) ? ", " : "", i);
+	fprintf(file, "%s", ");\n}\n");
+
+	/* Write batch function, as loop over points suitable for
+	 * vectorization. */
+	fprintf(file,
+		"\nvoid\n%s_batch(const double *const *values, long length, double *restrict results)\n{\n",
+		name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "\tconst double *const column%d = values[%d];\n",
+			i, i);
+	fprintf(file, "%s",
+		"\tlong i;\n\n#pragma omp simd\n\tfor (i = 0; i < length; i++)\n");
+	fprintf(file, "\t\tresults[i] = %s_point(", name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "%scolumn%d[i]", (i > 0) ? ", " : "", i);
+	fprintf(file, "%s", ");\n}\n");
+
+	return TRUE;
+}
+
+int
+codegen_valid_argument(char *string, char *name)
+{
+	size_t          length;	/* Length of function name. */
+	int             i;	/* Loop counter. */
+
+	/* Reject names used by generated code, names reserved for
+	 * implementation (starting with two underscores or underscore
+	 * followed by uppercase letter), keywords and macros defined by
+	 * <math.h>. */
+	if (!strncmp(string, "matheval_", 9) || !strncmp(string, "__", 2)
+	    || (string[0] == '_' && isupper((unsigned char) string[1])))
+		return FALSE;
+	for (i = 0; i < (int) (sizeof(keywords) / sizeof(keywords[0])); i++)
+		if (!strcmp(string, keywords[i]))
+			return FALSE;
+	for (i = 0; i < (int) (sizeof(macros) / sizeof(macros[0])); i++)
+		if (!strcmp(string, macros[i]))
+			return FALSE;
+	for (i = 0;
+	     i < (int) (sizeof(macro_prefixes) / sizeof(macro_prefixes[0]));
+	     i++)
+		if (!strncmp
+		    (string, macro_prefixes[i], strlen(macro_prefixes[i])))
+			return FALSE;
+
+	/* Reject names of functions calculating function and derivatives
+	 * values for single point, called by functions taking arguments
+	 * (that is, given name followed by "_point" or by "_d", digits
+	 * and "_point"). */
+	length = strlen(name);
+	if (strncmp(string, name, length) || string[length] != '_')
+		return TRUE;
+	string += length + 1;
+	if (string[0] == 'd' && isdigit((unsigned char) string[1]))
+		for (string++; isdigit((unsigned char) *string); string++);
+	else
+		string--;
+	return strcmp(string, "_point") != 0;
+}
+
+int
+codegen_write_inline(FILE * file, char *name, Node * root,
+		     Node ** derivatives, Record ** records, int count)
+{
+	char           *derivative;	/* Derivative function name. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Check if function and its derivatives could be written, with
+	 * variables names as arguments names. */
+	if (!codegen_supported(root))
+		return FALSE;
+	for (i = 0; i < count; i++)
+		if (!codegen_supported(derivatives[i])
+		    || !codegen_valid_argument(records[i]->name, name))
+			return FALSE;
+
+	/* Write functions calculating function and derivatives values for
+	 * single point. */
+	codegen_write_point(file, name, root, records, count);
+	derivative = XMALLOC(char, strlen(name) + 32);
+	for (i = 0; i < count; i++) {
+		sprintf(derivative, "%s_d%d", name, i);
+		codegen_write_point(file, derivative, derivatives[i],
+				    records, count);
+	}
+	XFREE(derivative);
+
+	/* Write scalar function, taking variable values as arguments
+	 * named after variables. */
+	fprintf(file, "\nstatic inline double\n%s(", name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "%sdouble %s", (i > 0) ? ", " : "",
+			records[i]->name);
+	fprintf(file, "%s\n{\n\treturn %s_point(",
+		(count > 0) ? ")" : "void)", name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "%s%s", (i > 0) ? ", " : "", records[i]->name);
+	fprintf(file, "%s", ");\n}\n");
+
+	/* Write batch function, taking number of points, array of values
+	 * for each variable and array for results (loop is vectorized
+	 * anyway by optimizing compilers, so pragma is written only for
+	 * OpenMP compilation to avoid warnings otherwise). */
+	fprintf(file,
+		"\nstatic inline void\n%s_batch(long matheval_length, ",
+		name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "const double *matheval_restrict %s, ",
+			records[i]->name);
+	fprintf(file, "%s",
+		"double *matheval_restrict matheval_results)\n{\n\tlong matheval_i;\n\n#ifdef _OPENMP\n#pragma omp simd\n#endif\n\tfor (matheval_i = 0; matheval_i < matheval_length; matheval_i++)\n");
+	fprintf(file, "\t\tmatheval_results[matheval_i] = %s_point(",
+		name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "%s%s[matheval_i]", (i > 0) ? ", " : "",
+			records[i]->name);
+	fprintf(file, "%s", ");\n}\n");
+
+	/* Write gradient function, taking variable values and array for
+	 * partial derivatives values. */
+	if (count > 0) {
+		fprintf(file, "\nstatic inline void\n%s_gradient(", name);
+		for (i = 0; i < count; i++)
+			fprintf(file, "double %s, ", records[i]->name);
+		fprintf(file, "%s", "double *matheval_gradient)\n{\n");
+		for (i = 0; i < count; i++) {
+			fprintf(file,
+				"\tmatheval_gradient[%d] = %s_d%d_point(", i,
+				name, i);
+			for (j = 0; j < count; j++)
+				fprintf(file, "%s%s", (j > 0) ? ", " : "",
+					records[j]->name);
+			fprintf(file, "%s", ");\n");
+		}
+		fprintf(file, "%s", "}\n");
+	}
+
+	return TRUE;
+}
+
+static void
+codegen_write_point(FILE * file, char *name, Node * root,
+		    Record ** records, int count)
+{
+	int             temporaries;	/* Number of temporaries used. */
+	int             result;	/* Temporary holding function value. */
+	int             i;	/* Loop counter. */
+
+	/* Write function header, with variable values as arguments, and
+	 * function body as sequence of statements. */
+	fprintf(file, "\nstatic inline double\n%s_point(", name);
+	for (i = 0; i < count; i++)
+		fprintf(file, "%sconst double x%d", (i > 0) ? ", " : "", i);
+	fprintf(file, "%s\n{\n", (count > 0) ? ")" : "void)");
+	temporaries = 0;
+	result = node_write_c(root, file, records, count, &temporaries);
+	fprintf(file, "\n\treturn t%d;\n}\n", result);
+}
+
+static int
+codegen_supported(Node * node)
+{
+	int             i;	/* Loop counter. */
+
+	/* According to node type, check functions used in subtree rooted
+	 * at node. */
+	switch (node->type) {
+	case 'n':
+	case 'c':
+	case 'v':
+		return TRUE;
+
+	case 'f':
+		/* Approximations of functions are not supported. */
+		if (approx_exact(node->data.function.record->data.function) !=
+		    node->data.function.record->data.function)
+			return FALSE;
+		for (i = 0;
+		     i < (int) (sizeof(functions) / sizeof(functions[0]));
+		     i++)
+			if (!strcmp
+			    (node->data.function.record->name,
+			     functions[i][0]))
+				return codegen_supported(node->data.
+							 function.child);
+		return FALSE;
+
+	case 'u':
+		return codegen_supported(node->data.un_op.child);
+
+	case 'b':
+		return codegen_supported(node->data.bin_op.left)
+		    && codegen_supported(node->data.bin_op.right);
+
+	case 'p':
+		return codegen_supported(node->data.power.child);
+
+	case 'h':
+		return codegen_supported(node->data.polynomial.child);
+
+	case 'm':
+		return codegen_supported(node->data.muladd.left)
+		    && codegen_supported(node->data.muladd.right)
+		    && codegen_supported(node->data.muladd.addend);
+	}
+
+	return FALSE;
+}
@@ -0,0 +1,84 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CODEGEN_H
+#define CODEGEN_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include "node.h"
+
+/* Write to file C code preceding generated functions: inclusion of
+ * <math.h> and definitions of "matheval_" prefixed functions used by
+ * expressions written by node_write_c(), calculating same values as
+ * respective library functions.  */
+void            codegen_write_prelude(FILE * file);
+
+/* Write to file C functions calculating function represented by tree
+ * rooted at given node.  Scalar function has given name and takes
+ * array of variable values, ordered as array of symbol table records
+ * given (with length given by last argument).  Batch function, with
+ * "_batch" appended to name, takes array of arrays of variable values,
+ * number of points and array for results.  Function returns TRUE if
+ * code written, FALSE if tree contains function not supported by
+ * generated code.  */
+int             codegen_write_function(FILE * file, char *name,
+				       Node * root, Record ** records,
+				       int count);
+
+/* Check if given variable name could be used as argument name of
+ * functions written by codegen_write_inline() for function with given
+ * name, that is if it is not C or C++ keyword, macro defined by
+ * <math.h>, identifier reserved for implementation or starting with
+ * "matheval_", nor name of function called from generated functions.
+ * Function returns TRUE if name could be used, FALSE otherwise.  */
+int             codegen_valid_argument(char *string, char *name);
+
+/* Write to file static inline C functions calculating function
+ * represented by tree rooted at given node, suitable for inclusion from
+ * header.  Scalar function has given name and variable values as
+ * arguments, named after variables and ordered as array of symbol table
+ * records given (with length given by last argument).  Batch function,
+ * with "_batch" appended to name, takes number of points, array of
+ * values for each variable and array for results.  Gradient function,
+ * with "_gradient" appended to name, takes variable values and array
+ * for partial derivatives, which are calculated from trees given by
+ * array of derivatives (ordered same as variables).  Function returns
+ * TRUE if code written, FALSE (without writing anything) if some tree
+ * contains function not supported by generated code or some variable
+ * name could not be used as argument name.  */
+int             codegen_write_inline(FILE * file, char *name, Node * root,
+				     Node ** derivatives,
+				     Record ** records, int count);
+
+/* Write to file static inline C functions calculating function
+ * represented by given evaluator and its gradient, as described above,
+ * with variables in alphabetical order.  This function is defined in
+ * matheval.c, as it needs access to evaluator internals.  Function
+ * returns TRUE if code written, FALSE otherwise.  */
+int             evaluator_write_inline(void *evaluator, FILE * file,
+				       char *name);
+
+#endif
@@ -0,0 +1,425 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "common.h"
+#include "compiler.h"
+#include "matheval.h"
+
+/* Cache directory set by compiler_set_cache_directory(), and flag set
+ * if that function called.  */
+static char    *cache_directory = NULL;
+static int      cache_directory_set = FALSE;
+
+#if HAVE_DLOPEN && HAVE_DLFCN_H && HAVE_MKDTEMP
+
+#include <dlfcn.h>
+#if HAVE_DLADDR1
+#include <link.h>
+#endif
+#include <sys/stat.h>
+#include <unistd.h>
+#include "codegen.h"
+
+/* Default compiler command and flags.  Floating point contraction is
+ * disabled, so that results are same as calculated by other engines.  */
+#define COMPILER_CC "cc"
+#define COMPILER_CFLAGS "-O3 -march=native -ffp-contract=off -fopenmp-simd"
+
+/* Length of trailer appended to cached shared objects.  */
+#define CACHE_TRAILER_LENGTH 64
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	void           *handle;	/* Handle of loaded shared object.  */
+	double          (*scalar) (double *values);	/* Scalar function. 
+							 */
+	void            (*batch) (double **values, long length,
+				  double *results);	/* Batch function. */
+} Compiler;
+
+/* Calculate key identifying compiled code in cache: two hash values, in 
+ * hexadecimal, and length of text consisting of library version,
+ * compiler command and flags, processor features and C code in given
+ * source file.  Key is stored into given buffer, that should be at
+ * least 64 characters long.  Function returns zero if source file could 
+ * not be read.  */
+static int      cache_key(char *key, char *cc, char *cflags, char *source);
+
+/* Fill given buffer with trailer of cache entry for given key.  */
+static void     cache_trailer(char *trailer, char *key);
+
+/* Mix given text into hash values and length.  */
+static void     cache_hash(unsigned long long *first,
+			   unsigned long long *second, long *length,
+			   const char *text, size_t size);
+
+/* Find size of machine code of function at given address in loaded
+ * shared object, or return zero if not known.  */
+static size_t   compiler_code_size(void *code);
+
+/* Load shared object from given file and look up functions, checking
+ * first that file is complete cache entry for given key (if not null
+ * pointer).  Function returns pointer to compiled function, or null
+ * pointer if loading failed.  */
+static Compiler *compiler_load(char *object, char *key);
+
+/* Calculate function value using compiled code.  */
+static double   compiler_evaluate(void *code, double *values);
+
+/* Calculate function values for batch of points using compiled code.  */
+static void     compiler_evaluate_batch(void *code, double **values,
+					int length, double *results);
+
+/* Destroy compiled code.  */
+static void     compiler_destroy(void *code);
+
+Engine         *
+compiler_create(Node * root, Record ** records, int count)
+{
+	Compiler       *compiler;	/* Compiled function. */
+	Engine         *engine;	/* Engine data structure. */
+	FILE           *file;	/* Source file. */
+	char           *directory;	/* Temporary directory. */
+	char           *source;	/* Source file name. */
+	char           *object;	/* Shared object file name. */
+	char           *command;	/* Compiler command line. */
+	char           *cc;	/* Compiler command. */
+	char           *cflags;	/* Compiler flags. */
+	char           *tmpdir;	/* Directory for temporary files. */
+	char           *cache;	/* Cache directory. */
+	char           *entry;	/* Cache entry file name. */
+	char            key[64];	/* Cache key. */
+	char            trailer[CACHE_TRAILER_LENGTH];	/* Cache entry
+							 * trailer. */
+	int             descriptor;	/* Temporary cache entry file
+					 * descriptor. */
+	int             ok;	/* Flag set if compilation succeeded. */
+
+	/* Determine compiler command and flags, as well as cache
+	 * directory. */
+	cc = getenv("MATHEVAL_CC");
+	if (!cc)
+		cc = COMPILER_CC;
+	cflags = getenv("MATHEVAL_CFLAGS");
+	if (!cflags)
+		cflags = COMPILER_CFLAGS;
+	cache =
+	    cache_directory_set ? cache_directory :
+	    getenv("MATHEVAL_CACHE");
+	if (cache && !*cache)
+		cache = NULL;
+
+	/* Create temporary directory for source file and shared object. */
+	tmpdir = getenv("TMPDIR");
+	if (!tmpdir)
+		tmpdir = "/tmp";
+	directory = XMALLOC(char, strlen(tmpdir) + 17);
+	sprintf(directory, "%s/matheval-XXXXXX", tmpdir);
+	if (!mkdtemp(directory)) {
+		XFREE(directory);
+		return NULL;
+	}
+	source = XMALLOC(char, strlen(directory) + 12);
+	sprintf(source, "%s/function.c", directory);
+	object = XMALLOC(char, strlen(directory) + 13);
+	sprintf(object, "%s/function.so", directory);
+
+	/* Write function as C code. */
+	ok = FALSE;
+	file = fopen(source, "w");
+	if (file) {
+		codegen_write_prelude(file);
+		ok = codegen_write_function(file, "evaluate", root, records,
+					    count);
+		ok = (fclose(file) == 0) && ok;
+	}
+
+	/* If cache used, calculate key from C code and compilation
+	 * settings, and try to load shared object from cache entry named
+	 * after key.  Otherwise, shared object is compiled into temporary
+	 * file in cache directory, that is atomically renamed into cache
+	 * entry afterwards, so that concurrent processes never see
+	 * incomplete entry. */
+	compiler = NULL;
+	entry = NULL;
+	if (ok && cache && cache_key(key, cc, cflags, source)) {
+		mkdir(cache, 0777);
+		entry = XMALLOC(char, strlen(cache) + strlen(key) + 12);
+		sprintf(entry, "%s/%.32s.so", cache, key);
+		compiler = compiler_load(entry, key);
+		if (!compiler) {
+			XFREE(object);
+			object = XMALLOC(char, strlen(entry) + 8);
+			sprintf(object, "%s.XXXXXX", entry);
+			if ((descriptor = mkstemp(object)) >= 0)
+				close(descriptor);
+			else {
+				XFREE(object);
+				object = XMALLOC(char, strlen(directory) + 13);
+				sprintf(object, "%s/function.so", directory);
+				XFREE(entry);
+				entry = NULL;
+			}
+		}
+	}
+
+	/* Compile C code into shared object, unless already loaded from
+	 * cache. */
+	if (ok && !compiler) {
+		command =
+		    XMALLOC(char,
+			    strlen(cc) + strlen(cflags) + strlen(source) +
+			    strlen(object) + 64);
+		sprintf(command,
+			"%s %s -shared -fPIC -o '%s' '%s' -lm >/dev/null 2>&1",
+			cc, cflags, object, source);
+		ok = (system(command) == 0);
+		XFREE(command);
+
+		/* Load shared object, from cache entry if it could be put
+		 * into cache; key is appended to shared object before (as
+		 * trailing data, ignored by dynamic loader), to be checked
+		 * when cache entry loaded. */
+		if (ok && entry && (file = fopen(object, "ab"))) {
+			cache_trailer(trailer, key);
+			fwrite(trailer, 1, CACHE_TRAILER_LENGTH, file);
+			if (fclose(file) == 0 && rename(object, entry) == 0)
+				compiler = compiler_load(entry, key);
+		}
+		if (ok && !compiler)
+			compiler = compiler_load(object, NULL);
+	}
+
+	/* Remove temporary files (loaded object remains mapped). */
+	unlink(source);
+	unlink(object);
+	rmdir(directory);
+	XFREE(source);
+	XFREE(object);
+	XFREE(directory);
+	XFREE(entry);
+	if (!compiler)
+		return NULL;
+
+	/* Create engine data structure. */
+	engine = XMALLOC(Engine, 1);
+	engine->type = EVALUATOR_ENGINE_C;
+	engine->count = count;
+	engine->code = compiler;
+	engine->evaluate = compiler_evaluate;
+	engine->evaluate_batch = compiler_evaluate_batch;
+	engine->destroy = compiler_destroy;
+	engine->scalar_code = *(void **) &compiler->scalar;
+	engine->scalar_size = compiler_code_size(engine->scalar_code);
+	engine->batch_code = *(void **) &compiler->batch;
+	engine->batch_size = compiler_code_size(engine->batch_code);
+
+	return engine;
+}
+
+static int
+cache_key(char *key, char *cc, char *cflags, char *source)
+{
+	unsigned long long first,
+	                second;	/* Hash values. */
+	long            length;	/* Length of text hashed. */
+	FILE           *file;	/* Source file. */
+	char            buffer[4096];	/* Buffer for reading source
+					 * file. */
+	size_t          size;	/* Number of bytes read. */
+
+	/* Hash library version, compiler command and flags. */
+	first = 14695981039346656037ULL;
+	second = 5381;
+	length = 0;
+	cache_hash(&first, &second, &length, PACKAGE_VERSION,
+		   strlen(PACKAGE_VERSION) + 1);
+	cache_hash(&first, &second, &length, cc, strlen(cc) + 1);
+	cache_hash(&first, &second, &length, cflags, strlen(cflags) + 1);
+
+	/* Hash processor features (as compiler flags may request code
+	 * specific to processor used). */
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#define CACHE_FEATURE(name) \
+	if (__builtin_cpu_supports(name)) \
+		cache_hash(&first, &second, &length, name, sizeof(name))
+	CACHE_FEATURE("sse2");
+	CACHE_FEATURE("sse3");
+	CACHE_FEATURE("ssse3");
+	CACHE_FEATURE("sse4.1");
+	CACHE_FEATURE("sse4.2");
+	CACHE_FEATURE("popcnt");
+	CACHE_FEATURE("avx");
+	CACHE_FEATURE("avx2");
+	CACHE_FEATURE("fma");
+	CACHE_FEATURE("bmi");
+	CACHE_FEATURE("bmi2");
+	CACHE_FEATURE("avx512f");
+	CACHE_FEATURE("avx512dq");
+	CACHE_FEATURE("avx512bw");
+	CACHE_FEATURE("avx512vl");
+#undef CACHE_FEATURE
+#endif
+
+	/* Hash C code. */
+	file = fopen(source, "r");
+	if (!file)
+		return FALSE;
+	while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		cache_hash(&first, &second, &length, buffer, size);
+	fclose(file);
+
+	sprintf(key, "%016llx%016llx-%ld", first, second, length);
+	return TRUE;
+}
+
+static void
+cache_trailer(char *trailer, char *key)
+{
+	/* Write library name and key, padded by zeros. */
+	memset(trailer, 0, CACHE_TRAILER_LENGTH);
+	sprintf(trailer, "matheval %s", key);
+}
+
+static void
+cache_hash(unsigned long long *first, unsigned long long *second,
+	   long *length, const char *text, size_t size)
+{
+	size_t          i;	/* Loop counter. */
+
+	/* Update FNV-1a and DJB hash values. */
+	for (i = 0; i < size; i++) {
+		*first = (*first ^ (unsigned char) text[i]) * 1099511628211ULL;
+		*second = *second * 33 + (unsigned char) text[i];
+	}
+	*length += size;
+}
+
+static size_t
+compiler_code_size(void *code)
+{
+#if HAVE_DLADDR1
+	Dl_info         info;	/* Information about symbol. */
+	ElfW(Sym)      *symbol;	/* Symbol table entry. */
+
+	/* Take size from symbol table entry of function. */
+	if (dladdr1(code, &info, (void **) &symbol, RTLD_DL_SYMENT)
+	    && symbol)
+		return symbol->st_size;
+#endif
+	return 0;
+}
+
+static Compiler *
+compiler_load(char *object, char *key)
+{
+	Compiler       *compiler;	/* Compiled function. */
+	FILE           *file;	/* Shared object file. */
+	char            expected[CACHE_TRAILER_LENGTH];	/* Expected
+							 * trailer. */
+	char            trailer[CACHE_TRAILER_LENGTH];	/* Trailer read. */
+	int             ok;	/* Flag set if trailer matches. */
+
+	/* If key given, check that file ends with trailer for key before
+	 * loading it, as loading incomplete shared object may crash. */
+	if (key) {
+		if (!(file = fopen(object, "rb")))
+			return NULL;
+		cache_trailer(expected, key);
+		ok = fseek(file, -CACHE_TRAILER_LENGTH, SEEK_END) == 0
+		    && fread(trailer, 1, CACHE_TRAILER_LENGTH,
+			     file) == CACHE_TRAILER_LENGTH
+		    && memcmp(trailer, expected, CACHE_TRAILER_LENGTH) == 0;
+		fclose(file);
+		if (!ok)
+			return NULL;
+	}
+
+	/* Load shared object and look up functions. */
+	compiler = XMALLOC(Compiler, 1);
+	compiler->handle = dlopen(object, RTLD_NOW | RTLD_LOCAL);
+	if (compiler->handle) {
+		*(void **) &compiler->scalar =
+		    dlsym(compiler->handle, "evaluate");
+		*(void **) &compiler->batch =
+		    dlsym(compiler->handle, "evaluate_batch");
+	}
+	if (!compiler->handle || !compiler->scalar || !compiler->batch) {
+		if (compiler->handle)
+			dlclose(compiler->handle);
+		XFREE(compiler);
+		return NULL;
+	}
+
+	return compiler;
+}
+
+static double
+compiler_evaluate(void *code, double *values)
+{
+	/* Call scalar function. */
+	return ((Compiler *) code)->scalar(values);
+}
+
+static void
+compiler_evaluate_batch(void *code, double **values, int length,
+			double *results)
+{
+	/* Call batch function. */
+	((Compiler *) code)->batch(values, length, results);
+}
+
+static void
+compiler_destroy(void *code)
+{
+	/* Unload shared object. */
+	dlclose(((Compiler *) code)->handle);
+	XFREE(code);
+}
+
+#else
+
+Engine         *
+compiler_create(Node * root, Record ** records, int count)
+{
+	/* Dynamic loading not available. */
+	return NULL;
+}
+
+#endif
+
+void
+compiler_set_cache_directory(char *directory)
+{
+	/* Remember copy of directory name. */
+	XFREE(cache_directory);
+	cache_directory = NULL;
+	if (directory) {
+		cache_directory = XMALLOC(char, strlen(directory) + 1);
+		strcpy(cache_directory, directory);
+	}
+	cache_directory_set = TRUE;
+}
@@ -0,0 +1,48 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef COMPILER_H
+#define COMPILER_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "engine.h"
+
+/* Compile function represented by tree rooted at given node by writing
+ * it as C code, compiling it into shared object using system C compiler
+ * and loading this object.  Further arguments are array of symbol
+ * table records of function variables and its length.  Compiler command 
+ * and flags are taken from MATHEVAL_CC and MATHEVAL_CFLAGS environment
+ * variables, if set.  Function returns pointer to compiled function, or 
+ * null pointer if compilation failed or dynamic loading not available.  */
+Engine         *compiler_create(Node * root, Record ** records,
+				int count);
+
+/* Set directory where compiled shared objects are cached, so that
+ * functions compiled once are later loaded without compilation; null
+ * pointer disables cache.  If not set, MATHEVAL_CACHE environment
+ * variable is used.  */
+void            compiler_set_cache_directory(char *directory);
+
+#endif
@@ -0,0 +1,1475 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include "approx.h"
+#include "common.h"
+#include "ddouble.h"
+#include "postfix.h"
+#include "xmath.h"
+
+/* Factor splitting double precision number into two halves (2^27+1), and 
+ * largest number that could be split without overflow.  */
+#define SPLITTER 134217729.0
+#define SPLIT_THRESHOLD 6.69692879491417e+299
+
+/* Number of points evaluated at once, so that operations on different
+ * points could overlap.  */
+#define TILE 64
+
+/* Relative precision of double-double numbers (2^-104), used to stop
+ * summation of series.  */
+#define EPSILON 4.93038065763132e-32
+
+/* Number of tabulated inverse factorials.  */
+#define FACTORIAL_COUNT 31
+
+/* Highest powers in Taylor series of exponential function (for argument 
+ * no larger than ln(2)/1024), sine (for argument no larger than pi/4)
+ * and hyperbolic sine (for argument no larger than 1/4), for which
+ * further terms are negligible.  */
+#define EXP_DEGREE 10
+#define SIN_DEGREE 29
+#define SINH_DEGREE 23
+
+/* Argument above which error function is calculated from asymptotic
+ * expansion of complementary error function instead of power series.  */
+#define ERF_ASYMPTOTIC 6.5
+
+/* Double-double version of function of one argument.  */
+typedef         DDouble(*Function) (DDouble);
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	Postfix        *postfix;	/* Postfix form of function. */
+	DDouble        *numbers;	/* Values of numbers and constants, 
+					 * indexed by step. */
+	Function       *functions;	/* Double-double versions of
+					 * called functions, indexed by
+					 * step (null pointer if not
+					 * known). */
+	DDouble        *stack;	/* Evaluation stack, consisting of
+				 * tile-sized vectors. */
+} Code;
+
+/* Predefined constants, in double-double precision.  */
+static struct {
+	char           *name;	/* Constant name. */
+	DDouble         value;	/* Constant value. */
+} constants[] = {
+	{
+		"e", {
+	2.7182818284590451, 1.4456468917292502e-16}}, {
+		"log2e", {
+	1.4426950408889634, 2.0355273740931033e-17}}, {
+		"log10e", {
+	0.43429448190325182, 1.0983196502167651e-17}}, {
+		"ln2", {
+	0.69314718055994529, 2.3190468138462996e-17}}, {
+		"ln10", {
+	2.3025850929940459, -2.1707562233822494e-16}}, {
+		"pi", {
+	3.1415926535897931, 1.2246467991473532e-16}}, {
+		"pi_2", {
+	1.5707963267948966, 6.123233995736766e-17}}, {
+		"pi_4", {
+	0.78539816339744828, 3.061616997868383e-17}}, {
+		"1_pi", {
+	0.31830988618379069, -1.9678676675182486e-17}}, {
+		"2_pi", {
+	0.63661977236758138, -3.9357353350364972e-17}}, {
+		"2_sqrtpi", {
+	1.1283791670955126, 1.5335459613165881e-17}}, {
+		"sqrt2", {
+	1.4142135623730951, -9.6672933134529135e-17}}, {
+		"sqrt1_2", {
+	0.70710678118654757, -4.8336466567264567e-17}}
+};
+
+/* Constants used by functions below.  */
+#define LN2 constants[3].value
+#define PI_2 constants[6].value
+#define PI_4 constants[7].value
+#define TWO_SQRTPI constants[10].value
+
+/* Values of ln(2) and pi/2 split into three parts, used for argument
+ * reduction.  */
+static double   ln2_parts[] = {
+	0.6931471805599453, 2.3190468138462996e-17, 5.707708438416212e-34
+};
+static double   pi_2_parts[] = {
+	1.5707963267948966, 6.123233995736766e-17, -1.4973849048591698e-33
+};
+
+/* Inverse factorials 1/n!, in double-double precision.  */
+static DDouble  inverse_factorials[FACTORIAL_COUNT] = {
+	{1, 0},
+	{1, 0},
+	{0.5, 0},
+	{0.16666666666666666, 9.2518585385429707e-18},
+	{0.041666666666666664, 2.3129646346357427e-18},
+	{0.0083333333333333332, 1.1564823173178714e-19},
+	{0.0013888888888888889, -5.3005439543735771e-20},
+	{0.00019841269841269841, 1.7209558293420705e-22},
+	{2.4801587301587302e-05, 2.1511947866775882e-23},
+	{2.7557319223985893e-06, -1.8583932740464721e-22},
+	{2.7557319223985888e-07, 2.3767714622250297e-23},
+	{2.505210838544172e-08, -1.448814070935912e-24},
+	{2.08767569878681e-09, -1.20734505911326e-25},
+	{1.6059043836821613e-10, 1.2585294588752098e-26},
+	{1.1470745597729725e-11, 2.0655512752830745e-28},
+	{7.6471637318198164e-13, 7.03872877733453e-30},
+	{4.7794773323873853e-14, 4.3992054858340813e-31},
+	{2.8114572543455206e-15, 1.6508842730861433e-31},
+	{1.5619206968586225e-16, 1.1910679660273754e-32},
+	{8.2206352466243295e-18, 2.2141894119604265e-34},
+	{4.1103176233121648e-19, 1.4412973378659527e-36},
+	{1.9572941063391263e-20, -1.3643503830087908e-36},
+	{8.8967913924505741e-22, -7.9114026148723762e-38},
+	{3.8681701706306841e-23, -8.8431776554823438e-40},
+	{1.6117375710961184e-24, -3.6846573564509766e-41},
+	{6.4469502843844736e-26, -1.9330404233703465e-42},
+	{2.4795962632247976e-27, -1.2953730964765229e-43},
+	{9.183689863795546e-29, 1.4303150396787322e-45},
+	{3.2798892370698378e-30, 1.5117542744029879e-46},
+	{1.1309962886447716e-31, 1.0498015412959506e-47},
+	{3.7699876288159054e-33, 2.5870347832750324e-49}
+};
+
+/* Flag set if fused multiply-add is implemented by hardware, so that
+ * product errors are calculated by calling fma().  */
+static int      fast_fma;
+
+/* Evaluate compiled function for given number (at most tile size) of
+ * points starting at given offset into arrays of variable values, and
+ * leave function values in first vector of evaluation stack.  */
+static void     evaluate(Code * code, double **values, double **values_low,
+			 int offset, int length);
+
+/* Return double-double version of given function of one argument (one
+ * of functions predefined in symbol table), or null pointer if not
+ * known.  */
+static Function function_ddouble(double (*function) (double));
+
+/* Error-free transformations: return rounded sum (assuming that first
+ * argument is not smaller than second one for quick version) or
+ * product of given numbers, and store its rounding error into location
+ * given by last argument.  */
+static inline double two_sum(double a, double b, double *error);
+static inline double quick_two_sum(double a, double b, double *error);
+static inline double two_prod(double a, double b, double *error);
+
+/* Return double-double number with given parts, as given or normalized
+ * so that trailing part is no larger than half unit in last place of
+ * leading part.  */
+static inline DDouble dd_pack(double hi, double lo);
+static inline DDouble dd_normalize(double hi, double lo);
+
+/* Arithmetic operations on double-double numbers, and on double-double
+ * and double precision number.  */
+static inline DDouble dd_neg(DDouble a);
+static inline DDouble dd_add(DDouble a, DDouble b);
+static inline DDouble dd_add_quick(DDouble a, DDouble b);
+static inline DDouble dd_sub(DDouble a, DDouble b);
+static inline DDouble dd_mul(DDouble a, DDouble b);
+static inline DDouble dd_div(DDouble a, DDouble b);
+static inline DDouble dd_add_double(DDouble a, double b);
+static inline DDouble dd_mul_double(DDouble a, double b);
+static inline DDouble dd_scale(DDouble a, double factor);
+static DDouble  dd_ldexp(DDouble a, int exponent);
+static DDouble  dd_recip(DDouble a);
+static DDouble  dd_sqr(DDouble a);
+static DDouble  dd_powi(DDouble a, int n);
+static DDouble  dd_pow(DDouble a, DDouble b);
+static DDouble  dd_polynomial(DDouble a, double *coefficients, int degree);
+
+/* Sum Taylor series x * (c[first] + t * (c[first+step] + t * (... +
+ * t * c[last]))), where c[n] is 1/n! and sign of t alternates if flag
+ * given by last argument set, by nested multiplication.  */
+static DDouble  dd_taylor(DDouble x, DDouble t, int first, int last,
+			  int step, int alternating);
+
+/* Subtract given integer multiple of constant, given by array of its
+ * three parts, from number.  */
+static DDouble  dd_reduce(DDouble a, double m, double *parts);
+
+/* Calculate exponential function minus one, for argument no larger than 
+ * ln(2)/2 in magnitude.  */
+static DDouble  dd_expm1_reduced(DDouble a);
+
+/* Calculate inverse hyperbolic cosine of one plus given non-negative
+ * number.  */
+static DDouble  dd_acosh1p(DDouble a);
+
+/* Calculate sine and cosine of given number at once.  */
+static void     dd_sincos(DDouble a, DDouble * sine, DDouble * cosine);
+
+/* Calculate angle of given point, from its ordinate and abscissa.  */
+static DDouble  dd_atan2(DDouble y, DDouble x);
+
+/* Double-double versions of functions predefined in symbol table.  */
+static DDouble  dd_exp(DDouble a);
+static DDouble  dd_log(DDouble a);
+static DDouble  dd_sqrt(DDouble a);
+static DDouble  dd_sin(DDouble a);
+static DDouble  dd_cos(DDouble a);
+static DDouble  dd_tan(DDouble a);
+static DDouble  dd_cot(DDouble a);
+static DDouble  dd_sec(DDouble a);
+static DDouble  dd_csc(DDouble a);
+static DDouble  dd_asin(DDouble a);
+static DDouble  dd_acos(DDouble a);
+static DDouble  dd_atan(DDouble a);
+static DDouble  dd_acot(DDouble a);
+static DDouble  dd_asec(DDouble a);
+static DDouble  dd_acsc(DDouble a);
+static DDouble  dd_sinh(DDouble a);
+static DDouble  dd_cosh(DDouble a);
+static DDouble  dd_tanh(DDouble a);
+static DDouble  dd_coth(DDouble a);
+static DDouble  dd_sech(DDouble a);
+static DDouble  dd_csch(DDouble a);
+static DDouble  dd_asinh(DDouble a);
+static DDouble  dd_acosh(DDouble a);
+static DDouble  dd_atanh(DDouble a);
+static DDouble  dd_acoth(DDouble a);
+static DDouble  dd_asech(DDouble a);
+static DDouble  dd_acsch(DDouble a);
+static DDouble  dd_abs(DDouble a);
+static DDouble  dd_step(DDouble a);
+static DDouble  dd_delta(DDouble a);
+static DDouble  dd_nandelta(DDouble a);
+static DDouble  dd_erf(DDouble a);
+
+void           *
+ddouble_create(Node * root, Record ** records, int count)
+{
+	Code           *code;	/* Compiled function. */
+	Node           *node;	/* Node evaluated by step. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Create postfix form of function and allocate memory for
+	 * evaluation. */
+	code = XMALLOC(Code, 1);
+	code->postfix = postfix_create(root, records, count);
+	code->numbers = XMALLOC(DDouble, code->postfix->length);
+	code->functions = XMALLOC(Function, code->postfix->length);
+	code->stack = XMALLOC(DDouble, code->postfix->depth * TILE);
+	fast_fma = math_fast_fma();
+
+	/* Convert numbers and constants to double-double precision
+	 * (predefined constants are calculated to full precision), and
+	 * look up double-double versions of functions. */
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		code->numbers[i] = dd_pack(0, 0);
+		code->functions[i] = NULL;
+		switch (node->type) {
+		case 'n':
+			code->numbers[i] = dd_pack(node->data.number, 0);
+			break;
+
+		case 'c':
+			code->numbers[i] =
+			    dd_pack(node->data.constant->data.value, 0);
+			for (j = 0;
+			     j <
+			     (int) (sizeof(constants) / sizeof(constants[0]));
+			     j++)
+				if (!strcmp
+				    (node->data.constant->name,
+				     constants[j].name))
+					code->numbers[i] = constants[j].value;
+			break;
+
+		case 'f':
+			code->functions[i] =
+			    function_ddouble(approx_exact
+					     (node->data.function.record->
+					      data.function));
+			break;
+		}
+	}
+
+	return code;
+}
+
+void
+ddouble_destroy(void *code)
+{
+	/* Free postfix form, arrays used for evaluation and data
+	 * structure representing compiled function. */
+	if (!code)
+		return;
+	postfix_destroy(((Code *) code)->postfix);
+	XFREE(((Code *) code)->numbers);
+	XFREE(((Code *) code)->functions);
+	XFREE(((Code *) code)->stack);
+	XFREE(code);
+}
+
+void
+ddouble_evaluate_batch(void *code, double **values, double **values_low,
+		       int length, double *results, double *results_low)
+{
+	int             offset;	/* Offset of tile. */
+	int             n;	/* Number of points in tile. */
+	int             j;	/* Loop counter. */
+
+	/* Evaluate function tile by tile, and store leading and trailing
+	 * parts of results. */
+	for (offset = 0; offset < length; offset += TILE) {
+		n = (length - offset < TILE) ? length - offset : TILE;
+		evaluate(code, values, values_low, offset, n);
+		for (j = 0; j < n; j++) {
+			results[offset + j] = ((Code *) code)->stack[j].hi;
+			if (results_low)
+				results_low[offset + j] =
+				    ((Code *) code)->stack[j].lo;
+		}
+	}
+}
+
+static void
+evaluate(Code * code, double **values, double **values_low, int offset,
+	 int length)
+{
+	DDouble        *stack;	/* Top vector of evaluation stack. */
+	Node           *node;	/* Node evaluated by step. */
+	double          (*function) (double);	/* Function called by
+						 * step. */
+	double         *hi,
+	               *lo;	/* Variable values. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Evaluate steps in order, each of them replacing vectors of
+	 * values of its children on top of stack by vector of its own
+	 * values. */
+	stack = code->stack - TILE;
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		switch (node->type) {
+		case 'n':
+		case 'c':
+			stack += TILE;
+			for (j = 0; j < length; j++)
+				stack[j] = code->numbers[i];
+			break;
+
+		case 'v':
+			stack += TILE;
+			hi = values[code->postfix->steps[i].index] + offset;
+			lo = values_low ? values_low[code->postfix->steps[i].
+						     index] + offset : NULL;
+			for (j = 0; j < length; j++)
+				stack[j] = dd_pack(hi[j], lo ? lo[j] : 0);
+			break;
+
+		case 'f':
+			/* Functions without double-double version are
+			 * calculated in double precision (exactly, even if
+			 * approximation selected for evaluator). */
+			function =
+			    approx_exact(node->data.function.record->data.
+					 function);
+			if (code->functions[i])
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    code->functions[i] (stack[j]);
+			else
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    dd_pack(function(stack[j].hi), 0);
+			break;
+
+		case 'u':
+			for (j = 0; j < length; j++)
+				stack[j] = dd_neg(stack[j]);
+			break;
+
+		case 'b':
+			stack -= TILE;
+			switch (node->data.bin_op.operation) {
+			case '+':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    dd_add(stack[j], stack[TILE + j]);
+				break;
+
+			case '-':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    dd_sub(stack[j], stack[TILE + j]);
+				break;
+
+			case '*':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    dd_mul(stack[j], stack[TILE + j]);
+				break;
+
+			case '/':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    dd_div(stack[j], stack[TILE + j]);
+				break;
+
+			case '^':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    dd_pow(stack[j], stack[TILE + j]);
+				break;
+			}
+			break;
+
+		case 'p':
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    dd_powi(stack[j],
+					    node->data.power.exponent);
+			break;
+
+		case 'h':
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    dd_polynomial(stack[j],
+						  node->data.polynomial.
+						  coefficients,
+						  node->data.polynomial.
+						  degree);
+			break;
+
+		case 'm':
+			/* Multiply-add is calculated as separate
+			 * multiplication and addition, both in
+			 * double-double precision. */
+			stack -= 2 * TILE;
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    dd_add(dd_mul(stack[j], stack[TILE + j]),
+					   stack[2 * TILE + j]);
+			break;
+		}
+	}
+}
+
+static          Function
+function_ddouble(double (*function) (double))
+{
+	static struct {
+		double          (*function) (double);	/* Function. */
+		Function        function_ddouble;	/* Double-double
+							 * version. */
+	} functions[] = {
+		{
+		exp, dd_exp}, {
+		log, dd_log}, {
+		sqrt, dd_sqrt}, {
+		sin, dd_sin}, {
+		cos, dd_cos}, {
+		tan, dd_tan}, {
+		math_cot, dd_cot}, {
+		math_sec, dd_sec}, {
+		math_csc, dd_csc}, {
+		asin, dd_asin}, {
+		acos, dd_acos}, {
+		atan, dd_atan}, {
+		math_acot, dd_acot}, {
+		math_asec, dd_asec}, {
+		math_acsc, dd_acsc}, {
+		sinh, dd_sinh}, {
+		cosh, dd_cosh}, {
+		tanh, dd_tanh}, {
+		math_coth, dd_coth}, {
+		math_sech, dd_sech}, {
+		math_csch, dd_csch}, {
+		math_asinh, dd_asinh}, {
+		math_acosh, dd_acosh}, {
+		math_atanh, dd_atanh}, {
+		math_acoth, dd_acoth}, {
+		math_asech, dd_asech}, {
+		math_acsch, dd_acsch}, {
+		fabs, dd_abs}, {
+		math_step, dd_step}, {
+		math_delta, dd_delta}, {
+		math_nandelta, dd_nandelta}, {
+		erf, dd_erf}
+	};			/* Functions and their double-double
+				 * versions. */
+	int             i;	/* Loop counter. */
+
+	/* Look up function among predefined functions. */
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0])); i++)
+		if (functions[i].function == function)
+			return functions[i].function_ddouble;
+	return NULL;
+}
+
+static inline double
+two_sum(double a, double b, double *error)
+{
+	double          sum;	/* Rounded sum. */
+	double          part;	/* Part of sum coming from second
+				 * number. */
+
+	/* Recover rounding error of sum without any assumption on
+	 * magnitudes of numbers (Knuth). */
+	sum = a + b;
+	part = sum - a;
+	*error = (a - (sum - part)) + (b - part);
+	return sum;
+}
+
+static inline double
+quick_two_sum(double a, double b, double *error)
+{
+	double          sum;	/* Rounded sum. */
+
+	/* Recover rounding error of sum, given that first number is not
+	 * smaller than second one (Dekker). */
+	sum = a + b;
+	*error = b - (sum - a);
+	return sum;
+}
+
+static inline double
+two_prod(double a, double b, double *error)
+{
+	double          product;	/* Rounded product. */
+#if !defined FP_FAST_FMA
+	double          a_hi,
+	                a_lo,
+	                b_hi,
+	                b_lo;	/* Halves of numbers. */
+	double          temporary;	/* Temporary value. */
+	double          scale;	/* Factor scaling halves back, if
+				 * number scaled down before splitting. */
+#endif
+
+	product = a * b;
+#if defined FP_FAST_FMA
+	/* Rounding error of product is calculated exactly by fused
+	 * multiply-add. */
+	*error = fma(a, b, -product);
+#else
+	/* Use fused multiply-add if implemented by hardware. */
+	if (fast_fma) {
+		*error = fma(a, b, -product);
+		return product;
+	}
+
+	/* Otherwise, split each number into halves whose products are
+	 * exact (scaling large numbers to avoid overflow), and recover
+	 * rounding error from these products (Dekker). */
+	scale = 1;
+	if (fabs(a) > SPLIT_THRESHOLD) {
+		a *= 3.7252902984619140625e-09;
+		scale = 268435456.0;
+	}
+	temporary = SPLITTER * a;
+	a_hi = (temporary - (temporary - a)) * scale;
+	a_lo = a * scale - a_hi;
+	scale = 1;
+	if (fabs(b) > SPLIT_THRESHOLD) {
+		b *= 3.7252902984619140625e-09;
+		scale = 268435456.0;
+	}
+	temporary = SPLITTER * b;
+	b_hi = (temporary - (temporary - b)) * scale;
+	b_lo = b * scale - b_hi;
+	*error =
+	    ((a_hi * b_hi - product) + a_hi * b_lo + a_lo * b_hi) +
+	    a_lo * b_lo;
+#endif
+	return product;
+}
+
+static inline   DDouble
+dd_pack(double hi, double lo)
+{
+	DDouble         result;	/* Double-double number. */
+
+	/* Store parts as given. */
+	result.hi = hi;
+	result.lo = lo;
+	return result;
+}
+
+static inline   DDouble
+dd_normalize(double hi, double lo)
+{
+	DDouble         result;	/* Double-double number. */
+
+	/* Make leading part rounded sum of parts, and trailing part its
+	 * rounding error; trailing part of infinite or not-a-number value
+	 * is set to zero. */
+	result.hi = quick_two_sum(hi, lo, &result.lo);
+	if (!isfinite(result.hi))
+		result.lo = 0;
+	return result;
+}
+
+static inline   DDouble
+dd_neg(DDouble a)
+{
+	/* Negate both parts. */
+	return dd_pack(-a.hi, -a.lo);
+}
+
+static inline   DDouble
+dd_add(DDouble a, DDouble b)
+{
+	double          s,
+	                e,
+	                t,
+	                f;	/* Sums of parts and their errors. */
+
+	/* Add leading and trailing parts separately, and combine sums
+	 * along with their rounding errors. */
+	s = two_sum(a.hi, b.hi, &e);
+	if (!isfinite(s))
+		return dd_pack(s, 0);
+	t = two_sum(a.lo, b.lo, &f);
+	e += t;
+	s = quick_two_sum(s, e, &e);
+	e += f;
+	return dd_normalize(s, e);
+}
+
+static inline   DDouble
+dd_add_quick(DDouble a, DDouble b)
+{
+	double          s,
+	                e;	/* Sum of leading parts and its error. */
+
+	/* Add leading parts, and add trailing parts to error; this is
+	 * precise unless numbers of opposite signs cancel. */
+	s = two_sum(a.hi, b.hi, &e);
+	if (!isfinite(s))
+		return dd_pack(s, 0);
+	e += a.lo + b.lo;
+	return dd_normalize(s, e);
+}
+
+static inline   DDouble
+dd_sub(DDouble a, DDouble b)
+{
+	/* Add negated second number. */
+	return dd_add(a, dd_neg(b));
+}
+
+static inline   DDouble
+dd_mul(DDouble a, DDouble b)
+{
+	double          p,
+	                e;	/* Product of leading parts and its
+				 * error. */
+
+	/* Multiply leading parts exactly, and add cross products of
+	 * leading and trailing parts to error. */
+	p = two_prod(a.hi, b.hi, &e);
+	if (!isfinite(p))
+		return dd_pack(p, 0);
+	e += a.hi * b.lo + a.lo * b.hi;
+	return dd_normalize(p, e);
+}
+
+static inline   DDouble
+dd_div(DDouble a, DDouble b)
+{
+	double          q1,
+	                q2;	/* Quotient of leading parts and its
+				 * correction. */
+	DDouble         r;	/* Product of divisor and quotient. */
+	double          s1,
+	                s2;	/* Remainder. */
+
+	/* Calculate quotient of leading parts, then correct it by
+	 * dividing remainder. */
+	q1 = a.hi / b.hi;
+	if (!isfinite(q1) || !isfinite(b.hi))
+		return dd_pack(q1, 0);
+	r = dd_mul_double(b, q1);
+	s1 = two_sum(a.hi, -r.hi, &s2);
+	s2 -= r.lo;
+	s2 += a.lo;
+	q2 = (s1 + s2) / b.hi;
+	return dd_normalize(q1, q2);
+}
+
+static inline   DDouble
+dd_add_double(DDouble a, double b)
+{
+	double          s,
+	                e;	/* Sum of leading part and number, and its
+				 * error. */
+
+	/* Add number to leading part, and trailing part to error. */
+	s = two_sum(a.hi, b, &e);
+	if (!isfinite(s))
+		return dd_pack(s, 0);
+	e += a.lo;
+	return dd_normalize(s, e);
+}
+
+static inline   DDouble
+dd_mul_double(DDouble a, double b)
+{
+	double          p,
+	                e;	/* Product of leading part and number, and
+				 * its error. */
+
+	/* Multiply leading part by number exactly, and add product of
+	 * trailing part to error. */
+	p = two_prod(a.hi, b, &e);
+	if (!isfinite(p))
+		return dd_pack(p, 0);
+	e += a.lo * b;
+	return dd_normalize(p, e);
+}
+
+static inline   DDouble
+dd_scale(DDouble a, double factor)
+{
+	/* Multiply both parts by factor, that should be power of two. */
+	return dd_pack(a.hi * factor, a.lo * factor);
+}
+
+static          DDouble
+dd_ldexp(DDouble a, int exponent)
+{
+	/* Multiply both parts by power of two, given by its exponent. */
+	return dd_pack(ldexp(a.hi, exponent), ldexp(a.lo, exponent));
+}
+
+static          DDouble
+dd_recip(DDouble a)
+{
+	/* Divide one by number. */
+	return dd_div(dd_pack(1, 0), a);
+}
+
+static          DDouble
+dd_sqr(DDouble a)
+{
+	/* Multiply number by itself. */
+	return dd_mul(a, a);
+}
+
+static          DDouble
+dd_powi(DDouble a, int n)
+{
+	DDouble         result;	/* Accumulated power. */
+	unsigned        m;	/* Absolute value of exponent. */
+
+	/* Multiply together squares of number corresponding to bits set
+	 * in absolute value of exponent, and take reciprocal for negative
+	 * exponent, as math_powi() does. */
+	m = (n < 0) ? -(unsigned) n : (unsigned) n;
+	for (result = dd_pack(1, 0); m; m >>= 1) {
+		if (m & 1)
+			result = dd_mul(result, a);
+		if (m > 1)
+			a = dd_sqr(a);
+	}
+	return (n < 0) ? dd_recip(result) : result;
+}
+
+static          DDouble
+dd_pow(DDouble a, DDouble b)
+{
+	DDouble         result;	/* Power of absolute value of base. */
+
+	/* Use repeated squaring if exponent is small integer, as
+	 * math_pow() does. */
+	if (b.lo == 0 && fabs(b.hi) <= MATH_POWI_MAX && b.hi == (int) b.hi)
+		return dd_powi(a, (int) b.hi);
+
+	/* Leave special cases to pow(). */
+	if (!isfinite(a.hi) || !isfinite(b.hi) || a.hi == 0)
+		return dd_pack(pow(a.hi, b.hi), 0);
+
+	/* Otherwise, calculate power through exponential and logarithm
+	 * functions, taking sign into account for negative base raised to
+	 * integer power. */
+	if (a.hi > 0)
+		return dd_exp(dd_mul(b, dd_log(a)));
+	if (b.lo == 0 && b.hi == floor(b.hi)) {
+		result = dd_exp(dd_mul(b, dd_log(dd_neg(a))));
+		return (fmod(b.hi, 2) != 0) ? dd_neg(result) : result;
+	}
+	return dd_pack(MATH_NAN, 0);
+}
+
+static          DDouble
+dd_polynomial(DDouble a, double *coefficients, int degree)
+{
+	DDouble         result;	/* Accumulated polynomial value. */
+	int             i;	/* Loop counter. */
+
+	/* Calculate polynomial value by nested multiplication. */
+	result = dd_pack(coefficients[degree], 0);
+	for (i = degree - 1; i >= 0; i--)
+		result = dd_add_double(dd_mul(result, a), coefficients[i]);
+	return result;
+}
+
+static          DDouble
+dd_taylor(DDouble x, DDouble t, int first, int last, int step,
+	  int alternating)
+{
+	DDouble         s;	/* Accumulated sum. */
+	int             i;	/* Loop counter. */
+
+	/* Evaluate series by nested multiplication, starting from
+	 * smallest terms. */
+	s = inverse_factorials[last];
+	for (i = last - step; i >= first; i -= step) {
+		s = dd_mul(s, t);
+		if (alternating)
+			s = dd_neg(s);
+		s = dd_add_quick(s, inverse_factorials[i]);
+	}
+	return dd_mul(s, x);
+}
+
+static          DDouble
+dd_reduce(DDouble a, double m, double *parts)
+{
+	double          p,
+	                e;	/* Product of part and multiple, and its
+				 * error. */
+
+	/* Subtract products of first two parts exactly, and of last part
+	 * rounded. */
+	p = two_prod(parts[0], m, &e);
+	a = dd_sub(a, dd_pack(p, e));
+	p = two_prod(parts[1], m, &e);
+	a = dd_sub(a, dd_pack(p, e));
+	return dd_add_double(a, -parts[2] * m);
+}
+
+static          DDouble
+dd_expm1_reduced(DDouble a)
+{
+	DDouble         r;	/* Reduced argument. */
+	DDouble         s;	/* Exponential of reduced argument, minus
+				 * one. */
+	int             i;	/* Loop counter. */
+
+	/* Divide argument by 512, and sum Taylor series of exponential
+	 * function minus one for it. */
+	r = dd_scale(a, 1.0 / 512);
+	s = dd_taylor(r, r, 1, EXP_DEGREE, 1, FALSE);
+
+	/* Square result 9 times, keeping it minus one to retain
+	 * precision. */
+	for (i = 0; i < 9; i++)
+		s = dd_add_quick(dd_scale(s, 2), dd_sqr(s));
+	return s;
+}
+
+static          DDouble
+dd_acosh1p(DDouble a)
+{
+	DDouble         z;	/* Approximate result. */
+
+	/* Handle arguments out of range and zero. */
+	if (a.hi < 0)
+		return dd_pack(MATH_NAN, 0);
+	if (a.hi == 0)
+		return dd_pack(0, 0);
+
+	/* Calculate double precision result, corrected for trailing part
+	 * of argument (as derivative is large close to zero), and correct
+	 * it by single Newton step; cosh(z)-1 is calculated as
+	 * 2*sinh(z/2)^2, to retain precision for small arguments. */
+	z = dd_pack(log1p(a.hi + sqrt(a.hi * (2 + a.hi))), 0);
+	z.hi += a.lo / sinh(z.hi);
+	return dd_sub(z,
+		      dd_div(dd_sub
+			     (dd_scale(dd_sqr(dd_sinh(dd_scale(z, 0.5))), 2),
+			      a), dd_sinh(z)));
+}
+
+static void
+dd_sincos(DDouble a, DDouble * sine, DDouble * cosine)
+{
+	DDouble         r;	/* Reduced argument. */
+	DDouble         s,
+	                c;	/* Sine and cosine of reduced argument. */
+	double          q;	/* Multiple of pi/2 subtracted. */
+
+	/* Leave zero, infinite and not-a-number values, as well as too
+	 * large arguments (that could not be reduced accurately using
+	 * double-double value of pi), to double precision functions. */
+	if (a.hi == 0 || !(fabs(a.hi) < 1e15)) {
+		*sine = dd_pack(sin(a.hi), 0);
+		*cosine = dd_pack(cos(a.hi), 0);
+		return;
+	}
+
+	/* Reduce argument to interval [-pi/4,pi/4] by subtracting
+	 * multiple of pi/2. */
+	q = floor(a.hi / PI_2.hi + 0.5);
+	r = dd_reduce(a, q, pi_2_parts);
+
+	/* Calculate sine of reduced argument from its Taylor series, and
+	 * cosine from sine. */
+	s = dd_taylor(r, dd_sqr(r), 1, SIN_DEGREE, 2, TRUE);
+	c = dd_sqrt(dd_add_double(dd_neg(dd_sqr(s)), 1));
+
+	/* Rotate sine and cosine according to quadrant. */
+	q = fmod(q, 4);
+	if (q < 0)
+		q += 4;
+	switch ((int) q) {
+	case 0:
+		*sine = s;
+		*cosine = c;
+		break;
+
+	case 1:
+		*sine = c;
+		*cosine = dd_neg(s);
+		break;
+
+	case 2:
+		*sine = dd_neg(s);
+		*cosine = dd_neg(c);
+		break;
+
+	case 3:
+		*sine = dd_neg(c);
+		*cosine = s;
+		break;
+	}
+}
+
+static          DDouble
+dd_atan2(DDouble y, DDouble x)
+{
+	DDouble         r;	/* Distance of point from origin. */
+	DDouble         s,
+	                c;	/* Sine and cosine of approximate angle. */
+	double          z;	/* Approximate angle. */
+	int             exponent;	/* Exponent of larger coordinate. */
+
+	/* For zero or infinite coordinates angle is multiple of pi/4,
+	 * that is recovered from double precision angle. */
+	z = atan2(y.hi, x.hi);
+	if (!isfinite(y.hi) || !isfinite(x.hi)
+	    || (y.hi == 0 && x.hi == 0)) {
+		if (MATH_ISNAN(z))
+			return dd_pack(z, 0);
+		return dd_mul_double(PI_4, floor(z / PI_4.hi + 0.5));
+	}
+
+	/* Scale coordinates to avoid overflow, and normalize them to
+	 * point on unit circle. */
+	exponent = ilogb(fabs(x.hi) > fabs(y.hi) ? x.hi : y.hi);
+	x = dd_ldexp(x, -exponent);
+	y = dd_ldexp(y, -exponent);
+	r = dd_sqrt(dd_add(dd_sqr(x), dd_sqr(y)));
+	x = dd_div(x, r);
+	y = dd_div(y, r);
+
+	/* Correct double precision angle by single Newton step, using
+	 * sine or cosine equation whichever is better conditioned. */
+	dd_sincos(dd_pack(z, 0), &s, &c);
+	if (fabs(x.hi) > fabs(y.hi))
+		return dd_add_double(dd_div(dd_sub(y, s), c), z);
+	else
+		return dd_add_double(dd_neg(dd_div(dd_sub(x, c), s)), z);
+}
+
+static          DDouble
+dd_exp(DDouble a)
+{
+	double          m;	/* Multiple of ln(2) subtracted. */
+
+	/* Handle overflow, underflow and not-a-number values. */
+	if (a.hi >= 709.79)
+		return dd_pack(MATH_INFINITY, 0);
+	if (a.hi <= -745.14)
+		return dd_pack(0, 0);
+	if (MATH_ISNAN(a.hi))
+		return a;
+
+	/* Reduce argument by subtracting multiple of ln(2), and multiply
+	 * exponential of reduced argument by power of two. */
+	m = floor(a.hi / LN2.hi + 0.5);
+	return
+	    dd_ldexp(dd_add_double
+		     (dd_expm1_reduced(dd_reduce(a, m, ln2_parts)), 1),
+		     (int) m);
+}
+
+static          DDouble
+dd_log(DDouble a)
+{
+	DDouble         result;	/* Logarithm. */
+	double          x;	/* Double precision logarithm. */
+	int             exponent;	/* Exponent of argument, if scaled.
+					 */
+
+	/* Leave non-positive, infinite and not-a-number values to double
+	 * precision function. */
+	if (!(a.hi > 0) || !isfinite(a.hi))
+		return dd_pack(log(a.hi), 0);
+	if (a.hi == 1 && a.lo == 0)
+		return dd_pack(0, 0);
+
+	/* Scale very small or large argument close to one, so that
+	 * exponential below does not overflow. */
+	exponent = 0;
+	if (a.hi < 1e-290 || a.hi > 1e290) {
+		exponent = ilogb(a.hi);
+		a = dd_ldexp(a, -exponent);
+	}
+
+	/* Correct double precision logarithm x by single Newton step: x + 
+	 * a * exp(-x) - 1, written as x + a * (exp(-x) - 1) + (a - 1) to
+	 * retain precision for arguments close to one. */
+	x = log(a.hi);
+	if (fabs(x) <= 0.34)
+		result =
+		    dd_add_double(dd_add
+				  (dd_mul(a, dd_expm1_reduced(dd_pack(-x, 0))),
+				   dd_add_double(a, -1)), x);
+	else
+		result =
+		    dd_add_double(dd_add_double
+				  (dd_mul(a, dd_exp(dd_pack(-x, 0))), -1), x);
+	if (exponent)
+		result = dd_add(result, dd_mul_double(LN2, exponent));
+	return result;
+}
+
+static          DDouble
+dd_sqrt(DDouble a)
+{
+	DDouble         r;	/* Remainder. */
+	double          x;	/* Inverse of double precision square
+				 * root. */
+	double          ax;	/* Double precision square root. */
+	double          s,
+	                e;	/* Square of double precision square root
+				 * and its error. */
+
+	/* Leave non-positive, infinite and not-a-number values to double
+	 * precision function. */
+	if (!(a.hi > 0) || !isfinite(a.hi))
+		return dd_pack(sqrt(a.hi), 0);
+
+	/* Correct double precision square root by single Newton step
+	 * (Karp). */
+	x = 1 / sqrt(a.hi);
+	ax = a.hi * x;
+	s = two_prod(ax, ax, &e);
+	r = dd_sub(a, dd_pack(s, e));
+	return dd_add_double(dd_pack(r.hi * x * 0.5, 0), ax);
+}
+
+static          DDouble
+dd_sin(DDouble a)
+{
+	DDouble         s,
+	                c;	/* Sine and cosine. */
+
+	/* Calculate sine along with cosine. */
+	dd_sincos(a, &s, &c);
+	return s;
+}
+
+static          DDouble
+dd_cos(DDouble a)
+{
+	DDouble         s,
+	                c;	/* Sine and cosine. */
+
+	/* Calculate cosine along with sine. */
+	dd_sincos(a, &s, &c);
+	return c;
+}
+
+static          DDouble
+dd_tan(DDouble a)
+{
+	DDouble         s,
+	                c;	/* Sine and cosine. */
+
+	/* Divide sine by cosine. */
+	dd_sincos(a, &s, &c);
+	return dd_div(s, c);
+}
+
+static          DDouble
+dd_cot(DDouble a)
+{
+	DDouble         s,
+	                c;	/* Sine and cosine. */
+
+	/* Divide cosine by sine. */
+	dd_sincos(a, &s, &c);
+	return dd_div(c, s);
+}
+
+static          DDouble
+dd_sec(DDouble a)
+{
+	/* Calculate reciprocal of cosine. */
+	return dd_recip(dd_cos(a));
+}
+
+static          DDouble
+dd_csc(DDouble a)
+{
+	/* Calculate reciprocal of sine. */
+	return dd_recip(dd_sin(a));
+}
+
+static          DDouble
+dd_asin(DDouble a)
+{
+	/* Calculate angle of point with given sine, or not-a-number if
+	 * argument out of range. */
+	if (fabs(a.hi) > 1 || (fabs(a.hi) == 1 && a.hi * a.lo > 0))
+		return dd_pack(MATH_NAN, 0);
+	return dd_atan2(a,
+			dd_sqrt(dd_mul
+				(dd_add_double(dd_neg(a), 1),
+				 dd_add_double(a, 1))));
+}
+
+static          DDouble
+dd_acos(DDouble a)
+{
+	/* Calculate angle of point with given cosine, or not-a-number if
+	 * argument out of range. */
+	if (fabs(a.hi) > 1 || (fabs(a.hi) == 1 && a.hi * a.lo > 0))
+		return dd_pack(MATH_NAN, 0);
+	return dd_atan2(dd_sqrt
+			(dd_mul
+			 (dd_add_double(dd_neg(a), 1), dd_add_double(a, 1))),
+			a);
+}
+
+static          DDouble
+dd_atan(DDouble a)
+{
+	/* Calculate angle of point with given ordinate and unit abscissa. 
+	 */
+	return dd_atan2(a, dd_pack(1, 0));
+}
+
+static          DDouble
+dd_acot(DDouble a)
+{
+	/* Calculate inverse tangent of reciprocal value. */
+	return dd_atan(dd_recip(a));
+}
+
+static          DDouble
+dd_asec(DDouble a)
+{
+	/* Calculate angle of point with abscissa 1/a, scaled by |a| to
+	 * avoid rounding reciprocal value. */
+	return dd_atan2(dd_sqrt
+			(dd_mul
+			 (dd_add_double(a, -1), dd_add_double(a, 1))),
+			dd_pack((a.hi < 0) ? -1 : 1, 0));
+}
+
+static          DDouble
+dd_acsc(DDouble a)
+{
+	/* Calculate angle of point with ordinate 1/a, scaled by |a| to
+	 * avoid rounding reciprocal value. */
+	return dd_atan2(dd_pack((a.hi < 0) ? -1 : 1, 0),
+			dd_sqrt(dd_mul
+				(dd_add_double(a, -1),
+				 dd_add_double(a, 1))));
+}
+
+static          DDouble
+dd_sinh(DDouble a)
+{
+	DDouble         e;	/* Exponential of argument. */
+
+	/* For small arguments, sum Taylor series to avoid cancellation. */
+	if (fabs(a.hi) < 0.25)
+		return dd_taylor(a, dd_sqr(a), 1, SINH_DEGREE, 2, FALSE);
+
+	/* Otherwise, calculate hyperbolic sine from exponential. */
+	if (!isfinite(a.hi))
+		return a;
+	e = dd_exp(a);
+	return dd_scale(dd_sub(e, dd_recip(e)), 0.5);
+}
+
+static          DDouble
+dd_cosh(DDouble a)
+{
+	DDouble         e;	/* Exponential of argument. */
+
+	/* Calculate hyperbolic cosine from exponential. */
+	e = dd_exp(a);
+	return dd_scale(dd_add(e, dd_recip(e)), 0.5);
+}
+
+static          DDouble
+dd_tanh(DDouble a)
+{
+	DDouble         s;	/* Hyperbolic sine. */
+	DDouble         e;	/* Exponential of argument. */
+	DDouble         inverse;	/* Exponential of negated argument. 
+					 */
+
+	/* Hyperbolic tangent of large arguments rounds to one. */
+	if (fabs(a.hi) > 40)
+		return dd_pack((a.hi > 0) ? 1 : -1, 0);
+
+	/* For small arguments, calculate hyperbolic tangent from
+	 * hyperbolic sine, otherwise from exponential. */
+	if (fabs(a.hi) < 0.25) {
+		s = dd_sinh(a);
+		return dd_div(s, dd_sqrt(dd_add_double(dd_sqr(s), 1)));
+	}
+	e = dd_exp(a);
+	inverse = dd_recip(e);
+	return dd_div(dd_sub(e, inverse), dd_add(e, inverse));
+}
+
+static          DDouble
+dd_coth(DDouble a)
+{
+	/* Calculate reciprocal of hyperbolic tangent. */
+	return dd_recip(dd_tanh(a));
+}
+
+static          DDouble
+dd_sech(DDouble a)
+{
+	/* Calculate reciprocal of hyperbolic cosine. */
+	return dd_recip(dd_cosh(a));
+}
+
+static          DDouble
+dd_csch(DDouble a)
+{
+	/* Calculate reciprocal of hyperbolic sine. */
+	return dd_recip(dd_sinh(a));
+}
+
+static          DDouble
+dd_asinh(DDouble a)
+{
+	DDouble         z;	/* Approximate result. */
+	DDouble         result;	/* Result for large argument. */
+
+	/* Leave zero, infinite and not-a-number values as they are. */
+	if (a.hi == 0 || !isfinite(a.hi))
+		return a;
+
+	/* For large arguments, hyperbolic sine is half of exponential. */
+	if (fabs(a.hi) > 1e20) {
+		result = dd_add(dd_log(dd_abs(a)), LN2);
+		return (a.hi < 0) ? dd_neg(result) : result;
+	}
+
+	/* Otherwise, correct double precision result by single Newton
+	 * step. */
+	z = dd_pack(asinh(a.hi), 0);
+	return dd_add(z, dd_div(dd_sub(a, dd_sinh(z)), dd_cosh(z)));
+}
+
+static          DDouble
+dd_acosh(DDouble a)
+{
+	/* Handle not-a-number and infinite values. */
+	if (MATH_ISNAN(a.hi) || a.hi == MATH_INFINITY)
+		return a;
+
+	/* For large arguments, hyperbolic cosine is half of exponential. */
+	if (a.hi > 1e20)
+		return dd_add(dd_log(a), LN2);
+
+	/* Otherwise, subtract one from argument exactly. */
+	return dd_acosh1p(dd_add_double(a, -1));
+}
+
+static          DDouble
+dd_atanh(DDouble a)
+{
+	DDouble         z;	/* Approximate result. */
+	DDouble         t;	/* Hyperbolic tangent of approximate
+				 * result. */
+
+	/* For arguments not small, calculate inverse hyperbolic tangent
+	 * from logarithm. */
+	if (fabs(a.hi) >= 0.5)
+		return
+		    dd_scale(dd_log
+			     (dd_div
+			      (dd_add_double(a, 1),
+			       dd_add_double(dd_neg(a), 1))), 0.5);
+
+	/* Otherwise, correct double precision result by single Newton
+	 * step. */
+	z = dd_pack(atanh(a.hi), 0);
+	t = dd_tanh(z);
+	return dd_add(z,
+		      dd_div(dd_sub(a, t),
+			     dd_add_double(dd_neg(dd_sqr(t)), 1)));
+}
+
+static          DDouble
+dd_acoth(DDouble a)
+{
+	/* For arguments close to one, calculate inverse hyperbolic
+	 * cotangent from logarithm, to avoid rounding reciprocal value. */
+	if (fabs(a.hi) < 2)
+		return
+		    dd_scale(dd_log
+			     (dd_div
+			      (dd_add_double(a, 1), dd_add_double(a, -1))),
+			     0.5);
+
+	/* Otherwise, calculate inverse hyperbolic tangent of reciprocal
+	 * value. */
+	return dd_atanh(dd_recip(a));
+}
+
+static          DDouble
+dd_asech(DDouble a)
+{
+	/* For arguments close to one, calculate reciprocal value minus
+	 * one as (1-a)/a, to avoid rounding reciprocal value. */
+	if (a.hi >= 0.5)
+		return dd_acosh1p(dd_div(dd_add_double(dd_neg(a), 1), a));
+
+	/* Otherwise, calculate inverse hyperbolic cosine of reciprocal
+	 * value. */
+	return dd_acosh(dd_recip(a));
+}
+
+static          DDouble
+dd_acsch(DDouble a)
+{
+	/* Calculate inverse hyperbolic sine of reciprocal value. */
+	return dd_asinh(dd_recip(a));
+}
+
+static          DDouble
+dd_abs(DDouble a)
+{
+	/* Negate negative number. */
+	return (a.hi < 0) ? dd_neg(a) : a;
+}
+
+static          DDouble
+dd_step(DDouble a)
+{
+	/* Sign of number is sign of its leading part. */
+	return dd_pack(math_step(a.hi), 0);
+}
+
+static          DDouble
+dd_delta(DDouble a)
+{
+	/* Number is zero if its leading part is zero. */
+	return dd_pack(math_delta(a.hi), 0);
+}
+
+static          DDouble
+dd_nandelta(DDouble a)
+{
+	/* Number is zero if its leading part is zero. */
+	return dd_pack(math_nandelta(a.hi), 0);
+}
+
+static          DDouble
+dd_erf(DDouble a)
+{
+	DDouble         x;	/* Absolute value of argument. */
+	DDouble         x2;	/* Square of argument. */
+	DDouble         factor;	/* Series factor. */
+	DDouble         s;	/* Series sum. */
+	DDouble         term;	/* Series term. */
+	DDouble         result;	/* Error function of absolute value. */
+	double          previous;	/* Previous term magnitude. */
+	int             i;	/* Loop counter. */
+
+	/* Leave not-a-number values as they are. */
+	if (MATH_ISNAN(a.hi))
+		return a;
+	x = dd_abs(a);
+	x2 = dd_sqr(x);
+
+	if (x.hi < ERF_ASYMPTOTIC) {
+		/* Sum series erf(x) = 2/sqrt(pi) * exp(-x^2) * sum(2^n *
+		 * x^(2n+1) / (1*3*...*(2n+1))), with all terms positive. */
+		factor = dd_scale(x2, 2);
+		term = s = x;
+		for (i = 1;; i++) {
+			term =
+			    dd_div(dd_mul(term, factor),
+				   dd_pack(2 * i + 1, 0));
+			s = dd_add(s, term);
+			if (fabs(term.hi) <= EPSILON * fabs(s.hi))
+				break;
+		}
+		result =
+		    dd_mul(dd_mul(s, dd_exp(dd_neg(x2))), TWO_SQRTPI);
+	} else {
+		/* Sum asymptotic series erfc(x) = exp(-x^2) / (x *
+		 * sqrt(pi)) * sum((-1)^n * (2n-1)!! / (2x^2)^n), until
+		 * terms become negligible or start to grow, and subtract
+		 * it from one. */
+		factor = dd_recip(dd_scale(x2, 2));
+		term = s = dd_pack(1, 0);
+		previous = 1;
+		for (i = 1;; i++) {
+			term = dd_mul(term, dd_mul_double(factor, -(2 * i - 1)));
+			if (fabs(term.hi) <= EPSILON
+			    || fabs(term.hi) >= previous)
+				break;
+			s = dd_add(s, term);
+			previous = fabs(term.hi);
+		}
+		result =
+		    dd_add_double(dd_neg
+				  (dd_div
+				   (dd_mul
+				    (dd_mul(s, dd_exp(dd_neg(x2))),
+				     dd_scale(TWO_SQRTPI, 0.5)), x)), 1);
+	}
+
+	return (a.hi < 0) ? dd_neg(result) : result;
+}
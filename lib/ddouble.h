@@ -0,0 +1,63 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DDOUBLE_H
+#define DDOUBLE_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+
+/* Data structure representing double-double number, that is unevaluated 
+ * sum of two double precision numbers, second one being no larger than
+ * half unit in last place of first one, giving about 106 bits of
+ * precision.  */
+typedef struct {
+	double          hi;	/* Leading part. */
+	double          lo;	/* Trailing part. */
+} DDouble;
+
+/* Compile function represented by tree rooted at given node for
+ * evaluation in double-double arithmetic.  Further arguments are array
+ * of symbol table records of function variables and its length.
+ * Numbers are taken exactly as double precision values stored in tree,
+ * while predefined constants and functions are calculated in
+ * double-double precision.  Function returns pointer to compiled
+ * function.  */
+void           *ddouble_create(Node * root, Record ** records, int count);
+
+/* Destroy compiled function.  */
+void            ddouble_destroy(void *code);
+
+/* Calculate function values for batch of points, given by arrays of
+ * leading and trailing parts of variable values (ordered as records
+ * passed to ddouble_create(), each array of given length; array of
+ * trailing parts could be null pointer if all of them are zero), and
+ * store leading and trailing parts of results into given arrays (latter
+ * could be null pointer if not needed).  */
+void            ddouble_evaluate_batch(void *code, double **values,
+				       double **values_low, int length,
+				       double *results, double *results_low);
+
+#endif
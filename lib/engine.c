@@ -0,0 +1,95 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bytecode.h"
+#include "closure.h"
+#include "common.h"
+#include "compiler.h"
+#include "engine.h"
+#include "jit.h"
+#include "llvm.h"
+#include "matheval.h"
+
+Engine         *
+engine_create(int type, Node * root, Record ** records, int count)
+{
+	/* Compile function using engine of given type. */
+	switch (type) {
+	case EVALUATOR_ENGINE_JIT:
+		return jit_create(root, records, count);
+
+	case EVALUATOR_ENGINE_LLVM:
+		return llvm_create(root, records, count);
+
+	case EVALUATOR_ENGINE_C:
+		return compiler_create(root, records, count);
+
+	case EVALUATOR_ENGINE_BYTECODE:
+		return bytecode_create(root, records, count);
+
+	case EVALUATOR_ENGINE_CLOSURE:
+		return closure_create(root, records, count);
+	}
+
+	return NULL;
+}
+
+void
+engine_destroy(Engine * engine)
+{
+	/* Skip if engine not created. */
+	if (!engine)
+		return;
+
+	/* Destroy engine specific representation of compiled function, as 
+	 * well as data structure representing it. */
+	engine->destroy(engine->code);
+	XFREE(engine);
+}
+
+void
+engine_evaluate_batch(Engine * engine, double **values, int length,
+		      double *results)
+{
+	double         *point;	/* Variable values for single point. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Use batch support of engine, if available. */
+	if (engine->evaluate_batch) {
+		engine->evaluate_batch(engine->code, values, length,
+				       results);
+		return;
+	}
+
+	/* Otherwise, calculate function value point by point. */
+	point = XMALLOC(double, engine->count + 1);
+	for (j = 0; j < length; j++) {
+		for (i = 0; i < engine->count; i++)
+			point[i] = values[i][j];
+		results[j] = engine->evaluate(engine->code, point);
+	}
+	XFREE(point);
+}
@@ -0,0 +1,87 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+#include "symbol_table.h"
+
+/* Data structure representing function compiled by one of evaluator
+ * engines.  Compiled function reads variable values from array, with
+ * variables ordered same as array of symbol table records passed to
+ * engine when function compiled.  Member evaluate calculates function
+ * value for given array of variable values, while member
+ * evaluate_batch calculates function values for batch of points, given
+ * by array of arrays (each of given length) of variable values; latter
+ * is null pointer if engine has no batch support.  */
+typedef struct {
+	int             type;	/* Engine type (one of EVALUATOR_ENGINE_*
+				 * values).  */
+	int             count;	/* Number of function variables.  */
+	void           *code;	/* Engine specific representation of
+				 * compiled function.  */
+	double          (*evaluate) (void *code, double *values);
+	void            (*evaluate_batch) (void *code, double **values,
+					   int length, double *results);
+	void            (*destroy) (void *code);	/* Destroy compiled
+							 * function.  */
+	void           *scalar_code;	/* Machine code evaluating
+					 * function for single point, or
+					 * null pointer if not known.  */
+	size_t          scalar_size;	/* Size of above code.  */
+	void           *batch_code;	/* Machine code evaluating function
+					 * for batch of points, or null
+					 * pointer if not known.  */
+	size_t          batch_size;	/* Size of above code.  */
+} Engine;
+
+/* Compile function represented by tree rooted at given node using engine 
+ * of given type.  Further arguments are array of symbol table records
+ * of function variables and its length.  Function returns pointer to
+ * compiled function, or null pointer if engine not available.  */
+Engine         *engine_create(int type, Node * root, Record ** records,
+			      int count);
+
+/* Destroy compiled function.  */
+void            engine_destroy(Engine * engine);
+
+/* Calculate function values for batch of points, using batch support of
+ * engine if available, or calculating function value point by point
+ * otherwise.  Arguments are same as for evaluate_batch member above.  */
+void            engine_evaluate_batch(Engine * engine, double **values,
+				      int length, double *results);
+
+/* Get tree representation of function represented by given evaluator,
+ * array of symbol table records of its variables (ordered as names
+ * returned by evaluator_get_variables()) and its length.  Function
+ * returns compiled function used for evaluation, or null pointer if
+ * tree representation evaluated.  This function is defined in
+ * matheval.c, as it needs access to evaluator internals, and is used by
+ * benchmarks to time evaluation without evaluator_evaluate() overhead.  */
+Engine         *evaluator_get_internals(void *evaluator, Node ** root,
+					Record *** records, int *count);
+
+#endif
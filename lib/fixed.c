@@ -0,0 +1,636 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "approx.h"
+#include "common.h"
+#include "fixed.h"
+#include "matheval.h"
+#include "postfix.h"
+#include "xmath.h"
+
+/* Number of points evaluated at once.  */
+#define TILE 64
+
+/* Largest number of bits of word for which values of functions are
+ * tabulated for all possible arguments (so that each table has at most
+ * 65536 entries).  */
+#define TABLE_BITS 16
+
+/* Magnitude (2^62) of scaled values beyond which conversion from
+ * double precision reduces or saturates them before rounding.  */
+#define LIMIT 4611686018427387904.0
+
+/* Mask selecting rounding mode from flags.  */
+#define ROUNDING_MASK 3
+
+/* Data structure representing format of fixed-point numbers: number
+ * with given number of fraction bits is represented by integer equal to 
+ * its value multiplied by two raised to that number; integers are kept
+ * in 64 bits during evaluation, so that products of two words and words
+ * shifted by number of fraction bits are representable.  */
+typedef struct {
+	int             bits;	/* Number of bits of word. */
+	int             fraction;	/* Number of fraction bits of word. */
+	int             rounding;	/* Rounding mode. */
+	int             wrap;	/* Flag set if overflowing values are
+				 * wrapped around instead of saturated. */
+	long long       min;	/* Smallest value representable by word. */
+	long long       max;	/* Largest value representable by word. */
+	long long       one;	/* Fixed-point representation of one
+				 * (possibly not representable by word). */
+} Format;
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	Postfix        *postfix;	/* Postfix form of function. */
+	Format          format;	/* Format of numbers. */
+	long long      *numbers;	/* Fixed-point values of numbers and
+					 * constants, indexed by step. */
+	long long     **coefficients;	/* Fixed-point coefficients of
+					 * polynomials, indexed by step
+					 * (null pointer for other steps). 
+					 */
+	int           **tables;	/* Tables of function values for all
+				 * possible arguments, indexed by step (null 
+				 * pointer if not tabulated); steps calling
+				 * same function share table. */
+	long long      *stack;	/* Evaluation stack, consisting of
+				 * tile-sized vectors. */
+} Code;
+
+/* Evaluate compiled function for given number (at most tile size) of
+ * points starting at given offset into arrays of variable values, and
+ * leave function values in first vector of evaluation stack.  */
+static void     evaluate(Code * code, int **values, int offset,
+			 int length);
+
+/* Bring given integer into range of word, by saturation or wrapping
+ * around as selected for compiled function.  */
+static inline long long fixed_overflow(Format * format, long long value);
+
+/* Round quotient of division, given as floor of quotient, non-negative
+ * remainder, positive divisor and flag set if quotient negative,
+ * according to rounding mode of compiled function.  */
+static inline long long fixed_round(Format * format, long long quotient,
+				    long long remainder, long long divisor,
+				    int negative);
+
+/* Convert between double precision and fixed-point numbers.  */
+static long long fixed_from_double(Format * format, double value);
+static double   fixed_to_double(Format * format, long long value);
+
+/* Return sum, difference, product and quotient of fixed-point numbers
+ * and negated fixed-point number.  */
+static inline long long fixed_add(Format * format, long long a, long long b);
+static inline long long fixed_sub(Format * format, long long a, long long b);
+static inline long long fixed_mul(Format * format, long long a, long long b);
+static long long fixed_div(Format * format, long long a, long long b);
+static inline long long fixed_neg(Format * format, long long a);
+
+/* Return fixed-point number raised to integer power, calculated by
+ * repeated squaring.  */
+static long long fixed_powi(Format * format, long long a, int n);
+
+/* Calculate value of polynomial with given fixed-point coefficients
+ * (starting from constant term) and degree for fixed-point number, using 
+ * Horner scheme.  */
+static long long fixed_polynomial(Format * format, long long a,
+				  long long *coefficients, int degree);
+
+/* Return value of given function of one argument for fixed-point
+ * number, calculated in double precision and rounded to fixed-point.  */
+static long long fixed_function(Format * format,
+				double (*function) (double), long long a);
+
+void           *
+fixed_create(Node * root, Record ** records, int count, int bits,
+	     int fraction, int flags)
+{
+	Code           *code;	/* Compiled function. */
+	Node           *node;	/* Node evaluated by step. */
+	double          (*function) (double);	/* Function called by
+						 * step. */
+	int             size;	/* Number of entries of table. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Create postfix form of function, allocate memory for evaluation 
+	 * and remember word format. */
+	code = XMALLOC(Code, 1);
+	code->postfix = postfix_create(root, records, count);
+	code->numbers = XCALLOC(long long, code->postfix->length);
+	code->coefficients = XCALLOC(long long *, code->postfix->length);
+	code->tables = XCALLOC(int *, code->postfix->length);
+	code->stack = XMALLOC(long long, code->postfix->depth * TILE);
+	code->format.bits = bits;
+	code->format.fraction = fraction;
+	code->format.rounding = flags & ROUNDING_MASK;
+	code->format.wrap = (flags & EVALUATOR_FIXED_WRAP) != 0;
+	code->format.min = -(1LL << (bits - 1));
+	code->format.max = (1LL << (bits - 1)) - 1;
+	code->format.one = 1LL << fraction;
+
+	/* Convert numbers, constants and polynomial coefficients to
+	 * fixed-point, and tabulate values of called functions if word
+	 * narrow enough, sharing tables between calls of same function. */
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		switch (node->type) {
+		case 'n':
+			code->numbers[i] =
+			    fixed_from_double(&code->format,
+					      node->data.number);
+			break;
+
+		case 'c':
+			code->numbers[i] =
+			    fixed_from_double(&code->format,
+					      node->data.constant->data.
+					      value);
+			break;
+
+		case 'h':
+			code->coefficients[i] =
+			    XMALLOC(long long,
+				    node->data.polynomial.degree + 1);
+			for (j = 0; j <= node->data.polynomial.degree; j++)
+				code->coefficients[i][j] =
+				    fixed_from_double(&code->format,
+						      node->data.polynomial.
+						      coefficients[j]);
+			break;
+
+		case 'f':
+			if (bits > TABLE_BITS)
+				break;
+			function =
+			    node->data.function.record->data.function;
+			for (j = 0; j < i; j++)
+				if (code->tables[j]
+				    && code->postfix->steps[j].node->data.
+				    function.record->data.function ==
+				    function)
+					break;
+			function = approx_exact(function);
+			if (j < i) {
+				code->tables[i] = code->tables[j];
+				break;
+			}
+			size = 1 << bits;
+			code->tables[i] = XMALLOC(int, size);
+			for (j = 0; j < size; j++)
+				code->tables[i][j] =
+				    fixed_function(&code->format, function,
+						   code->format.min + j);
+			break;
+		}
+	}
+
+	return code;
+}
+
+void
+fixed_destroy(void *code)
+{
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Free coefficients of polynomials, tables (each shared table
+	 * once), postfix form, arrays used for evaluation and data
+	 * structure representing compiled function. */
+	if (!code)
+		return;
+	for (i = 0; i < ((Code *) code)->postfix->length; i++) {
+		XFREE(((Code *) code)->coefficients[i]);
+		for (j = 0; j < i; j++)
+			if (((Code *) code)->tables[j] ==
+			    ((Code *) code)->tables[i])
+				break;
+		if (j == i)
+			XFREE(((Code *) code)->tables[i]);
+	}
+	postfix_destroy(((Code *) code)->postfix);
+	XFREE(((Code *) code)->numbers);
+	XFREE(((Code *) code)->coefficients);
+	XFREE(((Code *) code)->tables);
+	XFREE(((Code *) code)->stack);
+	XFREE(code);
+}
+
+int
+fixed_convert(void *code, double value)
+{
+	/* Convert number using rounding and overflow behavior of compiled 
+	 * function. */
+	return fixed_from_double(&((Code *) code)->format, value);
+}
+
+void
+fixed_evaluate_batch(void *code, int **values, int length, int *results)
+{
+	int             offset;	/* Offset of tile. */
+	int             n;	/* Number of points in tile. */
+	int             j;	/* Loop counter. */
+
+	/* Evaluate function tile by tile, and store results. */
+	for (offset = 0; offset < length; offset += TILE) {
+		n = (length - offset < TILE) ? length - offset : TILE;
+		evaluate(code, values, offset, n);
+		for (j = 0; j < n; j++)
+			results[offset + j] = ((Code *) code)->stack[j];
+	}
+}
+
+static void
+evaluate(Code * code, int **values, int offset, int length)
+{
+	Format          format;	/* Format of numbers, copied so that it
+				 * is not reloaded after each store to
+				 * stack. */
+	long long      *stack;	/* Top vector of evaluation stack. */
+	Node           *node;	/* Node evaluated by step. */
+	int            *table;	/* Table of function values. */
+	double          (*function) (double);	/* Function called by
+						 * step. */
+	int            *x;	/* Variable values. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Evaluate steps in order, each of them replacing vectors of
+	 * values of its children on top of stack by vector of its own
+	 * values. */
+	format = code->format;
+	stack = code->stack - TILE;
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		switch (node->type) {
+		case 'n':
+		case 'c':
+			stack += TILE;
+			for (j = 0; j < length; j++)
+				stack[j] = code->numbers[i];
+			break;
+
+		case 'v':
+			/* Variable values outside of range of word are
+			 * treated as overflow. */
+			stack += TILE;
+			x = values[code->postfix->steps[i].index] + offset;
+			for (j = 0; j < length; j++)
+				stack[j] = fixed_overflow(&format, x[j]);
+			break;
+
+		case 'f':
+			/* Function is called exactly, even if
+			 * approximation selected for evaluator. */
+			function =
+			    approx_exact(node->data.function.record->data.
+					 function);
+			if ((table = code->tables[i]))
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    table[stack[j] - format.min];
+			else
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_function(&format, function,
+							   stack[j]);
+			break;
+
+		case 'u':
+			for (j = 0; j < length; j++)
+				stack[j] = fixed_neg(&format, stack[j]);
+			break;
+
+		case 'b':
+			stack -= TILE;
+			switch (node->data.bin_op.operation) {
+			case '+':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_add(&format, stack[j],
+						      stack[TILE + j]);
+				break;
+
+			case '-':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_sub(&format, stack[j],
+						      stack[TILE + j]);
+				break;
+
+			case '*':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_mul(&format, stack[j],
+						      stack[TILE + j]);
+				break;
+
+			case '/':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_div(&format, stack[j],
+						      stack[TILE + j]);
+				break;
+
+			case '^':
+				/* Power with exponent not known to be
+				 * integer is calculated in double
+				 * precision. */
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_from_double(&format,
+							      math_pow
+							      (fixed_to_double
+							       (&format,
+								stack[j]),
+							       fixed_to_double
+							       (&format,
+								stack[TILE +
+								      j])));
+				break;
+			}
+			break;
+
+		case 'p':
+			/* Squares, that are most common, are calculated
+			 * without call. */
+			if (node->data.power.exponent == 2)
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_mul(&format, stack[j],
+						      stack[j]);
+			else
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    fixed_powi(&format, stack[j],
+						       node->data.power.
+						       exponent);
+			break;
+
+		case 'h':
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    fixed_polynomial(&format, stack[j],
+						     code->coefficients[i],
+						     node->data.polynomial.
+						     degree);
+			break;
+
+		case 'm':
+			stack -= 2 * TILE;
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    fixed_add(&format,
+					      fixed_mul(&format, stack[j],
+							stack[TILE + j]),
+					      stack[2 * TILE + j]);
+			break;
+		}
+	}
+}
+
+static inline long long
+fixed_overflow(Format * format, long long value)
+{
+	/* Clamp value to range of word, or keep its lowest bits and
+	 * extend sign (calculating in unsigned arithmetic, where
+	 * wrapping around is well defined). */
+	if (value >= format->min && value <= format->max)
+		return value;
+	if (!format->wrap)
+		return (value < format->min) ? format->min : format->max;
+	return (long long) (((unsigned long long) value -
+			     (unsigned long long) format->min) &
+			    ((1ULL << format->bits) - 1)) + format->min;
+}
+
+static inline long long
+fixed_round(Format * format, long long quotient, long long remainder,
+	    long long divisor, int negative)
+{
+	/* Floor of quotient is result of rounding down; otherwise, step
+	 * up if remainder non-zero for rounding toward zero of negative
+	 * quotient, if remainder at least half of divisor for rounding to 
+	 * nearest, and if remainder greater than half of divisor, or
+	 * equal to it with odd floor of quotient, for rounding to nearest
+	 * even (conditions combined without branches, that are hard to
+	 * predict). */
+	switch (format->rounding) {
+	case EVALUATOR_FIXED_ROUND_ZERO:
+		return quotient + (negative & (remainder != 0));
+
+	case EVALUATOR_FIXED_ROUND_NEAREST:
+		return quotient + (2 * remainder >= divisor);
+
+	case EVALUATOR_FIXED_ROUND_EVEN:
+		return quotient + ((2 * remainder > divisor) |
+				   ((2 * remainder == divisor) & quotient &
+				    1));
+
+	default:
+		return quotient;
+	}
+}
+
+static long long
+fixed_from_double(Format * format, double value)
+{
+	double          x;	/* Value multiplied by two raised to
+				 * number of fraction bits. */
+	double          floor_x;	/* Floor of above value. */
+	double          rest;	/* Difference of value and its floor. */
+	long long       result;	/* Rounded value. */
+
+	/* Not-a-number is converted to zero and infinities to limits of
+	 * range of word. */
+	if (MATH_ISNAN(value))
+		return 0;
+	if (value == MATH_INFINITY || value == -MATH_INFINITY)
+		return (value > 0) ? format->max : format->min;
+
+	/* Scale value (exactly, as by power of two), and bring values far 
+	 * out of range into range of 64-bit integers (reducing them
+	 * modulo two raised to number of bits of word, that is exact as
+	 * well, if wrapping around). */
+	x = ldexp(value, format->fraction);
+	if (fabs(x) >= LIMIT) {
+		if (!format->wrap)
+			return (x > 0) ? format->max : format->min;
+		x = fmod(x, ldexp(1, format->bits));
+	}
+
+	/* Round scaled value to integer, as for quotient with remainder
+	 * (difference of value and its floor is exact), and handle
+	 * overflow. */
+	floor_x = floor(x);
+	rest = x - floor_x;
+	result = (long long) floor_x;
+	switch (format->rounding) {
+	case EVALUATOR_FIXED_ROUND_ZERO:
+		result += (x < 0 && rest != 0);
+		break;
+
+	case EVALUATOR_FIXED_ROUND_NEAREST:
+		result += (rest >= 0.5);
+		break;
+
+	case EVALUATOR_FIXED_ROUND_EVEN:
+		result += (rest > 0.5 || (rest == 0.5 && (result & 1)));
+		break;
+	}
+	return fixed_overflow(format, result);
+}
+
+static double
+fixed_to_double(Format * format, long long value)
+{
+	/* Conversion is exact, as word has at most 32 bits. */
+	return ldexp((double) value, -format->fraction);
+}
+
+static inline long long
+fixed_add(Format * format, long long a, long long b)
+{
+	/* Sum is exact before overflow handling. */
+	return fixed_overflow(format, a + b);
+}
+
+static inline long long
+fixed_sub(Format * format, long long a, long long b)
+{
+	/* Difference is exact before overflow handling. */
+	return fixed_overflow(format, a - b);
+}
+
+static inline long long
+fixed_mul(Format * format, long long a, long long b)
+{
+	long long       product;	/* Exact product. */
+
+	/* Calculate exact product (of at most 62 bits), drop fraction
+	 * bits of one factor with rounding (arithmetic shift giving floor 
+	 * of quotient), and handle overflow. */
+	product = a * b;
+	return fixed_overflow(format,
+			      fixed_round(format, product >> format->fraction,
+					  product & (format->one - 1),
+					  format->one, product < 0));
+}
+
+static long long
+fixed_div(Format * format, long long a, long long b)
+{
+	long long       dividend;	/* Dividend shifted by number of
+					 * fraction bits. */
+	long long       quotient;	/* Floor of quotient. */
+	long long       remainder;	/* Non-negative remainder. */
+
+	/* Division by zero gives limit of range of word with sign of
+	 * dividend, or zero for zero dividend. */
+	if (b == 0)
+		return (a > 0) ? format->max : (a < 0) ? format->min : 0;
+
+	/* Shift dividend (to at most 62 bits) and make divisor positive,
+	 * calculate floor of quotient and non-negative remainder from
+	 * truncated ones, round quotient and handle overflow. */
+	dividend = a * format->one;
+	if (b < 0) {
+		dividend = -dividend;
+		b = -b;
+	}
+	quotient = dividend / b;
+	remainder = dividend % b;
+	if (remainder < 0) {
+		quotient--;
+		remainder += b;
+	}
+	return fixed_overflow(format,
+			      fixed_round(format, quotient, remainder, b,
+					  dividend < 0));
+}
+
+static inline long long
+fixed_neg(Format * format, long long a)
+{
+	/* Negation overflows for smallest value of word only. */
+	return fixed_overflow(format, -a);
+}
+
+static long long
+fixed_powi(Format * format, long long a, int n)
+{
+	long long       result;	/* Accumulated power. */
+	int             first;	/* Flag set until first factor
+				 * multiplied into result. */
+	unsigned        m;	/* Absolute value of exponent. */
+
+	/* Multiply together squares of number corresponding to bits set
+	 * in absolute value of exponent, as math_powi() does, with first
+	 * factor taken as is instead of multiplied by one (that may be
+	 * not representable), and divide one by result for negative
+	 * exponent. */
+	if (n == 0)
+		return fixed_overflow(format, format->one);
+	m = (n < 0) ? -(unsigned) n : (unsigned) n;
+	result = 0;
+	for (first = TRUE; m; m >>= 1) {
+		if (m & 1) {
+			result = first ? a : fixed_mul(format, result, a);
+			first = FALSE;
+		}
+		if (m > 1)
+			a = fixed_mul(format, a, a);
+	}
+	return (n < 0) ? fixed_div(format, format->one, result) : result;
+}
+
+static long long
+fixed_polynomial(Format * format, long long a, long long *coefficients,
+		 int degree)
+{
+	long long       result;	/* Accumulated polynomial value. */
+	int             i;	/* Loop counter. */
+
+	/* Calculate polynomial value by nested multiplication, rounding
+	 * each product. */
+	result = coefficients[degree];
+	for (i = degree - 1; i >= 0; i--)
+		result =
+		    fixed_add(format, fixed_mul(format, result, a),
+			      coefficients[i]);
+	return result;
+}
+
+static long long
+fixed_function(Format * format, double (*function) (double), long long a)
+{
+	/* Argument is converted exactly, and function value rounded
+	 * according to rounding mode of compiled function. */
+	return fixed_from_double(format,
+				 function(fixed_to_double(format, a)));
+}
@@ -0,0 +1,55 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FIXED_H
+#define FIXED_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+
+/* Compile function represented by tree rooted at given node for
+ * evaluation in fixed-point arithmetic.  Further arguments are array of
+ * symbol table records of function variables and its length, as well as 
+ * number of bits of word (at most 32), number of fraction bits of word
+ * (less than 32) and flags selecting rounding and overflow behavior (as
+ * passed to evaluator_set_fixed()).  Function returns pointer to
+ * compiled function.  */
+void           *fixed_create(Node * root, Record ** records, int count,
+			     int bits, int fraction, int flags);
+
+/* Destroy compiled function.  */
+void            fixed_destroy(void *code);
+
+/* Convert given number to fixed-point format of compiled function.  */
+int             fixed_convert(void *code, double value);
+
+/* Calculate function values for batch of points, given by arrays of
+ * fixed-point variable values (ordered as records passed to
+ * fixed_create(), each array of given length), and store fixed-point
+ * results into given array.  */
+void            fixed_evaluate_batch(void *code, int **values, int length,
+				     int *results);
+
+#endif
@@ -59,6 +59,30 @@ evaluator_create__(char *string, int length)
 	return evaluator;
 }
 
+/* Wrapper for evaluator_create_flags() function.  */
+int64_t
+evaluator_create_flags__(char *string, int *flags, int length)
+{
+	char           *stringz;	/* Zero-terminated string
+					 * representing function.  */
+	int64_t         evaluator;	/* Evaluator created for function. 
+					 */
+
+	/* Copy string passed from Fortran code and terminate it with
+	 * zero. */
+	stringz = XMALLOC(char, length + 1);
+	memcpy(stringz, string, length * sizeof(char));
+	stringz[length] = '\0';
+
+	/* Call evaluator_create_flags() function. */
+	evaluator = (int64_t) evaluator_create_flags(stringz, *flags);
+
+	/* Free string used to create evaluator. */
+	XFREE(stringz);
+
+	return evaluator;
+}
+
 /* Wrapper for evaluator_destroy() function.  */
 void
 evaluator_destroy__(int64_t * evaluator)
@@ -206,6 +230,74 @@ evaluator_derivative__(int64_t * evaluator, char *name, int length)
 	return derivative;
 }
 
+/* Wrapper for evaluator_specialize() function.  */
+int64_t
+evaluator_specialize__(int64_t * evaluator, int *count, char *names,
+		       double *values, int length)
+{
+	char          **names_copy;	/* Copy of variable names.  Names
+					 * are passed in single string
+					 * from Fortran code, delimited by 
+					 * blanks, while
+					 * evaluator_specialize() function
+					 * expects array of strings.  */
+	int64_t         specialization;	/* Evaluator for specialized
+					 * function.  */
+	int             i,
+	                j,
+	                n;	/* Loop counters.  */
+
+	/* Parse string containing variable names and create array of
+	 * strings with each string containing single name. */
+	names_copy = XMALLOC(char *, *count);
+	for (i = j = 0; i < *count && j < length; i++, j += n) {
+		for (; names[j] == ' '; j++);
+		for (n = 1; j + n < length && !(names[j + n] == ' '); n++);
+		names_copy[i] = XMALLOC(char, n + 1);
+		memcpy(names_copy[i], names + j, n * sizeof(char));
+		names_copy[i][n] = '\0';
+	}
+
+	/* Call evaluator_specialize() function. */
+	specialization =
+	    (int64_t) evaluator_specialize((void *) *evaluator, *count,
+					   names_copy, values);
+
+	/* Free memory used. */
+	for (i = 0; i < *count; i++)
+		XFREE(names_copy[i]);
+	XFREE(names_copy);
+
+	return specialization;
+}
+
+/* Wrapper for evaluator_substitute() function.  */
+int64_t
+evaluator_substitute__(int64_t * evaluator, char *name,
+		       int64_t * replacement, int length)
+{
+	char           *stringz;	/* Zero terminated string
+					 * containing variable name.  */
+	int64_t         composition;	/* Evaluator for composite
+					 * function.  */
+
+	/* Copy variable name passed from Fortran code and terminate it
+	 * with zero. */
+	stringz = XMALLOC(char, length + 1);
+	memcpy(stringz, name, length * sizeof(char));
+	stringz[length] = '\0';
+
+	/* Call evaluator_substitute() function. */
+	composition =
+	    (int64_t) evaluator_substitute((void *) *evaluator, stringz,
+					   (void *) *replacement);
+
+	/* Free string containing variable name. */
+	XFREE(stringz);
+
+	return composition;
+}
+
 /* Wrapper for evaluator_evaluate_x() function.  */
 double
 evaluator_evaluate_x__(int64_t * evaluator, double *x)
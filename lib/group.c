@@ -0,0 +1,562 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include "common.h"
+#include "group.h"
+#include "isa.h"
+#include "xmath.h"
+
+/* Length of group symbol table.  */
+#define TABLE_LENGTH 211
+
+/* Number of functions evaluated at once, that is number of vector lanes
+ * (64 bytes, that is one AVX-512, two AVX or four SSE registers).  */
+#define LANES 8
+
+/* Loop over vector lanes; loops with this fixed number of iterations
+ * are vectorized by compiler.  */
+#define LANEWISE(statement) \
+	for (l = 0; l < LANES; l++) \
+		statement
+
+/* Instruction opcodes.  Program is executed on stack of vectors, each
+ * holding values of subexpression for all lanes.  */
+enum {
+	OP_VARIABLE, OP_CONSTANT, OP_NEG, OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+	OP_POW, OP_CALL, OP_POWI, OP_POLYNOMIAL, OP_FMA
+};
+
+/* Data structure representing instruction.  Operands differing between 
+ * functions are stored for each lane of each block of functions.  */
+typedef struct {
+	int             opcode;	/* Instruction opcode. */
+	double        **variables;	/* Pointers to variable values. */
+	double         *constants;	/* Constants, or polynomial
+					 * coefficients (degree plus one
+					 * per lane). */
+	double          (*function) (double);	/* Called function. */
+	int             exponent;	/* Integer exponent or polynomial
+					 * degree. */
+} Instruction;
+
+/* Data structure representing partition of functions of same
+ * structure.  */
+typedef struct {
+	unsigned long   hash;	/* Hash value of functions structure. */
+	Node           *root;	/* Tree of first function (used during
+				 * group creation only). */
+	int            *functions;	/* Indices of functions. */
+	int             count;	/* Number of functions. */
+	int             capacity;	/* Capacity of functions array. */
+	int             blocks;	/* Number of blocks of LANES functions 
+				 * (last one padded by repeating last
+				 * function). */
+	Instruction    *instructions;	/* Program. */
+	int             length;	/* Number of instructions. */
+	int             allocated;	/* Capacity of instructions array. */
+	int             depth;	/* Stack depth during generation. */
+	int             max_depth;	/* Stack depth needed. */
+} Partition;
+
+/* Data structure representing group of functions.  */
+struct _Group {
+	SymbolTable    *symbol_table;	/* Variables of all functions. */
+	Partition      *partitions;	/* Partitions of functions. */
+	int             count;	/* Number of partitions. */
+	int             isa;	/* Execution kernel variant. */
+	double         *stack;	/* Stack used by programs. */
+};
+
+/* Generate instructions calculating values of subtrees rooted at given
+ * nodes (corresponding nodes of functions of partition, for each lane of 
+ * each block).  */
+static void     generate(Group * group, Partition * partition,
+			 Node ** nodes);
+
+/* Append instruction with given opcode and stack effect to program of
+ * partition, and return pointer to it.  */
+static Instruction *emit(Partition * partition, int opcode, int effect);
+
+/* Execute program of each partition, with stack given.  Function is
+ * inlined into kernel variants below, each compiled for different
+ * instruction set.  */
+static inline void execute(Group * group, double *stack,
+			   double *results)
+#if defined __GNUC__
+    __attribute__ ((always_inline))
+#endif
+;
+
+/* Kernel variants. */
+static void     execute_generic(Group * group, double *stack,
+				double *results);
+#if ISA_DISPATCH
+static void     execute_sse42(Group * group, double *stack,
+			      double *results) ISA_TARGET("sse4.2");
+static void     execute_avx2(Group * group, double *stack,
+			     double *results) ISA_TARGET("avx2");
+static void     execute_avx512f(Group * group, double *stack,
+				double *results) ISA_TARGET("avx512f");
+#endif
+
+/* Kernel variants, indexed by instruction set variant.  */
+static void     (*kernels[]) (Group *, double *, double *) = {
+#if ISA_DISPATCH
+	execute_avx512f, execute_avx2, execute_sse42,
+#endif
+	execute_generic
+};
+
+Group          *
+group_create(Node ** roots, int count)
+{
+	Group          *group;	/* Group created. */
+	Partition      *partition;	/* Current partition. */
+	unsigned long   hash;	/* Hash value of function structure. */
+	Node          **nodes;	/* Roots of functions in lanes. */
+	int             depth;	/* Stack depth needed. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Create group data structure. */
+	group = XMALLOC(Group, 1);
+	group->symbol_table = symbol_table_create(TABLE_LENGTH);
+	group->partitions = XMALLOC(Partition, count + 1);
+	group->count = 0;
+	group->isa = isa_select();
+
+	/* Assign each function to partition of functions of same
+	 * structure, creating new partition if none found. */
+	for (i = 0; i < count; i++) {
+		hash = node_hash(roots[i]);
+		for (j = 0; j < group->count; j++)
+			if (group->partitions[j].hash == hash
+			    && node_same_shape(group->partitions[j].root,
+					       roots[i]))
+				break;
+		partition = &group->partitions[j];
+		if (j == group->count) {
+			group->count++;
+			partition->hash = hash;
+			partition->root = roots[i];
+			partition->count = 0;
+			partition->capacity = 8;
+			partition->functions =
+			    XMALLOC(int, partition->capacity);
+		}
+		if (partition->count == partition->capacity) {
+			partition->capacity *= 2;
+			partition->functions =
+			    XREALLOC(int, partition->functions,
+				     partition->capacity);
+		}
+		partition->functions[partition->count++] = i;
+	}
+
+	/* Generate program of each partition, from roots of its
+	 * functions in block lanes, and find stack depth needed. */
+	depth = 1;
+	for (i = 0; i < group->count; i++) {
+		partition = &group->partitions[i];
+		partition->blocks = (partition->count + LANES - 1) / LANES;
+		nodes = XMALLOC(Node *, partition->blocks * LANES);
+		for (j = 0; j < partition->blocks * LANES; j++)
+			nodes[j] =
+			    roots[partition->
+				  functions[(j <
+					     partition->count) ? j :
+					    partition->count - 1]];
+		partition->allocated = 16;
+		partition->instructions =
+		    XMALLOC(Instruction, partition->allocated);
+		partition->length = 0;
+		partition->depth = partition->max_depth = 0;
+		generate(group, partition, nodes);
+		XFREE(nodes);
+		partition->root = NULL;
+		if (partition->max_depth > depth)
+			depth = partition->max_depth;
+	}
+	group->stack = XMALLOC(double, depth * LANES);
+
+	return group;
+}
+
+void
+group_destroy(Group * group)
+{
+	Instruction    *instruction;	/* Current instruction. */
+	int             i;	/* Loop counter. */
+
+	/* Free programs and function indices of partitions, then group
+	 * data structures. */
+	for (i = 0; i < group->count; i++) {
+		for (instruction = group->partitions[i].instructions;
+		     instruction <
+		     group->partitions[i].instructions +
+		     group->partitions[i].length; instruction++) {
+			XFREE(instruction->variables);
+			XFREE(instruction->constants);
+		}
+		XFREE(group->partitions[i].instructions);
+		XFREE(group->partitions[i].functions);
+	}
+	XFREE(group->partitions);
+	XFREE(group->stack);
+	symbol_table_destroy(group->symbol_table);
+	XFREE(group);
+}
+
+void
+group_evaluate(Group * group, int count, char **names, double *values,
+	       double *results)
+{
+	Record         *record;	/* Symbol table record corresponding to
+				 * given variable name.  */
+	int             i;	/* Loop counter. */
+
+	/* Assign values to symbol table records corresponding to variable 
+	 * names. */
+	for (i = 0; i < count; i++) {
+		record = symbol_table_lookup(group->symbol_table, names[i]);
+		if (record && record->type == 'v')
+			record->data.value = values[i];
+	}
+
+	/* Execute programs. */
+	kernels[group->isa] (group, group->stack, results);
+}
+
+int
+group_get_partition_count(Group * group)
+{
+	/* Return number of partitions. */
+	return group->count;
+}
+
+static void
+generate(Group * group, Partition * partition, Node ** nodes)
+{
+	Instruction    *instruction;	/* Instruction emitted. */
+	Node          **children;	/* Child nodes. */
+	int             lanes;	/* Number of lanes of all blocks. */
+	int             degree;	/* Polynomial degree. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* According to node type, generate instructions calculating
+	 * values of children, then instruction for node itself; nodes of
+	 * all lanes have same type, so first one is examined. */
+	lanes = partition->blocks * LANES;
+	children = XMALLOC(Node *, lanes);
+	switch (nodes[0]->type) {
+	case 'n':
+	case 'c':
+		/* Numbers and constants are pushed from constants of each 
+		 * lane. */
+		instruction = emit(partition, OP_CONSTANT, 1);
+		instruction->constants = XMALLOC(double, lanes);
+		for (j = 0; j < lanes; j++)
+			instruction->constants[j] =
+			    (nodes[j]->type ==
+			     'n') ? nodes[j]->data.number : nodes[j]->data.
+			    constant->data.value;
+		break;
+
+	case 'v':
+		/* Variables are pushed from values of group symbol table
+		 * records. */
+		instruction = emit(partition, OP_VARIABLE, 1);
+		instruction->variables = XMALLOC(double *, lanes);
+		for (j = 0; j < lanes; j++)
+			instruction->variables[j] =
+			    &symbol_table_insert(group->symbol_table,
+						 nodes[j]->data.variable->
+						 name, 'v')->data.value;
+		break;
+
+	case 'f':
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.function.child;
+		generate(group, partition, children);
+		emit(partition, OP_CALL, 0)->function =
+		    nodes[0]->data.function.record->data.function;
+		break;
+
+	case 'u':
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.un_op.child;
+		generate(group, partition, children);
+		emit(partition, OP_NEG, 0);
+		break;
+
+	case 'b':
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.bin_op.left;
+		generate(group, partition, children);
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.bin_op.right;
+		generate(group, partition, children);
+		switch (nodes[0]->data.bin_op.operation) {
+		case '+':
+			emit(partition, OP_ADD, -1);
+			break;
+
+		case '-':
+			emit(partition, OP_SUB, -1);
+			break;
+
+		case '*':
+			emit(partition, OP_MUL, -1);
+			break;
+
+		case '/':
+			emit(partition, OP_DIV, -1);
+			break;
+
+		case '^':
+			emit(partition, OP_POW, -1);
+			break;
+		}
+		break;
+
+	case 'p':
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.power.child;
+		generate(group, partition, children);
+		emit(partition, OP_POWI, 0)->exponent =
+		    nodes[0]->data.power.exponent;
+		break;
+
+	case 'h':
+		/* Coefficients are copied for each lane. */
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.polynomial.child;
+		generate(group, partition, children);
+		degree = nodes[0]->data.polynomial.degree;
+		instruction = emit(partition, OP_POLYNOMIAL, 0);
+		instruction->exponent = degree;
+		instruction->constants =
+		    XMALLOC(double, (size_t) lanes * (degree + 1));
+		for (j = 0; j < lanes; j++)
+			for (i = 0; i <= degree; i++)
+				instruction->constants[j * (degree + 1) +
+						       i] =
+				    nodes[j]->data.polynomial.
+				    coefficients[i];
+		break;
+
+	case 'm':
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.muladd.left;
+		generate(group, partition, children);
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.muladd.right;
+		generate(group, partition, children);
+		for (j = 0; j < lanes; j++)
+			children[j] = nodes[j]->data.muladd.addend;
+		generate(group, partition, children);
+		emit(partition, OP_FMA, -2);
+		break;
+	}
+	XFREE(children);
+}
+
+static Instruction *
+emit(Partition * partition, int opcode, int effect)
+{
+	Instruction    *instruction;	/* Instruction appended. */
+
+	/* Grow instructions array if needed, and append instruction. */
+	if (partition->length == partition->allocated) {
+		partition->allocated *= 2;
+		partition->instructions =
+		    XREALLOC(Instruction, partition->instructions,
+			     partition->allocated);
+	}
+	instruction = &partition->instructions[partition->length++];
+	memset(instruction, 0, sizeof(Instruction));
+	instruction->opcode = opcode;
+
+	/* Track stack depth. */
+	partition->depth += effect;
+	if (partition->depth > partition->max_depth)
+		partition->max_depth = partition->depth;
+	return instruction;
+}
+
+static inline void
+execute(Group * group, double *stack, double *results)
+{
+#if defined __clang__
+#pragma clang fp contract(off)
+#endif
+	Partition      *partition;	/* Current partition. */
+	Instruction    *instruction;	/* Current instruction. */
+	double          (*top)[LANES];	/* Top of stack. */
+	double        **variables;	/* Variable pointers of block. */
+	double         *constants;	/* Constants of block. */
+	int             block;	/* Current block. */
+	int             i,
+	                l;	/* Loop counters. */
+
+	/* Execute program of each partition for each block of its
+	 * functions, with each instruction operating on all lanes. */
+	for (partition = group->partitions;
+	     partition < group->partitions + group->count; partition++)
+		for (block = 0; block < partition->blocks; block++) {
+			top = (double (*)[LANES]) stack - 1;
+			for (instruction = partition->instructions;
+			     instruction <
+			     partition->instructions + partition->length;
+			     instruction++)
+				switch (instruction->opcode) {
+				case OP_VARIABLE:
+					variables =
+					    instruction->variables +
+					    block * LANES;
+					top++;
+					LANEWISE((*top)[l] = *variables[l]);
+					break;
+
+				case OP_CONSTANT:
+					constants =
+					    instruction->constants +
+					    block * LANES;
+					top++;
+					LANEWISE((*top)[l] = constants[l]);
+					break;
+
+				case OP_NEG:
+					LANEWISE((*top)[l] = -(*top)[l]);
+					break;
+
+				case OP_ADD:
+					top--;
+					LANEWISE((*top)[l] =
+						 (*top)[l] + top[1][l]);
+					break;
+
+				case OP_SUB:
+					top--;
+					LANEWISE((*top)[l] =
+						 (*top)[l] - top[1][l]);
+					break;
+
+				case OP_MUL:
+					top--;
+					LANEWISE((*top)[l] =
+						 (*top)[l] * top[1][l]);
+					break;
+
+				case OP_DIV:
+					top--;
+					LANEWISE((*top)[l] =
+						 (*top)[l] / top[1][l]);
+					break;
+
+				case OP_POW:
+					top--;
+					LANEWISE((*top)[l] =
+						 math_pow((*top)[l],
+							  top[1][l]));
+					break;
+
+				case OP_CALL:
+					LANEWISE((*top)[l] =
+						 instruction->
+						 function((*top)[l]));
+					break;
+
+				case OP_POWI:
+					LANEWISE((*top)[l] =
+						 math_powi((*top)[l],
+							   instruction->
+							   exponent));
+					break;
+
+				case OP_POLYNOMIAL:
+					i = instruction->exponent + 1;
+					constants =
+					    instruction->constants +
+					    (size_t) block *LANES * i;
+					LANEWISE((*top)[l] =
+						 math_polynomial((*top)[l],
+								 constants +
+								 l * i,
+								 instruction->
+								 exponent));
+					break;
+
+				case OP_FMA:
+					top -= 2;
+					LANEWISE((*top)[l] =
+						 fma((*top)[l], top[1][l],
+						     top[2][l]));
+					break;
+				}
+
+			/* Store values of functions in block, skipping
+			 * padding lanes. */
+			for (l = 0;
+			     l < LANES
+			     && block * LANES + l < partition->count; l++)
+				results[partition->
+					functions[block * LANES + l]] =
+				    (*top)[l];
+		}
+}
+
+static void
+execute_generic(Group * group, double *stack, double *results)
+{
+	/* Execute programs using baseline instruction set. */
+	execute(group, stack, results);
+}
+
+#if ISA_DISPATCH
+static void
+execute_sse42(Group * group, double *stack, double *results)
+{
+	/* Execute programs using SSE4.2 instructions. */
+	execute(group, stack, results);
+}
+
+static void
+execute_avx2(Group * group, double *stack, double *results)
+{
+	/* Execute programs using AVX2 instructions. */
+	execute(group, stack, results);
+}
+
+static void
+execute_avx512f(Group * group, double *stack, double *results)
+{
+	/* Execute programs using AVX-512 foundation instructions. */
+	execute(group, stack, results);
+}
+#endif
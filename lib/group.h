@@ -0,0 +1,61 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef GROUP_H
+#define GROUP_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+#include "symbol_table.h"
+
+/* Data structure representing group of functions evaluated together.  */
+typedef struct _Group Group;
+
+/* Create group of functions represented by trees rooted at given nodes
+ * (array of given length), evaluated together for same variable
+ * values.  Functions are partitioned by structure, ignoring numbers and
+ * variable names, and functions of each partition are packed into
+ * single program executed for several functions at once, with constants 
+ * and variables of each function in own vector lane.  Variables of all
+ * functions are kept in group symbol table, matched by name.  Trees are
+ * not referenced after function returns.  Function returns pointer to
+ * group created.  */
+Group          *group_create(Node ** roots, int count);
+
+/* Destroy group.  */
+void            group_destroy(Group * group);
+
+/* Calculate values of functions of group and store them into given
+ * array, in order of functions when group created.  Further arguments
+ * are number of variables, and arrays of their names and values; values
+ * of variables not given are kept from previous evaluation (initially
+ * zero).  */
+void            group_evaluate(Group * group, int count, char **names,
+			       double *values, double *results);
+
+/* Return number of partitions of functions of group.  */
+int             group_get_partition_count(Group * group);
+
+#endif
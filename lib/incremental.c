@@ -0,0 +1,356 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <limits.h>
+#include <string.h>
+#include "common.h"
+#include "incremental.h"
+#include "postfix.h"
+#include "xmath.h"
+
+/* Number of bits of word of sets of variables.  */
+#define WORD_BITS (CHAR_BIT * sizeof(unsigned long))
+
+/* Data structure representing function prepared for incremental
+ * evaluation: each step of postfix form keeps its value, and for each
+ * variable steps depending on it are listed, so that only these are
+ * recalculated when variable value changes.  */
+typedef struct {
+	Postfix        *postfix;	/* Postfix form of function. */
+	Record        **records;	/* Symbol table records of
+					 * variables. */
+	int             count;	/* Number of variables. */
+	int            *operands;	/* Indices of steps calculating
+					 * operands, three per step. */
+	double         *results;	/* Values calculated by steps. */
+	double         *values;	/* Variable values used by previous
+				 * evaluation. */
+	int            *starts;	/* Offsets of lists of dependent steps 
+				 * of each variable (one more than number of
+				 * variables). */
+	int            *dependents;	/* Concatenated lists of steps
+					 * depending on each variable, in
+					 * order of evaluation. */
+	int            *changed;	/* Indices of variables which values 
+					 * changed. */
+	char           *dirty;	/* Flags set for steps to be
+				 * recalculated. */
+	int             evaluated;	/* Flag set if all steps evaluated 
+					 * at least once. */
+} Code;
+
+/* Return number of operands of node.  */
+static int      arity(Node * node);
+
+/* Calculate value of given step from values of its operands.  */
+static inline void calculate(Code * code, int step);
+
+void           *
+incremental_create(Node * root, Record ** records, int count)
+{
+	Code           *code;	/* Prepared function. */
+	int            *stack;	/* Indices of steps which values are on
+				 * evaluation stack. */
+	int             top;	/* Number of values on stack. */
+	unsigned long  *sets;	/* Sets of variables each step depends
+				 * on, as bit sets of given number of
+				 * words. */
+	int             words;	/* Number of words of set of variables. */
+	int            *positions;	/* Positions in lists of dependent
+					 * steps to be filled next. */
+	int             length;	/* Number of steps. */
+	int             n;	/* Number of operands of step. */
+	int             i,
+	                j,
+	                k;	/* Loop counters. */
+
+	/* Create postfix form of function. */
+	code = XMALLOC(Code, 1);
+	code->postfix = postfix_create(root, records, count);
+	code->records = records;
+	code->count = count;
+	length = code->postfix->length;
+
+	/* Simulate evaluation stack to find steps calculating operands of
+	 * each step, and collect set of variables each step depends on as
+	 * union of sets of its operands. */
+	words = (count + WORD_BITS - 1) / WORD_BITS;
+	sets = XCALLOC(unsigned long, length * words + 1);
+	code->operands = XCALLOC(int, 3 * length);
+	stack = XMALLOC(int, code->postfix->depth + 1);
+	top = 0;
+	for (i = 0; i < length; i++) {
+		n = arity(code->postfix->steps[i].node);
+		for (j = 0; j < n; j++) {
+			code->operands[3 * i + j] = stack[top - n + j];
+			for (k = 0; k < words; k++)
+				sets[i * words + k] |=
+				    sets[stack[top - n + j] * words + k];
+		}
+		top -= n;
+		stack[top++] = i;
+		if (code->postfix->steps[i].index >= 0)
+			sets[i * words +
+			     code->postfix->steps[i].index / WORD_BITS] |=
+			    1UL << code->postfix->steps[i].index % WORD_BITS;
+	}
+	XFREE(stack);
+
+	/* List steps depending on each variable, counting them first. */
+	code->starts = XCALLOC(int, count + 1);
+	for (i = 0; i < length; i++)
+		for (j = 0; j < count; j++)
+			if (sets[i * words + j / WORD_BITS] >> j % WORD_BITS &
+			    1)
+				code->starts[j + 1]++;
+	for (j = 0; j < count; j++)
+		code->starts[j + 1] += code->starts[j];
+	code->dependents = XMALLOC(int, code->starts[count] + 1);
+	positions = XMALLOC(int, count + 1);
+	memcpy(positions, code->starts, count * sizeof(int));
+	for (i = 0; i < length; i++)
+		for (j = 0; j < count; j++)
+			if (sets[i * words + j / WORD_BITS] >> j % WORD_BITS &
+			    1)
+				code->dependents[positions[j]++] = i;
+	XFREE(positions);
+	XFREE(sets);
+
+	/* Allocate values of steps and variables, and flags; no value is
+	 * calculated yet. */
+	code->results = XMALLOC(double, length);
+	code->values = XMALLOC(double, count + 1);
+	code->changed = XMALLOC(int, count + 1);
+	code->dirty = XCALLOC(char, length);
+	code->evaluated = FALSE;
+
+	return code;
+}
+
+void
+incremental_destroy(void *code)
+{
+	/* Free all memory associated with prepared function. */
+	if (!code)
+		return;
+	postfix_destroy(((Code *) code)->postfix);
+	XFREE(((Code *) code)->operands);
+	XFREE(((Code *) code)->results);
+	XFREE(((Code *) code)->values);
+	XFREE(((Code *) code)->starts);
+	XFREE(((Code *) code)->dependents);
+	XFREE(((Code *) code)->changed);
+	XFREE(((Code *) code)->dirty);
+	XFREE(code);
+}
+
+double
+incremental_evaluate(void *code)
+{
+	Code           *c;	/* Prepared function. */
+	double          value;	/* Current variable value. */
+	int             changed;	/* Number of variables which values 
+					 * changed. */
+	int             begin,
+	                end;	/* Range of list of steps depending on
+				 * variable. */
+	int             first,
+	                last;	/* Range of steps to be recalculated. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	c = code;
+
+	/* On first evaluation, take variable values and calculate all
+	 * steps. */
+	if (!c->evaluated) {
+		for (i = 0; i < c->count; i++)
+			c->values[i] = c->records[i]->data.value;
+		for (i = 0; i < c->postfix->length; i++)
+			calculate(c, i);
+		c->evaluated = TRUE;
+		return c->results[c->postfix->length - 1];
+	}
+
+	/* Otherwise, find variables which values changed (comparing
+	 * representations, so that change of sign of zero or of
+	 * not-a-number value is noticed), and remember new values. */
+	changed = 0;
+	for (i = 0; i < c->count; i++) {
+		value = c->records[i]->data.value;
+		if (memcmp(&value, &c->values[i], sizeof(value))) {
+			c->values[i] = value;
+			c->changed[changed++] = i;
+		}
+	}
+
+	/* If single variable changed, recalculate steps depending on it,
+	 * already listed in order of evaluation. */
+	if (changed == 1) {
+		i = c->changed[0];
+		for (j = c->starts[i]; j < c->starts[i + 1]; j++)
+			calculate(c, c->dependents[j]);
+	}
+
+	/* If more variables changed, flag steps depending on any of them,
+	 * and recalculate flagged steps in order of evaluation. */
+	else if (changed > 1) {
+		first = c->postfix->length;
+		last = -1;
+		for (i = 0; i < changed; i++) {
+			begin = c->starts[c->changed[i]];
+			end = c->starts[c->changed[i] + 1];
+			if (begin == end)
+				continue;
+			for (j = begin; j < end; j++)
+				c->dirty[c->dependents[j]] = TRUE;
+			if (c->dependents[begin] < first)
+				first = c->dependents[begin];
+			if (c->dependents[end - 1] > last)
+				last = c->dependents[end - 1];
+		}
+		for (i = first; i <= last; i++)
+			if (c->dirty[i]) {
+				calculate(c, i);
+				c->dirty[i] = FALSE;
+			}
+	}
+
+	return c->results[c->postfix->length - 1];
+}
+
+static int
+arity(Node * node)
+{
+	/* Return number of children according to node type. */
+	switch (node->type) {
+	case 'f':
+	case 'u':
+	case 'p':
+	case 'h':
+		return 1;
+
+	case 'b':
+		return 2;
+
+	case 'm':
+		return 3;
+	}
+
+	return 0;
+}
+
+static inline void
+calculate(Code * code, int step)
+{
+	Node           *node;	/* Node evaluated by step. */
+	int            *operands;	/* Indices of steps calculating
+					 * operands. */
+	double         *results;	/* Values calculated by steps. */
+
+	node = code->postfix->steps[step].node;
+	operands = &code->operands[3 * step];
+	results = code->results;
+
+	/* According to node type, calculate step value from values of its 
+	 * operands, exactly as node_evaluate() does. */
+	switch (node->type) {
+	case 'n':
+		results[step] = node->data.number;
+		break;
+
+	case 'c':
+		results[step] = node->data.constant->data.value;
+		break;
+
+	case 'v':
+		results[step] =
+		    (code->postfix->steps[step].index >= 0) ?
+		    code->values[code->postfix->steps[step].index] :
+		    node->data.variable->data.value;
+		break;
+
+	case 'f':
+		results[step] =
+		    (*node->data.function.record->data.
+		     function) (results[operands[0]]);
+		break;
+
+	case 'u':
+		results[step] = -results[operands[0]];
+		break;
+
+	case 'b':
+		switch (node->data.bin_op.operation) {
+		case '+':
+			results[step] =
+			    results[operands[0]] + results[operands[1]];
+			break;
+
+		case '-':
+			results[step] =
+			    results[operands[0]] - results[operands[1]];
+			break;
+
+		case '*':
+			results[step] =
+			    results[operands[0]] * results[operands[1]];
+			break;
+
+		case '/':
+			results[step] =
+			    results[operands[0]] / results[operands[1]];
+			break;
+
+		case '^':
+			results[step] =
+			    math_pow(results[operands[0]],
+				     results[operands[1]]);
+			break;
+		}
+		break;
+
+	case 'p':
+		results[step] =
+		    math_powi(results[operands[0]],
+			      node->data.power.exponent);
+		break;
+
+	case 'h':
+		results[step] =
+		    math_polynomial(results[operands[0]],
+				    node->data.polynomial.coefficients,
+				    node->data.polynomial.degree);
+		break;
+
+	case 'm':
+		results[step] =
+		    fma(results[operands[0]], results[operands[1]],
+			results[operands[2]]);
+		break;
+	}
+}
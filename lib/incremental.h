@@ -0,0 +1,50 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+
+/* Prepare function represented by tree rooted at given node for
+ * incremental evaluation, keeping value of each subtree between
+ * evaluations.  Further arguments are array of symbol table records of
+ * function variables and its length.  Function returns pointer to
+ * prepared function.  */
+void           *incremental_create(Node * root, Record ** records,
+				   int count);
+
+/* Destroy prepared function.  */
+void            incremental_destroy(void *code);
+
+/* Calculate function value for current values of variables in symbol
+ * table records passed to incremental_create(), recalculating only
+ * subtrees depending on variables which values changed since previous
+ * evaluation (all subtrees on first evaluation).  */
+double          incremental_evaluate(void *code);
+
+#endif
@@ -0,0 +1,1323 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <float.h>
+#include <limits.h>
+#include "approx.h"
+#include "common.h"
+#include "interval.h"
+#include "postfix.h"
+#include "xmath.h"
+
+/* Number of points evaluated at once.  */
+#define TILE 64
+
+/* Relative (2^-50, that is at least four units in last place) and
+ * absolute (four smallest subnormal numbers) widening of values of C
+ * library functions, that are assumed to be accurate within two units in 
+ * last place, so that widened values bound exact ones.  */
+#define ERROR_RELATIVE 8.8817841970012523e-16
+#define ERROR_ABSOLUTE 1.976262583365439e-323
+
+/* Relative (2^-52) and absolute (smallest subnormal number) amounts by
+ * which finite number is decreased or increased to step to at least
+ * next representable number.  */
+#define STEP_RELATIVE 2.220446049250313e-16
+#define STEP_ABSOLUTE 4.9406564584124654e-324
+
+/* Smallest magnitude (2^-900) of numbers for which rounding errors of
+ * arithmetic operations are exactly representable, so that direction of 
+ * rounding could be determined from them.  */
+#define EXACT_MIN 1.1806916731885104e-271
+
+/* Lower and upper bounds of pi/2, upper bound of pi, and reciprocals of
+ * pi and 2*pi, used to locate periods of trigonometric functions.  */
+#define PI_2_LOWER 1.5707963267948966
+#define PI_2_UPPER 1.5707963267948968
+#define PI_UPPER 3.1415926535897936
+#define INV_PI 0.3183098861837907
+#define INV_2PI 0.15915494309189535
+
+/* Check if interval is empty.  */
+#define IS_EMPTY(a) MATH_ISNAN((a).lo)
+
+/* Interval version of function of one argument.  */
+typedef Interval(*Function) (Interval);
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	Postfix        *postfix;	/* Postfix form of function. */
+	Interval       *numbers;	/* Intervals of numbers and
+					 * constants, indexed by step. */
+	Function       *functions;	/* Interval versions of called
+					 * functions, indexed by step (null 
+					 * pointer if not known). */
+	Interval       *stack;	/* Evaluation stack, consisting of
+				 * tile-sized vectors. */
+} Code;
+
+/* Evaluate compiled function for given number (at most tile size) of
+ * boxes starting at given offset into arrays of variable bounds, and
+ * leave function intervals in first vector of evaluation stack.  */
+static void     evaluate(Code * code, double **lower, double **upper,
+			 int offset, int length);
+
+/* Return interval version of given function of one argument (one of
+ * functions predefined in symbol table), or null pointer if not
+ * known.  */
+static Function function_interval(double (*function) (double));
+
+/* Return finite number stepped down or up by at least one unit in last
+ * place.  */
+static inline double next_down(double x);
+static inline double next_up(double x);
+
+/* Return lower and upper bounds of sum, product and quotient of given
+ * numbers, and of square root of given number, calculated from
+ * rounding errors of these operations.  */
+static double   add_down(double a, double b);
+static double   add_up(double a, double b);
+static double   mul_down(double a, double b);
+static double   mul_up(double a, double b);
+static double   div_down(double a, double b);
+static double   div_up(double a, double b);
+static double   sqrt_down(double a);
+static double   sqrt_up(double a);
+
+/* Return lower and upper bounds of exact value of C library function,
+ * given its computed value.  */
+static double   widen_down(double value);
+static double   widen_up(double value);
+
+/* Return lower and upper bounds of value of given C library function of 
+ * one argument for given number.  */
+static double   value_down(double (*function) (double), double x);
+static double   value_up(double (*function) (double), double x);
+
+/* Return lower and upper bounds of given non-negative number raised to
+ * given positive integer power.  */
+static double   power_down(double x, unsigned n);
+static double   power_up(double x, unsigned n);
+
+/* Check if interval given by its bounds, with some margin to account
+ * for rounding errors, contains number differing by integer from given
+ * offset.  */
+static int      contains_period(double lo, double hi, double offset);
+
+/* Construct interval from its bounds, and return empty interval and
+ * interval of all real numbers.  */
+static inline Interval interval_pack(double lo, double hi);
+static inline Interval interval_empty(void);
+static inline Interval interval_entire(void);
+
+/* Return smallest interval containing both given intervals, intersection 
+ * of interval with interval given by bounds, and interval with bounds
+ * clamped to interval given by bounds.  */
+static Interval interval_hull(Interval a, Interval b);
+static Interval interval_restrict(Interval a, double lo, double hi);
+static Interval interval_clamp(Interval a, double lo, double hi);
+
+/* Return interval bounding value of C library function for given
+ * number, and interval of its values, if function is either increasing
+ * or decreasing, for given interval.  */
+static Interval interval_value(double (*function) (double), double x);
+static Interval interval_increasing(double (*function) (double),
+				    Interval a);
+static Interval interval_decreasing(double (*function) (double),
+				    Interval a);
+
+/* Arithmetic operations on intervals.  */
+static Interval interval_neg(Interval a);
+static Interval interval_add(Interval a, Interval b);
+static Interval interval_sub(Interval a, Interval b);
+static Interval interval_mul(Interval a, Interval b);
+static Interval interval_div(Interval a, Interval b);
+static Interval interval_recip(Interval a);
+static Interval interval_powi(Interval a, int n);
+static Interval interval_pow(Interval a, Interval b);
+static Interval interval_polynomial(Interval a, double *coefficients,
+				    int degree);
+
+/* Interval versions of functions predefined in symbol table.  */
+static Interval interval_exp(Interval a);
+static Interval interval_log(Interval a);
+static Interval interval_sqrt(Interval a);
+static Interval interval_sin(Interval a);
+static Interval interval_cos(Interval a);
+static Interval interval_tan(Interval a);
+static Interval interval_cot(Interval a);
+static Interval interval_sec(Interval a);
+static Interval interval_csc(Interval a);
+static Interval interval_asin(Interval a);
+static Interval interval_acos(Interval a);
+static Interval interval_atan(Interval a);
+static Interval interval_acot(Interval a);
+static Interval interval_asec(Interval a);
+static Interval interval_acsc(Interval a);
+static Interval interval_sinh(Interval a);
+static Interval interval_cosh(Interval a);
+static Interval interval_tanh(Interval a);
+static Interval interval_coth(Interval a);
+static Interval interval_sech(Interval a);
+static Interval interval_csch(Interval a);
+static Interval interval_asinh(Interval a);
+static Interval interval_acosh(Interval a);
+static Interval interval_atanh(Interval a);
+static Interval interval_acoth(Interval a);
+static Interval interval_asech(Interval a);
+static Interval interval_acsch(Interval a);
+static Interval interval_abs(Interval a);
+static Interval interval_step(Interval a);
+static Interval interval_delta(Interval a);
+static Interval interval_nandelta(Interval a);
+static Interval interval_erf(Interval a);
+
+void           *
+interval_create(Node * root, Record ** records, int count)
+{
+	Code           *code;	/* Compiled function. */
+	Node           *node;	/* Node evaluated by step. */
+	double          value;	/* Constant value. */
+	int             i;	/* Loop counter. */
+
+	/* Create postfix form of function and allocate memory for
+	 * evaluation. */
+	code = XMALLOC(Code, 1);
+	code->postfix = postfix_create(root, records, count);
+	code->numbers = XMALLOC(Interval, code->postfix->length);
+	code->functions = XMALLOC(Function, code->postfix->length);
+	code->stack = XMALLOC(Interval, code->postfix->depth * TILE);
+
+	/* Convert numbers to single point intervals and constants, that
+	 * are rounded to double precision, to intervals containing their
+	 * exact values, and look up interval versions of functions. */
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		code->numbers[i] = interval_pack(0, 0);
+		code->functions[i] = NULL;
+		switch (node->type) {
+		case 'n':
+			code->numbers[i] =
+			    interval_pack(node->data.number,
+					  node->data.number);
+			break;
+
+		case 'c':
+			value = node->data.constant->data.value;
+			code->numbers[i] =
+			    interval_pack(nextafter(value, -MATH_INFINITY),
+					  nextafter(value, MATH_INFINITY));
+			break;
+
+		case 'f':
+			code->functions[i] =
+			    function_interval(approx_exact
+					      (node->data.function.record->
+					       data.function));
+			break;
+		}
+	}
+
+	return code;
+}
+
+void
+interval_destroy(void *code)
+{
+	/* Free postfix form, arrays used for evaluation and data
+	 * structure representing compiled function. */
+	if (!code)
+		return;
+	postfix_destroy(((Code *) code)->postfix);
+	XFREE(((Code *) code)->numbers);
+	XFREE(((Code *) code)->functions);
+	XFREE(((Code *) code)->stack);
+	XFREE(code);
+}
+
+void
+interval_evaluate_batch(void *code, double **lower, double **upper,
+			int length, double *results_lower,
+			double *results_upper)
+{
+	int             offset;	/* Offset of tile. */
+	int             n;	/* Number of boxes in tile. */
+	int             j;	/* Loop counter. */
+
+	/* Evaluate function tile by tile, and store bounds of results. */
+	for (offset = 0; offset < length; offset += TILE) {
+		n = (length - offset < TILE) ? length - offset : TILE;
+		evaluate(code, lower, upper, offset, n);
+		for (j = 0; j < n; j++) {
+			results_lower[offset + j] =
+			    ((Code *) code)->stack[j].lo;
+			results_upper[offset + j] =
+			    ((Code *) code)->stack[j].hi;
+		}
+	}
+}
+
+static void
+evaluate(Code * code, double **lower, double **upper, int offset,
+	 int length)
+{
+	Interval       *stack;	/* Top vector of evaluation stack. */
+	Node           *node;	/* Node evaluated by step. */
+	double         *lo,
+	               *hi;	/* Variable bounds. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Evaluate steps in order, each of them replacing vectors of
+	 * intervals of its children on top of stack by vector of its own 
+	 * intervals. */
+	stack = code->stack - TILE;
+	for (i = 0; i < code->postfix->length; i++) {
+		node = code->postfix->steps[i].node;
+		switch (node->type) {
+		case 'n':
+		case 'c':
+			stack += TILE;
+			for (j = 0; j < length; j++)
+				stack[j] = code->numbers[i];
+			break;
+
+		case 'v':
+			/* Variable bounds not ordered (or not-a-number
+			 * bounds) give empty interval. */
+			stack += TILE;
+			lo = lower[code->postfix->steps[i].index] + offset;
+			hi = upper[code->postfix->steps[i].index] + offset;
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    (lo[j] <=
+				     hi[j]) ? interval_pack(lo[j],
+							    hi[j]) :
+				    interval_empty();
+			break;
+
+		case 'f':
+			/* Nothing is known about values of functions
+			 * without interval version. */
+			if (code->functions[i])
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    code->functions[i] (stack[j]);
+			else
+				for (j = 0; j < length; j++)
+					if (!IS_EMPTY(stack[j]))
+						stack[j] = interval_entire();
+			break;
+
+		case 'u':
+			for (j = 0; j < length; j++)
+				stack[j] = interval_neg(stack[j]);
+			break;
+
+		case 'b':
+			stack -= TILE;
+			switch (node->data.bin_op.operation) {
+			case '+':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    interval_add(stack[j],
+							 stack[TILE + j]);
+				break;
+
+			case '-':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    interval_sub(stack[j],
+							 stack[TILE + j]);
+				break;
+
+			case '*':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    interval_mul(stack[j],
+							 stack[TILE + j]);
+				break;
+
+			case '/':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    interval_div(stack[j],
+							 stack[TILE + j]);
+				break;
+
+			case '^':
+				for (j = 0; j < length; j++)
+					stack[j] =
+					    interval_pow(stack[j],
+							 stack[TILE + j]);
+				break;
+			}
+			break;
+
+		case 'p':
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    interval_powi(stack[j],
+						  node->data.power.exponent);
+			break;
+
+		case 'h':
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    interval_polynomial(stack[j],
+							node->data.polynomial.
+							coefficients,
+							node->data.polynomial.
+							degree);
+			break;
+
+		case 'm':
+			stack -= 2 * TILE;
+			for (j = 0; j < length; j++)
+				stack[j] =
+				    interval_add(interval_mul
+						 (stack[j], stack[TILE + j]),
+						 stack[2 * TILE + j]);
+			break;
+		}
+	}
+}
+
+static          Function
+function_interval(double (*function) (double))
+{
+	static struct {
+		double          (*function) (double);	/* Function. */
+		Function        function_interval;	/* Interval
+							 * version. */
+	} functions[] = {
+		{
+		exp, interval_exp}, {
+		log, interval_log}, {
+		sqrt, interval_sqrt}, {
+		sin, interval_sin}, {
+		cos, interval_cos}, {
+		tan, interval_tan}, {
+		math_cot, interval_cot}, {
+		math_sec, interval_sec}, {
+		math_csc, interval_csc}, {
+		asin, interval_asin}, {
+		acos, interval_acos}, {
+		atan, interval_atan}, {
+		math_acot, interval_acot}, {
+		math_asec, interval_asec}, {
+		math_acsc, interval_acsc}, {
+		sinh, interval_sinh}, {
+		cosh, interval_cosh}, {
+		tanh, interval_tanh}, {
+		math_coth, interval_coth}, {
+		math_sech, interval_sech}, {
+		math_csch, interval_csch}, {
+		math_asinh, interval_asinh}, {
+		math_acosh, interval_acosh}, {
+		math_atanh, interval_atanh}, {
+		math_acoth, interval_acoth}, {
+		math_asech, interval_asech}, {
+		math_acsch, interval_acsch}, {
+		fabs, interval_abs}, {
+		math_step, interval_step}, {
+		math_delta, interval_delta}, {
+		math_nandelta, interval_nandelta}, {
+		erf, interval_erf}
+	};			/* Functions and their interval versions. */
+	int             i;	/* Loop counter. */
+
+	/* Look up function among predefined functions. */
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0])); i++)
+		if (functions[i].function == function)
+			return functions[i].function_interval;
+	return NULL;
+}
+
+static inline double
+next_down(double x)
+{
+	/* Subtract amount no smaller than unit in last place, avoiding
+	 * call to nextafter(). */
+	return x - (fabs(x) * STEP_RELATIVE + STEP_ABSOLUTE);
+}
+
+static inline double
+next_up(double x)
+{
+	/* Add amount no smaller than unit in last place. */
+	return x + (fabs(x) * STEP_RELATIVE + STEP_ABSOLUTE);
+}
+
+static double
+add_down(double a, double b)
+{
+	double          sum;	/* Rounded sum. */
+	double          part;	/* Part of sum coming from second
+				 * number. */
+	double          error;	/* Rounding error of sum. */
+
+	/* Overflow of sum of finite numbers is bounded by largest finite 
+	 * number. */
+	sum = a + b;
+	if (isinf(sum))
+		return (isinf(a) || isinf(b) || sum < 0) ? sum : DBL_MAX;
+
+	/* Recover rounding error of sum (Knuth), and step down if sum was 
+	 * rounded up. */
+	part = sum - a;
+	error = (a - (sum - part)) + (b - part);
+	return (error < 0) ? next_down(sum) : sum;
+}
+
+static double
+add_up(double a, double b)
+{
+	/* Negate lower bound of sum of negated numbers. */
+	return -add_down(-a, -b);
+}
+
+static double
+mul_down(double a, double b)
+{
+	double          product;	/* Rounded product. */
+
+	/* Product of zero and any number (including infinite one) is
+	 * zero, while overflow of product of finite numbers is bounded by
+	 * largest finite number. */
+	if (a == 0 || b == 0)
+		return 0;
+	product = a * b;
+	if (isinf(product))
+		return (isinf(a) || isinf(b)
+			|| product < 0) ? product : DBL_MAX;
+
+	/* Step down if product was rounded up, as determined from
+	 * rounding error calculated by fused multiply-add, or if product
+	 * too small for rounding error to be representable. */
+	if (fabs(product) < EXACT_MIN || fma(a, b, -product) < 0)
+		return next_down(product);
+	return product;
+}
+
+static double
+mul_up(double a, double b)
+{
+	/* Negate lower bound of product with one number negated. */
+	return -mul_down(-a, b);
+}
+
+static double
+div_down(double a, double b)
+{
+	double          quotient;	/* Rounded quotient. */
+	double          remainder;	/* Remainder of division. */
+
+	/* Overflow of quotient of finite numbers is bounded by largest
+	 * finite number, while quotient of zero or by infinite number is
+	 * exact. */
+	quotient = a / b;
+	if (isinf(quotient))
+		return (isinf(a) || quotient < 0) ? quotient : DBL_MAX;
+	if (a == 0 || isinf(b))
+		return quotient;
+
+	/* Step down if quotient was rounded up, as determined from sign
+	 * of remainder calculated by fused multiply-add, or if numbers
+	 * too small for remainder to be representable. */
+	if (fabs(a) < EXACT_MIN || fabs(quotient) < EXACT_MIN)
+		return next_down(quotient);
+	remainder = fma(-quotient, b, a);
+	if (remainder != 0 && (remainder < 0) != (b < 0))
+		return next_down(quotient);
+	return quotient;
+}
+
+static double
+div_up(double a, double b)
+{
+	/* Negate lower bound of quotient of negated dividend. */
+	return -div_down(-a, b);
+}
+
+static double
+sqrt_down(double a)
+{
+	double          root;	/* Rounded square root. */
+
+	/* Step down if square root was rounded up, as determined from
+	 * sign of remainder calculated by fused multiply-add. */
+	root = sqrt(a);
+	if (root == 0 || isinf(root))
+		return root;
+	if (a < EXACT_MIN || fma(-root, root, a) < 0)
+		return next_down(root);
+	return root;
+}
+
+static double
+sqrt_up(double a)
+{
+	double          root;	/* Rounded square root. */
+
+	/* Step up if square root was rounded down. */
+	root = sqrt(a);
+	if (root == 0 || isinf(root))
+		return root;
+	if (a < EXACT_MIN || fma(-root, root, a) > 0)
+		return next_up(root);
+	return root;
+}
+
+static double
+widen_down(double value)
+{
+	/* Infinite value is either exact or result of overflow, so that
+	 * largest finite number bounds it. */
+	if (value == MATH_INFINITY)
+		return DBL_MAX;
+	if (isinf(value))
+		return value;
+	return value - fabs(value) * ERROR_RELATIVE - ERROR_ABSOLUTE;
+}
+
+static double
+widen_up(double value)
+{
+	/* Negate lower bound of negated value. */
+	return -widen_down(-value);
+}
+
+static double
+value_down(double (*function) (double), double x)
+{
+	double          value;	/* Function value. */
+
+	/* Zero function value for zero argument is exact. */
+	value = (*function) (x);
+	if (value == 0 && x == 0)
+		return 0;
+	return widen_down(value);
+}
+
+static double
+value_up(double (*function) (double), double x)
+{
+	double          value;	/* Function value. */
+
+	/* Zero function value for zero argument is exact. */
+	value = (*function) (x);
+	if (value == 0 && x == 0)
+		return 0;
+	return widen_up(value);
+}
+
+static double
+power_down(double x, unsigned n)
+{
+	double          result;	/* Accumulated power. */
+
+	/* Multiply together squares of number corresponding to bits set
+	 * in exponent, starting from lowest one, rounding down every
+	 * product. */
+	for (; !(n & 1); n >>= 1)
+		x = mul_down(x, x);
+	for (result = x, n >>= 1; n; n >>= 1) {
+		x = mul_down(x, x);
+		if (n & 1)
+			result = mul_down(result, x);
+	}
+	return result;
+}
+
+static double
+power_up(double x, unsigned n)
+{
+	double          result;	/* Accumulated power. */
+
+	/* Multiply together squares of number corresponding to bits set
+	 * in exponent, starting from lowest one, rounding up every
+	 * product. */
+	for (; !(n & 1); n >>= 1)
+		x = mul_up(x, x);
+	for (result = x, n >>= 1; n; n >>= 1) {
+		x = mul_up(x, x);
+		if (n & 1)
+			result = mul_up(result, x);
+	}
+	return result;
+}
+
+static int
+contains_period(double lo, double hi, double offset)
+{
+	double          margin;	/* Margin for rounding errors. */
+
+	/* Check if there is integer between bounds shifted by offset,
+	 * with bounds widened by margin bounding rounding errors of their
+	 * calculation (and whole period covered by margin for very large
+	 * bounds). */
+	margin = (fabs(lo) + fabs(hi)) * ERROR_RELATIVE;
+	return floor(hi + margin - offset) >= ceil(lo - margin - offset);
+}
+
+static inline   Interval
+interval_pack(double lo, double hi)
+{
+	Interval        a;	/* Interval. */
+
+	/* Assign bounds to interval. */
+	a.lo = lo;
+	a.hi = hi;
+	return a;
+}
+
+static inline   Interval
+interval_empty(void)
+{
+	/* Empty interval has not-a-number bounds. */
+	return interval_pack(MATH_NAN, MATH_NAN);
+}
+
+static inline   Interval
+interval_entire(void)
+{
+	/* Interval of all real numbers has infinite bounds. */
+	return interval_pack(-MATH_INFINITY, MATH_INFINITY);
+}
+
+static          Interval
+interval_hull(Interval a, Interval b)
+{
+	/* Take smaller of lower bounds and larger of upper bounds of
+	 * non-empty intervals. */
+	if (IS_EMPTY(a))
+		return b;
+	if (IS_EMPTY(b))
+		return a;
+	return interval_pack((a.lo < b.lo) ? a.lo : b.lo,
+			     (a.hi > b.hi) ? a.hi : b.hi);
+}
+
+static          Interval
+interval_restrict(Interval a, double lo, double hi)
+{
+	/* Take larger of lower bounds and smaller of upper bounds,
+	 * giving empty interval if they are not ordered. */
+	if (a.lo < lo)
+		a.lo = lo;
+	if (a.hi > hi)
+		a.hi = hi;
+	return (a.lo <= a.hi) ? a : interval_empty();
+}
+
+static          Interval
+interval_clamp(Interval a, double lo, double hi)
+{
+	/* Clamp bounds to range of function, that exact bounds lie in. */
+	if (a.lo < lo)
+		a.lo = lo;
+	if (a.hi > hi)
+		a.hi = hi;
+	return a;
+}
+
+static          Interval
+interval_value(double (*function) (double), double x)
+{
+	double          value;	/* Function value. */
+
+	/* Zero function value for zero argument is exact. */
+	value = (*function) (x);
+	if (value == 0 && x == 0)
+		return interval_pack(0, 0);
+	return interval_pack(widen_down(value), widen_up(value));
+}
+
+static          Interval
+interval_increasing(double (*function) (double), Interval a)
+{
+	/* Bound function values at interval bounds. */
+	if (IS_EMPTY(a))
+		return a;
+	return interval_pack(value_down(function, a.lo),
+			     value_up(function, a.hi));
+}
+
+static          Interval
+interval_decreasing(double (*function) (double), Interval a)
+{
+	/* Bound function values at interval bounds, in reverse order. */
+	if (IS_EMPTY(a))
+		return a;
+	return interval_pack(value_down(function, a.hi),
+			     value_up(function, a.lo));
+}
+
+static          Interval
+interval_neg(Interval a)
+{
+	/* Negate and swap bounds. */
+	return interval_pack(-a.hi, -a.lo);
+}
+
+static          Interval
+interval_add(Interval a, Interval b)
+{
+	/* Add lower and upper bounds, rounding outward. */
+	if (IS_EMPTY(a) || IS_EMPTY(b))
+		return interval_empty();
+	return interval_pack(add_down(a.lo, b.lo), add_up(a.hi, b.hi));
+}
+
+static          Interval
+interval_sub(Interval a, Interval b)
+{
+	/* Add negated second interval. */
+	return interval_add(a, interval_neg(b));
+}
+
+static          Interval
+interval_mul(Interval a, Interval b)
+{
+	if (IS_EMPTY(a) || IS_EMPTY(b))
+		return interval_empty();
+
+	/* Choose products of bounds giving bounds of product according to 
+	 * signs of intervals, rounding outward; only if both intervals
+	 * contain zero in their interiors, two candidates for each bound
+	 * have to be compared. */
+	if (a.lo >= 0) {
+		if (b.lo >= 0)
+			return interval_pack(mul_down(a.lo, b.lo),
+					     mul_up(a.hi, b.hi));
+		if (b.hi <= 0)
+			return interval_pack(mul_down(a.hi, b.lo),
+					     mul_up(a.lo, b.hi));
+		return interval_pack(mul_down(a.hi, b.lo),
+				     mul_up(a.hi, b.hi));
+	}
+	if (a.hi <= 0) {
+		if (b.lo >= 0)
+			return interval_pack(mul_down(a.lo, b.hi),
+					     mul_up(a.hi, b.lo));
+		if (b.hi <= 0)
+			return interval_pack(mul_down(a.hi, b.hi),
+					     mul_up(a.lo, b.lo));
+		return interval_pack(mul_down(a.lo, b.hi),
+				     mul_up(a.lo, b.lo));
+	}
+	if (b.lo >= 0)
+		return interval_pack(mul_down(a.lo, b.hi),
+				     mul_up(a.hi, b.hi));
+	if (b.hi <= 0)
+		return interval_pack(mul_down(a.hi, b.lo),
+				     mul_up(a.lo, b.lo));
+	return interval_hull(interval_pack(mul_down(a.lo, b.hi),
+					   mul_up(a.lo, b.lo)),
+			     interval_pack(mul_down(a.hi, b.lo),
+					   mul_up(a.hi, b.hi)));
+}
+
+static          Interval
+interval_div(Interval a, Interval b)
+{
+	double          lo,
+	                hi;	/* Bounds of quotients of bounds. */
+	Interval        result;	/* Quotient. */
+
+	if (IS_EMPTY(a) || IS_EMPTY(b) || (b.lo == 0 && b.hi == 0))
+		return interval_empty();
+
+	if (b.lo > 0 || b.hi < 0) {
+		/* For divisor not containing zero, multiply by
+		 * reciprocal of divisor if quotient of infinite bounds
+		 * could arise, and otherwise take smallest and largest of 
+		 * quotients of bounds, rounding outward. */
+		if ((isinf(a.lo) || isinf(a.hi))
+		    && (isinf(b.lo) || isinf(b.hi)))
+			return interval_mul(a, interval_recip(b));
+		result =
+		    interval_pack(div_down(a.lo, b.lo),
+				  div_up(a.lo, b.lo));
+		lo = div_down(a.lo, b.hi);
+		hi = div_up(a.lo, b.hi);
+		result = interval_hull(result, interval_pack(lo, hi));
+		lo = div_down(a.hi, b.lo);
+		hi = div_up(a.hi, b.lo);
+		result = interval_hull(result, interval_pack(lo, hi));
+		lo = div_down(a.hi, b.hi);
+		hi = div_up(a.hi, b.hi);
+		return interval_hull(result, interval_pack(lo, hi));
+	}
+
+	/* Otherwise, zero divisor is disregarded: quotient of zero is
+	 * zero, quotient of interval containing zero or by interval
+	 * containing zero in its interior is unbounded, and quotient by
+	 * interval with zero bound is unbounded on one side. */
+	if (a.lo == 0 && a.hi == 0)
+		return a;
+	if ((a.lo <= 0 && a.hi >= 0) || (b.lo < 0 && b.hi > 0))
+		return interval_entire();
+	if (b.lo == 0)
+		return (a.lo > 0) ? interval_pack(div_down(a.lo, b.hi),
+						  MATH_INFINITY) :
+		    interval_pack(-MATH_INFINITY, div_up(a.hi, b.hi));
+	return (a.lo > 0) ? interval_pack(-MATH_INFINITY,
+					  div_up(a.lo,
+						 b.lo)) :
+	    interval_pack(div_down(a.hi, b.lo), MATH_INFINITY);
+}
+
+static          Interval
+interval_recip(Interval a)
+{
+	/* Divide one by interval. */
+	return interval_div(interval_pack(1, 1), a);
+}
+
+static          Interval
+interval_powi(Interval a, int n)
+{
+	unsigned        m;	/* Absolute value of exponent. */
+	double          lo,
+	                hi;	/* Smallest and largest absolute values
+				 * in interval. */
+	Interval        result;	/* Power. */
+
+	/* Zero power is one (including zero raised to zero power). */
+	if (IS_EMPTY(a))
+		return a;
+	if (n == 0)
+		return interval_pack(1, 1);
+
+	/* Odd power is increasing, while even power is increasing in
+	 * absolute value of number; reciprocal of positive power is taken 
+	 * for negative exponent. */
+	m = (n < 0) ? -(unsigned) n : (unsigned) n;
+	if (m & 1)
+		result =
+		    interval_pack((a.lo <
+				   0) ? -power_up(-a.lo,
+						  m) : power_down(a.lo, m),
+				  (a.hi <
+				   0) ? -power_down(-a.hi,
+						    m) : power_up(a.hi, m));
+	else {
+		lo = (a.lo > 0) ? a.lo : (a.hi < 0) ? -a.hi : 0;
+		hi = (-a.lo > a.hi) ? -a.lo : a.hi;
+		result = interval_pack(power_down(lo, m), power_up(hi, m));
+	}
+	return (n < 0) ? interval_recip(result) : result;
+}
+
+static          Interval
+interval_pow(Interval a, Interval b)
+{
+	double          value;	/* Power of bounds. */
+	Interval        result;	/* Power. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Use repeated squaring if exponent is single integer, as
+	 * math_pow() does. */
+	if (IS_EMPTY(a) || IS_EMPTY(b))
+		return interval_empty();
+	if (b.lo == b.hi && fabs(b.lo) <= INT_MAX && b.lo == (int) b.lo)
+		return interval_powi(a, (int) b.lo);
+
+	/* Otherwise, negative base is disregarded and power, being
+	 * monotonic in both base and exponent, has extreme values at
+	 * corners of box. */
+	a = interval_restrict(a, 0, MATH_INFINITY);
+	if (IS_EMPTY(a))
+		return a;
+	result = interval_empty();
+	for (i = 0; i < 2; i++)
+		for (j = 0; j < 2; j++) {
+			value = pow(i ? a.hi : a.lo, j ? b.hi : b.lo);
+			result =
+			    interval_hull(result,
+					  interval_pack(widen_down(value),
+							widen_up(value)));
+		}
+	return interval_clamp(result, 0, MATH_INFINITY);
+}
+
+static          Interval
+interval_polynomial(Interval a, double *coefficients, int degree)
+{
+	Interval        result;	/* Accumulated polynomial value. */
+	int             i;	/* Loop counter. */
+
+	/* Calculate polynomial value by nested multiplication. */
+	result = interval_pack(coefficients[degree], coefficients[degree]);
+	for (i = degree - 1; i >= 0; i--)
+		result =
+		    interval_add(interval_mul(result, a),
+				 interval_pack(coefficients[i],
+					       coefficients[i]));
+	return result;
+}
+
+static          Interval
+interval_exp(Interval a)
+{
+	/* Exponential function is increasing and positive. */
+	return interval_clamp(interval_increasing(exp, a), 0,
+			      MATH_INFINITY);
+}
+
+static          Interval
+interval_log(Interval a)
+{
+	/* Logarithm is increasing on non-negative numbers. */
+	return interval_increasing(log,
+				   interval_restrict(a, 0, MATH_INFINITY));
+}
+
+static          Interval
+interval_sqrt(Interval a)
+{
+	/* Square root is increasing on non-negative numbers, and
+	 * correctly rounded. */
+	a = interval_restrict(a, 0, MATH_INFINITY);
+	if (IS_EMPTY(a))
+		return a;
+	return interval_pack(sqrt_down(a.lo), sqrt_up(a.hi));
+}
+
+static          Interval
+interval_sin(Interval a)
+{
+	Interval        result;	/* Sine. */
+
+	/* Sine of unbounded interval has full range. */
+	if (IS_EMPTY(a))
+		return a;
+	if (isinf(a.lo) || isinf(a.hi))
+		return interval_pack(-1, 1);
+
+	/* Sine is monotonic between its extremes, at pi/2 and 3*pi/2
+	 * modulo 2*pi, so that it has extreme values either at interval
+	 * bounds or at these points, if contained in interval. */
+	result =
+	    interval_hull(interval_value(sin, a.lo),
+			  interval_value(sin, a.hi));
+	if (contains_period(a.lo * INV_2PI, a.hi * INV_2PI, 0.25))
+		result.hi = 1;
+	if (contains_period(a.lo * INV_2PI, a.hi * INV_2PI, 0.75))
+		result.lo = -1;
+	return interval_clamp(result, -1, 1);
+}
+
+static          Interval
+interval_cos(Interval a)
+{
+	Interval        result;	/* Cosine. */
+
+	/* Cosine of unbounded interval has full range. */
+	if (IS_EMPTY(a))
+		return a;
+	if (isinf(a.lo) || isinf(a.hi))
+		return interval_pack(-1, 1);
+
+	/* Cosine has extremes at 0 and pi modulo 2*pi. */
+	result =
+	    interval_hull(interval_value(cos, a.lo),
+			  interval_value(cos, a.hi));
+	if (contains_period(a.lo * INV_2PI, a.hi * INV_2PI, 0))
+		result.hi = 1;
+	if (contains_period(a.lo * INV_2PI, a.hi * INV_2PI, 0.5))
+		result.lo = -1;
+	return interval_clamp(result, -1, 1);
+}
+
+static          Interval
+interval_tan(Interval a)
+{
+	/* Tangent is increasing between its poles at pi/2 modulo pi, and
+	 * unbounded on intervals containing pole. */
+	if (IS_EMPTY(a))
+		return a;
+	if (isinf(a.lo) || isinf(a.hi)
+	    || contains_period(a.lo * INV_PI, a.hi * INV_PI, 0.5))
+		return interval_entire();
+	return interval_increasing(tan, a);
+}
+
+static          Interval
+interval_cot(Interval a)
+{
+	/* Cotangent is decreasing between its poles at multiples of pi,
+	 * and unbounded on intervals containing pole, while pole at zero
+	 * bound of interval makes interval unbounded on one side only. */
+	if (IS_EMPTY(a))
+		return a;
+	if (a.lo == 0 && a.hi == 0)
+		return interval_empty();
+	if (isinf(a.lo) || isinf(a.hi))
+		return interval_entire();
+	if (a.lo == 0)
+		return contains_period(0.5, a.hi * INV_PI,
+				       0) ? interval_entire() :
+		    interval_pack(value_down(math_cot, a.hi), MATH_INFINITY);
+	if (a.hi == 0)
+		return contains_period(a.lo * INV_PI, -0.5,
+				       0) ? interval_entire() :
+		    interval_pack(-MATH_INFINITY, value_up(math_cot, a.lo));
+	if (contains_period(a.lo * INV_PI, a.hi * INV_PI, 0))
+		return interval_entire();
+	return interval_decreasing(math_cot, a);
+}
+
+static          Interval
+interval_sec(Interval a)
+{
+	/* Calculate secant as reciprocal of cosine. */
+	return interval_recip(interval_cos(a));
+}
+
+static          Interval
+interval_csc(Interval a)
+{
+	/* Calculate cosecant as reciprocal of sine. */
+	return interval_recip(interval_sin(a));
+}
+
+static          Interval
+interval_asin(Interval a)
+{
+	/* Inverse sine is increasing on [-1,1]. */
+	return interval_clamp(interval_increasing
+			      (asin, interval_restrict(a, -1, 1)),
+			      -PI_2_UPPER, PI_2_UPPER);
+}
+
+static          Interval
+interval_acos(Interval a)
+{
+	/* Inverse cosine is decreasing on [-1,1]. */
+	return interval_clamp(interval_decreasing
+			      (acos, interval_restrict(a, -1, 1)), 0,
+			      PI_UPPER);
+}
+
+static          Interval
+interval_atan(Interval a)
+{
+	/* Inverse tangent is increasing. */
+	return interval_clamp(interval_increasing(atan, a), -PI_2_UPPER,
+			      PI_2_UPPER);
+}
+
+static          Interval
+interval_acot(Interval a)
+{
+	Interval        result;	/* Inverse cotangent. */
+
+	/* Calculate inverse cotangent as inverse tangent of reciprocal,
+	 * as math_acot() does, adding its value pi/2 for zero, if
+	 * contained in interval. */
+	result = interval_atan(interval_recip(a));
+	if (a.lo <= 0 && a.hi >= 0)
+		result =
+		    interval_hull(result,
+				  interval_pack(PI_2_LOWER, PI_2_UPPER));
+	return result;
+}
+
+static          Interval
+interval_asec(Interval a)
+{
+	/* Calculate inverse secant as inverse cosine of reciprocal. */
+	return interval_acos(interval_recip(a));
+}
+
+static          Interval
+interval_acsc(Interval a)
+{
+	/* Calculate inverse cosecant as inverse sine of reciprocal. */
+	return interval_asin(interval_recip(a));
+}
+
+static          Interval
+interval_sinh(Interval a)
+{
+	/* Hyperbolic sine is increasing. */
+	return interval_increasing(sinh, a);
+}
+
+static          Interval
+interval_cosh(Interval a)
+{
+	double          lo,
+	                hi;	/* Smallest and largest absolute values
+				 * in interval. */
+
+	/* Hyperbolic cosine is even, increasing in absolute value of
+	 * number, and no less than one. */
+	if (IS_EMPTY(a))
+		return a;
+	lo = (a.lo > 0) ? a.lo : (a.hi < 0) ? -a.hi : 0;
+	hi = (-a.lo > a.hi) ? -a.lo : a.hi;
+	return interval_clamp(interval_increasing
+			      (cosh, interval_pack(lo, hi)), 1,
+			      MATH_INFINITY);
+}
+
+static          Interval
+interval_tanh(Interval a)
+{
+	/* Hyperbolic tangent is increasing, and bounded by one in
+	 * absolute value. */
+	return interval_clamp(interval_increasing(tanh, a), -1, 1);
+}
+
+static          Interval
+interval_coth(Interval a)
+{
+	/* Calculate hyperbolic cotangent as reciprocal of hyperbolic
+	 * tangent. */
+	return interval_recip(interval_tanh(a));
+}
+
+static          Interval
+interval_sech(Interval a)
+{
+	/* Calculate hyperbolic secant as reciprocal of hyperbolic
+	 * cosine. */
+	return interval_recip(interval_cosh(a));
+}
+
+static          Interval
+interval_csch(Interval a)
+{
+	/* Calculate hyperbolic cosecant as reciprocal of hyperbolic sine. 
+	 */
+	return interval_recip(interval_sinh(a));
+}
+
+static          Interval
+interval_asinh(Interval a)
+{
+	/* Inverse hyperbolic sine is increasing (C library function is
+	 * used instead of math_asinh(), that is not accurate enough to
+	 * be bounded). */
+	return interval_increasing(asinh, a);
+}
+
+static          Interval
+interval_acosh(Interval a)
+{
+	/* Inverse hyperbolic cosine is increasing on numbers no less
+	 * than one, and non-negative (C library function is used as for
+	 * inverse hyperbolic sine). */
+	return interval_clamp(interval_increasing
+			      (acosh,
+			       interval_restrict(a, 1, MATH_INFINITY)), 0,
+			      MATH_INFINITY);
+}
+
+static          Interval
+interval_atanh(Interval a)
+{
+	/* Inverse hyperbolic tangent is increasing on [-1,1]. */
+	return interval_increasing(atanh, interval_restrict(a, -1, 1));
+}
+
+static          Interval
+interval_acoth(Interval a)
+{
+	/* Calculate inverse hyperbolic cotangent as inverse hyperbolic
+	 * tangent of reciprocal. */
+	return interval_atanh(interval_recip(a));
+}
+
+static          Interval
+interval_asech(Interval a)
+{
+	/* Calculate inverse hyperbolic secant as inverse hyperbolic
+	 * cosine of reciprocal, as math_asech() does. */
+	return interval_acosh(interval_recip(a));
+}
+
+static          Interval
+interval_acsch(Interval a)
+{
+	/* Calculate inverse hyperbolic cosecant as inverse hyperbolic
+	 * sine of reciprocal, as math_acsch() does. */
+	return interval_asinh(interval_recip(a));
+}
+
+static          Interval
+interval_abs(Interval a)
+{
+	/* Absolute value ranges from smallest to largest absolute value
+	 * in interval. */
+	if (IS_EMPTY(a))
+		return a;
+	return interval_pack((a.lo > 0) ? a.lo : (a.hi < 0) ? -a.hi : 0,
+			     (-a.lo > a.hi) ? -a.lo : a.hi);
+}
+
+static          Interval
+interval_step(Interval a)
+{
+	/* Step function is zero for negative numbers and one otherwise. */
+	if (IS_EMPTY(a))
+		return a;
+	return interval_pack((a.lo < 0) ? 0 : 1, (a.hi < 0) ? 0 : 1);
+}
+
+static          Interval
+interval_delta(Interval a)
+{
+	/* Delta function is infinite for zero and zero otherwise. */
+	if (IS_EMPTY(a))
+		return a;
+	return interval_pack((a.lo == 0 && a.hi == 0) ? MATH_INFINITY : 0,
+			     (a.lo <= 0
+			      && a.hi >= 0) ? MATH_INFINITY : 0);
+}
+
+static          Interval
+interval_nandelta(Interval a)
+{
+	/* Modified delta function is zero for non-zero numbers, and
+	 * undefined for zero. */
+	if (IS_EMPTY(a) || (a.lo == 0 && a.hi == 0))
+		return interval_empty();
+	return interval_pack(0, 0);
+}
+
+static          Interval
+interval_erf(Interval a)
+{
+	/* Error function is increasing, and bounded by one in absolute
+	 * value. */
+	return interval_clamp(interval_increasing(erf, a), -1, 1);
+}
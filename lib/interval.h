@@ -0,0 +1,57 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INTERVAL_H
+#define INTERVAL_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+
+/* Data structure representing closed interval of real numbers (possibly
+ * unbounded), empty interval being represented by not-a-number bounds.  */
+typedef struct {
+	double          lo;	/* Lower bound. */
+	double          hi;	/* Upper bound. */
+} Interval;
+
+/* Compile function represented by tree rooted at given node for
+ * evaluation in interval arithmetic.  Further arguments are array of
+ * symbol table records of function variables and its length.  Function
+ * returns pointer to compiled function.  */
+void           *interval_create(Node * root, Record ** records, int count);
+
+/* Destroy compiled function.  */
+void            interval_destroy(void *code);
+
+/* Calculate intervals enclosing function values for batch of boxes,
+ * given by arrays of lower and upper bounds of variable values (ordered
+ * as records passed to interval_create(), each array of given length),
+ * and store lower and upper bounds of results into given arrays.  */
+void            interval_evaluate_batch(void *code, double **lower,
+					double **upper, int length,
+					double *results_lower,
+					double *results_upper);
+
+#endif
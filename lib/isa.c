@@ -0,0 +1,95 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "common.h"
+#include "isa.h"
+
+/* Instruction set variant names.  */
+static char    *names[] = {
+#if ISA_DISPATCH
+	"avx512f", "avx2", "sse4.2",
+#endif
+	"generic"
+};
+
+/* Variant selected, or negative value if not selected yet.  */
+static int      selected = -1;
+
+/* Return non-zero if processor supports instruction set variant given. */
+static int      isa_supported(int isa);
+
+int
+isa_select(void)
+{
+	char           *name;	/* Variant name given by environment. */
+	int             isa;	/* Variant tried. */
+
+	/* Return variant if already selected.  Concurrent first calls
+	 * select same variant, so no locking is needed. */
+	if (selected >= 0)
+		return selected;
+
+	/* Select variant named by MATHEVAL_ISA environment variable, if
+	 * set and supported by processor; otherwise, select most
+	 * preferred supported variant. */
+	name = getenv("MATHEVAL_ISA");
+	for (isa = 0; isa < ISA_COUNT; isa++)
+		if (name && !strcmp(name, names[isa]) && isa_supported(isa))
+			break;
+	if (isa == ISA_COUNT)
+		for (isa = 0; !isa_supported(isa); isa++);
+	selected = isa;
+	return selected;
+}
+
+char           *
+isa_name(int isa)
+{
+	/* Return variant name. */
+	return names[isa];
+}
+
+static int
+isa_supported(int isa)
+{
+	/* Check processor features (through CPUID instruction, also
+	 * checking that operating system saves respective registers). */
+	switch (isa) {
+#if ISA_DISPATCH
+	case ISA_AVX512F:
+		return __builtin_cpu_supports("avx512f");
+
+	case ISA_AVX2:
+		return __builtin_cpu_supports("avx2");
+
+	case ISA_SSE42:
+		return __builtin_cpu_supports("sse4.2");
+#endif
+
+	default:
+		return 1;
+	}
+}
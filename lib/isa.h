@@ -0,0 +1,63 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ISA_H
+#define ISA_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+/* Vector kernels are compiled for several instruction sets.  */
+#define ISA_DISPATCH 1
+
+/* Attribute compiling function for given instruction set.  Floating
+ * point contraction is disabled, as fused multiply-add instructions
+ * enabled by some instruction sets would change results.  */
+#if defined __clang__
+#define ISA_TARGET(isa) __attribute__ ((target(isa)))
+#else
+#define ISA_TARGET(isa) \
+	__attribute__ ((target(isa), optimize("fp-contract=off")))
+#endif
+#endif
+
+/* Instruction set variants of vector kernels, in order of preference.  */
+enum {
+#if ISA_DISPATCH
+	ISA_AVX512F, ISA_AVX2, ISA_SSE42,
+#endif
+	ISA_GENERIC, ISA_COUNT
+};
+
+/* Return instruction set variant of vector kernels to be used.  Variant
+ * is selected once per process, as most preferred one supported by
+ * processor, unless MATHEVAL_ISA environment variable names other
+ * supported variant.  */
+int             isa_select(void);
+
+/* Return name of given instruction set variant: "avx512f", "avx2",
+ * "sse4.2" or "generic".  */
+char           *isa_name(int isa);
+
+#endif
@@ -0,0 +1,1017 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "common.h"
+#include "jit.h"
+#include "matheval.h"
+
+#if ENABLE_JIT && HAVE_SYS_MMAN_H && defined __x86_64__
+
+#include <math.h>
+#include <sys/mman.h>
+#include "xmath.h"
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/* Numbers of general purpose registers used, as encoded in instructions.
+ * Register rbx holds pointer to variable values, r12 pointer to table of
+ * called functions, r13 index of first point in vector code, and r14
+ * pointer to results in vector code.  */
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RSP 4
+#define RSI 6
+#define RDI 7
+#define R12 12
+#define R13 13
+#define R14 14
+
+/* Pseudo register number denoting RIP-relative addressing, used to
+ * access constant pool (placed in memory right before code).  */
+#define RIP 16
+
+/* Opcodes (following 0F escape byte) of SSE and AVX instructions used. */
+#define LOAD 0x10
+#define STORE 0x11
+#define MOVE 0x28
+#define XOR 0x57
+#define ADD 0x58
+#define MUL 0x59
+#define SUB 0x5c
+#define DIV 0x5e
+
+/* Size of constant pool entry (holding four copies of a value, so that
+ * it could be used as operand of both scalar and vector instructions).  */
+#define ENTRY_SIZE 32
+
+/* Data structure representing memory operand.  */
+typedef struct {
+	int             base;	/* Base register.  */
+	int             index;	/* Index register (scaled by 8), or -1 if
+				 * none.  */
+	int             displacement;	/* Displacement, or constant pool
+					 * offset for RIP-relative
+					 * addressing.  */
+} Operand;
+
+/* Data structure representing state of code generation.  */
+typedef struct {
+	unsigned char  *code;	/* Generated code.  */
+	int             length;	/* Length of generated code.  */
+	int             capacity;	/* Capacity of code buffer.  */
+	unsigned char  *pool;	/* Constant pool.  */
+	int             pool_length;	/* Length of constant pool.  */
+	int             pool_capacity;	/* Capacity of constant pool.  */
+	int            *constants;	/* Offsets of constant pool entries 
+					 * added by add_constant() (as
+					 * opposed to arrays).  */
+	int             constant_count;	/* Number of above offsets.  */
+	int             constant_capacity;	/* Capacity of above
+						 * array.  */
+	int            *relocations;	/* Offsets of displacements in code 
+					 * referencing constant pool.  */
+	int             relocation_count;	/* Number of above
+						 * offsets.  */
+	int             relocation_capacity;	/* Capacity of above
+						 * array.  */
+	void          **functions;	/* Table of called functions.  */
+	int             function_count;	/* Number of called functions. */
+	int             function_capacity;	/* Capacity of above table. 
+						 */
+	Record        **records;	/* Records of function variables.  */
+	int             count;	/* Number of function variables.  */
+	int             vector;	/* Flag set if code for four points is
+				 * generated.  */
+	int             fma;	/* Flag set if fused multiply-add
+				 * instructions available.  */
+	int             depth;	/* Number of temporaries in use.  */
+	int             max_depth;	/* Maximal number of temporaries in 
+					 * use.  */
+} Assembler;
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	unsigned char  *memory;	/* Memory holding constant pool and code. 
+				 */
+	size_t          size;	/* Size of above memory.  */
+	double          (*scalar) (double *values, void **functions);	/* Scalar 
+									 * entry 
+									 * point. 
+									 */
+	void            (*vector) (double **values, long index,
+				   double *results, void **functions);	/* Entry 
+									 * point 
+									 * for 
+									 * four 
+									 * points, 
+									 * or 
+									 * null 
+									 * pointer. 
+									 */
+	void          **functions;	/* Table of called functions.  */
+	int             count;	/* Number of function variables.  */
+} Jit;
+
+/* Append byte to generated code.  */
+static void     emit_byte(Assembler * assembler, int byte);
+
+/* Append 32-bit integer to generated code.  */
+static void     emit_int(Assembler * assembler, int value);
+
+/* Append ModRM byte (and SIB byte and displacement, if needed) encoding
+ * given register and memory operand.  */
+static void     emit_operand(Assembler * assembler, int reg,
+			     Operand * operand);
+
+/* Append scalar (or, in vector code, AVX) floating point instruction
+ * with given opcode, destination register and memory operand.  For AVX
+ * instructions, destination register is also first source register. */
+static void     emit_memory(Assembler * assembler, int opcode, int reg,
+			    Operand * operand);
+
+/* Same as above, with register as second operand.  */
+static void     emit_register(Assembler * assembler, int opcode, int reg,
+			      int rm);
+
+/* Append VEX encoded instruction with given opcode map, prefix (pp
+ * field), W bit, vector length flag, additional source register and
+ * destination register, with memory operand or, if operand is null
+ * pointer, register given by last argument.  */
+static void     emit_vex(Assembler * assembler, int map, int pp, int w,
+			 int l, int vvvv, int opcode, int reg,
+			 Operand * operand, int rm);
+
+/* Append call to given function.  First argument is in register 0,
+ * remaining arguments are memory operands from given array (with
+ * length one less than function arity).  If non-negative, further
+ * arguments are constant pool offset of array of polynomial
+ * coefficients and polynomial degree passed as integer arguments. */
+static void     emit_call(Assembler * assembler, void *function,
+			  int arity, Operand * operands, int coefficients,
+			  int degree);
+
+/* Append entry point prologue and return offset of frame size field.  */
+static int      emit_prologue(Assembler * assembler);
+
+/* Append entry point epilogue, and set frame size in prologue.  */
+static void     emit_epilogue(Assembler * assembler, int frame);
+
+/* Append code calculating value of subtree rooted at given node into
+ * register 0.  */
+static void     generate(Assembler * assembler, Node * node);
+
+/* Initialize memory operand for leaf node (number, constant or
+ * variable).  In vector code, load of variable array pointer is
+ * appended, so that operand should be used immediately.  */
+static void     leaf_operand(Assembler * assembler, Node * node,
+			     Operand * operand);
+
+/* Allocate temporary and initialize memory operand for it.  */
+static void     push_temporary(Assembler * assembler, Operand * operand);
+
+/* Add value to constant pool and return its offset.  */
+static int      add_constant(Assembler * assembler, double value);
+
+/* Add array of values to constant pool and return its offset.  */
+static int      add_array(Assembler * assembler, double *values,
+			  int length);
+
+/* Add function to table of called functions and return its index.  */
+static int      add_function(Assembler * assembler, void *function);
+
+/* Calculate function value using compiled code.  */
+static double   jit_evaluate(void *code, double *values);
+
+/* Calculate function values for batch of points using compiled code.  */
+static void     jit_evaluate_batch(void *code, double **values,
+				   int length, double *results);
+
+/* Destroy compiled code.  */
+static void     jit_destroy(void *code);
+
+Engine         *
+jit_create(Node * root, Record ** records, int count)
+{
+	Assembler       assembler;	/* Code generation state. */
+	Jit            *jit;	/* Compiled function. */
+	Engine         *engine;	/* Engine data structure. */
+	int             frame;	/* Offset of frame size field. */
+	int             vector;	/* Offset of vector entry point. */
+	int             i;	/* Loop counter. */
+
+	/* Initialize code generation state. */
+	assembler.capacity = 256;
+	assembler.code = XMALLOC(unsigned char, assembler.capacity);
+	assembler.length = 0;
+	assembler.pool_capacity = 8 * ENTRY_SIZE;
+	assembler.pool = XMALLOC(unsigned char, assembler.pool_capacity);
+	assembler.pool_length = 0;
+	assembler.constant_capacity = 16;
+	assembler.constants = XMALLOC(int, assembler.constant_capacity);
+	assembler.constant_count = 0;
+	assembler.relocation_capacity = 16;
+	assembler.relocations =
+	    XMALLOC(int, assembler.relocation_capacity);
+	assembler.relocation_count = 0;
+	assembler.function_capacity = 8;
+	assembler.functions =
+	    XMALLOC(void *, assembler.function_capacity);
+	assembler.function_count = 0;
+	assembler.records = records;
+	assembler.count = count;
+	assembler.fma = __builtin_cpu_supports("fma");
+
+	/* Generate scalar entry point. */
+	assembler.vector = FALSE;
+	assembler.depth = assembler.max_depth = 0;
+	frame = emit_prologue(&assembler);
+	generate(&assembler, root);
+	emit_epilogue(&assembler, frame);
+
+	/* Generate vector entry point, if AVX instructions available. */
+	vector = -1;
+	if (__builtin_cpu_supports("avx")) {
+		vector = assembler.length;
+		assembler.vector = TRUE;
+		assembler.depth = assembler.max_depth = 0;
+		frame = emit_prologue(&assembler);
+		generate(&assembler, root);
+		emit_epilogue(&assembler, frame);
+	}
+
+	/* Allocate memory for constant pool and code, copy them there and 
+	 * resolve references to constant pool. */
+	jit = XMALLOC(Jit, 1);
+	jit->size = assembler.pool_length + assembler.length;
+	jit->memory =
+	    mmap(NULL, jit->size, PROT_READ | PROT_WRITE,
+		 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (jit->memory == MAP_FAILED) {
+		XFREE(jit);
+		XFREE(assembler.code);
+		XFREE(assembler.pool);
+		XFREE(assembler.constants);
+		XFREE(assembler.relocations);
+		XFREE(assembler.functions);
+		return NULL;
+	}
+	memcpy(jit->memory, assembler.pool, assembler.pool_length);
+	memcpy(jit->memory + assembler.pool_length, assembler.code,
+	       assembler.length);
+	for (i = 0; i < assembler.relocation_count; i++) {
+		int             offset;	/* Offset of displacement. */
+		int             displacement;	/* Displacement value. */
+
+		offset = assembler.pool_length + assembler.relocations[i];
+		memcpy(&displacement, jit->memory + offset, sizeof(int));
+		displacement -= offset + (int) sizeof(int);
+		memcpy(jit->memory + offset, &displacement, sizeof(int));
+	}
+
+	/* Make memory executable; if not permitted (for example, because 
+	 * of security policy of system), give up on compilation. */
+	if (mprotect(jit->memory, jit->size, PROT_READ | PROT_EXEC)) {
+		munmap(jit->memory, jit->size);
+		XFREE(jit);
+		XFREE(assembler.code);
+		XFREE(assembler.pool);
+		XFREE(assembler.constants);
+		XFREE(assembler.relocations);
+		XFREE(assembler.functions);
+		return NULL;
+	}
+
+	/* Initialize entry points. */
+	jit->scalar =
+	    (double (*)(double *, void **)) (jit->memory +
+					     assembler.pool_length);
+	jit->vector =
+	    (vector < 0) ? NULL : (void (*)(double **, long, double *,
+					    void **)) (jit->memory +
+						       assembler.
+						       pool_length +
+						       vector);
+	jit->functions = assembler.functions;
+	jit->count = count;
+	XFREE(assembler.code);
+	XFREE(assembler.pool);
+	XFREE(assembler.constants);
+	XFREE(assembler.relocations);
+
+	/* Create engine data structure. */
+	engine = XMALLOC(Engine, 1);
+	engine->type = EVALUATOR_ENGINE_JIT;
+	engine->count = count;
+	engine->code = jit;
+	engine->evaluate = jit_evaluate;
+	engine->evaluate_batch = jit_evaluate_batch;
+	engine->destroy = jit_destroy;
+	engine->scalar_code = jit->memory + assembler.pool_length;
+	engine->scalar_size = (vector < 0) ? assembler.length : vector;
+	engine->batch_code =
+	    (vector < 0) ? NULL : jit->memory + assembler.pool_length +
+	    vector;
+	engine->batch_size = (vector < 0) ? 0 : assembler.length - vector;
+
+	return engine;
+}
+
+static void
+emit_byte(Assembler * assembler, int byte)
+{
+	/* Enlarge code buffer if necessary and append byte. */
+	if (assembler->length == assembler->capacity) {
+		assembler->capacity *= 2;
+		assembler->code =
+		    XREALLOC(unsigned char, assembler->code,
+			     assembler->capacity);
+	}
+	assembler->code[assembler->length++] = (unsigned char) byte;
+}
+
+static void
+emit_int(Assembler * assembler, int value)
+{
+	int             i;	/* Loop counter. */
+
+	/* Append bytes of value in little endian order. */
+	for (i = 0; i < 4; i++)
+		emit_byte(assembler, ((unsigned) value >> (8 * i)) & 0xff);
+}
+
+static void
+emit_operand(Assembler * assembler, int reg, Operand * operand)
+{
+	/* For RIP-relative addressing, remember position of displacement, 
+	 * to be resolved when code is placed after constant pool. */
+	if (operand->base == RIP) {
+		emit_byte(assembler, ((reg & 7) << 3) | 5);
+		if (assembler->relocation_count ==
+		    assembler->relocation_capacity) {
+			assembler->relocation_capacity *= 2;
+			assembler->relocations =
+			    XREALLOC(int, assembler->relocations,
+				     assembler->relocation_capacity);
+		}
+		assembler->relocations[assembler->relocation_count++] =
+		    assembler->length;
+		emit_int(assembler, operand->displacement);
+		return;
+	}
+
+	/* Otherwise, always use 32-bit displacement, with SIB byte if
+	 * index register used or if required by base register. */
+	if (operand->index < 0 && (operand->base & 7) != RSP)
+		emit_byte(assembler,
+			  0x80 | ((reg & 7) << 3) | (operand->base & 7));
+	else {
+		emit_byte(assembler, 0x80 | ((reg & 7) << 3) | RSP);
+		if (operand->index < 0)
+			emit_byte(assembler, (RSP << 3) | (operand->base & 7));
+		else
+			emit_byte(assembler,
+				  0xc0 | ((operand->index & 7) << 3) |
+				  (operand->base & 7));
+	}
+	emit_int(assembler, operand->displacement);
+}
+
+static void
+emit_memory(Assembler * assembler, int opcode, int reg, Operand * operand)
+{
+	int             rex;	/* REX prefix bits. */
+
+	/* Use AVX instruction on packed values in vector code. */
+	if (assembler->vector) {
+		emit_vex(assembler, 1, 1, 0, 1,
+			 (opcode == LOAD || opcode == STORE
+			  || opcode == MOVE) ? 0 : reg, opcode, reg,
+			 operand, 0);
+		return;
+	}
+
+	/* Otherwise, use SSE2 instruction on scalar value (except for
+	 * bitwise exclusive or, that exists in packed form only). */
+	rex = 0;
+	if (operand->base != RIP && operand->base >= 8)
+		rex |= 1;
+	if (operand->index >= 8)
+		rex |= 2;
+	emit_byte(assembler, (opcode == XOR || opcode == MOVE) ? 0x66 : 0xf2);
+	if (rex)
+		emit_byte(assembler, 0x40 | rex);
+	emit_byte(assembler, 0x0f);
+	emit_byte(assembler, opcode);
+	emit_operand(assembler, reg, operand);
+}
+
+static void
+emit_register(Assembler * assembler, int opcode, int reg, int rm)
+{
+	/* Use AVX instruction on packed values in vector code. */
+	if (assembler->vector) {
+		emit_vex(assembler, 1, 1, 0, 1,
+			 (opcode == MOVE) ? 0 : reg, opcode, reg, NULL, rm);
+		return;
+	}
+
+	/* Otherwise, use SSE2 instruction on scalar value. */
+	emit_byte(assembler, (opcode == MOVE) ? 0x66 : 0xf2);
+	emit_byte(assembler, 0x0f);
+	emit_byte(assembler, opcode);
+	emit_byte(assembler, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+static void
+emit_vex(Assembler * assembler, int map, int pp, int w, int l, int vvvv,
+	 int opcode, int reg, Operand * operand, int rm)
+{
+	int             x,
+	                b;	/* Extension bits for index and base
+				 * registers. */
+
+	/* Emit three byte VEX prefix, with register extension bits
+	 * inverted. */
+	if (operand) {
+		x = operand->index >= 8;
+		b = operand->base != RIP && operand->base >= 8;
+	} else {
+		x = 0;
+		b = rm >= 8;
+	}
+	emit_byte(assembler, 0xc4);
+	emit_byte(assembler,
+		  ((reg < 8) << 7) | (!x << 6) | (!b << 5) | map);
+	emit_byte(assembler,
+		  (w << 7) | ((~vvvv & 15) << 3) | (l << 2) | pp);
+
+	/* Emit opcode and operands. */
+	emit_byte(assembler, opcode);
+	if (operand)
+		emit_operand(assembler, reg, operand);
+	else
+		emit_byte(assembler, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+static void
+emit_call(Assembler * assembler, void *function, int arity,
+	  Operand * operands, int coefficients, int degree)
+{
+	Operand         temporary;	/* Temporary holding first
+					 * argument and result. */
+	Operand         lane;	/* Operand for single point. */
+	Operand         table;	/* Operand for function table entry. */
+	int             lanes;	/* Number of points. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	table.base = R12;
+	table.index = -1;
+	table.displacement = sizeof(void *) * add_function(assembler,
+							   function);
+
+	/* In vector code, store first argument into temporary, and clear
+	 * upper halves of AVX registers to avoid penalties in called
+	 * function. */
+	lanes = 1;
+	if (assembler->vector) {
+		push_temporary(assembler, &temporary);
+		emit_memory(assembler, STORE, 0, &temporary);
+		emit_byte(assembler, 0xc5);
+		emit_byte(assembler, 0xf8);
+		emit_byte(assembler, 0x77);
+		assembler->vector = FALSE;
+		lanes = 4;
+	}
+
+	/* Call function for each point, with arguments loaded into
+	 * registers, using SSE2 instructions. */
+	for (j = 0; j < lanes; j++) {
+		if (lanes > 1) {
+			lane = temporary;
+			lane.displacement += j * sizeof(double);
+			emit_memory(assembler, LOAD, 0, &lane);
+		}
+		for (i = 0; i < arity - 1; i++) {
+			lane = operands[i];
+			lane.displacement += j * sizeof(double);
+			emit_memory(assembler, LOAD, i + 1, &lane);
+		}
+		if (coefficients >= 0) {
+			/* lea rdi, [rip+coefficients] */
+			lane.base = RIP;
+			lane.index = -1;
+			lane.displacement = coefficients;
+			emit_byte(assembler, 0x48);
+			emit_byte(assembler, 0x8d);
+			emit_operand(assembler, RDI, &lane);
+			/* mov esi, degree */
+			emit_byte(assembler, 0xb8 | RSI);
+			emit_int(assembler, degree);
+		}
+		/* call [r12+index] */
+		emit_byte(assembler, 0x41);
+		emit_byte(assembler, 0xff);
+		emit_operand(assembler, 2, &table);
+		if (lanes > 1) {
+			lane = temporary;
+			lane.displacement += j * sizeof(double);
+			emit_memory(assembler, STORE, 0, &lane);
+		}
+	}
+
+	/* In vector code, load results of all points into register. */
+	if (lanes > 1) {
+		assembler->vector = TRUE;
+		emit_memory(assembler, LOAD, 0, &temporary);
+		assembler->depth--;
+	}
+}
+
+static int
+emit_prologue(Assembler * assembler)
+{
+	int             frame;	/* Offset of frame size field. */
+
+	/* Save callee-saved registers used. */
+	emit_byte(assembler, 0x50 | RBX);
+	emit_byte(assembler, 0x41);
+	emit_byte(assembler, 0x50 | (R12 & 7));
+	emit_byte(assembler, 0x41);
+	emit_byte(assembler, 0x50 | (R13 & 7));
+	emit_byte(assembler, 0x41);
+	emit_byte(assembler, 0x50 | (R14 & 7));
+
+	/* sub rsp, frame (frame size filled in by epilogue) */
+	emit_byte(assembler, 0x48);
+	emit_byte(assembler, 0x81);
+	emit_byte(assembler, 0xec);
+	frame = assembler->length;
+	emit_int(assembler, 0);
+
+	/* Move arguments into callee-saved registers: mov rbx, rdi; and
+	 * mov r12, rsi for scalar code, or mov r13, rsi; mov r14, rdx;
+	 * mov r12, rcx for vector code. */
+	emit_byte(assembler, 0x48);
+	emit_byte(assembler, 0x89);
+	emit_byte(assembler, 0xc0 | (RDI << 3) | RBX);
+	if (!assembler->vector) {
+		emit_byte(assembler, 0x49);
+		emit_byte(assembler, 0x89);
+		emit_byte(assembler, 0xc0 | (RSI << 3) | (R12 & 7));
+	} else {
+		emit_byte(assembler, 0x49);
+		emit_byte(assembler, 0x89);
+		emit_byte(assembler, 0xc0 | (RSI << 3) | (R13 & 7));
+		emit_byte(assembler, 0x49);
+		emit_byte(assembler, 0x89);
+		emit_byte(assembler, 0xc0 | (RDX << 3) | (R14 & 7));
+		emit_byte(assembler, 0x49);
+		emit_byte(assembler, 0x89);
+		emit_byte(assembler, 0xc0 | (RCX << 3) | (R12 & 7));
+	}
+
+	return frame;
+}
+
+static void
+emit_epilogue(Assembler * assembler, int frame)
+{
+	Operand         results;	/* Operand for results. */
+	int             size;	/* Frame size. */
+	int             i;	/* Loop counter. */
+
+	/* In vector code, store results and clear upper halves of AVX
+	 * registers. */
+	if (assembler->vector) {
+		results.base = R14;
+		results.index = -1;
+		results.displacement = 0;
+		emit_memory(assembler, STORE, 0, &results);
+		emit_byte(assembler, 0xc5);
+		emit_byte(assembler, 0xf8);
+		emit_byte(assembler, 0x77);
+	}
+
+	/* Calculate frame size, keeping stack aligned to 16 bytes for
+	 * function calls (four registers and return address are already
+	 * on stack), and set it in prologue. */
+	size = assembler->max_depth * (assembler->vector ? 32 : 8);
+	size = (size + 7) / 16 * 16 + 8;
+	for (i = 0; i < 4; i++)
+		assembler->code[frame + i] = ((unsigned) size >> (8 * i)) & 0xff;
+
+	/* add rsp, frame */
+	emit_byte(assembler, 0x48);
+	emit_byte(assembler, 0x81);
+	emit_byte(assembler, 0xc4);
+	emit_int(assembler, size);
+
+	/* Restore callee-saved registers and return. */
+	emit_byte(assembler, 0x41);
+	emit_byte(assembler, 0x58 | (R14 & 7));
+	emit_byte(assembler, 0x41);
+	emit_byte(assembler, 0x58 | (R13 & 7));
+	emit_byte(assembler, 0x41);
+	emit_byte(assembler, 0x58 | (R12 & 7));
+	emit_byte(assembler, 0x58 | RBX);
+	emit_byte(assembler, 0xc3);
+}
+
+static void
+generate(Assembler * assembler, Node * node)
+{
+	Operand         operand;	/* Memory operand. */
+	Operand         operands[2];	/* Temporaries for function
+					 * arguments. */
+	int             have;	/* Flag set if power accumulated. */
+	int             m;	/* Absolute value of exponent. */
+	int             k;	/* Loop counter. */
+
+	/* According to node type, generate code calculating value of
+	 * subtree rooted at node. */
+	switch (node->type) {
+	case 'n':
+	case 'c':
+	case 'v':
+		leaf_operand(assembler, node, &operand);
+		emit_memory(assembler, LOAD, 0, &operand);
+		break;
+
+	case 'f':
+		/* Call function directly, bypassing symbol table. */
+		generate(assembler, node->data.function.child);
+		emit_call(assembler,
+			  (void *) node->data.function.record->data.
+			  function, 1, NULL, -1, 0);
+		break;
+
+	case 'u':
+		/* Negate value by flipping sign bit. */
+		generate(assembler, node->data.un_op.child);
+		operand.base = RIP;
+		operand.index = -1;
+		operand.displacement = add_constant(assembler, -0.0);
+		emit_memory(assembler, XOR, 0, &operand);
+		break;
+
+	case 'b':
+		/* Exponentiation is calculated by calling function. */
+		if (node->data.bin_op.operation == '^') {
+			generate(assembler, node->data.bin_op.right);
+			push_temporary(assembler, &operands[0]);
+			emit_memory(assembler, STORE, 0, &operands[0]);
+			generate(assembler, node->data.bin_op.left);
+			emit_call(assembler, (void *) math_pow, 2, operands,
+				  -1, 0);
+			assembler->depth--;
+			break;
+		}
+
+		/* For other operations, use right operand directly from
+		 * memory if leaf, or calculate it into temporary
+		 * otherwise. */
+		if (node->data.bin_op.right->type == 'n'
+		    || node->data.bin_op.right->type == 'c'
+		    || node->data.bin_op.right->type == 'v') {
+			generate(assembler, node->data.bin_op.left);
+			leaf_operand(assembler, node->data.bin_op.right,
+				     &operand);
+		} else {
+			generate(assembler, node->data.bin_op.right);
+			push_temporary(assembler, &operand);
+			emit_memory(assembler, STORE, 0, &operand);
+			generate(assembler, node->data.bin_op.left);
+			assembler->depth--;
+		}
+		switch (node->data.bin_op.operation) {
+		case '+':
+			emit_memory(assembler, ADD, 0, &operand);
+			break;
+
+		case '-':
+			emit_memory(assembler, SUB, 0, &operand);
+			break;
+
+		case '*':
+			emit_memory(assembler, MUL, 0, &operand);
+			break;
+
+		case '/':
+			emit_memory(assembler, DIV, 0, &operand);
+			break;
+		}
+		break;
+
+	case 'p':
+		/* Calculate power by repeated squaring, multiplying in
+		 * same order as math_powi() does, keeping base in
+		 * register 1 and accumulated power in register 2. */
+		generate(assembler, node->data.power.child);
+		emit_register(assembler, MOVE, 1, 0);
+		m = abs(node->data.power.exponent);
+		for (have = FALSE; m; m >>= 1) {
+			if (m & 1) {
+				if (have)
+					emit_register(assembler, MUL, 2, 1);
+				else
+					emit_register(assembler, MOVE, 2, 1);
+				have = TRUE;
+			}
+			if (m > 1)
+				emit_register(assembler, MUL, 1, 1);
+		}
+		operand.base = RIP;
+		operand.index = -1;
+		operand.displacement = add_constant(assembler, 1.0);
+		if (!have)
+			emit_memory(assembler, LOAD, 0, &operand);
+		else if (node->data.power.exponent < 0) {
+			emit_memory(assembler, LOAD, 0, &operand);
+			emit_register(assembler, DIV, 0, 2);
+		} else
+			emit_register(assembler, MOVE, 0, 2);
+		break;
+
+	case 'h':
+		generate(assembler, node->data.polynomial.child);
+
+		/* Call function to evaluate higher degree polynomial by
+		 * Estrin scheme. */
+		if (node->data.polynomial.degree >= MATH_ESTRIN_MIN) {
+			emit_call(assembler, (void *) math_estrin, 1, NULL,
+				  add_array(assembler,
+					    node->data.polynomial.
+					    coefficients,
+					    node->data.polynomial.degree +
+					    1), node->data.polynomial.degree);
+			break;
+		}
+
+		/* Otherwise, evaluate polynomial by Horner scheme, same
+		 * as math_horner() does, keeping argument in register 1. */
+		emit_register(assembler, MOVE, 1, 0);
+		operand.base = RIP;
+		operand.index = -1;
+		operand.displacement =
+		    add_constant(assembler,
+				 node->data.polynomial.
+				 coefficients[node->data.polynomial.degree]);
+		emit_memory(assembler, LOAD, 0, &operand);
+		for (k = node->data.polynomial.degree - 1; k >= 0; k--) {
+			emit_register(assembler, MUL, 0, 1);
+			operand.displacement =
+			    add_constant(assembler,
+					 node->data.polynomial.
+					 coefficients[k]);
+			emit_memory(assembler, ADD, 0, &operand);
+		}
+		break;
+
+	case 'm':
+		/* Calculate addend and right multiplication operand into 
+		 * temporaries. */
+		generate(assembler, node->data.muladd.addend);
+		push_temporary(assembler, &operands[1]);
+		emit_memory(assembler, STORE, 0, &operands[1]);
+		generate(assembler, node->data.muladd.right);
+		push_temporary(assembler, &operands[0]);
+		emit_memory(assembler, STORE, 0, &operands[0]);
+		generate(assembler, node->data.muladd.left);
+
+		/* Use fused multiply-add instruction if available
+		 * (vfmadd213sd or vfmadd213pd), or call fma() otherwise. */
+		if (assembler->fma) {
+			emit_memory(assembler, LOAD, 1, &operands[0]);
+			emit_vex(assembler, 2, 1, 1, assembler->vector, 1,
+				 assembler->vector ? 0xa8 : 0xa9, 0,
+				 &operands[1], 0);
+		} else
+			emit_call(assembler, (void *) fma, 3, operands, -1,
+				  0);
+		assembler->depth -= 2;
+		break;
+	}
+}
+
+static void
+leaf_operand(Assembler * assembler, Node * node, Operand * operand)
+{
+	int             i;	/* Loop counter. */
+
+	/* Numbers and constants are taken from constant pool. */
+	if (node->type == 'n' || node->type == 'c') {
+		operand->base = RIP;
+		operand->index = -1;
+		operand->displacement =
+		    add_constant(assembler,
+				 (node->type ==
+				  'n') ? node->data.number : node->data.
+				 constant->data.value);
+		return;
+	}
+
+	/* Find variable index. */
+	for (i = 0; i < assembler->count; i++)
+		if (assembler->records[i] == node->data.variable)
+			break;
+
+	/* In scalar code, variable values are taken from array pointed
+	 * by rbx register. */
+	if (!assembler->vector) {
+		operand->base = RBX;
+		operand->index = -1;
+		operand->displacement = i * sizeof(double);
+		return;
+	}
+
+	/* In vector code, load pointer to array of variable values into
+	 * rax register (mov rax, [rbx+i*8]), and take values from this
+	 * array, indexed by r13 register. */
+	operand->base = RBX;
+	operand->index = -1;
+	operand->displacement = i * sizeof(double *);
+	emit_byte(assembler, 0x48);
+	emit_byte(assembler, 0x8b);
+	emit_operand(assembler, RAX, operand);
+	operand->base = RAX;
+	operand->index = R13;
+	operand->displacement = 0;
+}
+
+static void
+push_temporary(Assembler * assembler, Operand * operand)
+{
+	/* Temporaries are allocated from stack frame. */
+	operand->base = RSP;
+	operand->index = -1;
+	operand->displacement =
+	    assembler->depth * (assembler->vector ? 32 : 8);
+	if (++assembler->depth > assembler->max_depth)
+		assembler->max_depth = assembler->depth;
+}
+
+static int
+add_constant(Assembler * assembler, double value)
+{
+	unsigned char   entry[ENTRY_SIZE];	/* Entry with four copies of 
+						 * value. */
+	int             offset;	/* Constant pool offset. */
+	int             i;	/* Loop counter. */
+
+	/* Build entry with four copies of value. */
+	for (i = 0; i < (int) (ENTRY_SIZE / sizeof(double)); i++)
+		memcpy(entry + i * sizeof(double), &value, sizeof(double));
+
+	/* Look for entry with same value among entries added by this
+	 * function, comparing whole entries bitwise (to distinguish signed
+	 * zeroes); arrays appended by add_array() are skipped, as their
+	 * slots hold different values. */
+	for (i = 0; i < assembler->constant_count; i++)
+		if (!memcmp
+		    (assembler->pool + assembler->constants[i], entry,
+		     ENTRY_SIZE))
+			return assembler->constants[i];
+
+	/* Otherwise, append entry and remember its offset. */
+	if (assembler->pool_length + ENTRY_SIZE > assembler->pool_capacity) {
+		assembler->pool_capacity *= 2;
+		assembler->pool =
+		    XREALLOC(unsigned char, assembler->pool,
+			     assembler->pool_capacity);
+	}
+	if (assembler->constant_count == assembler->constant_capacity) {
+		assembler->constant_capacity *= 2;
+		assembler->constants =
+		    XREALLOC(int, assembler->constants,
+			     assembler->constant_capacity);
+	}
+	offset = assembler->pool_length;
+	memcpy(assembler->pool + offset, entry, ENTRY_SIZE);
+	assembler->pool_length += ENTRY_SIZE;
+	assembler->constants[assembler->constant_count++] = offset;
+	return offset;
+}
+
+static int
+add_array(Assembler * assembler, double *values, int length)
+{
+	int             offset;	/* Constant pool offset. */
+	int             size;	/* Size of array, rounded to entry
+				 * size. */
+
+	/* Append array, keeping constant pool entries aligned. */
+	size = (length * sizeof(double) + ENTRY_SIZE - 1) / ENTRY_SIZE *
+	    ENTRY_SIZE;
+	while (assembler->pool_length + size > assembler->pool_capacity) {
+		assembler->pool_capacity *= 2;
+		assembler->pool =
+		    XREALLOC(unsigned char, assembler->pool,
+			     assembler->pool_capacity);
+	}
+	offset = assembler->pool_length;
+	memset(assembler->pool + offset, 0, size);
+	memcpy(assembler->pool + offset, values, length * sizeof(double));
+	assembler->pool_length += size;
+	return offset;
+}
+
+static int
+add_function(Assembler * assembler, void *function)
+{
+	int             i;	/* Loop counter. */
+
+	/* Look for function in table, and append it if not found. */
+	for (i = 0; i < assembler->function_count; i++)
+		if (assembler->functions[i] == function)
+			return i;
+	if (assembler->function_count == assembler->function_capacity) {
+		assembler->function_capacity *= 2;
+		assembler->functions =
+		    XREALLOC(void *, assembler->functions,
+			     assembler->function_capacity);
+	}
+	assembler->functions[assembler->function_count] = function;
+	return assembler->function_count++;
+}
+
+static double
+jit_evaluate(void *code, double *values)
+{
+	/* Call scalar entry point. */
+	return ((Jit *) code)->scalar(values, ((Jit *) code)->functions);
+}
+
+static void
+jit_evaluate_batch(void *code, double **values, int length,
+		   double *results)
+{
+	Jit            *jit;	/* Compiled function. */
+	double         *point;	/* Variable values for single point. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Use vector entry point for as many points as possible. */
+	jit = (Jit *) code;
+	j = 0;
+	if (jit->vector)
+		for (; j + 4 <= length; j += 4)
+			jit->vector(values, j, results + j, jit->functions);
+
+	/* Use scalar entry point for remaining points. */
+	if (j < length) {
+		point = XMALLOC(double, jit->count + 1);
+		for (; j < length; j++) {
+			for (i = 0; i < jit->count; i++)
+				point[i] = values[i][j];
+			results[j] = jit->scalar(point, jit->functions);
+		}
+		XFREE(point);
+	}
+}
+
+static void
+jit_destroy(void *code)
+{
+	/* Release memory holding code and table of called functions. */
+	munmap(((Jit *) code)->memory, ((Jit *) code)->size);
+	XFREE(((Jit *) code)->functions);
+	XFREE(code);
+}
+
+#else
+
+Engine         *
+jit_create(Node * root, Record ** records, int count)
+{
+	/* Native code compilation not available. */
+	return NULL;
+}
+
+#endif
@@ -0,0 +1,650 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "common.h"
+#include "llvm.h"
+#include "matheval.h"
+
+#if HAVE_LLVM
+
+#include <math.h>
+#include <stdint.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/LLJIT.h>
+#include <llvm-c/Orc.h>
+#include <llvm-c/Target.h>
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+#include "xmath.h"
+
+/* Data structure representing state of code generation.  */
+typedef struct {
+	LLVMContextRef  context;	/* LLVM context.  */
+	LLVMModuleRef   module;	/* Module being generated.  */
+	LLVMBuilderRef  builder;	/* Instruction builder.  */
+	LLVMTypeRef     type;	/* Floating point type.  */
+	Record        **records;	/* Records of function variables.  */
+	int             count;	/* Number of function variables.  */
+	LLVMValueRef   *values;	/* Values of function variables.  */
+} Generator;
+
+/* Data structure representing compiled function.  */
+typedef struct {
+	LLVMOrcLLJITRef jit;	/* Just-in-time compiler holding code.  */
+	double          (*scalar) (double *values);	/* Scalar entry
+							 * point.  */
+	void            (*batch) (double **values, int64_t length,
+				  double *results);	/* Batch entry
+							 * point.  */
+} Llvm;
+
+/* Generate scalar entry point, reading variable values from array.  */
+static void     generate_scalar(Generator * generator, Node * root);
+
+/* Generate batch entry point, looping over arrays of variable values.  */
+static void     generate_batch(Generator * generator, Node * root);
+
+/* Generate instructions calculating value of subtree rooted at given
+ * node, and return resulting value.  */
+static LLVMValueRef generate(Generator * generator, Node * node);
+
+/* Generate call to function at given address, with given arguments.
+ * Polynomial evaluation function, taking pointer to coefficients and
+ * degree as additional arguments, is called if last argument set.  */
+static LLVMValueRef generate_call(Generator * generator, void *function,
+				  LLVMValueRef * arguments, int count,
+				  int polynomial);
+
+/* Generate call to intrinsic with given name, with given arguments.  */
+static LLVMValueRef generate_intrinsic(Generator * generator,
+				       char *name,
+				       LLVMValueRef * arguments,
+				       int count);
+
+/* Create target machine for processor library running on.  */
+static LLVMTargetMachineRef target_machine_create(void);
+
+/* Calculate function value using compiled code.  */
+static double   llvm_evaluate(void *code, double *values);
+
+/* Calculate function values for batch of points using compiled code.  */
+static void     llvm_evaluate_batch(void *code, double **values,
+				    int length, double *results);
+
+/* Destroy compiled code.  */
+static void     llvm_destroy(void *code);
+
+Engine         *
+llvm_create(Node * root, Record ** records, int count)
+{
+	static int      initialized = FALSE;	/* Flag set if LLVM
+						 * initialized.  */
+	Generator       generator;	/* Code generation state. */
+	LLVMOrcThreadSafeContextRef context;	/* Context owning
+						 * module. */
+	LLVMOrcLLJITBuilderRef builder;	/* Just-in-time compiler
+					 * builder. */
+	LLVMOrcDefinitionGeneratorRef process;	/* Process symbols
+						 * resolver. */
+	LLVMOrcExecutorAddress address;	/* Entry point address. */
+	LLVMTargetMachineRef machine;	/* Target machine. */
+	LLVMTargetDataRef layout;	/* Target data layout. */
+	LLVMPassBuilderOptionsRef options;	/* Optimization options. */
+	LLVMErrorRef    error;	/* Error returned by LLVM. */
+	Llvm           *llvm;	/* Compiled function. */
+	Engine         *engine;	/* Engine data structure. */
+	char           *string;	/* Target description. */
+
+	/* Initialize LLVM native target on first use. */
+	if (!initialized) {
+		if (LLVMInitializeNativeTarget()
+		    || LLVMInitializeNativeAsmPrinter())
+			return NULL;
+		initialized = TRUE;
+	}
+
+	/* Create module in new context, targeting processor library
+	 * running on. */
+	machine = target_machine_create();
+	if (!machine)
+		return NULL;
+	context = LLVMOrcCreateNewThreadSafeContext();
+	generator.context = LLVMOrcThreadSafeContextGetContext(context);
+	generator.module =
+	    LLVMModuleCreateWithNameInContext("matheval", generator.context);
+	generator.builder = LLVMCreateBuilderInContext(generator.context);
+	generator.type = LLVMDoubleTypeInContext(generator.context);
+	generator.records = records;
+	generator.count = count;
+	generator.values = XMALLOC(LLVMValueRef, count + 1);
+	string = LLVMGetTargetMachineTriple(machine);
+	LLVMSetTarget(generator.module, string);
+	LLVMDisposeMessage(string);
+	layout = LLVMCreateTargetDataLayout(machine);
+	LLVMSetModuleDataLayout(generator.module, layout);
+	LLVMDisposeTargetData(layout);
+
+	/* Generate entry points. */
+	generate_scalar(&generator, root);
+	generate_batch(&generator, root);
+	LLVMDisposeBuilder(generator.builder);
+	XFREE(generator.values);
+
+	/* Optimize module, with loop and straight-line code
+	 * vectorization. */
+	options = LLVMCreatePassBuilderOptions();
+	LLVMPassBuilderOptionsSetLoopVectorization(options, TRUE);
+	LLVMPassBuilderOptionsSetSLPVectorization(options, TRUE);
+	error =
+	    LLVMRunPasses(generator.module, "default<O3>", machine, options);
+	LLVMDisposePassBuilderOptions(options);
+	if (error) {
+		LLVMConsumeError(error);
+		LLVMDisposeModule(generator.module);
+		LLVMOrcDisposeThreadSafeContext(context);
+		LLVMDisposeTargetMachine(machine);
+		return NULL;
+	}
+
+	/* Create just-in-time compiler for same target machine, able to
+	 * resolve symbols from process (needed for library calls
+	 * generated for intrinsics). */
+	llvm = XMALLOC(Llvm, 1);
+	llvm->jit = NULL;
+	builder = LLVMOrcCreateLLJITBuilder();
+	LLVMOrcLLJITBuilderSetJITTargetMachineBuilder(builder,
+						      LLVMOrcJITTargetMachineBuilderCreateFromTargetMachine
+						      (machine));
+	error = LLVMOrcCreateLLJIT(&llvm->jit, builder);
+	if (!error) {
+		error =
+		    LLVMOrcCreateDynamicLibrarySearchGeneratorForProcess
+		    (&process, LLVMOrcLLJITGetGlobalPrefix(llvm->jit), NULL,
+		     NULL);
+		if (!error)
+			LLVMOrcJITDylibAddGenerator
+			    (LLVMOrcLLJITGetMainJITDylib(llvm->jit), process);
+	}
+
+	/* Compile module and look up entry points. */
+	if (!error)
+		error =
+		    LLVMOrcLLJITAddLLVMIRModule(llvm->jit,
+						LLVMOrcLLJITGetMainJITDylib
+						(llvm->jit),
+						LLVMOrcCreateNewThreadSafeModule
+						(generator.module, context));
+	else
+		LLVMDisposeModule(generator.module);
+	LLVMOrcDisposeThreadSafeContext(context);
+	if (!error) {
+		error = LLVMOrcLLJITLookup(llvm->jit, &address, "evaluate");
+		llvm->scalar = (double (*)(double *)) (uintptr_t) address;
+	}
+	if (!error) {
+		error =
+		    LLVMOrcLLJITLookup(llvm->jit, &address,
+				       "evaluate_batch");
+		llvm->batch =
+		    (void (*)(double **, int64_t, double *)) (uintptr_t)
+		    address;
+	}
+	if (error) {
+		LLVMConsumeError(error);
+		llvm_destroy(llvm);
+		return NULL;
+	}
+
+	/* Create engine data structure. */
+	engine = XMALLOC(Engine, 1);
+	engine->type = EVALUATOR_ENGINE_LLVM;
+	engine->count = count;
+	engine->code = llvm;
+	engine->evaluate = llvm_evaluate;
+	engine->evaluate_batch = llvm_evaluate_batch;
+	engine->destroy = llvm_destroy;
+	engine->scalar_code = engine->batch_code = NULL;
+	engine->scalar_size = engine->batch_size = 0;
+
+	return engine;
+}
+
+static void
+generate_scalar(Generator * generator, Node * root)
+{
+	LLVMTypeRef     pointer;	/* Type of pointer to values. */
+	LLVMValueRef    function;	/* Function generated. */
+	LLVMValueRef    index;	/* Variable index. */
+	int             i;	/* Loop counter. */
+
+	/* Declare function taking pointer to variable values. */
+	pointer = LLVMPointerType(generator->type, 0);
+	function =
+	    LLVMAddFunction(generator->module, "evaluate",
+			    LLVMFunctionType(generator->type, &pointer, 1,
+					     FALSE));
+	LLVMPositionBuilderAtEnd(generator->builder,
+				 LLVMAppendBasicBlockInContext(generator->
+							       context,
+							       function,
+							       "entry"));
+
+	/* Load variable values, calculate function value and return it. */
+	for (i = 0; i < generator->count; i++) {
+		index =
+		    LLVMConstInt(LLVMInt64TypeInContext(generator->context),
+				 i, FALSE);
+		generator->values[i] =
+		    LLVMBuildLoad2(generator->builder, generator->type,
+				   LLVMBuildGEP2(generator->builder,
+						 generator->type,
+						 LLVMGetParam(function, 0),
+						 &index, 1, ""), "");
+	}
+	LLVMBuildRet(generator->builder, generate(generator, root));
+}
+
+static void
+generate_batch(Generator * generator, Node * root)
+{
+	LLVMTypeRef     integer;	/* Type of point index. */
+	LLVMTypeRef     pointer;	/* Type of pointer to values. */
+	LLVMTypeRef     types[3];	/* Types of function arguments. */
+	LLVMValueRef    function;	/* Function generated. */
+	LLVMValueRef   *columns;	/* Pointers to arrays of variable
+					 * values. */
+	LLVMValueRef    index;	/* Point index. */
+	LLVMValueRef    next;	/* Next point index. */
+	LLVMValueRef    value;	/* Function value. */
+	LLVMValueRef    zero;	/* Initial point index. */
+	LLVMBasicBlockRef entry,
+	                loop,
+	                exit;	/* Function basic blocks. */
+	int             i;	/* Loop counter. */
+
+	/* Declare function taking array of pointers to arrays of variable 
+	 * values, number of points and pointer to array for results (not
+	 * aliasing variable values). */
+	integer = LLVMInt64TypeInContext(generator->context);
+	pointer = LLVMPointerType(generator->type, 0);
+	types[0] = LLVMPointerType(pointer, 0);
+	types[1] = integer;
+	types[2] = pointer;
+	function =
+	    LLVMAddFunction(generator->module, "evaluate_batch",
+			    LLVMFunctionType(LLVMVoidTypeInContext
+					     (generator->context), types, 3,
+					     FALSE));
+	LLVMAddAttributeAtIndex(function, 3,
+				LLVMCreateEnumAttribute(generator->context,
+							LLVMGetEnumAttributeKindForName
+							("noalias", 7), 0));
+	entry =
+	    LLVMAppendBasicBlockInContext(generator->context, function,
+					  "entry");
+	loop =
+	    LLVMAppendBasicBlockInContext(generator->context, function,
+					  "loop");
+	exit =
+	    LLVMAppendBasicBlockInContext(generator->context, function,
+					  "exit");
+
+	/* Load pointers to arrays of variable values and skip loop if no 
+	 * points given. */
+	LLVMPositionBuilderAtEnd(generator->builder, entry);
+	columns = XMALLOC(LLVMValueRef, generator->count + 1);
+	for (i = 0; i < generator->count; i++) {
+		index = LLVMConstInt(integer, i, FALSE);
+		columns[i] =
+		    LLVMBuildLoad2(generator->builder, pointer,
+				   LLVMBuildGEP2(generator->builder, pointer,
+						 LLVMGetParam(function, 0),
+						 &index, 1, ""), "");
+	}
+	zero = LLVMConstInt(integer, 0, FALSE);
+	LLVMBuildCondBr(generator->builder,
+			LLVMBuildICmp(generator->builder, LLVMIntSGT,
+				      LLVMGetParam(function, 1), zero, ""),
+			loop, exit);
+
+	/* In loop body, load variable values for current point,
+	 * calculate function value and store it. */
+	LLVMPositionBuilderAtEnd(generator->builder, loop);
+	index = LLVMBuildPhi(generator->builder, integer, "");
+	for (i = 0; i < generator->count; i++)
+		generator->values[i] =
+		    LLVMBuildLoad2(generator->builder, generator->type,
+				   LLVMBuildGEP2(generator->builder,
+						 generator->type, columns[i],
+						 &index, 1, ""), "");
+	value = generate(generator, root);
+	LLVMBuildStore(generator->builder, value,
+		       LLVMBuildGEP2(generator->builder, generator->type,
+				     LLVMGetParam(function, 2), &index, 1,
+				     ""));
+	next =
+	    LLVMBuildAdd(generator->builder, index,
+			 LLVMConstInt(integer, 1, FALSE), "");
+	LLVMBuildCondBr(generator->builder,
+			LLVMBuildICmp(generator->builder, LLVMIntSLT, next,
+				      LLVMGetParam(function, 1), ""), loop,
+			exit);
+	LLVMAddIncoming(index, &zero, &entry, 1);
+	LLVMAddIncoming(index, &next, &loop, 1);
+	XFREE(columns);
+
+	/* Return from function. */
+	LLVMPositionBuilderAtEnd(generator->builder, exit);
+	LLVMBuildRetVoid(generator->builder);
+}
+
+static LLVMValueRef
+generate(Generator * generator, Node * node)
+{
+	LLVMValueRef    arguments[3];	/* Function call arguments. */
+	LLVMValueRef    base;	/* Base of power. */
+	LLVMValueRef    power;	/* Accumulated power. */
+	LLVMValueRef    value;	/* Resulting value. */
+	int             m;	/* Absolute value of exponent. */
+	int             i;	/* Loop counter. */
+
+	/* According to node type, generate instructions calculating value 
+	 * of subtree rooted at node. */
+	switch (node->type) {
+	case 'n':
+		return LLVMConstReal(generator->type, node->data.number);
+
+	case 'c':
+		return LLVMConstReal(generator->type,
+				     node->data.constant->data.value);
+
+	case 'v':
+		for (i = 0; i < generator->count; i++)
+			if (generator->records[i] == node->data.variable)
+				break;
+		return generator->values[i];
+
+	case 'f':
+		/* Use intrinsics for square root and absolute value, so
+		 * that these could be inlined and vectorized, and call
+		 * other functions directly. */
+		arguments[0] = generate(generator, node->data.function.child);
+		if (node->data.function.record->data.function == sqrt)
+			return generate_intrinsic(generator, "llvm.sqrt",
+						  arguments, 1);
+		if (node->data.function.record->data.function == fabs)
+			return generate_intrinsic(generator, "llvm.fabs",
+						  arguments, 1);
+		return generate_call(generator,
+				     (void *) node->data.function.record->
+				     data.function, arguments, 1, FALSE);
+
+	case 'u':
+		return LLVMBuildFNeg(generator->builder,
+				     generate(generator,
+					      node->data.un_op.child), "");
+
+	case 'b':
+		arguments[0] = generate(generator, node->data.bin_op.left);
+		arguments[1] = generate(generator, node->data.bin_op.right);
+		switch (node->data.bin_op.operation) {
+		case '+':
+			return LLVMBuildFAdd(generator->builder, arguments[0],
+					     arguments[1], "");
+
+		case '-':
+			return LLVMBuildFSub(generator->builder, arguments[0],
+					     arguments[1], "");
+
+		case '*':
+			return LLVMBuildFMul(generator->builder, arguments[0],
+					     arguments[1], "");
+
+		case '/':
+			return LLVMBuildFDiv(generator->builder, arguments[0],
+					     arguments[1], "");
+
+		case '^':
+			return generate_call(generator, (void *) math_pow,
+					     arguments, 2, FALSE);
+		}
+		break;
+
+	case 'p':
+		/* Calculate power by repeated squaring, multiplying in
+		 * same order as math_powi() does. */
+		base = generate(generator, node->data.power.child);
+		power = NULL;
+		for (m = abs(node->data.power.exponent); m; m >>= 1) {
+			if (m & 1)
+				power =
+				    power ? LLVMBuildFMul(generator->builder,
+							  power, base,
+							  "") : base;
+			if (m > 1)
+				base =
+				    LLVMBuildFMul(generator->builder, base,
+						  base, "");
+		}
+		value = LLVMConstReal(generator->type, 1);
+		if (!power)
+			return value;
+		if (node->data.power.exponent < 0)
+			return LLVMBuildFDiv(generator->builder, value, power,
+					     "");
+		return power;
+
+	case 'h':
+		arguments[0] =
+		    generate(generator, node->data.polynomial.child);
+
+		/* Call function to evaluate higher degree polynomial by
+		 * Estrin scheme, with coefficients placed into module as
+		 * constant array. */
+		if (node->data.polynomial.degree >= MATH_ESTRIN_MIN) {
+			LLVMValueRef   *coefficients;	/* Coefficient
+							 * values. */
+			LLVMValueRef    array;	/* Coefficients array. */
+
+			coefficients =
+			    XMALLOC(LLVMValueRef,
+				    node->data.polynomial.degree + 1);
+			for (i = 0; i <= node->data.polynomial.degree; i++)
+				coefficients[i] =
+				    LLVMConstReal(generator->type,
+						  node->data.polynomial.
+						  coefficients[i]);
+			array =
+			    LLVMAddGlobal(generator->module,
+					  LLVMArrayType(generator->type,
+							node->data.
+							polynomial.degree +
+							1), "");
+			LLVMSetInitializer(array,
+					   LLVMConstArray(generator->type,
+							  coefficients,
+							  node->data.
+							  polynomial.degree +
+							  1));
+			LLVMSetGlobalConstant(array, TRUE);
+			LLVMSetLinkage(array, LLVMPrivateLinkage);
+			XFREE(coefficients);
+			arguments[1] =
+			    LLVMConstBitCast(array,
+					     LLVMPointerType(generator->type,
+							     0));
+			arguments[2] =
+			    LLVMConstInt(LLVMInt32TypeInContext
+					 (generator->context),
+					 node->data.polynomial.degree, FALSE);
+			return generate_call(generator, (void *) math_estrin,
+					     arguments, 3, TRUE);
+		}
+
+		/* Otherwise, evaluate polynomial by Horner scheme, same
+		 * as math_horner() does. */
+		value =
+		    LLVMConstReal(generator->type,
+				  node->data.polynomial.coefficients[node->
+								     data.
+								     polynomial.
+								     degree]);
+		for (i = node->data.polynomial.degree - 1; i >= 0; i--)
+			value =
+			    LLVMBuildFAdd(generator->builder,
+					  LLVMBuildFMul(generator->builder,
+							value, arguments[0],
+							""),
+					  LLVMConstReal(generator->type,
+							node->data.polynomial.
+							coefficients[i]), "");
+		return value;
+
+	case 'm':
+		arguments[0] = generate(generator, node->data.muladd.left);
+		arguments[1] = generate(generator, node->data.muladd.right);
+		arguments[2] =
+		    generate(generator, node->data.muladd.addend);
+		return generate_intrinsic(generator, "llvm.fma", arguments,
+					  3);
+	}
+
+	return NULL;
+}
+
+static LLVMValueRef
+generate_call(Generator * generator, void *function,
+	      LLVMValueRef * arguments, int count, int polynomial)
+{
+	LLVMTypeRef     types[3];	/* Types of function arguments. */
+	LLVMTypeRef     type;	/* Function type. */
+	int             i;	/* Loop counter. */
+
+	/* Determine function type. */
+	for (i = 0; i < count; i++)
+		types[i] = generator->type;
+	if (polynomial) {
+		types[1] = LLVMPointerType(generator->type, 0);
+		types[2] = LLVMInt32TypeInContext(generator->context);
+	}
+	type = LLVMFunctionType(generator->type, types, count, FALSE);
+
+	/* Call function through its address. */
+	return LLVMBuildCall2(generator->builder, type,
+			      LLVMConstIntToPtr(LLVMConstInt
+						(LLVMInt64TypeInContext
+						 (generator->context),
+						 (uintptr_t) function, FALSE),
+						LLVMPointerType(type, 0)),
+			      arguments, count, "");
+}
+
+static LLVMValueRef
+generate_intrinsic(Generator * generator, char *name,
+		   LLVMValueRef * arguments, int count)
+{
+	unsigned        id;	/* Intrinsic identifier. */
+
+	/* Declare intrinsic overloaded for floating point type, and call
+	 * it. */
+	id = LLVMLookupIntrinsicID(name, strlen(name));
+	return LLVMBuildCall2(generator->builder,
+			      LLVMIntrinsicGetType(generator->context, id,
+						   &generator->type, 1),
+			      LLVMGetIntrinsicDeclaration(generator->module,
+							  id,
+							  &generator->type,
+							  1), arguments,
+			      count, "");
+}
+
+static LLVMTargetMachineRef
+target_machine_create(void)
+{
+	LLVMTargetRef   target;	/* Target. */
+	LLVMTargetMachineRef machine;	/* Target machine. */
+	char           *triple;	/* Target triple. */
+	char           *cpu;	/* Processor name. */
+	char           *features;	/* Processor features. */
+
+	/* Create target machine for processor library running on, with
+	 * all of its features enabled.  Null pointer is returned if
+	 * target not supported by LLVM. */
+	triple = LLVMGetDefaultTargetTriple();
+	cpu = LLVMGetHostCPUName();
+	features = LLVMGetHostCPUFeatures();
+	machine = NULL;
+	if (!LLVMGetTargetFromTriple(triple, &target, NULL))
+		machine =
+		    LLVMCreateTargetMachine(target, triple, cpu, features,
+					    LLVMCodeGenLevelAggressive,
+					    LLVMRelocDefault,
+					    LLVMCodeModelJITDefault);
+	LLVMDisposeMessage(triple);
+	LLVMDisposeMessage(cpu);
+	LLVMDisposeMessage(features);
+
+	return machine;
+}
+
+static double
+llvm_evaluate(void *code, double *values)
+{
+	/* Call scalar entry point. */
+	return ((Llvm *) code)->scalar(values);
+}
+
+static void
+llvm_evaluate_batch(void *code, double **values, int length,
+		    double *results)
+{
+	/* Call batch entry point. */
+	((Llvm *) code)->batch(values, length, results);
+}
+
+static void
+llvm_destroy(void *code)
+{
+	/* Destroy just-in-time compiler, releasing compiled code. */
+	if (((Llvm *) code)->jit)
+		LLVMOrcDisposeLLJIT(((Llvm *) code)->jit);
+	XFREE(code);
+}
+
+#else
+
+Engine         *
+llvm_create(Node * root, Record ** records, int count)
+{
+	/* Library built without LLVM support. */
+	(void) root;
+	(void) records;
+	(void) count;
+	return NULL;
+}
+
+#endif
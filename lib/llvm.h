@@ -0,0 +1,40 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LLVM_H
+#define LLVM_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "engine.h"
+
+/* Compile function represented by tree rooted at given node through LLVM 
+ * just-in-time compiler, optimizing code for processor library running
+ * on.  Further arguments are array of symbol table records of function
+ * variables and its length.  Function returns pointer to compiled
+ * function, or null pointer if library built without LLVM support or
+ * compilation failed.  */
+Engine         *llvm_create(Node * root, Record ** records, int count);
+
+#endif
@@ -23,14 +23,54 @@
 #include "config.h"
 #endif
 
+#include <limits.h>
+#include <time.h>
+#if HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include "bytecode.h"
+#include "cmplx.h"
 #include "common.h"
+#include "codegen.h"
+#include "compiler.h"
+#include "ddouble.h"
+#include "engine.h"
+#include "fixed.h"
+#include "group.h"
+#include "incremental.h"
+#include "interval.h"
+#include "isa.h"
 #include "matheval.h"
+#include "memo.h"
 #include "node.h"
+#include "perf.h"
 #include "symbol_table.h"
 
 /* Minimal length of evaluator symbol table.  */
 #define MIN_TABLE_LENGTH 211
 
+/* Largest number of variables for which tuple of their values is kept on 
+ * stack while looking up memoized function value.  */
+#define MEMO_KEY_LENGTH 16
+
+/* Number of evaluated points between checks if compilation in
+ * background thread finished.  */
+#define TIER_POLL_INTERVAL 64
+
+/* Length of table of autotuning decisions.  */
+#define DECISION_TABLE_LENGTH 256
+
+/* Minimal duration, in seconds, of single autotuning measurement.  */
+#define AUTOTUNE_DURATION 2e-4
+
+/* Number of autotuning measurements for each engine and batch width,
+ * shortest one being used.  */
+#define AUTOTUNE_TRIALS 5
+
+/* Maximal length of textual representation of function included in
+ * names of symbols announced to perf profiler.  */
+#define PERF_NAME_LENGTH 48
+
 /* Function used to parse string representing function (this function is
  * generated by parser generator). */
 extern int      yyparse();
@@ -53,10 +93,203 @@ typedef struct {
 	int             count;	/* Number of evaluator variables. */
 	char          **names;	/* Array of pointers to evaluator variable 
 				 * names. */
+	Record        **records;	/* Array of symbol table records of
+					 * evaluator variables. */
+	int             flags;	/* Evaluator flags. */
+	Engine         *engine;	/* Compiled function, or null pointer if 
+				 * tree representation of function used
+				 * for evaluation. */
+	double         *values;	/* Array of variable values passed to
+				 * compiled function. */
+	long            calls;	/* Number of points evaluated. */
+	long            threshold;	/* Number of points evaluated
+					 * after which evaluator should be
+					 * considered for promotion. */
+	int             tier;	/* Tier of compiled function used. */
+	int             level;	/* Highest tier promotion attempted to. */
+#if HAVE_PTHREAD
+	int             compiling;	/* Flag set if function compiled
+					 * in background thread. */
+	pthread_t       thread;	/* Background compilation thread. */
+	pthread_mutex_t mutex;	/* Mutex protecting following two
+				 * members. */
+	int             compiled;	/* Flag set if background
+					 * compilation finished. */
+	Engine         *engine_compiled;	/* Function compiled in
+						 * background, or null
+						 * pointer if compilation
+						 * failed. */
+#endif
+	int             width;	/* Number of points evaluated by single
+				 * call of compiled batch function, or zero 
+				 * if not limited. */
+	int             autotuned;	/* Flag set if engine selected by
+					 * autotuning. */
+	double          time;	/* Time per point, in nanoseconds,
+				 * measured by autotuning. */
+	Engine         *engine_float;	/* Bytecode used for single
+					 * precision evaluation, or null
+					 * pointer if not compiled yet. */
+	void           *ddouble;	/* Function compiled for
+					 * double-double evaluation, or
+					 * null pointer if not compiled
+					 * yet. */
+	void           *cmplx;	/* Function compiled for complex
+				 * evaluation, or null pointer if not
+				 * compiled yet. */
+	void           *interval;	/* Function compiled for interval
+					 * evaluation, or null pointer if
+					 * not compiled yet. */
+	void           *fixed;	/* Function compiled for fixed-point
+				 * evaluation, or null pointer if not
+				 * compiled yet. */
+	int             fixed_bits;	/* Number of bits of fixed-point
+					 * word. */
+	int             fixed_fraction;	/* Number of fraction bits of
+					 * fixed-point word. */
+	int             fixed_flags;	/* Fixed-point rounding and
+					 * overflow flags. */
+	void           *incremental;	/* Function prepared for
+					 * incremental evaluation, or null
+					 * pointer if not prepared yet. */
+	void           *memo;	/* Table of memoized function values, or
+				 * null pointer if memoization disabled. */
 } Evaluator;
 
+/* Data structure representing autotuning decision, remembered for
+ * reuse by evaluators with functions of same structure.  */
+typedef struct {
+	int             used;	/* Flag set if entry used. */
+	unsigned long   hash;	/* Hash value of function structure. */
+	int             flags;	/* Evaluator flags. */
+	int             length;	/* Number of points in sample batch. */
+	int             engine;	/* Engine selected. */
+	int             width;	/* Batch width selected. */
+	double          time;	/* Time per point measured, in
+				 * nanoseconds. */
+} Decision;
+
+/* Tiered execution settings: numbers of points evaluated after which
+ * evaluators are promoted to baseline and optimized tier (zero if
+ * promotion disabled), engine used for optimized tier and flag set if
+ * optimized tier compilation done in background thread.  */
+static long     tier_baseline = 0;
+static long     tier_optimized = 0;
+static int      tier_engine = EVALUATOR_ENGINE_LLVM;
+static int      tier_asynchronous = FALSE;
+
+/* Table of autotuning decisions, indexed by hash value of function
+ * structure.  */
+static Decision decisions[DECISION_TABLE_LENGTH];
+
+#if HAVE_PTHREAD
+/* Mutex serializing compilations, as engines are not required to be
+ * reentrant.  */
+static pthread_mutex_t compile_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Mutex protecting table of autotuning decisions.  */
+static pthread_mutex_t decision_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* Allocate memory for and initialize evaluator data structure for
+ * function given by tree representation and symbol table. */
+static Evaluator *evaluator_new(Node * root, SymbolTable * symbol_table,
+				int flags);
+
+/* Prepare simplified tree representation of function for evaluation,
+ * according to evaluator flags. */
+static Node    *evaluator_lower(Node * root, SymbolTable * symbol_table,
+				int flags);
+
+/* Calculate function value for current values of variables in symbol
+ * table, promoting evaluator to higher tier if needed. */
+static double   evaluator_calculate(Evaluator * evaluator);
+
+/* Return memoized function value for variable values given as for
+ * evaluator_evaluate(), calculating and memoizing it if not found. */
+static double   evaluator_memoize(Evaluator * evaluator, int count,
+				  char **names, double *values);
+
+/* Compile function represented by evaluator using engine of given type. 
+ */
+static Engine  *evaluator_compile(Evaluator * evaluator, int engine);
+
+/* Announce compiled function to perf profiler, with symbols named after 
+ * hash value and beginning of textual representation of function. */
+static void     evaluator_announce(Evaluator * evaluator, Engine * engine);
+
+/* Replace compiled function used by evaluator with given one, that
+ * belongs to given tier (null pointer means using tree representation
+ * of function). */
+static void     evaluator_install(Evaluator * evaluator, Engine * engine,
+				  int tier);
+
+/* Promote evaluator to higher tier if number of points evaluated
+ * reached respective threshold, and calculate next threshold. */
+static void     evaluator_promote(Evaluator * evaluator);
+
+/* Wait for background compilation, if any, to finish and discard its
+ * result. */
+static void     evaluator_cancel(Evaluator * evaluator);
+
+/* Map evaluator variables to ones given by names of given count (last
+ * one taken if name repeated).  Function returns array of indices of
+ * given names, ordered as evaluator variables, with -1 for variables
+ * not given. */
+static int     *evaluator_map(Evaluator * evaluator, int count,
+			      char **names);
+
+/* Gather arrays of values of evaluator variables, given array of
+ * indices as above and arrays of values of given variables, for batch
+ * of points of given length.  For variables not given, arrays are
+ * allocated and filled with their current values, each value followed
+ * by given number of zeros less one. */
+static double **evaluator_gather(Evaluator * evaluator, int *map,
+				 double **values, int length,
+				 int stride);
+
+/* Free arrays of variable values as gathered above, or as gathered
+ * likewise for other types of values. */
+static void     evaluator_release(Evaluator * evaluator, int *map,
+				  void **columns);
+
+/* Evaluate function for batch of points, given by arrays of variable
+ * values ordered as evaluator variables, using given compiled function
+ * (null pointer means tree representation of function).  Compiled batch
+ * function is called for at most given number of points at once; if
+ * this number is one, points are evaluated one by one using compiled
+ * scalar function. */
+static void     evaluator_run(Evaluator * evaluator, Engine * engine,
+			      double **columns, int length, int width,
+			      double *results);
+
+/* Measure time per point, in nanoseconds, of evaluating function for
+ * batch of points as above. */
+static double   evaluator_measure(Evaluator * evaluator, Engine * engine,
+				  double **columns, int length, int width,
+				  double *results);
+
+/* Return current time in seconds, relative to unspecified origin. */
+static double   clock_seconds(void);
+
+#if HAVE_PTHREAD
+/* Background compilation thread function, argument is evaluator. */
+static void    *evaluator_compile_thread(void *evaluator);
+#endif
+
+/* Compare symbol table records given by pointers to them by name (used
+ * for sorting). */
+static int      record_compare(const void *first, const void *second);
+
 void           *
 evaluator_create(char *string)
+{
+	/* Create evaluator without any flags set. */
+	return evaluator_create_flags(string, 0);
+}
+
+void           *
+evaluator_create_flags(char *string, int flags)
 {
 	Evaluator      *evaluator;	/* Evaluator representing function 
 					 * given by string.  */
@@ -90,16 +323,12 @@ evaluator_create(char *string)
 		return NULL;
         }
 
-	/* Simplify tree represention of function. */
-	root = node_simplify(root);
+	/* Simplify tree represention of function and prepare it for
+	 * evaluation. */
+	root = evaluator_lower(node_simplify(root), symbol_table, flags);
 
 	/* Allocate memory for and initialize evaluator data structure. */
-	evaluator = XMALLOC(Evaluator, 1);
-	evaluator->root = root;
-	evaluator->symbol_table = symbol_table;
-	evaluator->string = NULL;
-	evaluator->count = 0;
-	evaluator->names = NULL;
+	evaluator = evaluator_new(root, symbol_table, flags);
 
 	return evaluator;
 }
@@ -107,13 +336,29 @@ evaluator_create(char *string)
 void
 evaluator_destroy(void *evaluator)
 {
-	/* Destroy tree represention of function, symbol table, array of
-	 * pointers to evaluator variable names, as well as data structure 
-	 * representing evaluator. */
+	/* Wait for background compilation to finish, if any, then
+	 * destroy compiled function, tree represention of function,
+	 * symbol table, arrays of pointers to evaluator variable names
+	 * and records, as well as data structure representing evaluator. 
+	 */
+	evaluator_cancel(evaluator);
+#if HAVE_PTHREAD
+	pthread_mutex_destroy(&((Evaluator *) evaluator)->mutex);
+#endif
+	engine_destroy(((Evaluator *) evaluator)->engine);
+	engine_destroy(((Evaluator *) evaluator)->engine_float);
+	ddouble_destroy(((Evaluator *) evaluator)->ddouble);
+	cmplx_destroy(((Evaluator *) evaluator)->cmplx);
+	interval_destroy(((Evaluator *) evaluator)->interval);
+	fixed_destroy(((Evaluator *) evaluator)->fixed);
+	incremental_destroy(((Evaluator *) evaluator)->incremental);
+	memo_destroy(((Evaluator *) evaluator)->memo);
 	node_destroy(((Evaluator *) evaluator)->root);
 	symbol_table_destroy(((Evaluator *) evaluator)->symbol_table);
 	XFREE(((Evaluator *) evaluator)->string);
 	XFREE(((Evaluator *) evaluator)->names);
+	XFREE(((Evaluator *) evaluator)->records);
+	XFREE(((Evaluator *) evaluator)->values);
 	XFREE(evaluator);
 }
 
@@ -125,6 +370,10 @@ evaluator_evaluate(void *evaluator, int count, char **names,
 				 * given variable name.  */
 	int             i;	/* Loop counter.  */
 
+	/* If memoization enabled, look function value up. */
+	if (((Evaluator *) evaluator)->memo)
+		return evaluator_memoize(evaluator, count, names, values);
+
 	/* Assign values to symbol table records corresponding to variable 
 	 * names. */
 	for (i = 0; i < count; i++) {
@@ -135,8 +384,713 @@ evaluator_evaluate(void *evaluator, int count, char **names,
 			record->data.value = values[i];
 	}
 
-	/* Evaluate function value using tree represention of function. */
-	return node_evaluate(((Evaluator *) evaluator)->root);
+	/* Calculate function value. */
+	return evaluator_calculate(evaluator);
+}
+
+void
+evaluator_evaluate_batch(void *evaluator, int count, char **names,
+			 double **values, int length, double *results)
+{
+	int            *map;	/* Indices of given variables. */
+	double        **columns;	/* Arrays of variable values,
+					 * ordered as evaluator variables. 
+					 */
+
+	/* Find evaluator variables and assign to each of them array of
+	 * values given by arguments; if variable not given, array filled 
+	 * with its current value is used. */
+	map = evaluator_map(evaluator, count, names);
+	columns = evaluator_gather(evaluator, map, values, length, 1);
+
+	/* Count points evaluated, and promote evaluator to higher tier if
+	 * threshold reached. */
+	if ((((Evaluator *) evaluator)->calls += length) >=
+	    ((Evaluator *) evaluator)->threshold)
+		evaluator_promote(evaluator);
+
+	/* Calculate function values using compiled function if
+	 * available, or using tree representation of function point by
+	 * point otherwise. */
+	evaluator_run(evaluator, ((Evaluator *) evaluator)->engine,
+		      columns, length, ((Evaluator *) evaluator)->width,
+		      results);
+
+	/* Free arrays used. */
+	evaluator_release(evaluator, map, (void **) columns);
+	XFREE(map);
+}
+
+void
+evaluator_evaluate_batch_float(void *evaluator, int count, char **names,
+			       float **values, int length, float *results)
+{
+	int            *map;	/* Indices of given variables. */
+	float         **columns;	/* Arrays of variable values,
+					 * ordered as evaluator variables. 
+					 */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* Find evaluator variables and assign to each of them array of
+	 * values given by arguments, as in double precision batch
+	 * evaluation. */
+	map = evaluator_map(evaluator, count, names);
+	columns = XMALLOC(float *, ((Evaluator *) evaluator)->count + 1);
+	for (i = 0; i < ((Evaluator *) evaluator)->count; i++)
+		if (map[i] >= 0)
+			columns[i] = values[map[i]];
+		else {
+			columns[i] = XMALLOC(float, length + 1);
+			for (j = 0; j < length; j++)
+				columns[i][j] =
+				    ((Evaluator *) evaluator)->records[i]->
+				    data.value;
+		}
+
+	/* Compile function into bytecode on first use, and calculate
+	 * function values in single precision. */
+	if (!((Evaluator *) evaluator)->engine_float)
+		((Evaluator *) evaluator)->engine_float =
+		    bytecode_create(((Evaluator *) evaluator)->root,
+				    ((Evaluator *) evaluator)->records,
+				    ((Evaluator *) evaluator)->count);
+	bytecode_evaluate_batch_float(((Evaluator *) evaluator)->
+				      engine_float->code, columns, length,
+				      results);
+
+	/* Free arrays used. */
+	evaluator_release(evaluator, map, (void **) columns);
+	XFREE(map);
+}
+
+double
+evaluator_evaluate_ddouble(void *evaluator, int count, char **names,
+			   double *values, double *values_low,
+			   double *result_low)
+{
+	double        **columns;	/* Arrays of single value of each
+					 * variable. */
+	double        **columns_low;	/* Same as above for trailing
+					 * parts. */
+	double          result;	/* Leading part of function value. */
+	int             i;	/* Loop counter.  */
+
+	/* Evaluate function for batch consisting of single point. */
+	columns = XMALLOC(double *, count + 1);
+	columns_low = XMALLOC(double *, count + 1);
+	for (i = 0; i < count; i++) {
+		columns[i] = &values[i];
+		columns_low[i] = values_low ? &values_low[i] : NULL;
+	}
+	evaluator_evaluate_batch_ddouble(evaluator, count, names, columns,
+					 values_low ? columns_low : NULL, 1,
+					 &result, result_low);
+	XFREE(columns);
+	XFREE(columns_low);
+
+	return result;
+}
+
+void
+evaluator_evaluate_batch_ddouble(void *evaluator, int count, char **names,
+				 double **values, double **values_low,
+				 int length, double *results,
+				 double *results_low)
+{
+	int            *map;	/* Indices of given variables. */
+	double        **columns;	/* Arrays of leading parts of
+					 * variable values, ordered as
+					 * evaluator variables. */
+	double        **columns_low;	/* Same as above for trailing
+					 * parts. */
+	double         *zeros;	/* Trailing parts of values of
+				 * variables not given. */
+	int             i;	/* Loop counter.  */
+
+	/* Find evaluator variables and assign to each of them arrays of
+	 * leading and trailing parts of values given by arguments; if
+	 * variable not given, its current value is used with trailing
+	 * part zero. */
+	map = evaluator_map(evaluator, count, names);
+	columns = evaluator_gather(evaluator, map, values, length, 1);
+	columns_low =
+	    XMALLOC(double *, ((Evaluator *) evaluator)->count + 1);
+	zeros = XCALLOC(double, length + 1);
+	for (i = 0; i < ((Evaluator *) evaluator)->count; i++)
+		columns_low[i] = (map[i] >= 0
+				  && values_low) ? values_low[map[i]] : zeros;
+
+	/* Compile function for double-double evaluation on first use,
+	 * and calculate function values. */
+	if (!((Evaluator *) evaluator)->ddouble)
+		((Evaluator *) evaluator)->ddouble =
+		    ddouble_create(((Evaluator *) evaluator)->root,
+				   ((Evaluator *) evaluator)->records,
+				   ((Evaluator *) evaluator)->count);
+	ddouble_evaluate_batch(((Evaluator *) evaluator)->ddouble, columns,
+			       columns_low, length, results, results_low);
+
+	/* Free arrays used. */
+	evaluator_release(evaluator, map, (void **) columns);
+	XFREE(zeros);
+	XFREE(columns_low);
+	XFREE(map);
+}
+
+void
+evaluator_evaluate_complex(void *evaluator, int count, char **names,
+			   double *values, double *result)
+{
+	double        **columns;	/* Arrays of single value of each
+					 * variable. */
+	int             i;	/* Loop counter.  */
+
+	/* Evaluate function for batch consisting of single point. */
+	columns = XMALLOC(double *, count + 1);
+	for (i = 0; i < count; i++)
+		columns[i] = &values[2 * i];
+	evaluator_evaluate_batch_complex(evaluator, count, names, columns,
+					 1, result);
+	XFREE(columns);
+}
+
+void
+evaluator_evaluate_batch_complex(void *evaluator, int count, char **names,
+				 double **values, int length,
+				 double *results)
+{
+	int            *map;	/* Indices of given variables. */
+	double        **columns;	/* Arrays of variable values,
+					 * ordered as evaluator variables. */
+
+	/* Find evaluator variables and assign to each of them array of
+	 * values given by arguments; if variable not given, its current
+	 * value is used with imaginary part zero. */
+	map = evaluator_map(evaluator, count, names);
+	columns = evaluator_gather(evaluator, map, values, length, 2);
+
+	/* Compile function for complex evaluation on first use, and
+	 * calculate function values. */
+	if (!((Evaluator *) evaluator)->cmplx)
+		((Evaluator *) evaluator)->cmplx =
+		    cmplx_create(((Evaluator *) evaluator)->root,
+				 ((Evaluator *) evaluator)->records,
+				 ((Evaluator *) evaluator)->count);
+	cmplx_evaluate_batch(((Evaluator *) evaluator)->cmplx, columns,
+			     length, results);
+
+	/* Free arrays used. */
+	evaluator_release(evaluator, map, (void **) columns);
+	XFREE(map);
+}
+
+void
+evaluator_evaluate_interval(void *evaluator, int count, char **names,
+			    double *lower, double *upper,
+			    double *result_lower, double *result_upper)
+{
+	double        **columns;	/* Arrays of single lower bound of
+					 * each variable. */
+	double        **columns_upper;	/* Same as above for upper
+					 * bounds. */
+	int             i;	/* Loop counter.  */
+
+	/* Evaluate function for batch consisting of single box. */
+	columns = XMALLOC(double *, count + 1);
+	columns_upper = XMALLOC(double *, count + 1);
+	for (i = 0; i < count; i++) {
+		columns[i] = &lower[i];
+		columns_upper[i] = &upper[i];
+	}
+	evaluator_evaluate_batch_interval(evaluator, count, names, columns,
+					  columns_upper, 1, result_lower,
+					  result_upper);
+	XFREE(columns);
+	XFREE(columns_upper);
+}
+
+void
+evaluator_evaluate_batch_interval(void *evaluator, int count,
+				  char **names, double **lower,
+				  double **upper, int length,
+				  double *results_lower,
+				  double *results_upper)
+{
+	int            *map;	/* Indices of given variables. */
+	double        **columns;	/* Arrays of lower bounds of
+					 * variable values, ordered as
+					 * evaluator variables. */
+	double        **columns_upper;	/* Same as above for upper
+					 * bounds. */
+	int             i;	/* Loop counter.  */
+
+	/* Find evaluator variables and assign to each of them arrays of
+	 * lower and upper bounds given by arguments; if variable not
+	 * given, its current value is used as both bounds. */
+	map = evaluator_map(evaluator, count, names);
+	columns = evaluator_gather(evaluator, map, lower, length, 1);
+	columns_upper =
+	    XMALLOC(double *, ((Evaluator *) evaluator)->count + 1);
+	for (i = 0; i < ((Evaluator *) evaluator)->count; i++)
+		columns_upper[i] = (map[i] >= 0) ? upper[map[i]] : columns[i];
+
+	/* Compile function for interval evaluation on first use, and
+	 * calculate function intervals. */
+	if (!((Evaluator *) evaluator)->interval)
+		((Evaluator *) evaluator)->interval =
+		    interval_create(((Evaluator *) evaluator)->root,
+				    ((Evaluator *) evaluator)->records,
+				    ((Evaluator *) evaluator)->count);
+	interval_evaluate_batch(((Evaluator *) evaluator)->interval,
+				columns, columns_upper, length,
+				results_lower, results_upper);
+
+	/* Free arrays used. */
+	evaluator_release(evaluator, map, (void **) columns);
+	XFREE(columns_upper);
+	XFREE(map);
+}
+
+int
+evaluator_set_fixed(void *evaluator, int bits, int fraction, int flags)
+{
+	/* Check format, and remember it, discarding function compiled
+	 * for previous format, if any. */
+	if (bits < 2 || bits > 32 || fraction < 0 || fraction > 31)
+		return FALSE;
+	fixed_destroy(((Evaluator *) evaluator)->fixed);
+	((Evaluator *) evaluator)->fixed = NULL;
+	((Evaluator *) evaluator)->fixed_bits = bits;
+	((Evaluator *) evaluator)->fixed_fraction = fraction;
+	((Evaluator *) evaluator)->fixed_flags = flags;
+	return TRUE;
+}
+
+int
+evaluator_evaluate_fixed(void *evaluator, int count, char **names,
+			 int *values)
+{
+	int           **columns;	/* Arrays of single value of each
+					 * variable. */
+	int             result;	/* Function value. */
+	int             i;	/* Loop counter.  */
+
+	/* Evaluate function for batch consisting of single point. */
+	columns = XMALLOC(int *, count + 1);
+	for (i = 0; i < count; i++)
+		columns[i] = &values[i];
+	evaluator_evaluate_batch_fixed(evaluator, count, names, columns, 1,
+				       &result);
+	XFREE(columns);
+	return result;
+}
+
+void
+evaluator_evaluate_batch_fixed(void *evaluator, int count, char **names,
+			       int **values, int length, int *results)
+{
+	int            *map;	/* Indices of given variables. */
+	int           **columns;	/* Arrays of variable values,
+					 * ordered as evaluator variables. */
+	int             value;	/* Current variable value converted to
+				 * fixed-point. */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* Find evaluator variables, and compile function for fixed-point
+	 * evaluation on first use. */
+	map = evaluator_map(evaluator, count, names);
+	if (!((Evaluator *) evaluator)->fixed)
+		((Evaluator *) evaluator)->fixed =
+		    fixed_create(((Evaluator *) evaluator)->root,
+				 ((Evaluator *) evaluator)->records,
+				 ((Evaluator *) evaluator)->count,
+				 ((Evaluator *) evaluator)->fixed_bits,
+				 ((Evaluator *) evaluator)->fixed_fraction,
+				 ((Evaluator *) evaluator)->fixed_flags);
+
+	/* Assign to each variable array of values given by arguments; if
+	 * variable not given, its current value converted to fixed-point
+	 * is used. */
+	columns = XMALLOC(int *, ((Evaluator *) evaluator)->count + 1);
+	for (i = 0; i < ((Evaluator *) evaluator)->count; i++)
+		if (map[i] >= 0)
+			columns[i] = values[map[i]];
+		else {
+			value =
+			    fixed_convert(((Evaluator *) evaluator)->fixed,
+					  ((Evaluator *) evaluator)->
+					  records[i]->data.value);
+			columns[i] = XMALLOC(int, length + 1);
+			for (j = 0; j < length; j++)
+				columns[i][j] = value;
+		}
+
+	/* Calculate function values. */
+	fixed_evaluate_batch(((Evaluator *) evaluator)->fixed, columns,
+			     length, results);
+
+	/* Free arrays used. */
+	evaluator_release(evaluator, map, (void **) columns);
+	XFREE(map);
+}
+
+double
+evaluator_evaluate_incremental(void *evaluator, int count, char **names,
+			       double *values)
+{
+	Record         *record;	/* Symbol table record corresponding to
+				 * given variable name.  */
+	char          **variables;	/* Evaluator variable names. */
+	int             variable_count;	/* Number of evaluator variables. 
+					 */
+	int             i;	/* Loop counter.  */
+
+	/* Assign values to symbol table records corresponding to variable 
+	 * names. */
+	for (i = 0; i < count; i++) {
+		record =
+		    symbol_table_lookup(((Evaluator *) evaluator)->
+					symbol_table, names[i]);
+		if (record && record->type == 'v')
+			record->data.value = values[i];
+	}
+
+	/* Find evaluator variables, and prepare function for incremental 
+	 * evaluation on first use. */
+	evaluator_get_variables(evaluator, &variables, &variable_count);
+	if (!((Evaluator *) evaluator)->incremental)
+		((Evaluator *) evaluator)->incremental =
+		    incremental_create(((Evaluator *) evaluator)->root,
+				       ((Evaluator *) evaluator)->records,
+				       ((Evaluator *) evaluator)->count);
+
+	/* Recalculate subtrees depending on variables changed. */
+	return incremental_evaluate(((Evaluator *) evaluator)->incremental);
+}
+
+double
+evaluator_update(void *evaluator, char *name, double value)
+{
+	/* Evaluate function incrementally with single variable given. */
+	return evaluator_evaluate_incremental(evaluator, 1, &name, &value);
+}
+
+int
+evaluator_set_memo(void *evaluator, int size)
+{
+	char          **names;	/* Evaluator variable names. */
+	int             count;	/* Number of evaluator variables. */
+
+	/* Check size, and replace table of memoized function values, if
+	 * any, with empty one of given size (if not zero). */
+	if (size < 0)
+		return FALSE;
+	evaluator_get_variables(evaluator, &names, &count);
+	memo_destroy(((Evaluator *) evaluator)->memo);
+	((Evaluator *) evaluator)->memo =
+	    size ? memo_create(count, size) : NULL;
+	return TRUE;
+}
+
+void
+evaluator_get_memo_statistics(void *evaluator, long *hits, long *misses,
+			      long *evictions)
+{
+	/* Report counters of table of memoized function values, or zeros
+	 * if memoization disabled. */
+	*hits = *misses = *evictions = 0;
+	if (((Evaluator *) evaluator)->memo)
+		memo_get_statistics(((Evaluator *) evaluator)->memo, hits,
+				    misses, evictions);
+}
+
+int
+evaluator_set_engine(void *evaluator, int engine)
+{
+	/* Discard function being compiled in background, if any, and
+	 * disable further automatic promotions of evaluator. */
+	evaluator_cancel(evaluator);
+	((Evaluator *) evaluator)->level = EVALUATOR_TIER_OPTIMIZED;
+	((Evaluator *) evaluator)->threshold = LONG_MAX;
+	((Evaluator *) evaluator)->width = 0;
+	((Evaluator *) evaluator)->autotuned = FALSE;
+
+	/* Compile function using engine requested, unless tree
+	 * representation of function requested, and use it instead of
+	 * previously compiled function.  Function compiled by native code 
+	 * engine is considered baseline tier, by other engines optimized
+	 * tier. */
+	evaluator_install(evaluator,
+			  engine !=
+			  EVALUATOR_ENGINE_TREE ? evaluator_compile(evaluator,
+								    engine)
+			  : NULL,
+			  engine ==
+			  EVALUATOR_ENGINE_JIT ? EVALUATOR_TIER_BASELINE :
+			  EVALUATOR_TIER_OPTIMIZED);
+
+	/* Return engine actually used. */
+	return evaluator_get_engine(evaluator);
+}
+
+int
+evaluator_get_engine(void *evaluator)
+{
+	/* Return engine type, or tree representation if function not
+	 * compiled. */
+	return ((Evaluator *) evaluator)->engine ?
+	    ((Evaluator *) evaluator)->engine->type : EVALUATOR_ENGINE_TREE;
+}
+
+int
+evaluator_autotune(void *evaluator, int sample_batch_size)
+{
+	static int      engines[] = {
+		EVALUATOR_ENGINE_TREE, EVALUATOR_ENGINE_CLOSURE,
+		EVALUATOR_ENGINE_BYTECODE, EVALUATOR_ENGINE_JIT,
+		EVALUATOR_ENGINE_LLVM, EVALUATOR_ENGINE_C
+	};			/* Engines tried. */
+	static int      widths[] = { 64, 256, 1024, 4096 };	/* Batch
+								 * widths
+								 * tried
+								 * besides
+								 * sample
+								 * batch size. 
+								 */
+	char          **names;	/* Evaluator variable names. */
+	int             count;	/* Number of evaluator variables. */
+	unsigned long   hash;	/* Hash value of function structure. */
+	Decision       *decision;	/* Autotuning decision. */
+	Decision        best;	/* Best engine and batch width found. */
+	Engine         *engine;	/* Function compiled by engine tried. */
+	Engine         *winner;	/* Function compiled by best engine. */
+	double        **columns;	/* Sample batch variable values. */
+	double         *results;	/* Sample batch function values. */
+	double          time;	/* Time per point measured. */
+	int             width;	/* Batch width tried. */
+	int             found;	/* Flag set if decision found. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Discard function being compiled in background, if any, and
+	 * disable further automatic promotions of evaluator. */
+	evaluator_cancel(evaluator);
+	((Evaluator *) evaluator)->level = EVALUATOR_TIER_OPTIMIZED;
+	((Evaluator *) evaluator)->threshold = LONG_MAX;
+
+	/* Look up decision made for function of same structure, flags and 
+	 * sample batch size. */
+	if (sample_batch_size < 1)
+		sample_batch_size = 1;
+	evaluator_get_variables(evaluator, &names, &count);
+	hash = node_hash(((Evaluator *) evaluator)->root);
+	decision = &decisions[hash % DECISION_TABLE_LENGTH];
+#if HAVE_PTHREAD
+	pthread_mutex_lock(&decision_mutex);
+#endif
+	found = decision->used && decision->hash == hash
+	    && decision->flags == ((Evaluator *) evaluator)->flags
+	    && decision->length == sample_batch_size;
+	best = *decision;
+#if HAVE_PTHREAD
+	pthread_mutex_unlock(&decision_mutex);
+#endif
+
+	/* If decision found, compile function using engine selected; if
+	 * that fails, proceed with autotuning. */
+	winner = NULL;
+	if (found && best.engine != EVALUATOR_ENGINE_TREE
+	    && !(winner = evaluator_compile(evaluator, best.engine)))
+		found = FALSE;
+
+	/* Otherwise, measure time per point of evaluating sample batch,
+	 * with variable values close to current ones, using each engine
+	 * available and each batch width not greater than sample batch
+	 * size (compiled scalar function being used for sample batch of
+	 * single point), and keep fastest one. */
+	if (!found) {
+		columns = XMALLOC(double *, count + 1);
+		for (i = 0; i < count; i++) {
+			columns[i] = XMALLOC(double, sample_batch_size);
+			for (j = 0; j < sample_batch_size; j++)
+				columns[i][j] =
+				    ((Evaluator *) evaluator)->records[i]->
+				    data.value + j * 1e-9;
+		}
+		results = XMALLOC(double, sample_batch_size);
+		if (!((Evaluator *) evaluator)->values)
+			((Evaluator *) evaluator)->values =
+			    XMALLOC(double, count + 1);
+
+		best.engine = EVALUATOR_ENGINE_TREE;
+		best.width = 0;
+		best.time =
+		    evaluator_measure(evaluator, NULL, columns,
+				      sample_batch_size, 0, results);
+		for (i = 1; i < (int) (sizeof(engines) / sizeof(engines[0]));
+		     i++) {
+			if (!(engine = evaluator_compile(evaluator, engines[i])))
+				continue;
+			for (j = -1;
+			     j < (int) (sizeof(widths) / sizeof(widths[0]))
+			     && (j < 0 || widths[j] < sample_batch_size);
+			     j++) {
+				width =
+				    (j < 0) ? (sample_batch_size ==
+					       1) : widths[j];
+				time =
+				    evaluator_measure(evaluator, engine,
+						      columns,
+						      sample_batch_size,
+						      width, results);
+				if (time < best.time) {
+					best.engine = engines[i];
+					best.width = (j < 0) ? 0 : width;
+					best.time = time;
+					if (winner != engine)
+						engine_destroy(winner);
+					winner = engine;
+				}
+			}
+			if (engine != winner)
+				engine_destroy(engine);
+		}
+
+		for (i = 0; i < count; i++)
+			XFREE(columns[i]);
+		XFREE(columns);
+		XFREE(results);
+
+		/* Remember decision. */
+#if HAVE_PTHREAD
+		pthread_mutex_lock(&decision_mutex);
+#endif
+		best.used = TRUE;
+		best.hash = hash;
+		best.flags = ((Evaluator *) evaluator)->flags;
+		best.length = sample_batch_size;
+		*decision = best;
+#if HAVE_PTHREAD
+		pthread_mutex_unlock(&decision_mutex);
+#endif
+	}
+
+	/* Lock in fastest engine and batch width, and record decision
+	 * for inspection. */
+	evaluator_install(evaluator, winner,
+			  best.engine ==
+			  EVALUATOR_ENGINE_JIT ? EVALUATOR_TIER_BASELINE :
+			  EVALUATOR_TIER_OPTIMIZED);
+	((Evaluator *) evaluator)->width = best.width;
+	((Evaluator *) evaluator)->autotuned = TRUE;
+	((Evaluator *) evaluator)->time = best.time;
+
+	return evaluator_get_engine(evaluator);
+}
+
+int
+evaluator_get_autotune(void *evaluator, int *engine, int *width,
+		       double *time)
+{
+	/* Return engine and batch width selected by autotuning, as well
+	 * as time per point measured, if evaluator autotuned. */
+	if (!((Evaluator *) evaluator)->autotuned)
+		return FALSE;
+	*engine = evaluator_get_engine(evaluator);
+	*width = ((Evaluator *) evaluator)->width;
+	*time = ((Evaluator *) evaluator)->time;
+	return TRUE;
+}
+
+void
+evaluator_set_cache_directory(char *directory)
+{
+	/* Pass directory to engine compiling C code. */
+	compiler_set_cache_directory(directory);
+}
+
+void
+evaluator_set_tiering(long baseline, long optimized, int engine,
+		      int asynchronous)
+{
+	/* Remember tiered execution settings. */
+	tier_baseline = baseline;
+	tier_optimized = optimized;
+	tier_engine = engine;
+	tier_asynchronous = asynchronous;
+}
+
+void
+evaluator_get_tiering(long *baseline, long *optimized, int *engine,
+		      int *asynchronous)
+{
+	/* Return tiered execution settings. */
+	*baseline = tier_baseline;
+	*optimized = tier_optimized;
+	*engine = tier_engine;
+	*asynchronous = tier_asynchronous;
+}
+
+int
+evaluator_get_tier(void *evaluator)
+{
+	/* Return tier of function currently used by evaluator. */
+	return ((Evaluator *) evaluator)->tier;
+}
+
+long
+evaluator_get_call_count(void *evaluator)
+{
+	/* Return number of points evaluated. */
+	return ((Evaluator *) evaluator)->calls;
+}
+
+char           *
+evaluator_get_isa(void)
+{
+	/* Return name of vector kernels variant. */
+	return isa_name(isa_select());
+}
+
+void           *
+evaluator_create_group(void **evaluators, int count)
+{
+	Node          **roots;	/* Roots of evaluators functions. */
+	Group          *group;	/* Group created. */
+	int             i;	/* Loop counter. */
+
+	/* Create group from tree representations of evaluators
+	 * functions. */
+	roots = XMALLOC(Node *, count + 1);
+	for (i = 0; i < count; i++)
+		roots[i] = ((Evaluator *) evaluators[i])->root;
+	group = group_create(roots, count);
+	XFREE(roots);
+	return group;
+}
+
+void
+evaluator_destroy_group(void *group)
+{
+	/* Destroy group. */
+	group_destroy(group);
+}
+
+void
+evaluator_evaluate_group(void *group, int count, char **names,
+			 double *values, double *results)
+{
+	/* Evaluate group functions. */
+	group_evaluate(group, count, names, values, results);
+}
+
+int
+evaluator_get_group_shape_count(void *group)
+{
+	/* Return number of partitions of group functions. */
+	return group_get_partition_count(group);
 }
 
 char           *
@@ -163,12 +1117,10 @@ evaluator_get_string(void *evaluator)
 void
 evaluator_get_variables(void *evaluator, char ***names, int *count)
 {
-	Record        **records;	/* Array of symbol table records
-					 * containing evaluator variables. 
-					 */
 	int             i;	/* Loop counter.  */
 
-	/* If not already, find and remember evaluator variable names. */
+	/* If not already, find and remember evaluator variable names and 
+	 * records. */
 	if (!((Evaluator *) evaluator)->names) {
 		symbol_table_clear_flags(((Evaluator *) evaluator)->
 					 symbol_table);
@@ -177,17 +1129,17 @@ evaluator_get_variables(void *evaluator, char ***names, int *count)
 		    symbol_table_get_flagged_count(((Evaluator *)
 						    evaluator)->
 						   symbol_table);
-		records =
-		    XMALLOC(Record *, ((Evaluator *) evaluator)->count);
+		((Evaluator *) evaluator)->records =
+		    XMALLOC(Record *, ((Evaluator *) evaluator)->count + 1);
 		symbol_table_get_flagged(((Evaluator *) evaluator)->
-					 symbol_table, records,
+					 symbol_table,
+					 ((Evaluator *) evaluator)->records,
 					 ((Evaluator *) evaluator)->count);
 		((Evaluator *) evaluator)->names =
-		    XMALLOC(char *, ((Evaluator *) evaluator)->count);
+		    XMALLOC(char *, ((Evaluator *) evaluator)->count + 1);
 		for (i = 0; i < ((Evaluator *) evaluator)->count; i++)
 			((Evaluator *) evaluator)->names[i] =
-			    records[i]->name;
-		XFREE(records);
+			    ((Evaluator *) evaluator)->records[i]->name;
 	}
 
 	/* Return requested information. */
@@ -198,22 +1150,160 @@ evaluator_get_variables(void *evaluator, char ***names, int *count)
 void           *
 evaluator_derivative(void *evaluator, char *name)
 {
-	Evaluator      *derivative;	/* Derivative function evaluator. */
+	Node           *root;	/* Root of tree representation of
+				 * derivative. */
+
+	/* Differentiate tree representation of function and simplify
+	 * it. */
+	root =
+	    evaluator_lower(node_simplify
+			    (node_derivative
+			     (((Evaluator *) evaluator)->root, name,
+			      ((Evaluator *) evaluator)->symbol_table)),
+			    ((Evaluator *) evaluator)->symbol_table,
+			    ((Evaluator *) evaluator)->flags);
 
 	/* Allocate memory for and initalize data structure for evaluator
 	 * representing derivative of function given by evaluator. */
-	derivative = XMALLOC(Evaluator, 1);
-	derivative->root =
-	    node_simplify(node_derivative
-			  (((Evaluator *) evaluator)->root, name,
-			   ((Evaluator *) evaluator)->symbol_table));
-	derivative->symbol_table =
-	    symbol_table_assign(((Evaluator *) evaluator)->symbol_table);
-	derivative->string = NULL;
-	derivative->count = 0;
-	derivative->names = NULL;
+	return evaluator_new(root,
+			     symbol_table_assign(((Evaluator *) evaluator)->
+						 symbol_table),
+			     ((Evaluator *) evaluator)->flags);
+}
+
+void           *
+evaluator_specialize(void *evaluator, int count, char **names,
+		     double *values)
+{
+	Record         *record;	/* Symbol table record corresponding to
+				 * given variable name.  */
+	Node           *root;	/* Root of tree representation of
+				 * specialized function.  */
+	Node           *number;	/* Number node replacing variable. */
+	int             i;	/* Loop counter.  */
+
+	/* Copy tree representation of function and replace variables
+	 * given by numbers. */
+	root = node_copy(((Evaluator *) evaluator)->root);
+	for (i = 0; i < count; i++) {
+		record =
+		    symbol_table_lookup(((Evaluator *) evaluator)->
+					symbol_table, names[i]);
+		if (record && record->type == 'v') {
+			number = node_create('n', values[i]);
+			root = node_substitute(root, record, number);
+			node_destroy(number);
+		}
+	}
+
+	/* Allocate memory for and initalize data structure for evaluator
+	 * representing specialized function, simplifying tree
+	 * representation again. */
+	root =
+	    evaluator_lower(node_simplify(root),
+			    ((Evaluator *) evaluator)->symbol_table,
+			    ((Evaluator *) evaluator)->flags);
+	return evaluator_new(root,
+			     symbol_table_assign(((Evaluator *) evaluator)->
+						 symbol_table),
+			     ((Evaluator *) evaluator)->flags);
+}
+
+void           *
+evaluator_substitute(void *evaluator, char *name, void *replacement)
+{
+	SymbolTable    *symbol_table;	/* Symbol table for composite
+					 * function. */
+	Record         *record;	/* Symbol table record corresponding to
+				 * given variable name.  */
+	Node           *root;	/* Root of tree representation of
+				 * composite function.  */
+	Node           *child;	/* Root of tree representation of
+				 * function substituted.  */
+
+	/* Create new symbol table and copy trees representation of both
+	 * functions, with their records replaced by records from new
+	 * symbol table. */
+	symbol_table = symbol_table_create(MIN_TABLE_LENGTH);
+	root = node_import(((Evaluator *) evaluator)->root, symbol_table);
+	child =
+	    node_import(((Evaluator *) replacement)->root, symbol_table);
+
+	/* Replace variable given by tree representation of second
+	 * function. */
+	record = symbol_table_lookup(symbol_table, name);
+	if (record && record->type == 'v')
+		root = node_substitute(root, record, child);
+	node_destroy(child);
+
+	/* Allocate memory for and initalize data structure for evaluator
+	 * representing composite function, simplifying tree
+	 * representation again. */
+	root =
+	    evaluator_lower(node_simplify(root), symbol_table,
+			    ((Evaluator *) evaluator)->flags);
+	return evaluator_new(root, symbol_table,
+			     ((Evaluator *) evaluator)->flags);
+}
+
+int
+evaluator_write_inline(void *evaluator, FILE * file, char *name)
+{
+	Record        **records;	/* Records of evaluator variables,
+					 * sorted by name. */
+	void          **derivatives;	/* Evaluators of partial
+					 * derivatives. */
+	Node          **roots;	/* Roots of tree representations of
+				 * partial derivatives. */
+	char          **names;	/* Evaluator variable names. */
+	int             count;	/* Number of evaluator variables. */
+	int             ok;	/* Flag set if code written. */
+	int             i;	/* Loop counter. */
+
+	/* Find evaluator variables and sort them by name. */
+	evaluator_get_variables(evaluator, &names, &count);
+	records = XMALLOC(Record *, count + 1);
+	memcpy(records, ((Evaluator *) evaluator)->records,
+	       count * sizeof(Record *));
+	qsort(records, count, sizeof(Record *), record_compare);
+
+	/* Differentiate function by each variable. */
+	derivatives = XMALLOC(void *, count + 1);
+	roots = XMALLOC(Node *, count + 1);
+	for (i = 0; i < count; i++) {
+		derivatives[i] =
+		    evaluator_derivative(evaluator, records[i]->name);
+		roots[i] = ((Evaluator *) derivatives[i])->root;
+	}
+
+	/* Write function and its gradient. */
+	ok = codegen_write_inline(file, name,
+				  ((Evaluator *) evaluator)->root, roots,
+				  records, count);
+
+	/* Destroy derivatives evaluators and free arrays used. */
+	for (i = 0; i < count; i++)
+		evaluator_destroy(derivatives[i]);
+	XFREE(derivatives);
+	XFREE(roots);
+	XFREE(records);
+
+	return ok;
+}
+
+Engine         *
+evaluator_get_internals(void *evaluator, Node ** root, Record *** records,
+			int *count)
+{
+	char          **names;	/* Evaluator variable names. */
 
-	return derivative;
+	/* Find evaluator variables, if not already, and return tree
+	 * representation of function, variables records and compiled
+	 * function. */
+	evaluator_get_variables(evaluator, &names, count);
+	*root = ((Evaluator *) evaluator)->root;
+	*records = ((Evaluator *) evaluator)->records;
+	return ((Evaluator *) evaluator)->engine;
 }
 
 double
@@ -282,3 +1372,538 @@ evaluator_derivative_z(void *evaluator)
 	/* Differentiate function using derivation variable "z". */
 	return evaluator_derivative(evaluator, "z");
 }
+
+static Evaluator *
+evaluator_new(Node * root, SymbolTable * symbol_table, int flags)
+{
+	Evaluator      *evaluator;	/* Evaluator data structure. */
+
+	/* Allocate memory for evaluator data structure and initialize
+	 * it, with function evaluated using its tree representation. */
+	evaluator = XMALLOC(Evaluator, 1);
+	evaluator->root = root;
+	evaluator->symbol_table = symbol_table;
+	evaluator->string = NULL;
+	evaluator->count = 0;
+	evaluator->names = NULL;
+	evaluator->records = NULL;
+	evaluator->flags = flags;
+	evaluator->engine = NULL;
+	evaluator->values = NULL;
+
+	/* Initialize tiered execution data, with first promotion
+	 * threshold determined by current settings. */
+	evaluator->calls = 0;
+	evaluator->tier = EVALUATOR_TIER_INTERPRETED;
+	evaluator->level = EVALUATOR_TIER_INTERPRETED;
+#if HAVE_PTHREAD
+	evaluator->compiling = FALSE;
+	pthread_mutex_init(&evaluator->mutex, NULL);
+	evaluator->compiled = FALSE;
+	evaluator->engine_compiled = NULL;
+#endif
+	evaluator->threshold =
+	    tier_baseline > 0 ? tier_baseline : tier_optimized >
+	    0 ? tier_optimized : LONG_MAX;
+	evaluator->width = 0;
+	evaluator->autotuned = FALSE;
+	evaluator->time = 0;
+	evaluator->engine_float = NULL;
+	evaluator->ddouble = NULL;
+	evaluator->cmplx = NULL;
+	evaluator->interval = NULL;
+	evaluator->fixed = NULL;
+	evaluator->fixed_bits = 32;
+	evaluator->fixed_fraction = 16;
+	evaluator->fixed_flags = EVALUATOR_FIXED_ROUND_DOWN;
+	evaluator->incremental = NULL;
+	evaluator->memo = NULL;
+
+	return evaluator;
+}
+
+static Engine  *
+evaluator_compile(Evaluator * evaluator, int engine)
+{
+	char          **names;	/* Evaluator variable names. */
+	int             count;	/* Number of evaluator variables. */
+	Engine         *compiled;	/* Function compiled. */
+
+	/* Make sure records of evaluator variables are available, then
+	 * compile function and announce it to perf profiler if
+	 * requested, with compilations serialized (including ones
+	 * triggered by promotions of evaluators used from different
+	 * threads, or done by background compilation thread). */
+	evaluator_get_variables(evaluator, &names, &count);
+#if HAVE_PTHREAD
+	pthread_mutex_lock(&compile_mutex);
+#endif
+	compiled =
+	    engine_create(engine, evaluator->root, evaluator->records,
+			  count);
+	if (compiled && perf_enabled())
+		evaluator_announce(evaluator, compiled);
+#if HAVE_PTHREAD
+	pthread_mutex_unlock(&compile_mutex);
+#endif
+	return compiled;
+}
+
+static void
+evaluator_announce(Evaluator * evaluator, Engine * engine)
+{
+	char           *string;	/* Textual representation of function. */
+	char           *name;	/* Symbol name. */
+	unsigned long   hash;	/* Hash value of textual representation. */
+	int             i;	/* Loop counter. */
+
+	/* Calculate hash value of textual representation of function. */
+	string = evaluator_get_string(evaluator);
+	hash = 2166136261UL;
+	for (i = 0; string[i]; i++)
+		hash = ((hash ^ (unsigned char) string[i]) * 16777619UL) &
+		    0xffffffffUL;
+
+	/* Announce code evaluating function for single point and for
+	 * batch of points. */
+	name = XMALLOC(char, PERF_NAME_LENGTH + 32);
+	sprintf(name, "matheval_%08lx %.*s", hash, PERF_NAME_LENGTH,
+		string);
+	perf_register(name, engine->scalar_code, engine->scalar_size);
+	sprintf(name, "matheval_%08lx_batch %.*s", hash, PERF_NAME_LENGTH,
+		string);
+	perf_register(name, engine->batch_code, engine->batch_size);
+	XFREE(name);
+}
+
+static void
+evaluator_install(Evaluator * evaluator, Engine * engine, int tier)
+{
+	/* Destroy previously compiled function and use given one
+	 * instead. */
+	engine_destroy(evaluator->engine);
+	evaluator->engine = engine;
+	evaluator->tier = engine ? tier : EVALUATOR_TIER_INTERPRETED;
+
+	/* Allocate array for variable values passed to compiled
+	 * function, if not already allocated. */
+	if (engine && !evaluator->values)
+		evaluator->values = XMALLOC(double, evaluator->count + 1);
+}
+
+static void
+evaluator_promote(Evaluator * evaluator)
+{
+	Engine         *engine;	/* Function compiled. */
+#if HAVE_PTHREAD
+	char          **names;	/* Evaluator variable names. */
+	int             count;	/* Number of evaluator variables. */
+	int             compiled;	/* Flag set if background
+					 * compilation finished. */
+
+	/* If function compiled in background, check if compilation
+	 * finished; if not, check again after some more points evaluated, 
+	 * otherwise use function compiled if compilation succeeded. */
+	if (evaluator->compiling) {
+		pthread_mutex_lock(&evaluator->mutex);
+		compiled = evaluator->compiled;
+		pthread_mutex_unlock(&evaluator->mutex);
+		if (!compiled) {
+			evaluator->threshold =
+			    evaluator->calls + TIER_POLL_INTERVAL;
+			return;
+		}
+		pthread_join(evaluator->thread, NULL);
+		evaluator->compiling = FALSE;
+		if (evaluator->engine_compiled)
+			evaluator_install(evaluator,
+					  evaluator->engine_compiled,
+					  EVALUATOR_TIER_OPTIMIZED);
+		else if (!evaluator->engine && tier_baseline > 0
+			 && (engine =
+			     evaluator_compile(evaluator,
+					       EVALUATOR_ENGINE_JIT)))
+			evaluator_install(evaluator, engine,
+					  EVALUATOR_TIER_BASELINE);
+		evaluator->engine_compiled = NULL;
+	} else
+#endif
+	/* Otherwise, if optimized tier threshold reached, compile
+	 * function using engine for optimized tier, in background thread
+	 * if requested and possible.  Baseline tier is skipped if its
+	 * threshold is reached at the same time, unless optimized tier
+	 * compilation fails. */
+	if (tier_optimized > 0
+		    && evaluator->level < EVALUATOR_TIER_OPTIMIZED
+		    && evaluator->calls >= tier_optimized) {
+		evaluator->level = EVALUATOR_TIER_OPTIMIZED;
+#if HAVE_PTHREAD
+		if (tier_asynchronous) {
+			evaluator_get_variables(evaluator, &names, &count);
+			evaluator_get_string(evaluator);
+			evaluator->compiled = FALSE;
+			evaluator->engine_compiled = NULL;
+			if (!pthread_create
+			    (&evaluator->thread, NULL,
+			     evaluator_compile_thread, evaluator)) {
+				evaluator->compiling = TRUE;
+				evaluator->threshold =
+				    evaluator->calls + TIER_POLL_INTERVAL;
+				return;
+			}
+		}
+#endif
+		if ((engine = evaluator_compile(evaluator, tier_engine)))
+			evaluator_install(evaluator, engine,
+					  EVALUATOR_TIER_OPTIMIZED);
+		else if (!evaluator->engine && tier_baseline > 0
+			 && (engine =
+			     evaluator_compile(evaluator,
+					       EVALUATOR_ENGINE_JIT)))
+			evaluator_install(evaluator, engine,
+					  EVALUATOR_TIER_BASELINE);
+	}
+
+	/* Otherwise, if baseline tier threshold reached, compile function 
+	 * using native code engine. */
+	else if (tier_baseline > 0
+		 && evaluator->level < EVALUATOR_TIER_BASELINE
+		 && evaluator->calls >= tier_baseline) {
+		evaluator->level = EVALUATOR_TIER_BASELINE;
+		if ((engine =
+		     evaluator_compile(evaluator, EVALUATOR_ENGINE_JIT)))
+			evaluator_install(evaluator, engine,
+					  EVALUATOR_TIER_BASELINE);
+	}
+
+	/* Calculate number of points evaluated after which evaluator
+	 * should be considered for next promotion. */
+	if (tier_baseline > 0 && evaluator->level < EVALUATOR_TIER_BASELINE)
+		evaluator->threshold = tier_baseline;
+	else if (tier_optimized > 0
+		 && evaluator->level < EVALUATOR_TIER_OPTIMIZED)
+		evaluator->threshold = tier_optimized;
+	else
+		evaluator->threshold = LONG_MAX;
+}
+
+static void
+evaluator_cancel(Evaluator * evaluator)
+{
+#if HAVE_PTHREAD
+	/* Wait for background compilation thread to finish, if any, and
+	 * destroy function compiled. */
+	if (evaluator->compiling) {
+		pthread_join(evaluator->thread, NULL);
+		evaluator->compiling = FALSE;
+		engine_destroy(evaluator->engine_compiled);
+		evaluator->engine_compiled = NULL;
+	}
+#endif
+}
+
+static int     *
+evaluator_map(Evaluator * evaluator, int count, char **names)
+{
+	char          **variables;	/* Evaluator variable names. */
+	int             variable_count;	/* Number of evaluator variables. 
+					 */
+	int            *map;	/* Indices of given variables. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Find evaluator variables, and for each of them search given
+	 * names, from last one. */
+	evaluator_get_variables(evaluator, &variables, &variable_count);
+	map = XMALLOC(int, variable_count + 1);
+	for (i = 0; i < variable_count; i++) {
+		for (j = count - 1; j >= 0; j--)
+			if (!strcmp(names[j], variables[i]))
+				break;
+		map[i] = j;
+	}
+	return map;
+}
+
+static double **
+evaluator_gather(Evaluator * evaluator, int *map, double **values,
+		 int length, int stride)
+{
+	double        **columns;	/* Arrays of variable values. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Use arrays given for variables given, and arrays filled with
+	 * current values for other variables. */
+	columns = XMALLOC(double *, evaluator->count + 1);
+	for (i = 0; i < evaluator->count; i++)
+		if (map[i] >= 0)
+			columns[i] = values[map[i]];
+		else {
+			columns[i] = XCALLOC(double, stride * length + 1);
+			for (j = 0; j < length; j++)
+				columns[i][stride * j] =
+				    evaluator->records[i]->data.value;
+		}
+	return columns;
+}
+
+static void
+evaluator_release(Evaluator * evaluator, int *map, void **columns)
+{
+	int             i;	/* Loop counter. */
+
+	/* Free arrays allocated for variables not given, and array of
+	 * arrays itself. */
+	for (i = 0; i < evaluator->count; i++)
+		if (map[i] < 0)
+			XFREE(columns[i]);
+	XFREE(columns);
+}
+
+static void
+evaluator_run(Evaluator * evaluator, Engine * engine, double **columns,
+	      int length, int width, double *results)
+{
+	double        **chunk;	/* Arrays of variable values for part of
+				 * batch. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Without compiled function, assign variable values to symbol
+	 * table records and evaluate tree representation of function
+	 * point by point. */
+	if (!engine)
+		for (j = 0; j < length; j++) {
+			for (i = 0; i < evaluator->count; i++)
+				evaluator->records[i]->data.value =
+				    columns[i][j];
+			results[j] = node_evaluate(evaluator->root);
+		}
+
+	/* For batch width of single point, call compiled scalar function
+	 * for each point. */
+	else if (width == 1)
+		for (j = 0; j < length; j++) {
+			for (i = 0; i < evaluator->count; i++)
+				evaluator->values[i] = columns[i][j];
+			results[j] =
+			    engine->evaluate(engine->code, evaluator->values);
+		}
+
+	/* Otherwise, call compiled batch function for whole batch, or for 
+	 * consecutive parts of batch if batch width limited. */
+	else if (width <= 0 || length <= width)
+		engine_evaluate_batch(engine, columns, length, results);
+	else {
+		chunk = XMALLOC(double *, evaluator->count + 1);
+		for (j = 0; j < length; j += width) {
+			for (i = 0; i < evaluator->count; i++)
+				chunk[i] = columns[i] + j;
+			engine_evaluate_batch(engine, chunk,
+					      (length - j <
+					       width) ? length - j : width,
+					      results + j);
+		}
+		XFREE(chunk);
+	}
+}
+
+static double
+evaluator_measure(Evaluator * evaluator, Engine * engine,
+		  double **columns, int length, int width, double *results)
+{
+	double          start;	/* Measurement start time. */
+	double          time;	/* Duration of single measurement. */
+	double          best;	/* Duration of shortest measurement. */
+	long            repetitions;	/* Number of batch evaluations
+					 * per measurement. */
+	long            k;	/* Loop counter. */
+	int             i;	/* Loop counter. */
+
+	/* Evaluate batch once, to warm up caches and estimate number of
+	 * repetitions needed for measurement to last long enough. */
+	start = clock_seconds();
+	evaluator_run(evaluator, engine, columns, length, width, results);
+	time = clock_seconds() - start;
+	repetitions =
+	    (time < AUTOTUNE_DURATION) ? (long) (AUTOTUNE_DURATION /
+						 (time + 1e-9)) + 1 : 1;
+
+	/* Repeat measurements and return shortest one, per point. */
+	best = -1;
+	for (i = 0; i < AUTOTUNE_TRIALS; i++) {
+		start = clock_seconds();
+		for (k = 0; k < repetitions; k++)
+			evaluator_run(evaluator, engine, columns, length,
+				      width, results);
+		time = clock_seconds() - start;
+		if (best < 0 || time < best)
+			best = time;
+	}
+	return best / repetitions / length * 1e9;
+}
+
+static double
+clock_seconds(void)
+{
+#if HAVE_CLOCK_GETTIME
+	struct timespec time;	/* Current time. */
+
+	/* Use monotonic clock if available. */
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+#else
+	/* Otherwise, use processor time. */
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+#if HAVE_PTHREAD
+static void    *
+evaluator_compile_thread(void *evaluator)
+{
+	Engine         *engine;	/* Function compiled. */
+
+	/* Compile function. */
+	engine = evaluator_compile(evaluator, tier_engine);
+
+	/* Pass function compiled to evaluator. */
+	pthread_mutex_lock(&((Evaluator *) evaluator)->mutex);
+	((Evaluator *) evaluator)->engine_compiled = engine;
+	((Evaluator *) evaluator)->compiled = TRUE;
+	pthread_mutex_unlock(&((Evaluator *) evaluator)->mutex);
+
+	return NULL;
+}
+#endif
+
+static Node    *
+evaluator_lower(Node * root, SymbolTable * symbol_table, int flags)
+{
+	/* Lower tree representation of function and, if requested, apply
+	 * fast math transformations and replace predefined functions by
+	 * their approximations. */
+	root = node_lower(root, symbol_table);
+	if (flags & EVALUATOR_FAST_MATH)
+		root = node_fast_math(root);
+	if (flags & (EVALUATOR_APPROXIMATE | EVALUATOR_APPROXIMATE_COARSE))
+		symbol_table_approximate(symbol_table,
+					 (flags & EVALUATOR_APPROXIMATE_COARSE)
+					 != 0);
+	return root;
+}
+
+static double
+evaluator_calculate(Evaluator * evaluator)
+{
+	int             i;	/* Loop counter.  */
+
+	/* Count evaluation, and promote evaluator to higher tier if
+	 * threshold reached. */
+	if (++evaluator->calls >= evaluator->threshold)
+		evaluator_promote(evaluator);
+
+	/* If function compiled, collect variable values and evaluate
+	 * function value using compiled function. */
+	if (evaluator->engine) {
+		for (i = 0; i < evaluator->count; i++)
+			evaluator->values[i] = evaluator->records[i]->data.value;
+		return evaluator->engine->evaluate(evaluator->engine->code,
+						   evaluator->values);
+	}
+
+	/* Otherwise, evaluate function value using tree represention of
+	 * function. */
+	return node_evaluate(evaluator->root);
+}
+
+static double
+evaluator_memoize(Evaluator * evaluator, int count, char **names,
+		  double *values)
+{
+	double          local[MEMO_KEY_LENGTH];	/* Tuple of variable
+						 * values, if few
+						 * variables. */
+	char            local_given[MEMO_KEY_LENGTH];	/* Flags of
+							 * variables given, 
+							 * if few
+							 * variables. */
+	double         *key;	/* Tuple of variable values, ordered as
+				 * evaluator variables. */
+	char           *given;	/* Flags set for variables given. */
+	Record         *record;	/* Symbol table record corresponding to
+				 * given variable name.  */
+	double          result;	/* Function value. */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* Collect tuple of variable values, finding index of each
+	 * variable given (at same position as in array of evaluator
+	 * variable names, or through symbol table record otherwise);
+	 * variables not given keep current values. */
+	if (evaluator->count <= MEMO_KEY_LENGTH) {
+		key = local;
+		given = local_given;
+	} else {
+		key = XMALLOC(double, evaluator->count);
+		given = XMALLOC(char, evaluator->count);
+	}
+	memset(given, FALSE, evaluator->count);
+	for (i = 0; i < count; i++) {
+		if (i < evaluator->count
+		    && !strcmp(names[i], evaluator->names[i]))
+			j = i;
+		else {
+			record =
+			    symbol_table_lookup(evaluator->symbol_table,
+						names[i]);
+			for (j = 0;
+			     j < evaluator->count
+			     && evaluator->records[j] != record; j++);
+		}
+		if (j < evaluator->count) {
+			key[j] = values[i];
+			given[j] = TRUE;
+		}
+	}
+	for (j = 0; j < evaluator->count; j++)
+		if (!given[j])
+			key[j] = evaluator->records[j]->data.value;
+
+	/* Look function value up.  If found, assign tuple to variables
+	 * (as evaluation would, so that values given are kept for later
+	 * calls), but only if table lock is free, so that concurrent
+	 * lookups never wait (lock is held by concurrent call then,
+	 * that assigns its own values); without concurrent calls, lock
+	 * is always free.  If not found, under table lock assign tuple to
+	 * variables, calculate function value and memoize it. */
+	if (memo_lookup(evaluator->memo, key, &result)) {
+		if (memo_trylock(evaluator->memo)) {
+			for (j = 0; j < evaluator->count; j++)
+				evaluator->records[j]->data.value = key[j];
+			memo_unlock(evaluator->memo);
+		}
+	} else {
+		memo_lock(evaluator->memo);
+		for (j = 0; j < evaluator->count; j++)
+			evaluator->records[j]->data.value = key[j];
+		result = evaluator_calculate(evaluator);
+		memo_insert(evaluator->memo, key, result);
+		memo_unlock(evaluator->memo);
+	}
+
+	if (key != local) {
+		XFREE(key);
+		XFREE(given);
+	}
+	return result;
+}
+
+static int
+record_compare(const void *first, const void *second)
+{
+	/* Compare records names. */
+	return strcmp((*(Record **) first)->name,
+		      (*(Record **) second)->name);
+}
@@ -26,12 +26,87 @@
 extern          "C" {
 #endif
 
+	/* Flags that could be combined to modify evaluator behavior.
+	 * With EVALUATOR_FAST_MATH, evaluator is allowed to replace
+	 * division by number with multiplication by its reciprocal, to
+	 * reassociate chains of additions and multiplications, and to
+	 * contract multiplication and addition into fused multiply-add;
+	 * each of these changes result of single operation by at most
+	 * 1 ulp, but errors could be amplified by cancellation in
+	 * subsequent operations. */
+#define EVALUATOR_FAST_MATH 1
+
+	/* With EVALUATOR_APPROXIMATE, trigonometric, hyperbolic, inverse
+	 * tangent and cotangent and error functions are replaced by
+	 * polynomial approximations, with relative error below 1e-7 for
+	 * each of them, and with EVALUATOR_APPROXIMATE_COARSE (that takes
+	 * precedence if both flags given), by faster ones, with relative
+	 * error below 1e-4.  Bounds hold for finite arguments and normal
+	 * results, including arguments close to zeros of functions; other
+	 * functions are evaluated exactly.  Double-double, complex, interval and
+	 * fixed-point evaluation use exact functions, and
+	 * EVALUATOR_ENGINE_C is not available with these flags. */
+#define EVALUATOR_APPROXIMATE 2
+#define EVALUATOR_APPROXIMATE_COARSE 4
+
+	/* Engines that could be used to evaluate function.  With
+	 * EVALUATOR_ENGINE_TREE, tree representation of function is
+	 * traversed for each evaluation.  With EVALUATOR_ENGINE_JIT,
+	 * function is compiled into native code (available on x86-64
+	 * only); batch evaluation then calculates four points at once if 
+	 * processor supports AVX instructions.  With
+	 * EVALUATOR_ENGINE_LLVM, function is compiled and optimized for
+	 * processor used through LLVM (available if library configured
+	 * with --with-llvm option), and batch evaluation is vectorized
+	 * where possible.  With EVALUATOR_ENGINE_C, function is written as
+	 * C code, compiled by system C compiler and loaded as shared
+	 * object; compiler command and flags could be changed through
+	 * MATHEVAL_CC and MATHEVAL_CFLAGS environment variables (default
+	 * ones are "cc" and "-O3 -march=native -ffp-contract=off
+	 * -fopenmp-simd").  With EVALUATOR_ENGINE_BYTECODE, function is
+	 * compiled into bytecode, interpreted for tile of points at once
+	 * in batch evaluation; tile size could be changed through
+	 * MATHEVAL_TILE environment variable (default is 512 points).
+	 * With EVALUATOR_ENGINE_CLOSURE, function is compiled into tree of
+	 * closures with handlers specialized for kinds of operands
+	 * (variable, constant or subexpression), for low latency of
+	 * single point evaluation without generating native code. */
+#define EVALUATOR_ENGINE_TREE 0
+#define EVALUATOR_ENGINE_JIT 1
+#define EVALUATOR_ENGINE_LLVM 2
+#define EVALUATOR_ENGINE_C 3
+#define EVALUATOR_ENGINE_BYTECODE 4
+#define EVALUATOR_ENGINE_CLOSURE 5
+
+	/* Tiers of tiered execution: function evaluated using its tree
+	 * representation, compiled by native code engine, or compiled by
+	 * optimizing engine. */
+#define EVALUATOR_TIER_INTERPRETED 0
+#define EVALUATOR_TIER_BASELINE 1
+#define EVALUATOR_TIER_OPTIMIZED 2
+
+	/* Flags selecting behavior of fixed-point evaluation: one of
+	 * rounding modes (rounding down, that is dropping low bits of
+	 * two's complement representation, toward zero, to nearest with
+	 * ties rounded up, and to nearest with ties rounded to even),
+	 * optionally combined with EVALUATOR_FIXED_WRAP to keep low bits
+	 * of overflowing values instead of saturating them. */
+#define EVALUATOR_FIXED_ROUND_DOWN 0
+#define EVALUATOR_FIXED_ROUND_ZERO 1
+#define EVALUATOR_FIXED_ROUND_NEAREST 2
+#define EVALUATOR_FIXED_ROUND_EVEN 3
+#define EVALUATOR_FIXED_WRAP 4
+
 	/* Create evaluator from string representing function.  Function
 	 * returns pointer that should be passed as first argument to all
 	 * other library functions.  If an error occurs, function will
 	 * return null pointer. */
 	extern void    *evaluator_create(char *string);
 
+	/* Same as above, with second argument being combination of flags
+	 * given above.  Evaluators for derivatives inherit these flags. */
+	extern void    *evaluator_create_flags(char *string, int flags);
+
 	/* Destroy evaluator specified. */
 	extern void     evaluator_destroy(void *evaluator);
 
@@ -41,10 +116,319 @@ extern          "C" {
 	 * two arrays is given by second argument.  Function returns
 	 * evaluated function value.  In case that function contains
 	 * variables with names not given through third function argument, 
-	 * value of this variable is undeterminated. */
+	 * value of this variable is undeterminated.  Exponentiation is
+	 * calculated as pow() does, except that powers with integer
+	 * exponent of absolute value up to 4 are calculated by repeated
+	 * squaring (within 2 ulps of pow() result), and that exponent 0.5
+	 * is calculated as square root, giving -0 for -0 and not-a-number
+	 * for negative infinity (where pow() gives 0 and infinity). */
 	extern double   evaluator_evaluate(void *evaluator, int count,
 					   char **names, double *values);
 
+	/* Evaluate function represented by evaluator given for batch of
+	 * points.  Variable names are given by third argument, and fourth
+	 * argument is array of arrays of respective variable values, each 
+	 * of length given by fifth argument.  Function values are stored
+	 * into array given by last argument.  Variables not given keep
+	 * value from last evaluation. */
+	extern void     evaluator_evaluate_batch(void *evaluator, int count,
+						 char **names,
+						 double **values, int length,
+						 double *results);
+
+	/* Same as above, in single precision: variable values and
+	 * results are single precision arrays, and function is
+	 * calculated in single precision throughout (constants rounded
+	 * to single precision, single precision versions of functions
+	 * used), using bytecode with twice as many points per vector
+	 * instruction as in double precision.  Engine selected for
+	 * evaluator is not used. */
+	extern void     evaluator_evaluate_batch_float(void *evaluator,
+						       int count,
+						       char **names,
+						       float **values,
+						       int length,
+						       float *results);
+
+	/* Evaluate function represented by evaluator in double-double
+	 * arithmetic (about 106 bits of precision).  Each variable value
+	 * is given as sum of leading part from fourth argument and
+	 * trailing part from fifth argument (that could be null pointer
+	 * if all trailing parts are zero).  Function returns leading part 
+	 * of function value, and stores its trailing part into location
+	 * given by last argument, unless it is null pointer.  Numbers in
+	 * function are taken as double precision values they are parsed
+	 * into, while predefined constants and functions are calculated
+	 * to full precision.  Engine selected for evaluator is not used. 
+	 */
+	extern double   evaluator_evaluate_ddouble(void *evaluator,
+						   int count, char **names,
+						   double *values,
+						   double *values_low,
+						   double *result_low);
+
+	/* Same as above for batch of points, with values given and
+	 * results stored as arrays of given length, as for
+	 * evaluator_evaluate_batch().  */
+	extern void     evaluator_evaluate_batch_ddouble(void *evaluator,
+							 int count,
+							 char **names,
+							 double **values,
+							 double
+							 **values_low,
+							 int length,
+							 double *results,
+							 double
+							 *results_low);
+
+	/* Evaluate function represented by evaluator in complex
+	 * arithmetic.  Fourth argument is array of pairs of real and
+	 * imaginary parts of variable values (laid out as array of C99
+	 * double complex numbers), and real and imaginary parts of
+	 * function value are stored into array given by last argument.
+	 * Predefined functions are extended to complex numbers by their
+	 * principal values, except for step and delta functions that
+	 * yield not-a-number value for arguments with non-zero imaginary
+	 * part, and abs function that yields modulus.  Engine selected
+	 * for evaluator is not used. */
+	extern void     evaluator_evaluate_complex(void *evaluator,
+						   int count, char **names,
+						   double *values,
+						   double *result);
+
+	/* Same as above for batch of points, with arrays of variable
+	 * values and results consisting of given number of pairs of
+	 * real and imaginary parts, as for evaluator_evaluate_batch(). */
+	extern void     evaluator_evaluate_batch_complex(void *evaluator,
+							 int count,
+							 char **names,
+							 double **values,
+							 int length,
+							 double *results);
+
+	/* Calculate interval enclosing all values of function
+	 * represented by evaluator over box given by lower and upper
+	 * bounds of variable values (fourth and fifth arguments, lower
+	 * bound of each variable not greater than upper one), and store
+	 * lower and upper bounds of this interval into locations given by
+	 * last two arguments.  Bounds are rounded outward, assuming C
+	 * library functions accurate within two units in last place, and
+	 * predefined constants are taken as intervals containing their
+	 * exact values.  Points of box where function is not defined or
+	 * has pole are disregarded (for example, log(x) for x in [-1,1]
+	 * gives [-inf,0]); if function is not defined anywhere in box,
+	 * not-a-number bounds are stored.  Engine selected for evaluator 
+	 * is not used. */
+	extern void     evaluator_evaluate_interval(void *evaluator,
+						    int count, char **names,
+						    double *lower,
+						    double *upper,
+						    double *result_lower,
+						    double *result_upper);
+
+	/* Same as above for batch of boxes, with bounds given and stored
+	 * as arrays of given length, as for evaluator_evaluate_batch().  */
+	extern void     evaluator_evaluate_batch_interval(void *evaluator,
+							  int count,
+							  char **names,
+							  double **lower,
+							  double **upper,
+							  int length,
+							  double
+							  *results_lower,
+							  double
+							  *results_upper);
+
+	/* Set format of fixed-point evaluation of function represented
+	 * by evaluator: number of bits of two's complement word (from 2
+	 * to 32), number of its fraction bits (from 0 to 31), and flags
+	 * selecting rounding and overflow behavior.  Function returns
+	 * non-zero value on success, or zero if format not valid (format
+	 * is then left unchanged).  Default format has 32 bits with 16
+	 * fraction bits, rounding down and saturation. */
+	extern int      evaluator_set_fixed(void *evaluator, int bits,
+					    int fraction, int flags);
+
+	/* Evaluate function represented by evaluator in fixed-point
+	 * arithmetic, for bit-exact reproduction of integer pipelines.
+	 * Variable values (fourth argument) and returned function value
+	 * are fixed-point numbers, that is integers equal to numbers
+	 * multiplied by two raised to number of fraction bits; values of
+	 * variables not given are current ones converted to
+	 * fixed-point.  Function is evaluated as simplified by evaluator,
+	 * with each operation rounded and its overflow handled as
+	 * selected: numbers and constants are converted from double
+	 * precision, sums and differences are exact, products and
+	 * quotients are rounded (division by zero gives largest or
+	 * smallest value, with sign of dividend, or zero), powers with
+	 * small non-negative integer exponent are calculated by repeated
+	 * squaring, as math_powi() does, and polynomials of single
+	 * variable are evaluated by Horner scheme.  Predefined functions
+	 * and other powers are calculated in double precision and
+	 * rounded, not-a-number values giving zero and infinities largest
+	 * or smallest value; for words of at most 16 bits, values of
+	 * predefined functions are tabulated for all possible arguments
+	 * on first use. */
+	extern int      evaluator_evaluate_fixed(void *evaluator, int count,
+						 char **names, int *values);
+
+	/* Same as above for batch of points, with values given and
+	 * results stored as arrays of given length, as for
+	 * evaluator_evaluate_batch().  */
+	extern void     evaluator_evaluate_batch_fixed(void *evaluator,
+						       int count,
+						       char **names,
+						       int **values,
+						       int length,
+						       int *results);
+
+	/* Evaluate function represented by evaluator given, as
+	 * evaluator_evaluate() does, keeping value of each subtree of
+	 * simplified function between calls, and recalculating only
+	 * subtrees depending on variables which values changed since
+	 * previous call (by this or any other way of assigning variable
+	 * values).  Result is same as of evaluation using tree
+	 * representation of function (EVALUATOR_ENGINE_TREE), whichever
+	 * engine selected.  Variables not given keep their current
+	 * values. */
+	extern double   evaluator_evaluate_incremental(void *evaluator,
+						       int count,
+						       char **names,
+						       double *values);
+
+	/* Assign given value to variable with given name, and evaluate
+	 * function incrementally as above. */
+	extern double   evaluator_update(void *evaluator, char *name,
+					 double value);
+
+	/* Enable memoization of function values computed by
+	 * evaluator_evaluate() for evaluator given, keeping at most given
+	 * number of values (rounded up to multiple of eight), or disable it
+	 * if zero given.  Values are memoized for tuples of values of all
+	 * evaluator variables (matched bitwise), and found ones are
+	 * returned without evaluation; when table is full, values not
+	 * looked up recently are evicted.  Function returns non-zero
+	 * value on success, or zero if size negative.  With memoization
+	 * enabled, evaluator_evaluate() could be called concurrently by
+	 * multiple threads, provided values of all variables are given:
+	 * values found are returned without waiting for any lock, while
+	 * evaluations of values not found are serialized.  Values given
+	 * are kept for later calls, as without memoization (with
+	 * concurrent calls, values kept are those of one of them).
+	 * Setting memoization again discards values memoized and counters
+	 * below. */
+	extern int      evaluator_set_memo(void *evaluator, int size);
+
+	/* Get numbers of memoized function values found and not found by
+	 * evaluator_evaluate() for evaluator given, and of values
+	 * evicted, since memoization enabled (zeros if disabled). */
+	extern void     evaluator_get_memo_statistics(void *evaluator,
+						      long *hits,
+						      long *misses,
+						      long *evictions);
+
+	/* Select engine used for evaluation of function represented by
+	 * evaluator given.  Function returns engine actually selected,
+	 * that is EVALUATOR_ENGINE_TREE if engine requested not
+	 * available.  Evaluators created by library functions use
+	 * EVALUATOR_ENGINE_TREE initially.  Selecting engine explicitly
+	 * disables tiered execution for evaluator. */
+	extern int      evaluator_set_engine(void *evaluator, int engine);
+
+	/* Return engine used by evaluator given. */
+	extern int      evaluator_get_engine(void *evaluator);
+
+	/* Select fastest engine for evaluator given, by measuring time
+	 * of evaluating function for batch of points of size given by
+	 * second argument (size of one meaning single point evaluation)
+	 * using each engine available and several batch widths (numbers
+	 * of points passed to compiled batch function at once).  Engine
+	 * and batch width selected are locked in, disabling tiered
+	 * execution for evaluator, and remembered for later evaluators
+	 * with function of same structure, flags and sample batch size,
+	 * which skip measurements.  Function returns engine selected. */
+	extern int      evaluator_autotune(void *evaluator,
+					   int sample_batch_size);
+
+	/* Return engine and batch width (zero if not limited) selected by 
+	 * autotuning of evaluator given, as well as time per point, in
+	 * nanoseconds, measured for them, into locations given by
+	 * arguments.  Function returns zero if evaluator not autotuned. */
+	extern int      evaluator_get_autotune(void *evaluator, int *engine,
+					       int *width, double *time);
+
+	/* Set directory where functions compiled by EVALUATOR_ENGINE_C
+	 * engine are cached, keyed by compiled code, compiler settings,
+	 * processor features and library version, so that later
+	 * compilations of same functions, possibly by other processes,
+	 * load cached code instead.  Cache could be shared by concurrent
+	 * processes; mismatched entries are rejected and replaced.  Null
+	 * pointer disables cache.  If not set, MATHEVAL_CACHE
+	 * environment variable is used. */
+	extern void     evaluator_set_cache_directory(char *directory);
+
+	/* Set tiered execution parameters.  Evaluator is promoted to
+	 * baseline tier, using EVALUATOR_ENGINE_JIT, after number of
+	 * points given by first argument evaluated, and to optimized
+	 * tier, using engine given by third argument, after number of
+	 * points given by second argument evaluated; zero disables
+	 * respective promotion.  If fourth argument is non-zero,
+	 * optimized tier compilation is done in background thread, with
+	 * evaluator using its current tier until compilation finishes.
+	 * Defaults are 0, 0, EVALUATOR_ENGINE_LLVM and 0, that is tiered
+	 * execution is disabled unless enabled by this function.  Settings
+	 * are global and not thread-safe; they apply to evaluators
+	 * created afterwards and to later promotions of existing ones. */
+	extern void     evaluator_set_tiering(long baseline, long optimized,
+					      int engine, int asynchronous);
+
+	/* Return tiered execution parameters into locations given by
+	 * arguments. */
+	extern void     evaluator_get_tiering(long *baseline,
+					      long *optimized, int *engine,
+					      int *asynchronous);
+
+	/* Return tier currently used by evaluator given. */
+	extern int      evaluator_get_tier(void *evaluator);
+
+	/* Return number of points evaluated by evaluator given. */
+	extern long     evaluator_get_call_count(void *evaluator);
+
+	/* Return name of instruction set variant of vector kernels used
+	 * by EVALUATOR_ENGINE_BYTECODE engine and evaluator groups:
+	 * "avx512f", "avx2",
+	 * "sse4.2" or "generic".  Variant is selected once per process as
+	 * most capable one supported by processor, unless MATHEVAL_ISA
+	 * environment variable names other supported variant.  Returned
+	 * string must not be freed. */
+	extern char    *evaluator_get_isa(void);
+
+	/* Create group of evaluators given (array of length given by
+	 * second argument), evaluated together for same variable values.
+	 * Functions of same structure, differing only in numbers and
+	 * variable names, are packed into shared program executed for
+	 * eight functions at once, each with own constants and variables
+	 * in own vector lane.  Variables are matched by name.  Evaluators
+	 * could be destroyed after group created.  Function returns
+	 * pointer that should be passed to other group functions. */
+	extern void    *evaluator_create_group(void **evaluators, int count);
+
+	/* Destroy group of evaluators. */
+	extern void     evaluator_destroy_group(void *group);
+
+	/* Calculate values of functions of group given, for variable
+	 * values given by rest of arguments as for evaluator_evaluate(),
+	 * and store them into results array, in order of evaluators when
+	 * group created.  Variables not given keep values from previous
+	 * evaluation of group (initially zero). */
+	extern void     evaluator_evaluate_group(void *group, int count,
+						 char **names,
+						 double *values,
+						 double *results);
+
+	/* Return number of distinct function structures in group. */
+	extern int      evaluator_get_group_shape_count(void *group);
+
 	/* Return textual representation of function given by evaluator.
 	 * Textual representation is built after evaluator simplification, 
 	 * so it may differ from original string supplied when creating
@@ -72,6 +456,28 @@ extern          "C" {
 	 * given as second argument. */
 	extern void    *evaluator_derivative(void *evaluator, char *name);
 
+	/* Create evaluator for function represented by evaluator given as
+	 * first argument, with variables which names and respective
+	 * values are given by third and fourth argument replaced by these
+	 * values.  Number of variables is given by second argument.
+	 * Function is simplified after replacement, so that all of its
+	 * parts depending on given variables only are calculated in
+	 * advance.  Names not representing variables of function are
+	 * ignored. */
+	extern void    *evaluator_specialize(void *evaluator, int count,
+					     char **names, double *values);
+
+	/* Create evaluator for function represented by evaluator given as
+	 * first argument, with variable which name is given as second
+	 * argument replaced by function represented by evaluator given as 
+	 * third argument.  Resulting function is simplified, and has as
+	 * variables remaining variables of first function together with
+	 * variables of second function (variables with same name are
+	 * merged).  Evaluators given are not changed, and resulting
+	 * evaluator has flags of first evaluator. */
+	extern void    *evaluator_substitute(void *evaluator, char *name,
+					     void *replacement);
+
 	/* Helper functions to simplify evaluation when variable names are 
 	 * "x", "x" and "y" or "x" and "y" and "z" respectively. */
 	extern double   evaluator_evaluate_x(void *evaluator, double x);
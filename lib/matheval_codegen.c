@@ -0,0 +1,343 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <ctype.h>
+#include <unistd.h>
+#include "common.h"
+#include "codegen.h"
+#include "matheval.h"
+
+/* Name of header guard macro used if output file not given.  */
+#define DEFAULT_GUARD "MATHEVAL_CODEGEN_H"
+
+/* Print usage information and exit with given status.  */
+static void     usage(char *program, int status);
+
+/* Read functions from input file, with given name used for error
+ * messages, and write them to output file.  Names of functions already
+ * written are given by array, with length given by location pointed by
+ * last argument; both are updated.  Function returns TRUE if all
+ * functions written, FALSE otherwise.  */
+static int      process(FILE * input, char *filename, FILE * output,
+			int flags, char ***names, int *count);
+
+/* Read line of arbitrary length from file.  Function returns allocated
+ * string without terminating newline character, or null pointer on end
+ * of file.  */
+static char    *read_line(FILE * file);
+
+/* Check if string is valid C identifier.  */
+static int      valid_identifier(char *string);
+
+int
+main(int argc, char **argv)
+{
+	FILE           *input;	/* Input file. */
+	FILE           *output;	/* Output file. */
+	char           *output_name;	/* Output file name. */
+	char           *guard;	/* Header guard macro name. */
+	char          **names;	/* Names of functions written. */
+	int             count;	/* Number of functions written. */
+	int             flags;	/* Evaluator flags. */
+	int             ok;	/* Flag set if no error occured. */
+	int             option;	/* Command line option. */
+	int             i;	/* Loop counter. */
+
+	/* Parse command line options. */
+	output_name = NULL;
+	guard = NULL;
+	flags = 0;
+	while ((option = getopt(argc, argv, "fg:ho:V")) != -1)
+		switch (option) {
+		case 'f':
+			flags |= EVALUATOR_FAST_MATH;
+			break;
+
+		case 'g':
+			guard = optarg;
+			break;
+
+		case 'h':
+			usage(argv[0], EXIT_SUCCESS);
+			break;
+
+		case 'o':
+			output_name = optarg;
+			break;
+
+		case 'V':
+			printf("matheval-codegen (%s) %s\n", PACKAGE_NAME,
+			       PACKAGE_VERSION);
+			return EXIT_SUCCESS;
+
+		default:
+			usage(argv[0], EXIT_FAILURE);
+		}
+
+	/* Open output file, and derive header guard macro name from its
+	 * name if not given. */
+	if (output_name) {
+		output = fopen(output_name, "w");
+		if (!output) {
+			fprintf(stderr, "%s: cannot open %s\n", argv[0],
+				output_name);
+			return EXIT_FAILURE;
+		}
+	} else
+		output = stdout;
+	if (!guard) {
+		if (output_name) {
+			guard =
+			    strrchr(output_name,
+				    '/') ? strrchr(output_name,
+						   '/') + 1 : output_name;
+			guard = strcpy(XMALLOC(char, strlen(guard) + 2),
+				       guard);
+			for (i = 0; guard[i]; i++)
+				guard[i] = isalnum((unsigned char) guard[i]) ?
+				    toupper((unsigned char) guard[i]) : '_';
+			if (!valid_identifier(guard)) {
+				memmove(guard + 1, guard, strlen(guard) + 1);
+				guard[0] = '_';
+			}
+		} else
+			guard = strcpy(XMALLOC(char, sizeof(DEFAULT_GUARD)),
+				       DEFAULT_GUARD);
+	} else
+		guard = strcpy(XMALLOC(char, strlen(guard) + 1), guard);
+
+	/* Write header guard and definitions of functions used by
+	 * generated code, guarded so that several generated headers
+	 * could be included together. */
+	fprintf(output,
+		"/* Generated by matheval-codegen, do not edit.  */\n\n#ifndef %s\n#define %s 1\n\n",
+		guard, guard);
+	fprintf(output, "%s",
+		"#ifndef MATHEVAL_CODEGEN_PRELUDE\n#define MATHEVAL_CODEGEN_PRELUDE 1\n\n");
+	codegen_write_prelude(output);
+	fprintf(output, "%s", "\n#endif\n");
+
+	/* Process input files given, or standard input if none given. */
+	names = NULL;
+	count = 0;
+	ok = TRUE;
+	if (optind == argc)
+		ok = process(stdin, "<stdin>", output, flags, &names,
+			     &count);
+	for (i = optind; ok && i < argc; i++) {
+		input = fopen(argv[i], "r");
+		if (!input) {
+			fprintf(stderr, "%s: cannot open %s\n", argv[0],
+				argv[i]);
+			ok = FALSE;
+			break;
+		}
+		ok = process(input, argv[i], output, flags, &names, &count);
+		fclose(input);
+	}
+
+	/* Close header guard and output file, removing output file if
+	 * error occured. */
+	fprintf(output, "\n#endif\n");
+	if (output != stdout && fclose(output) != 0) {
+		fprintf(stderr, "%s: cannot write %s\n", argv[0],
+			output_name);
+		ok = FALSE;
+	}
+	if (!ok && output_name)
+		remove(output_name);
+
+	for (i = 0; i < count; i++)
+		XFREE(names[i]);
+	XFREE(names);
+	XFREE(guard);
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void
+usage(char *program, int status)
+{
+	/* Print usage information to standard output if requested, or to 
+	 * standard error otherwise. */
+	fprintf(status == EXIT_SUCCESS ? stdout : stderr,
+		"Usage: %s [-f] [-g GUARD] [-o OUTPUT] [FILE]...\n"
+		"Write C header with inline functions calculating functions read from\n"
+		"FILEs (or standard input), given one per line as \"name = expression\".\n"
+		"Empty lines and lines starting with '#' are ignored.  For each function\n"
+		"name(...), name_batch(...) and name_gradient(...) are written, with\n"
+		"variables as arguments in alphabetical order (so that variables named\n"
+		"as C or C++ keywords, <math.h> macros or names used by generated code\n"
+		"are rejected).\n\n"
+		"  -f         allow fast math transformations\n"
+		"  -g GUARD   use GUARD as header guard macro name\n"
+		"  -o OUTPUT  write header to OUTPUT instead of standard output\n"
+		"  -h         print this help and exit\n"
+		"  -V         print version information and exit\n",
+		program);
+	exit(status);
+}
+
+static int
+process(FILE * input, char *filename, FILE * output, int flags,
+	char ***names, int *count)
+{
+	void           *evaluator;	/* Evaluator for function read. */
+	char           *line;	/* Line read. */
+	char           *name;	/* Function name. */
+	char           *string;	/* Function expression. */
+	char           *equals;	/* Position of equals sign. */
+	char          **variables;	/* Function variables names. */
+	int             variable_count;	/* Number of above names. */
+	int             number;	/* Line number. */
+	int             ok;	/* Flag set if no error occured. */
+	int             i;	/* Loop counter. */
+
+	/* Read input file line by line. */
+	ok = TRUE;
+	for (number = 1; ok && (line = read_line(input)); number++) {
+		/* Skip leading whitespace, empty lines and comments. */
+		for (name = line; isspace((unsigned char) *name); name++);
+		if (!*name || *name == '#') {
+			XFREE(line);
+			continue;
+		}
+
+		/* Split line into function name and expression, and check 
+		 * function name. */
+		equals = strchr(name, '=');
+		if (!equals) {
+			fprintf(stderr, "%s:%d: expected \"name = expression\"\n",
+				filename, number);
+			ok = FALSE;
+			XFREE(line);
+			break;
+		}
+		string = equals + 1;
+		for (*equals = 0;
+		     equals > name && isspace((unsigned char) equals[-1]);
+		     *--equals = 0);
+		if (!valid_identifier(name)) {
+			fprintf(stderr, "%s:%d: invalid function name \"%s\"\n",
+				filename, number, name);
+			ok = FALSE;
+			XFREE(line);
+			break;
+		}
+		for (i = 0; i < *count; i++)
+			if (!strcmp((*names)[i], name))
+				break;
+		if (i < *count) {
+			fprintf(stderr, "%s:%d: function \"%s\" redefined\n",
+				filename, number, name);
+			ok = FALSE;
+			XFREE(line);
+			break;
+		}
+
+		/* Parse expression and write functions calculating it. */
+		evaluator = evaluator_create_flags(string, flags);
+		if (!evaluator) {
+			fprintf(stderr, "%s:%d: invalid expression\n",
+				filename, number);
+			ok = FALSE;
+		} else {
+			/* Check that variables names could be used as
+			 * arguments names. */
+			evaluator_get_variables(evaluator, &variables,
+						&variable_count);
+			for (i = 0; i < variable_count; i++)
+				if (!codegen_valid_argument(variables[i], name)) {
+					fprintf(stderr,
+						"%s:%d: variable name \"%s\" could not be used in C code\n",
+						filename, number,
+						variables[i]);
+					ok = FALSE;
+					break;
+				}
+		}
+		if (ok) {
+			fprintf(output, "\n/* %s = %s */\n", name,
+				evaluator_get_string(evaluator));
+			if (!evaluator_write_inline(evaluator, output, name)) {
+				fprintf(stderr,
+					"%s:%d: unsupported function used\n",
+					filename, number);
+				ok = FALSE;
+			}
+		}
+		if (evaluator)
+			evaluator_destroy(evaluator);
+
+		/* Remember function name. */
+		*names = XREALLOC(char *, *names, *count + 1);
+		(*names)[(*count)++] =
+		    strcpy(XMALLOC(char, strlen(name) + 1), name);
+		XFREE(line);
+	}
+
+	return ok;
+}
+
+static char    *
+read_line(FILE * file)
+{
+	char           *line;	/* Line read. */
+	int             length;	/* Length of line read. */
+	int             capacity;	/* Capacity of line buffer. */
+
+	/* Read line in chunks, enlarging buffer as needed, until newline 
+	 * character or end of file reached. */
+	capacity = 256;
+	line = XMALLOC(char, capacity);
+	length = 0;
+	while (fgets(line + length, capacity - length, file)) {
+		length += strlen(line + length);
+		if (length > 0 && line[length - 1] == '\n') {
+			line[--length] = 0;
+			return line;
+		}
+		capacity *= 2;
+		line = XREALLOC(char, line, capacity);
+	}
+	if (length > 0)
+		return line;
+	XFREE(line);
+	return NULL;
+}
+
+static int
+valid_identifier(char *string)
+{
+	/* Check that string is non-empty, starts with letter or
+	 * underscore and continues with letters, digits or underscores. */
+	if (!isalpha((unsigned char) *string) && *string != '_')
+		return FALSE;
+	for (string++; *string; string++)
+		if (!isalnum((unsigned char) *string) && *string != '_')
+			return FALSE;
+	return TRUE;
+}
@@ -0,0 +1,352 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#if HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include "common.h"
+#include "memo.h"
+
+/* Number of entries of each set; tuple of variable values could be kept
+ * only in set selected by its hash value.  */
+#define WAYS 8
+
+/* Largest number of variables for which representations of tuple of
+ * their values are kept on stack while accessing table.  */
+#define KEY_WORDS 16
+
+/* Access to data shared with concurrent lookups: atomic loads and
+ * stores (relaxed unless stated otherwise), fences and counter
+ * increment.  Without compiler support for atomic operations, lookups
+ * take table lock instead.  */
+#if HAVE_PTHREAD && defined __GNUC__
+#define LOCK_FREE 1
+#define LOAD(location) __atomic_load_n(location, __ATOMIC_RELAXED)
+#define LOAD_ACQUIRE(location) __atomic_load_n(location, __ATOMIC_ACQUIRE)
+#define STORE(location, value) \
+	__atomic_store_n(location, value, __ATOMIC_RELAXED)
+#define STORE_RELEASE(location, value) \
+	__atomic_store_n(location, value, __ATOMIC_RELEASE)
+#define FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define INCREMENT(location) \
+	__atomic_fetch_add(location, 1, __ATOMIC_RELAXED)
+#else
+#define LOCK_FREE 0
+#define LOAD(location) (*(location))
+#define LOAD_ACQUIRE(location) (*(location))
+#define STORE(location, value) (*(location) = (value))
+#define STORE_RELEASE(location, value) (*(location) = (value))
+#define FENCE_ACQUIRE()
+#define FENCE_RELEASE()
+#define INCREMENT(location) ((*(location))++)
+#endif
+
+/* Data structure representing table entry.  Entry is written under
+ * protection of sequence number, odd while writing is in progress, so
+ * that lookup could detect entry changed during reading and ignore
+ * it.  */
+typedef struct {
+	unsigned long   sequence;	/* Sequence number, zero if entry
+					 * never written. */
+	unsigned long long hash;	/* Hash value of tuple of variable
+					 * values. */
+	unsigned long long result;	/* Representation of function
+					 * value. */
+	int             referenced;	/* Flag set when entry found by
+					 * lookup, cleared when entry
+					 * passed over for eviction. */
+} Entry;
+
+/* Data structure representing table.  */
+typedef struct {
+	int             count;	/* Number of variables. */
+	int             sets;	/* Number of sets. */
+	Entry          *entries;	/* Entries, consecutive ones forming 
+					 * sets. */
+	unsigned long long *keys;	/* Representations of tuples of
+					 * variable values of entries. */
+	int            *hands;	/* Entry of each set to be considered for 
+				 * eviction next. */
+	long            hits;	/* Number of lookups succeeded. */
+	long            misses;	/* Number of lookups failed. */
+	long            evictions;	/* Number of entries evicted. */
+#if HAVE_PTHREAD
+	pthread_mutex_t mutex;	/* Table lock. */
+#endif
+} Memo;
+
+/* Return hash value of tuple of variable values, storing their
+ * representations into given array.  */
+static unsigned long long hash(Memo * memo, double *key,
+			       unsigned long long *words);
+
+void           *
+memo_create(int count, int size)
+{
+	Memo           *memo;	/* Table. */
+
+	/* Allocate sets enough for given number of entries, all of them
+	 * empty. */
+	memo = XMALLOC(Memo, 1);
+	memo->count = count;
+	memo->sets = (size + WAYS - 1) / WAYS;
+	memo->entries = XCALLOC(Entry, memo->sets * WAYS);
+	memo->keys =
+	    XCALLOC(unsigned long long, memo->sets * WAYS * count + 1);
+	memo->hands = XCALLOC(int, memo->sets);
+	memo->hits = 0;
+	memo->misses = 0;
+	memo->evictions = 0;
+#if HAVE_PTHREAD
+	pthread_mutex_init(&memo->mutex, NULL);
+#endif
+
+	return memo;
+}
+
+void
+memo_destroy(void *memo)
+{
+	/* Free all memory associated with table. */
+	if (!memo)
+		return;
+#if HAVE_PTHREAD
+	pthread_mutex_destroy(&((Memo *) memo)->mutex);
+#endif
+	XFREE(((Memo *) memo)->entries);
+	XFREE(((Memo *) memo)->keys);
+	XFREE(((Memo *) memo)->hands);
+	XFREE(memo);
+}
+
+int
+memo_lookup(void *memo, double *key, double *result)
+{
+	Memo           *m;	/* Table. */
+	Entry          *entry;	/* Entry examined. */
+	unsigned long long words[KEY_WORDS];	/* Representations of
+						 * variable values, if few
+						 * variables. */
+	unsigned long long *representations;	/* Representations of
+						 * variable values. */
+	unsigned long long h;	/* Hash value of tuple. */
+	unsigned long long value;	/* Representation of function
+					 * value found. */
+	unsigned long   sequence;	/* Sequence number of entry before 
+					 * reading. */
+	int             found;	/* Flag set if tuple found. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	m = memo;
+#if !LOCK_FREE && HAVE_PTHREAD
+	pthread_mutex_lock(&m->mutex);
+#endif
+
+	/* Calculate hash value of tuple. */
+	representations =
+	    (m->count <= KEY_WORDS) ? words : XMALLOC(unsigned long long,
+						      m->count);
+	h = hash(m, key, representations);
+
+	/* Examine entries of set selected by hash value; entry matches if
+	 * its hash value and tuple are same as given ones, and its
+	 * sequence number did not change while reading it (that is, it
+	 * was not written meanwhile). */
+	found = FALSE;
+	for (i = 0; i < WAYS && !found; i++) {
+		entry = &m->entries[(h % m->sets) * WAYS + i];
+		sequence = LOAD_ACQUIRE(&entry->sequence);
+		if (sequence == 0 || sequence & 1
+		    || LOAD(&entry->hash) != h)
+			continue;
+		for (j = 0; j < m->count; j++)
+			if (LOAD(&m->keys[(entry - m->entries) * m->count + j])
+			    != representations[j])
+				break;
+		value = LOAD(&entry->result);
+		FENCE_ACQUIRE();
+		if (j < m->count || LOAD(&entry->sequence) != sequence)
+			continue;
+
+		/* Mark entry as referenced (only if not already, to avoid
+		 * writing shared data needlessly) and return its value. */
+		if (!LOAD(&entry->referenced))
+			STORE(&entry->referenced, TRUE);
+		memcpy(result, &value, sizeof(*result));
+		found = TRUE;
+	}
+
+	/* Count lookup. */
+	if (found)
+		INCREMENT(&m->hits);
+	else
+		INCREMENT(&m->misses);
+
+	if (representations != words)
+		XFREE(representations);
+#if !LOCK_FREE && HAVE_PTHREAD
+	pthread_mutex_unlock(&m->mutex);
+#endif
+	return found;
+}
+
+void
+memo_insert(void *memo, double *key, double result)
+{
+	Memo           *m;	/* Table. */
+	Entry          *set;	/* First entry of set selected. */
+	Entry          *entry;	/* Entry written. */
+	unsigned long long words[KEY_WORDS];	/* Representations of
+						 * variable values, if few
+						 * variables. */
+	unsigned long long *representations;	/* Representations of
+						 * variable values. */
+	unsigned long long h;	/* Hash value of tuple. */
+	unsigned long long value;	/* Representation of function
+					 * value. */
+	int             i;	/* Loop counter. */
+
+	m = memo;
+	representations =
+	    (m->count <= KEY_WORDS) ? words : XMALLOC(unsigned long long,
+						      m->count);
+	h = hash(m, key, representations);
+	set = &m->entries[(h % m->sets) * WAYS];
+
+	/* Do nothing if tuple already inserted (by concurrent caller that
+	 * also failed to find it); entries are only written under table
+	 * lock, so they could be read plainly here. */
+	for (i = 0; i < WAYS; i++)
+		if (set[i].sequence && set[i].hash == h
+		    && !memcmp(&m->keys[(set + i - m->entries) * m->count],
+			       representations,
+			       m->count * sizeof(unsigned long long)))
+			break;
+	if (i < WAYS) {
+		if (representations != words)
+			XFREE(representations);
+		return;
+	}
+
+	/* Select empty entry of set if any, otherwise move around set
+	 * from entry last evicted, clearing flags of referenced entries
+	 * and selecting first entry not referenced (second chance
+	 * policy). */
+	for (i = 0; i < WAYS && set[i].sequence; i++);
+	if (i < WAYS)
+		entry = &set[i];
+	else {
+		for (;;) {
+			entry = &set[m->hands[h % m->sets]];
+			m->hands[h % m->sets] =
+			    (m->hands[h % m->sets] + 1) % WAYS;
+			if (!LOAD(&entry->referenced))
+				break;
+			STORE(&entry->referenced, FALSE);
+		}
+		INCREMENT(&m->evictions);
+	}
+
+	/* Write entry, with sequence number odd meanwhile. */
+	memcpy(&value, &result, sizeof(value));
+	STORE(&entry->sequence, entry->sequence + 1);
+	FENCE_RELEASE();
+	STORE(&entry->hash, h);
+	for (i = 0; i < m->count; i++)
+		STORE(&m->keys[(entry - m->entries) * m->count + i],
+		      representations[i]);
+	STORE(&entry->result, value);
+	STORE(&entry->referenced, FALSE);
+	STORE_RELEASE(&entry->sequence, entry->sequence + 1);
+
+	if (representations != words)
+		XFREE(representations);
+}
+
+void
+memo_lock(void *memo)
+{
+#if HAVE_PTHREAD
+	pthread_mutex_lock(&((Memo *) memo)->mutex);
+#endif
+}
+
+void
+memo_unlock(void *memo)
+{
+#if HAVE_PTHREAD
+	pthread_mutex_unlock(&((Memo *) memo)->mutex);
+#endif
+}
+
+int
+memo_trylock(void *memo)
+{
+#if HAVE_PTHREAD
+	return !pthread_mutex_trylock(&((Memo *) memo)->mutex);
+#else
+	return TRUE;
+#endif
+}
+
+void
+memo_get_statistics(void *memo, long *hits, long *misses, long *evictions)
+{
+	/* Read counters. */
+	*hits = LOAD(&((Memo *) memo)->hits);
+	*misses = LOAD(&((Memo *) memo)->misses);
+	*evictions = LOAD(&((Memo *) memo)->evictions);
+}
+
+static unsigned long long
+hash(Memo * memo, double *key, unsigned long long *words)
+{
+	unsigned long long h;	/* Hash value. */
+	int             i;	/* Loop counter. */
+
+	/* Copy representations of variable values, and combine them by
+	 * multiplication with odd constant and folding of high bits. */
+	h = memo->count;
+	for (i = 0; i < memo->count; i++) {
+		memcpy(&words[i], &key[i], sizeof(words[i]));
+		h = (h ^ words[i]) * 0x9e3779b97f4a7c15ULL;
+		h ^= h >> 32;
+	}
+
+	/* Mix bits of result (as MurmurHash3 finalizer does), as low bits
+	 * of representations of round numbers are all zero, while set is
+	 * selected by low bits of hash value. */
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
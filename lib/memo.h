@@ -0,0 +1,64 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef MEMO_H
+#define MEMO_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* Create table memoizing function values for tuples of given number of
+ * variable values, keeping at most given number (positive) of entries.
+ * Function returns pointer to table.  */
+void           *memo_create(int count, int size);
+
+/* Destroy table.  */
+void            memo_destroy(void *memo);
+
+/* Look up function value for given tuple of variable values (matched
+ * bitwise), and store it into location given by last argument.  Function 
+ * returns non-zero value if found, zero otherwise.  Lookup does not take
+ * table lock, so that it could be done concurrently with lookups and
+ * insertion.  */
+int             memo_lookup(void *memo, double *key, double *result);
+
+/* Insert function value for given tuple of variable values, evicting
+ * entry of its set not used recently if needed.  Table lock should be
+ * held by caller.  */
+void            memo_insert(void *memo, double *key, double result);
+
+/* Take and release table lock, serializing insertions (and calculation
+ * of values to be inserted).  */
+void            memo_lock(void *memo);
+void            memo_unlock(void *memo);
+
+/* Take table lock if free, without waiting.  Function returns non-zero
+ * value if lock taken, zero otherwise.  */
+int             memo_trylock(void *memo);
+
+/* Get numbers of lookups succeeded and failed, and of entries evicted.  */
+void            memo_get_statistics(void *memo, long *hits, long *misses,
+				    long *evictions);
+
+#endif
@@ -28,6 +28,94 @@
 #include <stdarg.h>
 #include "common.h"
 #include "node.h"
+#include "xmath.h"
+
+/* Maximal number of variables and terms of polynomial recognized during
+ * lowering.  */
+#define POLYNOMIAL_VARIABLES 8
+#define POLYNOMIAL_TERMS 256
+
+/* Data structure representing term of polynomial recognized during
+ * lowering.  */
+typedef struct {
+	double          coefficient;	/* Term coefficient.  */
+	int             exponents[POLYNOMIAL_VARIABLES];	/* Exponents
+								 * of
+								 * polynomial
+								 * variables. 
+								 */
+} Term;
+
+/* Data structure representing polynomial recognized during lowering,
+ * with its own array of variables (that exponents of terms refer to).  */
+typedef struct {
+	Record         *variables[POLYNOMIAL_VARIABLES];	/* Polynomial
+								 * variables. 
+								 */
+	int             count;	/* Number of variables.  */
+	int             length;	/* Number of terms.  */
+	Term           *terms;	/* Array of terms (null pointer if subtree
+				 * not recognized).  */
+	int             rewrite;	/* Flag set if subtree is to be
+					 * rewritten in nested form, unless
+					 * subtree of some ancestor is.  */
+} Polynomial;
+
+/* Lower subtree rooted at given node, as node_lower() does, except that
+ * subtree is not rewritten in nested form if polynomial, but left to
+ * the caller to decide (as polynomial of some ancestor subtree could be
+ * rewritten instead).  Polynomial representing subtree is stored into
+ * location given by last argument.  */
+static Node    *node_lower_polynomial(Node * node,
+				      SymbolTable * symbol_table,
+				      Polynomial * polynomial);
+
+/* Recognize subtree rooted at given node as polynomial, given array of
+ * polynomials representing its children subtrees (first being left
+ * operand of binary operation), and initialize polynomial given by last
+ * argument.  Function returns TRUE if subtree recognized, FALSE
+ * otherwise (terms of polynomial allocated should be freed anyway).  */
+static int      polynomial_recognize(Node * node, Polynomial * operands,
+				     Polynomial * polynomial);
+
+/* Copy terms of polynomial given by first argument, with variables
+ * mapped to variables of polynomial given by second argument (appended
+ * to its variables if not found), into given array.  Function returns
+ * FALSE if number of variables would exceed POLYNOMIAL_VARIABLES, TRUE
+ * otherwise.  */
+static int      polynomial_map(Polynomial * source, Polynomial * polynomial,
+			       Term * terms);
+
+/* Create nested Horner form tree for polynomial with given terms and
+ * variables.  */
+static Node    *polynomial_node(Term * terms, int length,
+				Record ** variables, int count);
+
+/* Create tree of operations given by second argument over given array
+ * of operands with given length, balanced in order to shorten
+ * dependency chain.  Multiplications followed by additions or
+ * subtractions are contracted into multiply-add operations if last
+ * argument set.  */
+static Node    *balanced_node(Node ** operands, int length, char operation,
+			      int contract);
+
+/* Create binary operation node of given type for given operands,
+ * contracting multiplication followed by addition or subtraction into
+ * multiply-add operation if last argument set.  */
+static Node    *contracted_node(char operation, Node * left, Node * right,
+				int contract);
+
+/* Write polynomial node to given string, or only calculate length of
+ * its textual representation if string is null.  Function returns
+ * length of textual representation.  */
+static int      polynomial_write(Node * node, char *string);
+
+/* Write number to file as C floating point literal, precisely enough to 
+ * be read back unchanged.  */
+static void     write_c_number(FILE * file, double value);
+
+/* Mix given value into hash value.  */
+static unsigned long hash_combine(unsigned long hash, unsigned long value);
 
 Node           *
 node_create(char type, ...)
@@ -82,6 +170,27 @@ node_create(char type, ...)
 		node->data.bin_op.right = va_arg(ap, Node *);
 		break;
 
+	case 'p':
+		/* Initialize base and exponent. */
+		node->data.power.child = va_arg(ap, Node *);
+		node->data.power.exponent = va_arg(ap, int);
+		break;
+
+	case 'h':
+		/* Initialize argument, degree and array of coefficients
+		 * (that node takes ownership of). */
+		node->data.polynomial.child = va_arg(ap, Node *);
+		node->data.polynomial.degree = va_arg(ap, int);
+		node->data.polynomial.coefficients = va_arg(ap, double *);
+		break;
+
+	case 'm':
+		/* Initialize multiplication and addition operands. */
+		node->data.muladd.left = va_arg(ap, Node *);
+		node->data.muladd.right = va_arg(ap, Node *);
+		node->data.muladd.addend = va_arg(ap, Node *);
+		break;
+
 	default:
 		assert(0);
 	}
@@ -117,6 +226,21 @@ node_destroy(Node * node)
 		node_destroy(node->data.bin_op.left);
 		node_destroy(node->data.bin_op.right);
 		break;
+
+	case 'p':
+		node_destroy(node->data.power.child);
+		break;
+
+	case 'h':
+		node_destroy(node->data.polynomial.child);
+		XFREE(node->data.polynomial.coefficients);
+		break;
+
+	case 'm':
+		node_destroy(node->data.muladd.left);
+		node_destroy(node->data.muladd.right);
+		node_destroy(node->data.muladd.addend);
+		break;
 	}
 
 	/* Deallocate memory used by node. */
@@ -150,9 +274,107 @@ node_copy(Node * node)
 		return node_create('b', node->data.bin_op.operation,
 				   node_copy(node->data.bin_op.left),
 				   node_copy(node->data.bin_op.right));
+
+	case 'p':
+		return node_create('p', node_copy(node->data.power.child),
+				   node->data.power.exponent);
+
+	case 'h':
+		{
+			double         *coefficients;	/* Copy of
+							 * coefficients. */
+
+			coefficients =
+			    XMALLOC(double,
+				    node->data.polynomial.degree + 1);
+			memcpy(coefficients,
+			       node->data.polynomial.coefficients,
+			       (node->data.polynomial.degree +
+				1) * sizeof(double));
+			return node_create('h',
+					   node_copy(node->data.polynomial.
+						     child),
+					   node->data.polynomial.degree,
+					   coefficients);
+		}
+
+	case 'm':
+		return node_create('m', node_copy(node->data.muladd.left),
+				   node_copy(node->data.muladd.right),
+				   node_copy(node->data.muladd.addend));
 	}
 }
 
+Node           *
+node_import(Node * node, SymbolTable * symbol_table)
+{
+	Node           *copy;	/* Copy of node. */
+
+	/* According to node type, create (deep) copy of subtree rooted at 
+	 * node, looking up records by name in given symbol table. */
+	switch (node->type) {
+	case 'n':
+		return node_create('n', node->data.number);
+
+	case 'c':
+		return node_create('c',
+				   symbol_table_lookup(symbol_table,
+						       node->data.constant->
+						       name));
+
+	case 'v':
+		return node_create('v',
+				   symbol_table_insert(symbol_table,
+						       node->data.variable->
+						       name, 'v'));
+
+	case 'f':
+		return node_create('f',
+				   symbol_table_lookup(symbol_table,
+						       node->data.function.
+						       record->name),
+				   node_import(node->data.function.child,
+					       symbol_table));
+
+	case 'u':
+		return node_create('u', node->data.un_op.operation,
+				   node_import(node->data.un_op.child,
+					       symbol_table));
+
+	case 'b':
+		return node_create('b', node->data.bin_op.operation,
+				   node_import(node->data.bin_op.left,
+					       symbol_table),
+				   node_import(node->data.bin_op.right,
+					       symbol_table));
+
+	case 'p':
+		return node_create('p',
+				   node_import(node->data.power.child,
+					       symbol_table),
+				   node->data.power.exponent);
+
+	case 'h':
+		/* Reuse copy of coefficients. */
+		copy = node_copy(node);
+		node_destroy(copy->data.polynomial.child);
+		copy->data.polynomial.child =
+		    node_import(node->data.polynomial.child, symbol_table);
+		return copy;
+
+	case 'm':
+		return node_create('m',
+				   node_import(node->data.muladd.left,
+					       symbol_table),
+				   node_import(node->data.muladd.right,
+					       symbol_table),
+				   node_import(node->data.muladd.addend,
+					       symbol_table));
+	}
+
+	return NULL;
+}
+
 Node           *
 node_simplify(Node * node)
 {
@@ -304,7 +526,222 @@ node_simplify(Node * node)
 				return node;
 		else
 			return node;
+
+	case 'p':
+		/* Simplify base and if number apply operation and replace
+		 * operation node with number node.  Eliminate 0 and 1 as
+		 * exponents. */
+		node->data.power.child = node_simplify(node->data.power.child);
+		if (node->data.power.child->type == 'n'
+		    || node->data.power.exponent == 0) {
+			double          value = node_evaluate(node);
+
+			node_destroy(node);
+			return node_create('n', value);
+		} else if (node->data.power.exponent == 1) {
+			Node           *child;
+
+			child = node->data.power.child;
+			node->data.power.child = NULL;
+			node_destroy(node);
+			return child;
+		} else
+			return node;
+
+	case 'h':
+		/* Simplify polynomial argument and if number, or if
+		 * polynomial constant, evaluate polynomial and replace
+		 * polynomial node with number node. */
+		node->data.polynomial.child =
+		    node_simplify(node->data.polynomial.child);
+		if (node->data.polynomial.child->type == 'n'
+		    || node->data.polynomial.degree == 0) {
+			double          value = node_evaluate(node);
+
+			node_destroy(node);
+			return node_create('n', value);
+		} else
+			return node;
+
+	case 'm':
+		/* Simplify multiply-add operands and if numbers apply
+		 * operation and replace operation node with number node. */
+		node->data.muladd.left = node_simplify(node->data.muladd.left);
+		node->data.muladd.right =
+		    node_simplify(node->data.muladd.right);
+		node->data.muladd.addend =
+		    node_simplify(node->data.muladd.addend);
+		if (node->data.muladd.left->type == 'n'
+		    && node->data.muladd.right->type == 'n'
+		    && node->data.muladd.addend->type == 'n') {
+			double          value = node_evaluate(node);
+
+			node_destroy(node);
+			return node_create('n', value);
+		} else
+			return node;
+	}
+}
+
+Node           *
+node_lower(Node * node, SymbolTable * symbol_table)
+{
+	Polynomial      polynomial;	/* Polynomial representing tree. */
+
+	/* Lower tree, and rewrite it in nested form if whole tree is
+	 * polynomial to be rewritten. */
+	node = node_lower_polynomial(node, symbol_table, &polynomial);
+	if (polynomial.rewrite) {
+		node_destroy(node);
+		node =
+		    node_simplify(polynomial_node
+				  (polynomial.terms, polynomial.length,
+				   polynomial.variables, polynomial.count));
+	}
+	XFREE(polynomial.terms);
+	return node;
+}
+
+Node           *
+node_fast_math(Node * node)
+{
+	Node          **operands;	/* Operands of chain of same
+					 * operations. */
+	Node          **stack;	/* Stack of chain nodes still to
+				 * traverse. */
+	Node           *curr;	/* Current chain node. */
+	char            operation;	/* Chain operation type. */
+	int             length;	/* Number of operands. */
+	int             capacity;	/* Capacity of above arrays. */
+	int             height;	/* Number of nodes on stack. */
+	int             contract;	/* Flag set if fused multiply-add
+					 * is fast. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* According to node type, transform subtree rooted at node. */
+	switch (node->type) {
+	case 'n':
+	case 'c':
+	case 'v':
+		return node;
+
+	case 'f':
+		node->data.function.child =
+		    node_fast_math(node->data.function.child);
+		return node;
+
+	case 'u':
+		node->data.un_op.child = node_fast_math(node->data.un_op.child);
+		return node;
+
+	case 'p':
+		node->data.power.child = node_fast_math(node->data.power.child);
+		return node;
+
+	case 'h':
+		node->data.polynomial.child =
+		    node_fast_math(node->data.polynomial.child);
+		return node;
+
+	case 'm':
+		node->data.muladd.left = node_fast_math(node->data.muladd.left);
+		node->data.muladd.right =
+		    node_fast_math(node->data.muladd.right);
+		node->data.muladd.addend =
+		    node_fast_math(node->data.muladd.addend);
+		return node;
+
+	case 'b':
+		contract = math_fast_fma();
+
+		/* Replace division by number or constant with
+		 * multiplication by reciprocal. */
+		if (node->data.bin_op.operation == '/'
+		    && (node->data.bin_op.right->type == 'n'
+			|| node->data.bin_op.right->type == 'c')) {
+			double          value;	/* Divisor value. */
+
+			value = node_evaluate(node->data.bin_op.right);
+			node_destroy(node->data.bin_op.right);
+			node->data.bin_op.operation = '*';
+			node->data.bin_op.right = node_create('n', 1 / value);
+		}
+
+		/* Transform operands of operations other than addition
+		 * and multiplication, contracting subtraction. */
+		operation = node->data.bin_op.operation;
+		if (operation != '+' && operation != '*') {
+			Node           *left,
+			               *right;	/* Operands nodes. */
+
+			left = node_fast_math(node->data.bin_op.left);
+			right = node_fast_math(node->data.bin_op.right);
+			XFREE(node);
+			return contracted_node(operation, left, right,
+					       contract);
+		}
+
+		/* Collect operands of chain of same operations, and
+		 * destroy chain nodes. */
+		capacity = 8;
+		operands = XMALLOC(Node *, capacity);
+		stack = XMALLOC(Node *, capacity);
+		length = 0;
+		height = 0;
+		stack[height++] = node;
+		while (height > 0) {
+			curr = stack[--height];
+			if (curr->type == 'b'
+			    && curr->data.bin_op.operation == operation) {
+				if (height + 2 > capacity
+				    || length + 2 > capacity) {
+					capacity *= 2;
+					operands =
+					    XREALLOC(Node *, operands,
+						     capacity);
+					stack =
+					    XREALLOC(Node *, stack, capacity);
+				}
+				stack[height++] = curr->data.bin_op.right;
+				stack[height++] = curr->data.bin_op.left;
+				XFREE(curr);
+			} else
+				operands[length++] = node_fast_math(curr);
+		}
+		XFREE(stack);
+
+		/* Fold numbers among operands into single number, put
+		 * it last, and drop it if neutral for operation. */
+		for (curr = NULL, i = j = 0; i < length; i++)
+			if (operands[i]->type != 'n')
+				operands[j++] = operands[i];
+			else if (!curr)
+				curr = operands[i];
+			else {
+				if (operation == '+')
+					curr->data.number +=
+					    operands[i]->data.number;
+				else
+					curr->data.number *=
+					    operands[i]->data.number;
+				node_destroy(operands[i]);
+			}
+		length = j;
+		if (curr && (length == 0
+			     || curr->data.number !=
+			     ((operation == '+') ? 0 : 1)))
+			operands[length++] = curr;
+		else
+			node_destroy(curr);
+
+		/* Rebuild chain as balanced tree. */
+		node = balanced_node(operands, length, operation, contract);
+		XFREE(operands);
+		return node;
 	}
+
+	return node;
 }
 
 double
@@ -358,9 +795,28 @@ node_evaluate(Node * node)
 			    node_evaluate(node->data.bin_op.right);
 
 		case '^':
-			return pow(node_evaluate(node->data.bin_op.left),
-				   node_evaluate(node->data.bin_op.right));
+			return math_pow(node_evaluate(node->data.bin_op.left),
+					node_evaluate(node->data.bin_op.
+						      right));
 		}
+
+	case 'p':
+		/* Power node is evaluated by repeated squaring. */
+		return math_powi(node_evaluate(node->data.power.child),
+				 node->data.power.exponent);
+
+	case 'h':
+		/* Polynomial node is evaluated from packed coefficients. */
+		return math_polynomial(node_evaluate
+				       (node->data.polynomial.child),
+				       node->data.polynomial.coefficients,
+				       node->data.polynomial.degree);
+
+	case 'm':
+		/* Multiply-add node is evaluated with single rounding. */
+		return fma(node_evaluate(node->data.muladd.left),
+			   node_evaluate(node->data.muladd.right),
+			   node_evaluate(node->data.muladd.addend));
 	}
 
 	return 0;
@@ -1376,9 +1832,147 @@ node_derivative(Node * node, char *name, SymbolTable * symbol_table)
 				return derivative;
 			}
 		}
+
+	case 'p':
+		/* Apply (f^n)'=n*f^(n-1)*f' derivative rule. */
+		return node_create('b', '*',
+				   node_create('b', '*',
+					       node_create('n',
+							   (double) node->
+							   data.power.
+							   exponent),
+					       node_derivative(node->data.
+							       power.child,
+							       name,
+							       symbol_table)),
+				   node_create('p',
+					       node_copy(node->data.power.
+							 child),
+					       node->data.power.exponent - 1));
+
+	case 'h':
+		/* Apply (sum(c[k]*f^k))'=sum(k*c[k]*f^(k-1))*f' derivative
+		 * rule. */
+		{
+			double         *coefficients;	/* Derivative
+							 * polynomial
+							 * coefficients. */
+			int             k;	/* Loop counter. */
+
+			if (node->data.polynomial.degree == 0)
+				return node_create('n', 0.0);
+			coefficients =
+			    XMALLOC(double, node->data.polynomial.degree);
+			for (k = 1; k <= node->data.polynomial.degree; k++)
+				coefficients[k - 1] =
+				    k *
+				    node->data.polynomial.coefficients[k];
+			return node_create('b', '*',
+					   node_create('h',
+						       node_copy(node->data.
+								 polynomial.
+								 child),
+						       node->data.polynomial.
+						       degree - 1,
+						       coefficients),
+					   node_derivative(node->data.
+							   polynomial.child,
+							   name,
+							   symbol_table));
+		}
+
+	case 'm':
+		/* Apply (f*g+h)'=f'*g+f*g'+h' derivative rule. */
+		return node_create('b', '+',
+				   node_create('b', '+',
+					       node_create('b', '*',
+							   node_derivative
+							   (node->data.muladd.
+							    left, name,
+							    symbol_table),
+							   node_copy(node->
+								     data.
+								     muladd.
+								     right)),
+					       node_create('b', '*',
+							   node_copy(node->
+								     data.
+								     muladd.
+								     left),
+							   node_derivative
+							   (node->data.muladd.
+							    right, name,
+							    symbol_table))),
+				   node_derivative(node->data.muladd.addend,
+						   name, symbol_table));
 	}
 }
 
+Node           *
+node_substitute(Node * node, Record * record, Node * replacement)
+{
+	/* According to node type, replace variable or proceed with
+	 * calling function recursively on node children. */
+	switch (node->type) {
+	case 'n':
+	case 'c':
+		return node;
+
+	case 'v':
+		if (node->data.variable != record)
+			return node;
+		node_destroy(node);
+		return node_copy(replacement);
+
+	case 'f':
+		node->data.function.child =
+		    node_substitute(node->data.function.child, record,
+				    replacement);
+		return node;
+
+	case 'u':
+		node->data.un_op.child =
+		    node_substitute(node->data.un_op.child, record,
+				    replacement);
+		return node;
+
+	case 'b':
+		node->data.bin_op.left =
+		    node_substitute(node->data.bin_op.left, record,
+				    replacement);
+		node->data.bin_op.right =
+		    node_substitute(node->data.bin_op.right, record,
+				    replacement);
+		return node;
+
+	case 'p':
+		node->data.power.child =
+		    node_substitute(node->data.power.child, record,
+				    replacement);
+		return node;
+
+	case 'h':
+		node->data.polynomial.child =
+		    node_substitute(node->data.polynomial.child, record,
+				    replacement);
+		return node;
+
+	case 'm':
+		node->data.muladd.left =
+		    node_substitute(node->data.muladd.left, record,
+				    replacement);
+		node->data.muladd.right =
+		    node_substitute(node->data.muladd.right, record,
+				    replacement);
+		node->data.muladd.addend =
+		    node_substitute(node->data.muladd.addend, record,
+				    replacement);
+		return node;
+	}
+
+	return node;
+}
+
 void
 node_flag_variables(Node * node)
 {
@@ -1401,7 +1995,144 @@ node_flag_variables(Node * node)
 		node_flag_variables(node->data.bin_op.left);
 		node_flag_variables(node->data.bin_op.right);
 		break;
+
+	case 'p':
+		node_flag_variables(node->data.power.child);
+		break;
+
+	case 'h':
+		node_flag_variables(node->data.polynomial.child);
+		break;
+
+	case 'm':
+		node_flag_variables(node->data.muladd.left);
+		node_flag_variables(node->data.muladd.right);
+		node_flag_variables(node->data.muladd.addend);
+		break;
+	}
+}
+
+unsigned long
+node_hash(Node * node)
+{
+	unsigned long   hash;	/* Hash value. */
+	char           *name;	/* Function name. */
+	int             i;	/* Loop counter. */
+
+	/* Start from node type and, according to node type, mix in
+	 * operation, function name, exponent or degree, then hash values
+	 * of node children.  Values of numbers and constants, as well as
+	 * variable names, are ignored. */
+	hash = hash_combine(0, node->type);
+	switch (node->type) {
+	case 'f':
+		for (name = node->data.function.record->name; *name; name++)
+			hash = hash_combine(hash, *name);
+		hash =
+		    hash_combine(hash,
+				 node_hash(node->data.function.child));
+		break;
+
+	case 'u':
+		hash = hash_combine(hash, node->data.un_op.operation);
+		hash = hash_combine(hash, node_hash(node->data.un_op.child));
+		break;
+
+	case 'b':
+		hash = hash_combine(hash, node->data.bin_op.operation);
+		hash = hash_combine(hash, node_hash(node->data.bin_op.left));
+		hash =
+		    hash_combine(hash, node_hash(node->data.bin_op.right));
+		break;
+
+	case 'p':
+		hash = hash_combine(hash, node->data.power.exponent);
+		hash = hash_combine(hash, node_hash(node->data.power.child));
+		break;
+
+	case 'h':
+		hash = hash_combine(hash, node->data.polynomial.degree);
+		for (i = 0; i <= node->data.polynomial.degree; i++)
+			hash =
+			    hash_combine(hash,
+					 node->data.polynomial.
+					 coefficients[i] == 0);
+		hash =
+		    hash_combine(hash,
+				 node_hash(node->data.polynomial.child));
+		break;
+
+	case 'm':
+		hash = hash_combine(hash, node_hash(node->data.muladd.left));
+		hash =
+		    hash_combine(hash, node_hash(node->data.muladd.right));
+		hash =
+		    hash_combine(hash, node_hash(node->data.muladd.addend));
+		break;
 	}
+
+	return hash;
+}
+
+int
+node_same_shape(Node * node1, Node * node2)
+{
+	int             i;	/* Loop counter. */
+
+	/* Compare node types and, according to node type, operation,
+	 * function, exponent or degree, then structure of node children.
+	 * Values of numbers and constants, as well as variable names, are
+	 * not compared. */
+	if (node1->type != node2->type)
+		return 0;
+	switch (node1->type) {
+	case 'f':
+		return node1->data.function.record->data.function ==
+		    node2->data.function.record->data.function
+		    && node_same_shape(node1->data.function.child,
+				       node2->data.function.child);
+
+	case 'u':
+		return node1->data.un_op.operation ==
+		    node2->data.un_op.operation
+		    && node_same_shape(node1->data.un_op.child,
+				       node2->data.un_op.child);
+
+	case 'b':
+		return node1->data.bin_op.operation ==
+		    node2->data.bin_op.operation
+		    && node_same_shape(node1->data.bin_op.left,
+				       node2->data.bin_op.left)
+		    && node_same_shape(node1->data.bin_op.right,
+				       node2->data.bin_op.right);
+
+	case 'p':
+		return node1->data.power.exponent ==
+		    node2->data.power.exponent
+		    && node_same_shape(node1->data.power.child,
+				       node2->data.power.child);
+
+	case 'h':
+		if (node1->data.polynomial.degree !=
+		    node2->data.polynomial.degree)
+			return 0;
+		for (i = 0; i <= node1->data.polynomial.degree; i++)
+			if ((node1->data.polynomial.coefficients[i] == 0) !=
+			    (node2->data.polynomial.coefficients[i] == 0))
+				return 0;
+		return node_same_shape(node1->data.polynomial.child,
+				       node2->data.polynomial.child);
+
+	case 'm':
+		return node_same_shape(node1->data.muladd.left,
+				       node2->data.muladd.left)
+		    && node_same_shape(node1->data.muladd.right,
+				       node2->data.muladd.right)
+		    && node_same_shape(node1->data.muladd.addend,
+				       node2->data.muladd.addend);
+	}
+
+	return 1;
 }
 
 int
@@ -1448,6 +2179,23 @@ node_get_length(Node * node)
 	case 'b':
 		return 1 + node_get_length(node->data.bin_op.left) + 1 +
 		    node_get_length(node->data.bin_op.right) + 1;
+
+	case 'p':
+		/* Exponent is written same as number would be. */
+		length =
+		    snprintf(NULL, 0, "%d", node->data.power.exponent);
+		if (node->data.power.exponent < 0)
+			length += 2;
+		return 1 + node_get_length(node->data.power.child) + 1 +
+		    length + 1;
+
+	case 'h':
+		return polynomial_write(node, NULL);
+
+	case 'm':
+		return 1 + 1 + node_get_length(node->data.muladd.left) + 1 +
+		    node_get_length(node->data.muladd.right) + 1 + 1 +
+		    node_get_length(node->data.muladd.addend) + 1;
 	}
 
 	return 0;
@@ -1509,5 +2257,936 @@ node_write(Node * node, char *string)
 		string += strlen(string);
 		sprintf(string, "%c", ')');
 		break;
+
+	case 'p':
+		sprintf(string, "%c", '(');
+		string += strlen(string);
+		node_write(node->data.power.child, string);
+		string += strlen(string);
+		if (node->data.power.exponent < 0)
+			sprintf(string, "^(%d))", node->data.power.exponent);
+		else
+			sprintf(string, "^%d)", node->data.power.exponent);
+		break;
+
+	case 'h':
+		/* Polynomial is written as sum of terms. */
+		polynomial_write(node, string);
+		break;
+
+	case 'm':
+		/* Multiply-add is written as multiplication followed by
+		 * addition. */
+		sprintf(string, "%s", "((");
+		string += strlen(string);
+		node_write(node->data.muladd.left, string);
+		string += strlen(string);
+		sprintf(string, "%c", '*');
+		string += strlen(string);
+		node_write(node->data.muladd.right, string);
+		string += strlen(string);
+		sprintf(string, "%s", ")+");
+		string += strlen(string);
+		node_write(node->data.muladd.addend, string);
+		string += strlen(string);
+		sprintf(string, "%c", ')');
+		break;
 	}
 }
+
+int
+node_write_c(Node * node, FILE * file, Record ** records, int count,
+	     int *temporaries)
+{
+	int             operands[3];	/* Temporaries holding operand
+					 * values. */
+	int             partial[MATH_POLYNOMIAL_MAX / 2 + 1];	/* Temporaries 
+								 * holding 
+								 * partial 
+								 * sums. */
+	int             base;	/* Temporary holding base of power. */
+	int             result;	/* Temporary holding result. */
+	int             m;	/* Absolute value of exponent. */
+	int             length;	/* Number of partial sums. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* According to node type, write statements calculating value of
+	 * subtree rooted at node.  Operations are written in same order
+	 * as performed by node_evaluate(), so that same results are
+	 * calculated. */
+	switch (node->type) {
+	case 'n':
+	case 'c':
+		fprintf(file, "\tconst double t%d = ", *temporaries);
+		write_c_number(file, (node->type == 'n') ?
+			       node->data.number : node->data.constant->
+			       data.value);
+		fprintf(file, "%s", ";\n");
+		return (*temporaries)++;
+
+	case 'v':
+		for (i = 0; i < count; i++)
+			if (records[i] == node->data.variable)
+				break;
+		fprintf(file, "\tconst double t%d = x%d;\n", *temporaries,
+			i);
+		return (*temporaries)++;
+
+	case 'f':
+		operands[0] =
+		    node_write_c(node->data.function.child, file, records,
+				 count, temporaries);
+		fprintf(file, "\tconst double t%d = matheval_%s(t%d);\n",
+			*temporaries, node->data.function.record->name,
+			operands[0]);
+		return (*temporaries)++;
+
+	case 'u':
+		operands[0] =
+		    node_write_c(node->data.un_op.child, file, records,
+				 count, temporaries);
+		fprintf(file, "\tconst double t%d = %ct%d;\n", *temporaries,
+			node->data.un_op.operation, operands[0]);
+		return (*temporaries)++;
+
+	case 'b':
+		operands[0] =
+		    node_write_c(node->data.bin_op.left, file, records,
+				 count, temporaries);
+		operands[1] =
+		    node_write_c(node->data.bin_op.right, file, records,
+				 count, temporaries);
+		if (node->data.bin_op.operation == '^')
+			fprintf(file,
+				"\tconst double t%d = matheval_pow(t%d, t%d);\n",
+				*temporaries, operands[0], operands[1]);
+		else
+			fprintf(file, "\tconst double t%d = t%d %c t%d;\n",
+				*temporaries, operands[0],
+				node->data.bin_op.operation, operands[1]);
+		return (*temporaries)++;
+
+	case 'p':
+		/* Power is calculated by repeated squaring, as
+		 * math_powi() does. */
+		base =
+		    node_write_c(node->data.power.child, file, records,
+				 count, temporaries);
+		result = -1;
+		for (m = abs(node->data.power.exponent); m; m >>= 1) {
+			if (m & 1) {
+				if (result >= 0) {
+					fprintf(file,
+						"\tconst double t%d = t%d * t%d;\n",
+						*temporaries, result, base);
+					result = (*temporaries)++;
+				} else
+					result = base;
+			}
+			if (m > 1) {
+				fprintf(file,
+					"\tconst double t%d = t%d * t%d;\n",
+					*temporaries, base, base);
+				base = (*temporaries)++;
+			}
+		}
+		if (result < 0)
+			fprintf(file, "\tconst double t%d = 1.0;\n",
+				*temporaries);
+		else if (node->data.power.exponent < 0)
+			fprintf(file, "\tconst double t%d = 1.0 / t%d;\n",
+				*temporaries, result);
+		else
+			return result;
+		return (*temporaries)++;
+
+	case 'h':
+		base =
+		    node_write_c(node->data.polynomial.child, file, records,
+				 count, temporaries);
+
+		/* Lower degree polynomial is calculated by Horner scheme,
+		 * as math_horner() does. */
+		if (node->data.polynomial.degree < MATH_ESTRIN_MIN) {
+			fprintf(file, "\tconst double t%d = ", *temporaries);
+			write_c_number(file,
+				       node->data.polynomial.
+				       coefficients[node->data.polynomial.
+						    degree]);
+			fprintf(file, "%s", ";\n");
+			result = (*temporaries)++;
+			for (i = node->data.polynomial.degree - 1; i >= 0;
+			     i--) {
+				fprintf(file,
+					"\tconst double t%d = t%d * t%d + ",
+					*temporaries, result, base);
+				write_c_number(file,
+					       node->data.polynomial.
+					       coefficients[i]);
+				fprintf(file, "%s", ";\n");
+				result = (*temporaries)++;
+			}
+			return result;
+		}
+
+		/* Higher degree polynomial is calculated by Estrin scheme, 
+		 * as math_estrin() does. */
+		length = (node->data.polynomial.degree + 1) / 2;
+		for (i = 0; i < length; i++) {
+			fprintf(file, "\tconst double t%d = ", *temporaries);
+			write_c_number(file,
+				       node->data.polynomial.coefficients[2 *
+									  i]);
+			fprintf(file, "%s", " + ");
+			write_c_number(file,
+				       node->data.polynomial.coefficients[2 *
+									  i +
+									  1]);
+			fprintf(file, " * t%d;\n", base);
+			partial[i] = (*temporaries)++;
+		}
+		if (node->data.polynomial.degree % 2 == 0) {
+			fprintf(file, "\tconst double t%d = ", *temporaries);
+			write_c_number(file,
+				       node->data.polynomial.
+				       coefficients[node->data.polynomial.
+						    degree]);
+			fprintf(file, "%s", ";\n");
+			partial[length++] = (*temporaries)++;
+		}
+		while (length > 1) {
+			fprintf(file, "\tconst double t%d = t%d * t%d;\n",
+				*temporaries, base, base);
+			base = (*temporaries)++;
+			for (i = j = 0; i + 1 < length; i += 2) {
+				fprintf(file,
+					"\tconst double t%d = t%d + t%d * t%d;\n",
+					*temporaries, partial[i],
+					partial[i + 1], base);
+				partial[j++] = (*temporaries)++;
+			}
+			if (length % 2 == 1)
+				partial[j++] = partial[length - 1];
+			length = j;
+		}
+		return partial[0];
+
+	case 'm':
+		operands[0] =
+		    node_write_c(node->data.muladd.left, file, records,
+				 count, temporaries);
+		operands[1] =
+		    node_write_c(node->data.muladd.right, file, records,
+				 count, temporaries);
+		operands[2] =
+		    node_write_c(node->data.muladd.addend, file, records,
+				 count, temporaries);
+		fprintf(file, "\tconst double t%d = fma(t%d, t%d, t%d);\n",
+			*temporaries, operands[0], operands[1], operands[2]);
+		return (*temporaries)++;
+	}
+
+	return -1;
+}
+
+static Node    *
+node_lower_polynomial(Node * node, SymbolTable * symbol_table,
+		      Polynomial * polynomial)
+{
+	Node          **children[3];	/* Locations of children pointers. 
+					 */
+	Polynomial      operands[3];	/* Polynomials representing
+					 * children subtrees. */
+	int             length;	/* Number of children. */
+	int             degree;	/* Largest exponent. */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* According to node type, collect children of node. */
+	switch (node->type) {
+	case 'f':
+		children[0] = &node->data.function.child;
+		length = 1;
+		break;
+
+	case 'u':
+		children[0] = &node->data.un_op.child;
+		length = 1;
+		break;
+
+	case 'b':
+		children[0] = &node->data.bin_op.left;
+		children[1] = &node->data.bin_op.right;
+		length = 2;
+		break;
+
+	case 'p':
+		children[0] = &node->data.power.child;
+		length = 1;
+		break;
+
+	case 'h':
+		children[0] = &node->data.polynomial.child;
+		length = 1;
+		break;
+
+	case 'm':
+		children[0] = &node->data.muladd.left;
+		children[1] = &node->data.muladd.right;
+		children[2] = &node->data.muladd.addend;
+		length = 3;
+		break;
+
+	default:
+		length = 0;
+	}
+
+	/* Lower children subtrees, and recognize subtree rooted at node
+	 * as polynomial from polynomials representing them (so that
+	 * each node is visited once, instead of subtree being walked
+	 * again for each of its ancestors). */
+	for (i = 0; i < length; i++)
+		*children[i] =
+		    node_lower_polynomial(*children[i], symbol_table,
+					  &operands[i]);
+	if (!polynomial_recognize(node, operands, polynomial)) {
+		XFREE(polynomial->terms);
+		polynomial->terms = NULL;
+	}
+
+	/* Polynomial of at least second degree with more than single
+	 * term is to be rewritten in nested form, unless its degree
+	 * exceeds one supported by packed polynomial nodes. */
+	polynomial->rewrite = FALSE;
+	if (polynomial->terms && node->type == 'b'
+	    && node->data.bin_op.operation != '/'
+	    && node->data.bin_op.operation != '^'
+	    && polynomial->length > 1) {
+		degree = 0;
+		for (i = 0; i < polynomial->length; i++)
+			for (j = 0; j < polynomial->count; j++)
+				if (polynomial->terms[i].exponents[j] > degree)
+					degree =
+					    polynomial->terms[i].exponents[j];
+		polynomial->rewrite = degree > 1
+		    && degree <= MATH_POLYNOMIAL_MAX;
+	}
+
+	/* If subtree is not rewritten, rewrite children subtrees to be
+	 * rewritten. */
+	for (i = 0; i < length; i++) {
+		if (!polynomial->rewrite && operands[i].rewrite) {
+			node_destroy(*children[i]);
+			*children[i] =
+			    node_simplify(polynomial_node
+					  (operands[i].terms,
+					   operands[i].length,
+					   operands[i].variables,
+					   operands[i].count));
+		}
+		XFREE(operands[i].terms);
+	}
+	if (polynomial->rewrite || node->type != 'b')
+		return node;
+
+	/* Only exponentiation with number as exponent is further
+	 * lowered. */
+	if (node->data.bin_op.operation != '^'
+	    || node->data.bin_op.right->type != 'n')
+		return node;
+	else {
+		double          exponent;	/* Exponent value. */
+		Node           *left;	/* Base node. */
+
+		exponent = node->data.bin_op.right->data.number;
+		left = node->data.bin_op.left;
+
+		/* Replace exponentiation with -1 exponent by reciprocal. */
+		if (exponent == -1)
+			left =
+			    node_create('b', '/', node_create('n', 1.0), left);
+		/* Replace exponentiation with small non-negative integer
+		 * exponent by power node (negative exponents are left to
+		 * math_pow(), as reciprocal of power could be flushed to
+		 * zero or overflow). */
+		else if (exponent >= 0 && exponent <= MATH_POWI_MAX
+			 && exponent == (int) exponent)
+			left = node_create('p', left, (int) exponent);
+		/* Replace exponentiation with 0.5 exponent by square root. */
+		else if (exponent == 0.5)
+			left =
+			    node_create('f',
+					symbol_table_lookup(symbol_table,
+							    "sqrt"), left);
+		/* Replace exponentiation with -0.5 exponent by reciprocal
+		 * of square root. */
+		else if (exponent == -0.5)
+			left =
+			    node_create('b', '/', node_create('n', 1.0),
+					node_create('f',
+						    symbol_table_lookup
+						    (symbol_table, "sqrt"),
+						    left));
+		else
+			return node;
+
+		node->data.bin_op.left = NULL;
+		node_destroy(node);
+		return left;
+	}
+}
+
+static int
+polynomial_recognize(Node * node, Polynomial * operands,
+		     Polynomial * polynomial)
+{
+	Polynomial     *other;	/* Polynomial representing other operand. 
+				 */
+	Term           *terms;	/* Terms of other operand, with variables
+				 * mapped. */
+	Term           *term;	/* Term being combined. */
+	Term            base;	/* Argument of packed polynomial. */
+	double          value;	/* Number value. */
+	int             exponent;	/* Integer exponent. */
+	int             ok;	/* Recognition success flag. */
+	int             i,
+	                j,
+	                k;	/* Loop counters. */
+
+	/* According to node type, create polynomial representing subtree
+	 * rooted at node, starting from (copy of) polynomial representing
+	 * first child subtree if any. */
+	polynomial->count = 0;
+	polynomial->length = 0;
+	polynomial->terms = NULL;
+	switch (node->type) {
+	case 'n':
+	case 'c':
+		/* Number or constant is single term of zero degree. */
+		value = (node->type == 'n') ? node->data.number :
+		    node->data.constant->data.value;
+		polynomial->terms = XMALLOC(Term, 1);
+		if (value != 0) {
+			polynomial->terms[0].coefficient = value;
+			for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+				polynomial->terms[0].exponents[j] = 0;
+			polynomial->length = 1;
+		}
+		return TRUE;
+
+	case 'v':
+		/* Variable is single term of first degree in variable. */
+		polynomial->variables[0] = node->data.variable;
+		polynomial->count = 1;
+		polynomial->terms = XMALLOC(Term, 1);
+		polynomial->terms[0].coefficient = 1;
+		for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+			polynomial->terms[0].exponents[j] = (j == 0);
+		polynomial->length = 1;
+		return TRUE;
+
+	case 'u':
+	case 'b':
+	case 'p':
+	case 'h':
+		if (!operands[0].terms)
+			return FALSE;
+		break;
+
+	default:
+		return FALSE;
+	}
+
+	/* Copy polynomial representing first child subtree, with room
+	 * for terms of other operand of addition or subtraction, or for
+	 * expansion of packed polynomial. */
+	k = operands[0].length;
+	if (node->type == 'b' && (node->data.bin_op.operation == '+'
+				  || node->data.bin_op.operation == '-')
+	    && operands[1].terms)
+		k += operands[1].length;
+	else if (node->type == 'h')
+		k = node->data.polynomial.degree + 1;
+	polynomial->terms =
+	    XMALLOC(Term, (k < 1) ? 1 : (k > POLYNOMIAL_TERMS) ?
+		    POLYNOMIAL_TERMS : k);
+	memcpy(polynomial->variables, operands[0].variables,
+	       operands[0].count * sizeof(Record *));
+	polynomial->count = operands[0].count;
+	memcpy(polynomial->terms, operands[0].terms,
+	       operands[0].length * sizeof(Term));
+	polynomial->length = operands[0].length;
+
+	switch (node->type) {
+	case 'u':
+		/* Negate all terms of operand. */
+		for (i = 0; i < polynomial->length; i++)
+			polynomial->terms[i].coefficient =
+			    -polynomial->terms[i].coefficient;
+		return TRUE;
+
+	case 'b':
+		/* Exponentiation is accepted only for single term raised
+		 * to non-negative integer power. */
+		if (node->data.bin_op.operation == '^') {
+			if (node->data.bin_op.right->type != 'n')
+				return FALSE;
+			value = node->data.bin_op.right->data.number;
+			if (value < 0 || value > MATH_POLYNOMIAL_MAX
+			    || value != (int) value)
+				return FALSE;
+			exponent = (int) value;
+			break;
+		}
+
+		/* Division is accepted only by number or constant. */
+		if (node->data.bin_op.operation == '/') {
+			if (node->data.bin_op.right->type == 'n')
+				value = node->data.bin_op.right->data.number;
+			else if (node->data.bin_op.right->type == 'c')
+				value =
+				    node->data.bin_op.right->data.constant->
+				    data.value;
+			else
+				return FALSE;
+			if (value == 0)
+				return FALSE;
+			for (i = 0; i < polynomial->length; i++)
+				polynomial->terms[i].coefficient /= value;
+			return TRUE;
+		}
+
+		/* Map variables of right operand to ones of polynomial. */
+		other = &operands[1];
+		if (!other->terms)
+			return FALSE;
+		terms = XMALLOC(Term, (other->length < 1) ? 1 : other->length);
+		ok = polynomial_map(other, polynomial, terms);
+		switch (node->data.bin_op.operation) {
+		case '+':
+		case '-':
+			/* Merge terms of right operand into left operand
+			 * polynomial. */
+			for (k = 0; ok && k < other->length; k++) {
+				if (node->data.bin_op.operation == '-')
+					terms[k].coefficient =
+					    -terms[k].coefficient;
+				for (i = 0; i < polynomial->length; i++)
+					if (!memcmp
+					    (polynomial->terms[i].exponents,
+					     terms[k].exponents,
+					     sizeof(terms[k].exponents)))
+						break;
+				if (i < polynomial->length)
+					polynomial->terms[i].coefficient +=
+					    terms[k].coefficient;
+				else if (polynomial->length <
+					 POLYNOMIAL_TERMS)
+					polynomial->terms[polynomial->
+							  length++] =
+					    terms[k];
+				else
+					ok = FALSE;
+			}
+
+			/* Remove cancelled terms. */
+			for (i = j = 0; i < polynomial->length; i++)
+				if (polynomial->terms[i].coefficient != 0)
+					polynomial->terms[j++] =
+					    polynomial->terms[i];
+			polynomial->length = j;
+			break;
+
+		case '*':
+			/* Multiplication is accepted only if one of
+			 * operands is single term (products of sums are
+			 * not expanded). */
+			if (ok && polynomial->length <= 1) {
+				Term           *swap;	/* Swap pointer. */
+
+				swap = polynomial->terms;
+				polynomial->terms = terms;
+				terms = swap;
+				k = polynomial->length;
+				polynomial->length = other->length;
+				if (k == 0)
+					polynomial->length = 0;
+			} else if (other->length > 1)
+				ok = FALSE;
+			else if (ok && other->length == 0)
+				polynomial->length = 0;
+			for (i = 0; ok && i < polynomial->length; i++) {
+				polynomial->terms[i].coefficient *=
+				    terms[0].coefficient;
+				for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+					if ((polynomial->terms[i].
+					     exponents[j] +=
+					     terms[0].exponents[j]) >
+					    MATH_POLYNOMIAL_MAX)
+						ok = FALSE;
+			}
+			break;
+
+		default:
+			ok = FALSE;
+		}
+		XFREE(terms);
+		return ok;
+
+	case 'p':
+		if (node->data.power.exponent < 0
+		    || node->data.power.exponent > MATH_POLYNOMIAL_MAX)
+			return FALSE;
+		exponent = node->data.power.exponent;
+		break;
+
+	case 'h':
+		/* Polynomial in single term argument is expanded to
+		 * sum of powers of that term. */
+		if (polynomial->length > 1
+		    || node->data.polynomial.degree >= POLYNOMIAL_TERMS)
+			return FALSE;
+		if (polynomial->length == 0) {
+			value = node->data.polynomial.coefficients[0];
+			polynomial->length = (value != 0);
+			polynomial->terms[0].coefficient = value;
+			for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+				polynomial->terms[0].exponents[j] = 0;
+			return TRUE;
+		}
+		/* Copy argument term, as terms of expansion overwrite
+		 * it. */
+		base = polynomial->terms[0];
+		for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+			if (base.exponents[j] *
+			    node->data.polynomial.degree >
+			    MATH_POLYNOMIAL_MAX)
+				return FALSE;
+		for (k = node->data.polynomial.degree, i = 0; k >= 0; k--)
+			if (node->data.polynomial.coefficients[k] != 0) {
+				polynomial->terms[i].coefficient =
+				    node->data.polynomial.coefficients[k] *
+				    math_powi(base.coefficient, k);
+				for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+					polynomial->terms[i].exponents[j] =
+					    base.exponents[j] * k;
+				i++;
+			}
+		polynomial->length = i;
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+
+	/* Raise single term polynomial to integer power. */
+	if (polynomial->length > 1)
+		return FALSE;
+	if (polynomial->length == 0) {
+		if (exponent == 0) {
+			polynomial->terms[0].coefficient = 1;
+			for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+				polynomial->terms[0].exponents[j] = 0;
+			polynomial->length = 1;
+		}
+		return TRUE;
+	}
+	term = &polynomial->terms[0];
+	term->coefficient = math_powi(term->coefficient, exponent);
+	for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+		if ((term->exponents[j] *= exponent) > MATH_POLYNOMIAL_MAX)
+			return FALSE;
+	return TRUE;
+}
+
+static int
+polynomial_map(Polynomial * source, Polynomial * polynomial, Term * terms)
+{
+	int             map[POLYNOMIAL_VARIABLES];	/* Indices of source 
+							 * variables among
+							 * polynomial ones. 
+							 */
+	int             i,
+	                j;	/* Loop counters. */
+
+	/* Find each source variable among polynomial variables, appending
+	 * it if not found. */
+	for (j = 0; j < source->count; j++) {
+		for (i = 0; i < polynomial->count; i++)
+			if (polynomial->variables[i] == source->variables[j])
+				break;
+		if (i == polynomial->count) {
+			if (polynomial->count == POLYNOMIAL_VARIABLES)
+				return FALSE;
+			polynomial->variables[polynomial->count++] =
+			    source->variables[j];
+		}
+		map[j] = i;
+	}
+
+	/* Copy terms, moving exponents to mapped positions. */
+	for (i = 0; i < source->length; i++) {
+		terms[i].coefficient = source->terms[i].coefficient;
+		for (j = 0; j < POLYNOMIAL_VARIABLES; j++)
+			terms[i].exponents[j] = 0;
+		for (j = 0; j < source->count; j++)
+			terms[i].exponents[map[j]] =
+			    source->terms[i].exponents[j];
+	}
+	return TRUE;
+}
+
+static Node    *
+polynomial_node(Term * terms, int length, Record ** variables, int count)
+{
+	Term           *group;	/* Terms with given exponent of chosen
+				 * variable. */
+	int             size;	/* Number of terms in above group. */
+	Node           *node;	/* Horner form accumulated so far. */
+	Node           *power;	/* Power of chosen variable. */
+	int             variable;	/* Index of chosen variable. */
+	int             degree;	/* Degree in chosen variable. */
+	int             univariate;	/* Flag set if polynomial depends on 
+					 * chosen variable only. */
+	int             gap;	/* Exponent of chosen variable not yet
+				 * multiplied into accumulated form. */
+	int             i,
+	                j,
+	                k;	/* Loop counters. */
+
+	/* Zero polynomial is represented by number. */
+	if (length == 0)
+		return node_create('n', 0.0);
+
+	/* Choose variable with largest exponent.  Polynomial of zero
+	 * degree is represented by number. */
+	variable = 0;
+	degree = 0;
+	for (i = 0; i < length; i++)
+		for (j = 0; j < count; j++)
+			if (terms[i].exponents[j] > degree) {
+				variable = j;
+				degree = terms[i].exponents[j];
+			}
+	if (degree == 0) {
+		double          value;	/* Sum of coefficients. */
+
+		for (value = 0, i = 0; i < length; i++)
+			value += terms[i].coefficient;
+		return node_create('n', value);
+	}
+
+	/* Check if polynomial depends on chosen variable only. */
+	univariate = TRUE;
+	for (i = 0; i < length; i++)
+		for (j = 0; j < count; j++)
+			if (j != variable && terms[i].exponents[j] != 0)
+				univariate = FALSE;
+
+	/* Univariate polynomial is represented by node with packed
+	 * array of coefficients. */
+	if (univariate) {
+		double         *coefficients;	/* Polynomial coefficients. */
+
+		coefficients = XCALLOC(double, degree + 1);
+		for (i = 0; i < length; i++)
+			coefficients[terms[i].exponents[variable]] +=
+			    terms[i].coefficient;
+		return node_create('h',
+				   node_create('v', variables[variable]),
+				   degree, coefficients);
+	}
+
+	/* Otherwise, group terms by exponent of chosen variable, with
+	 * each group representing coefficient polynomial in remaining
+	 * variables, and combine groups in Horner form. */
+	group = XMALLOC(Term, length);
+	node = NULL;
+	gap = 0;
+	for (k = degree; k >= 0; k--) {
+		for (i = size = 0; i < length; i++)
+			if (terms[i].exponents[variable] == k) {
+				group[size] = terms[i];
+				group[size++].exponents[variable] = 0;
+			}
+		if (node)
+			gap++;
+		if (size == 0)
+			continue;
+		if (node) {
+			power = node_create('v', variables[variable]);
+			if (gap > 1)
+				power = node_create('p', power, gap);
+			node = node_create('b', '+',
+					   node_create('b', '*', node,
+						       power),
+					   polynomial_node(group, size,
+							   variables,
+							   count));
+			gap = 0;
+		} else
+			node =
+			    polynomial_node(group, size, variables, count);
+	}
+	if (gap > 0) {
+		power = node_create('v', variables[variable]);
+		if (gap > 1)
+			power = node_create('p', power, gap);
+		node = node_create('b', '*', node, power);
+	}
+	XFREE(group);
+
+	return node;
+}
+
+static Node    *
+balanced_node(Node ** operands, int length, char operation, int contract)
+{
+	/* Split operands in halves and combine trees built for each
+	 * half. */
+	if (length == 1)
+		return operands[0];
+	return contracted_node(operation,
+			       balanced_node(operands, length / 2,
+					     operation, contract),
+			       balanced_node(operands + length / 2,
+					     length - length / 2, operation,
+					     contract), contract);
+}
+
+static Node    *
+contracted_node(char operation, Node * left, Node * right, int contract)
+{
+	Node           *product;	/* Multiplication node to contract. 
+					 */
+	Node           *node;	/* Multiply-add node. */
+
+	/* Create plain binary operation node if contraction not
+	 * possible. */
+	if (!contract || (operation != '+' && operation != '-')
+	    || ((left->type != 'b' || left->data.bin_op.operation != '*')
+		&& (right->type != 'b'
+		    || right->data.bin_op.operation != '*')))
+		return node_create('b', operation, left, right);
+
+	/* Contract f*g+h, h+f*g and f*g-h into multiply-add, negating
+	 * addend if necessary, or h-f*g into multiply-add with first
+	 * multiplication operand negated. */
+	if (left->type == 'b' && left->data.bin_op.operation == '*') {
+		product = left;
+		node = node_create('m', product->data.bin_op.left,
+				   product->data.bin_op.right,
+				   (operation == '-') ? node_create('u', '-',
+								    right) :
+				   right);
+	} else {
+		product = right;
+		node = node_create('m',
+				   (operation == '-') ? node_create('u', '-',
+								    product->
+								    data.
+								    bin_op.
+								    left) :
+				   product->data.bin_op.left,
+				   product->data.bin_op.right, left);
+	}
+	XFREE(product);
+	return node;
+}
+
+/* Append given text to string, if string is not null, at given position.
+ * Function returns position after text. */
+static int
+write_text(char *string, int length, char *text)
+{
+	if (string)
+		strcpy(string + length, text);
+	return length + strlen(text);
+}
+
+static int
+polynomial_write(Node * node, char *string)
+{
+	char            buffer[64];	/* Buffer for number text. */
+	Node           *child;	/* Polynomial argument node. */
+	int             length;	/* Length of text written so far. */
+	int             count;	/* Number of non-zero terms. */
+	int             k;	/* Loop counter. */
+
+	/* Write polynomial as sum of terms with non-zero coefficients,
+	 * using parenthesis as node_write() would. */
+	child = node->data.polynomial.child;
+	for (count = 0, k = 0; k <= node->data.polynomial.degree; k++)
+		if (node->data.polynomial.coefficients[k] != 0)
+			count++;
+	if (count == 0)
+		return write_text(string, 0, "0");
+	for (length = 0; length < count - 1;)
+		length = write_text(string, length, "(");
+	for (count = 0, k = 0; k <= node->data.polynomial.degree; k++) {
+		double          coefficient;	/* Term coefficient. */
+
+		coefficient = node->data.polynomial.coefficients[k];
+		if (coefficient == 0)
+			continue;
+		if (count++ > 0)
+			length = write_text(string, length, "+");
+
+		/* Write coefficient, unless equal to 1 and multiplying
+		 * power. */
+		if (k == 0 || coefficient != 1) {
+			if (k > 0)
+				length = write_text(string, length, "(");
+			sprintf(buffer, (coefficient < 0) ? "(%g)" : "%g",
+				coefficient);
+			length = write_text(string, length, buffer);
+			if (k > 0)
+				length = write_text(string, length, "*");
+		}
+
+		/* Write power of argument. */
+		if (k > 1)
+			length = write_text(string, length, "(");
+		if (k > 0) {
+			if (string)
+				node_write(child, string + length);
+			length += node_get_length(child);
+		}
+		if (k > 1) {
+			sprintf(buffer, "^%d)", k);
+			length = write_text(string, length, buffer);
+		}
+		if (k > 0 && coefficient != 1)
+			length = write_text(string, length, ")");
+
+		if (count > 1)
+			length = write_text(string, length, ")");
+	}
+
+	return length;
+}
+
+static void
+write_c_number(FILE * file, double value)
+{
+	/* Write special values using macros from <math.h>, integral
+	 * values with single decimal, and other values with 17
+	 * significant digits. */
+	if (MATH_ISNAN(value))
+		fprintf(file, "%s", "NAN");
+	else if (value == MATH_INFINITY || value == -MATH_INFINITY)
+		fprintf(file, "%sINFINITY)", (value < 0) ? "(-" : "(");
+	else if (fabs(value) < 1e17 && value == (long long) value)
+		fprintf(file, "(%.1f)", value);
+	else
+		fprintf(file, "(%.17g)", value);
+}
+
+static unsigned long
+hash_combine(unsigned long hash, unsigned long value)
+{
+	/* Mix value into hash value using FNV-1a like step, with bits
+	 * spread by multiplication. */
+	return (hash ^ value) * 16777619UL + (hash >> 29);
+}
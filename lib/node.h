@@ -26,6 +26,7 @@
 #include "config.h"
 #endif
 
+#include <stdio.h>
 #include "symbol_table.h"
 
 /* Data structure representing function tree node.  */
@@ -33,7 +34,10 @@ typedef struct _Node {
 	char            type;	/* Node type ('n' for number, 'c' for
 				 * constant, 'v' for variable, 'f' for
 				 * function, 'u' for unary operation, 'b'
-				 * for binary operation).  */
+				 * for binary operation, 'p' for
+				 * exponentiation with integer exponent,
+				 * 'h' for polynomial, 'm' for fused
+				 * multiply-add).  */
 	union {
 		double          number;	/* Number value.  */
 		Record         *constant;	/* Symbol table record for 
@@ -70,6 +74,32 @@ typedef struct _Node {
 			               *right;	/* Operands nodes.  */
 		} bin_op;	/* Structure representing binary
 				 * operation.  */
+		struct {
+			struct _Node   *child;	/* Base node.  */
+			int             exponent;	/* Integer exponent.  */
+		} power;	/* Structure representing exponentiation
+				 * with integer exponent (created by
+				 * lowering only).  */
+		struct {
+			struct _Node   *child;	/* Polynomial argument
+						 * node.  */
+			int             degree;	/* Polynomial degree.  */
+			double         *coefficients;	/* Packed array of
+							 * degree+1
+							 * coefficients,
+							 * starting from
+							 * constant term.  */
+		} polynomial;	/* Structure representing polynomial in
+				 * single argument (created by lowering
+				 * only).  */
+		struct {
+			struct _Node   *left,
+			               *right;	/* Multiplication operands 
+						 * nodes.  */
+			struct _Node   *addend;	/* Addition operand node.  */
+		} muladd;	/* Structure representing fused
+				 * multiply-add operation (created by
+				 * fast math transformations only).  */
 	} data;
 } Node;
 
@@ -85,10 +115,38 @@ void            node_destroy(Node * node);
  * employed. */
 Node           *node_copy(Node * node);
 
+/* Same as above, except that symbol table records referenced from
+ * subtree are replaced in copy by records with same names from symbol
+ * table given as second argument (variables are inserted into this
+ * symbol table if not already there). */
+Node           *node_import(Node * node, SymbolTable * symbol_table);
+
 /* Simplify subtree rooted at given node.  Function returns root of
  * simplified subtree (that may or may not be original node). */
 Node           *node_simplify(Node * node);
 
+/* Lower simplified subtree rooted at given node into form cheaper to
+ * evaluate: sums of products of numbers and integer powers of variables
+ * are recognized as polynomials and rewritten in nested (Horner) form,
+ * with univariate polynomials in packed form evaluated by Horner or
+ * Estrin scheme; exponentiation with small non-negative integer exponent
+ * is replaced by power node (evaluated by repeated squaring),
+ * exponentiation with 0.5 and -0.5 exponent by square root and its
+ * reciprocal, and with -1 exponent by reciprocal.  Second argument is
+ * symbol table (needed to create function nodes).  Function returns
+ * root of lowered subtree. */
+Node           *node_lower(Node * node, SymbolTable * symbol_table);
+
+/* Apply transformations that may change result of evaluation in last
+ * bits to lowered subtree rooted at given node: division by number is
+ * replaced by multiplication with its reciprocal, chains of additions
+ * and multiplications are reassociated into balanced trees (with
+ * numbers folded together), and, if fused multiply-add is supported by
+ * hardware, multiplications followed by addition or subtraction are
+ * contracted into multiply-add nodes.  Function returns root of
+ * transformed subtree. */
+Node           *node_fast_math(Node * node);
+
 /* Evaluate subtree rooted at given node.  For variables, values from
  * symbol table are used. */
 double          node_evaluate(Node * node);
@@ -100,10 +158,27 @@ double          node_evaluate(Node * node);
 Node           *node_derivative(Node * node, char *name,
 				SymbolTable * symbol_table);
 
+/* Replace each occurrence of variable given by symbol table record in
+ * subtree rooted at given node with copy of subtree given by third
+ * argument.  Function returns root of resulting subtree, that should be
+ * simplified afterwards. */
+Node           *node_substitute(Node * node, Record * record,
+				Node * replacement);
+
 /* Flag each variable in symbol table that is used from subtree rooted at
  * specified node. */
 void            node_flag_variables(Node * node);
 
+/* Calculate hash value of structure of subtree rooted at specified node:
+ * subtrees that differ only in values of numbers and constants, or in
+ * variable names, have same hash value.  */
+unsigned long   node_hash(Node * node);
+
+/* Check if subtrees rooted at specified nodes have same structure, that
+ * is differ only in values of numbers and constants, or in variable
+ * names.  Return non-zero if so, zero otherwise.  */
+int             node_same_shape(Node * node1, Node * node2);
+
 /* Calculate length of the string representing subtree rooted at specified 
  * node. */
 int             node_get_length(Node * node);
@@ -113,4 +188,16 @@ int             node_get_length(Node * node);
  * that string of appropriate length is passed as argument. */
 void            node_write(Node * node, char *string);
 
+/* Write to file C statements calculating value of subtree rooted at
+ * specified node, in same order of operations as node_evaluate().  Each
+ * statement defines new temporary "tn", with n taken from and
+ * incremented in location given by last argument.  Variable given by
+ * i-th element of array of records (with length given by fourth
+ * argument) is referred as "xi".  Functions and exponentiation are
+ * written as calls to "matheval_" prefixed functions expected to be
+ * defined by preceding code.  Function returns number of temporary
+ * holding subtree value. */
+int             node_write_c(Node * node, FILE * file, Record ** records,
+			     int count, int *temporaries);
+
 #endif
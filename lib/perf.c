@@ -0,0 +1,249 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "common.h"
+#include "perf.h"
+
+#if defined __linux__ && HAVE_SYS_MMAN_H
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#if HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* Flags denoting kinds of perf support.  */
+#define PERF_MAP 1
+#define PERF_JITDUMP 2
+
+/* Magic number, version and processor architecture of jitdump file, and
+ * type of record describing loaded code.  */
+#define JITDUMP_MAGIC 0x4a695444
+#define JITDUMP_VERSION 1
+#if defined __x86_64__
+#define JITDUMP_MACHINE 62
+#elif defined __aarch64__
+#define JITDUMP_MACHINE 183
+#else
+#define JITDUMP_MACHINE 0
+#endif
+#define JITDUMP_CODE_LOAD 0
+
+/* Data structure representing jitdump file header.  */
+typedef struct {
+	unsigned int    magic;	/* Magic number. */
+	unsigned int    version;	/* Format version. */
+	unsigned int    total_size;	/* Size of header. */
+	unsigned int    elf_mach;	/* Processor architecture. */
+	unsigned int    pad1;	/* Padding. */
+	unsigned int    pid;	/* Process identifier. */
+	unsigned long long timestamp;	/* Time of file creation. */
+	unsigned long long flags;	/* Flags (none used). */
+} JitdumpHeader;
+
+/* Data structure representing jitdump record describing loaded code,
+ * followed in file by symbol name and code itself.  */
+typedef struct {
+	unsigned int    id;	/* Record type. */
+	unsigned int    total_size;	/* Size of record, including name and 
+					 * code. */
+	unsigned long long timestamp;	/* Time of code loading. */
+	unsigned int    pid;	/* Process identifier. */
+	unsigned int    tid;	/* Thread identifier. */
+	unsigned long long vma;	/* Code virtual address. */
+	unsigned long long code_addr;	/* Code address. */
+	unsigned long long code_size;	/* Code size. */
+	unsigned long long code_index;	/* Unique index of code. */
+} JitdumpCodeLoad;
+
+/* Kinds of perf support requested, or -1 if not determined yet.  */
+static int      mode = -1;
+
+/* Perf map file and jitdump file.  */
+static FILE    *map = NULL;
+static FILE    *dump = NULL;
+
+/* Number of code pieces written to jitdump file.  */
+static unsigned long long code_count = 0;
+
+#if HAVE_PTHREAD
+/* Mutex serializing registrations.  */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* Determine kinds of perf support requested and open files needed.  */
+static void     perf_initialize(void);
+
+/* Return time, in nanoseconds, of clock used by perf for jitdump.  */
+static unsigned long long perf_timestamp(void);
+
+int
+perf_enabled(void)
+{
+	/* Determine kinds of support requested, if not already. */
+#if HAVE_PTHREAD
+	pthread_mutex_lock(&mutex);
+#endif
+	if (mode < 0)
+		perf_initialize();
+#if HAVE_PTHREAD
+	pthread_mutex_unlock(&mutex);
+#endif
+
+	return mode != 0;
+}
+
+void
+perf_register(char *name, void *code, size_t size)
+{
+	JitdumpCodeLoad record;	/* Jitdump record. */
+
+	if (!perf_enabled() || !code || !size)
+		return;
+
+#if HAVE_PTHREAD
+	pthread_mutex_lock(&mutex);
+#endif
+
+	/* Append line with code address, size and name to perf map file. 
+	 */
+	if (map) {
+		fprintf(map, "%lx %lx %s\n", (unsigned long) code,
+			(unsigned long) size, name);
+		fflush(map);
+	}
+
+	/* Append record describing code, followed by name and code
+	 * itself, to jitdump file. */
+	if (dump) {
+		record.id = JITDUMP_CODE_LOAD;
+		record.total_size =
+		    sizeof(record) + strlen(name) + 1 + size;
+		record.timestamp = perf_timestamp();
+		record.pid = getpid();
+#ifdef SYS_gettid
+		record.tid = syscall(SYS_gettid);
+#else
+		record.tid = record.pid;
+#endif
+		record.vma = record.code_addr = (unsigned long) code;
+		record.code_size = size;
+		record.code_index = code_count++;
+		fwrite(&record, sizeof(record), 1, dump);
+		fwrite(name, strlen(name) + 1, 1, dump);
+		fwrite(code, size, 1, dump);
+		fflush(dump);
+	}
+
+#if HAVE_PTHREAD
+	pthread_mutex_unlock(&mutex);
+#endif
+}
+
+static void
+perf_initialize(void)
+{
+	char           *value;	/* Environment variable value. */
+	char            name[64];	/* File name. */
+	JitdumpHeader   header;	/* Jitdump file header. */
+	long            page;	/* Page size. */
+
+	/* Determine kinds of support requested. */
+	value = getenv("MATHEVAL_PERF");
+	if (!value || !*value)
+		mode = 0;
+	else if (!strcmp(value, "map"))
+		mode = PERF_MAP;
+	else if (!strcmp(value, "jitdump"))
+		mode = PERF_JITDUMP;
+	else
+		mode = PERF_MAP | PERF_JITDUMP;
+
+	/* Open perf map file. */
+	if (mode & PERF_MAP) {
+		sprintf(name, "/tmp/perf-%d.map", (int) getpid());
+		map = fopen(name, "a");
+	}
+
+	/* Open jitdump file and write its header.  File is also mapped
+	 * as executable, so that perf notices it in process memory map. 
+	 */
+	if (mode & PERF_JITDUMP) {
+		sprintf(name, "jit-%d.dump", (int) getpid());
+		dump = fopen(name, "w+");
+		page = sysconf(_SC_PAGESIZE);
+		if (dump
+		    && mmap(NULL, page, PROT_READ | PROT_EXEC, MAP_PRIVATE,
+			    fileno(dump), 0) == MAP_FAILED) {
+			fclose(dump);
+			dump = NULL;
+		}
+		if (dump) {
+			memset(&header, 0, sizeof(header));
+			header.magic = JITDUMP_MAGIC;
+			header.version = JITDUMP_VERSION;
+			header.total_size = sizeof(header);
+			header.elf_mach = JITDUMP_MACHINE;
+			header.pid = getpid();
+			header.timestamp = perf_timestamp();
+			fwrite(&header, sizeof(header), 1, dump);
+			fflush(dump);
+		}
+	}
+
+	/* Disable support if no file could be opened. */
+	if (!map && !dump)
+		mode = 0;
+}
+
+static unsigned long long
+perf_timestamp(void)
+{
+	struct timespec time;	/* Current time. */
+
+	/* Use monotonic clock, as expected by "perf record -k mono". */
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (unsigned long long) time.tv_sec * 1000000000ULL +
+	    time.tv_nsec;
+}
+
+#else
+
+int
+perf_enabled(void)
+{
+	/* Perf profiler support not available. */
+	return FALSE;
+}
+
+void
+perf_register(char *name, void *code, size_t size)
+{
+	/* Perf profiler support not available. */
+}
+
+#endif
@@ -0,0 +1,44 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERF_H
+#define PERF_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stddef.h>
+
+/* Check if support for Linux perf profiler requested, by MATHEVAL_PERF
+ * environment variable: value "map" requests writing symbols of
+ * compiled code to /tmp/perf-<pid>.map file, value "jitdump" requests
+ * writing compiled code to jit-<pid>.dump file in current directory (to 
+ * be merged into profile by "perf inject --jit"), any other non-empty
+ * value requests both.  Function returns non-zero if support requested 
+ * and available.  */
+int             perf_enabled(void);
+
+/* Announce compiled code, given by its address and size, as symbol of
+ * given name to perf profiler, if support requested.  */
+void            perf_register(char *name, void *code, size_t size);
+
+#endif
@@ -0,0 +1,152 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "common.h"
+#include "postfix.h"
+
+/* Return number of nodes in subtree rooted at given node.  */
+static int      count_nodes(Node * node);
+
+/* Append steps evaluating subtree rooted at given node to postfix form,
+ * given that number of values already on stack is as given by last
+ * argument.  */
+static void     generate(Postfix * postfix, Node * node, Record ** records,
+			 int count, int depth);
+
+Postfix        *
+postfix_create(Node * root, Record ** records, int count)
+{
+	Postfix        *postfix;	/* Postfix form of function. */
+
+	/* Allocate step for each node, and generate steps. */
+	postfix = XMALLOC(Postfix, 1);
+	postfix->steps = XMALLOC(Step, count_nodes(root));
+	postfix->length = 0;
+	postfix->depth = 0;
+	generate(postfix, root, records, count, 0);
+
+	return postfix;
+}
+
+void
+postfix_destroy(Postfix * postfix)
+{
+	/* Free steps and postfix form data structure. */
+	if (!postfix)
+		return;
+	XFREE(postfix->steps);
+	XFREE(postfix);
+}
+
+static int
+count_nodes(Node * node)
+{
+	/* Count node along with nodes of its children. */
+	switch (node->type) {
+	case 'f':
+		return 1 + count_nodes(node->data.function.child);
+
+	case 'u':
+		return 1 + count_nodes(node->data.un_op.child);
+
+	case 'b':
+		return 1 + count_nodes(node->data.bin_op.left) +
+		    count_nodes(node->data.bin_op.right);
+
+	case 'p':
+		return 1 + count_nodes(node->data.power.child);
+
+	case 'h':
+		return 1 + count_nodes(node->data.polynomial.child);
+
+	case 'm':
+		return 1 + count_nodes(node->data.muladd.left) +
+		    count_nodes(node->data.muladd.right) +
+		    count_nodes(node->data.muladd.addend);
+	}
+
+	return 1;
+}
+
+static void
+generate(Postfix * postfix, Node * node, Record ** records, int count,
+	 int depth)
+{
+	Step           *step;	/* Step evaluating node. */
+	int             i;	/* Loop counter. */
+
+	/* Generate steps for children first, each child value pushed on
+	 * stack above values of preceding children. */
+	switch (node->type) {
+	case 'f':
+		generate(postfix, node->data.function.child, records, count,
+			 depth);
+		break;
+
+	case 'u':
+		generate(postfix, node->data.un_op.child, records, count,
+			 depth);
+		break;
+
+	case 'b':
+		generate(postfix, node->data.bin_op.left, records, count,
+			 depth);
+		generate(postfix, node->data.bin_op.right, records, count,
+			 depth + 1);
+		break;
+
+	case 'p':
+		generate(postfix, node->data.power.child, records, count,
+			 depth);
+		break;
+
+	case 'h':
+		generate(postfix, node->data.polynomial.child, records, count,
+			 depth);
+		break;
+
+	case 'm':
+		generate(postfix, node->data.muladd.left, records, count,
+			 depth);
+		generate(postfix, node->data.muladd.right, records, count,
+			 depth + 1);
+		generate(postfix, node->data.muladd.addend, records, count,
+			 depth + 2);
+		break;
+	}
+
+	/* Append step for node itself, resolving variable index, and
+	 * update maximal stack depth with its value pushed. */
+	step = &postfix->steps[postfix->length++];
+	step->node = node;
+	step->index = -1;
+	if (node->type == 'v')
+		for (i = 0; i < count; i++)
+			if (records[i] == node->data.variable)
+				step->index = i;
+	if (depth + 1 > postfix->depth)
+		postfix->depth = depth + 1;
+}
@@ -0,0 +1,59 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef POSTFIX_H
+#define POSTFIX_H 1
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "node.h"
+
+/* Data structure representing step of postfix form of function: node
+ * is evaluated from values of its children, calculated by preceding
+ * steps and kept on stack.  */
+typedef struct {
+	Node           *node;	/* Node evaluated. */
+	int             index;	/* Index of variable, for variable
+				 * nodes. */
+} Step;
+
+/* Data structure representing function in postfix form, used by
+ * evaluation modes that calculate in other arithmetic than double
+ * precision one.  */
+typedef struct {
+	Step           *steps;	/* Steps, in order of evaluation. */
+	int             length;	/* Number of steps. */
+	int             depth;	/* Maximal number of values on stack. */
+} Postfix;
+
+/* Create postfix form of function represented by tree rooted at given
+ * node (steps refer to tree, that should outlive postfix form).  Further 
+ * arguments are array of symbol table records of function variables
+ * and its length.  */
+Postfix        *postfix_create(Node * root, Record ** records, int count);
+
+/* Destroy postfix form of function.  */
+void            postfix_destroy(Postfix * postfix);
+
+#endif
@@ -25,6 +25,7 @@
 
 #include <assert.h>
 #include <stdarg.h>
+#include "approx.h"
 #include "common.h"
 #include "symbol_table.h"
 #include "xmath.h"
@@ -255,6 +256,24 @@ symbol_table_get_flagged(SymbolTable * symbol_table, Record ** records,
 	return count;
 }
 
+void
+symbol_table_approximate(SymbolTable * symbol_table, int coarse)
+{
+	Record         *curr;	/* Pointer to current symbol table record
+				 * while traversing hash table bucket.  */
+	int             i;	/* Loop counter.  */
+
+	/* Replace function of each function record by its
+	 * approximation. */
+	for (i = 0; i < symbol_table->length; i++)
+		for (curr = symbol_table->records[i].next; curr;
+		     curr = curr->next)
+			if (curr->type == 'f')
+				curr->data.function =
+				    approx_function(curr->data.function,
+						    coarse);
+}
+
 SymbolTable    *
 symbol_table_assign(SymbolTable * symbol_table)
 {
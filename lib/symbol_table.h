@@ -89,6 +89,12 @@ int             symbol_table_get_flagged_count(SymbolTable * symbol_table);
 int             symbol_table_get_flagged(SymbolTable * symbol_table,
 					 Record ** records, int length);
 
+/* Replace function of each function record by its approximation, with
+ * relative error below 1e-7, or below 1e-4 if second argument non-zero 
+ * (see approx_function()). */
+void            symbol_table_approximate(SymbolTable * symbol_table,
+					 int coarse);
+
 /* Return symbol table pointer to be assigned to variable.  This function
  * should be used instead of simple pointer assignement for proper
  * reference counting.  Users willing to manage reference counts by
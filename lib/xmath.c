@@ -19,8 +19,127 @@
  * <http://www.gnu.org/licenses/>.
  */
 
+#include <float.h>
+#include <stddef.h>
 #include "xmath.h"
 
+double
+math_powi(double x, int n)
+{
+	double          base;	/* Base of exponentiation.  */
+	double          result;	/* Accumulated power.  */
+	unsigned        m;	/* Absolute value of exponent.  */
+
+	/* 
+	 * Multiply together squares of x corresponding to bits set in
+	 * absolute value of exponent.
+	 */
+	base = x;
+	m = (n < 0) ? -(unsigned) n : (unsigned) n;
+	for (result = 1; m; m >>= 1) {
+		if (m & 1)
+			result *= x;
+		if (m > 1)
+			x *= x;
+	}
+
+	/* 
+	 * Take reciprocal for negative exponent, unless power overflowed
+	 * or underflowed, when reciprocal would be flushed to zero or
+	 * overflow while result is representable.
+	 */
+	if (n >= 0)
+		return result;
+	if (fabs(result) > DBL_MAX || fabs(result) < DBL_MIN)
+		return pow(base, n);
+	return 1 / result;
+}
+
+double
+math_pow(double x, double y)
+{
+	/* 
+	 * Use repeated squaring if exponent is small integer, pow()
+	 * otherwise.
+	 */
+	if (fabs(y) <= MATH_POWI_MAX && y == (int) y)
+		return math_powi(x, (int) y);
+	return pow(x, y);
+}
+
+double
+math_horner(double x, double *coefficients, int degree)
+{
+	double          result;	/* Accumulated polynomial value.  */
+	int             i;	/* Loop counter.  */
+
+	/* 
+	 * Calculate polynomial value by nested multiplication.
+	 */
+	result = coefficients[degree];
+	for (i = degree - 1; i >= 0; i--)
+		result = result * x + coefficients[i];
+	return result;
+}
+
+double
+math_estrin(double x, double *coefficients, int degree)
+{
+	double          partial[MATH_POLYNOMIAL_MAX / 2 + 1];	/* Partial 
+								 * sums.  */
+	int             count;	/* Number of partial sums.  */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* 
+	 * Combine pairs of coefficients into linear polynomials in x, then
+	 * repeatedly combine pairs of partial sums using successive
+	 * squares of x, until single sum remains.
+	 */
+	count = (degree + 1) / 2;
+	for (i = 0; i < count; i++)
+		partial[i] = coefficients[2 * i] + coefficients[2 * i + 1] * x;
+	if (degree % 2 == 0)
+		partial[count++] = coefficients[degree];
+	while (count > 1) {
+		x *= x;
+		for (i = j = 0; i + 1 < count; i += 2)
+			partial[j++] = partial[i] + partial[i + 1] * x;
+		if (count % 2 == 1)
+			partial[j++] = partial[count - 1];
+		count = j;
+	}
+	return partial[0];
+}
+
+double
+math_polynomial(double x, double *coefficients, int degree)
+{
+	/* 
+	 * Use Estrin scheme for higher degree polynomials, Horner scheme
+	 * otherwise.
+	 */
+	return (degree >= MATH_ESTRIN_MIN) ?
+	    math_estrin(x, coefficients, degree) :
+	    math_horner(x, coefficients, degree);
+}
+
+int
+math_fast_fma(void)
+{
+	/* 
+	 * Rely on compiler telling that fma() is fast, or check CPU
+	 * features where possible.
+	 */
+#if defined FP_FAST_FMA
+	return 1;
+#elif defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+	return __builtin_cpu_supports("fma");
+#else
+	return 0;
+#endif
+}
+
 double
 math_cot(double x)
 {
@@ -182,3 +301,322 @@ math_nandelta(double x)
 	 */
 	return MATH_ISNAN(x) ? x : ((x == 0) ? MATH_NAN : 0);
 }
+
+float
+math_powif(float x, int n)
+{
+	float           base;	/* Base of exponentiation.  */
+	float           result;	/* Accumulated power.  */
+	unsigned        m;	/* Absolute value of exponent.  */
+
+	/* 
+	 * Multiply together squares of x corresponding to bits set in
+	 * absolute value of exponent.
+	 */
+	base = x;
+	m = (n < 0) ? -(unsigned) n : (unsigned) n;
+	for (result = 1; m; m >>= 1) {
+		if (m & 1)
+			result *= x;
+		if (m > 1)
+			x *= x;
+	}
+
+	/* 
+	 * Take reciprocal for negative exponent, unless power overflowed
+	 * or underflowed.
+	 */
+	if (n >= 0)
+		return result;
+	if (fabsf(result) > FLT_MAX || fabsf(result) < FLT_MIN)
+		return powf(base, n);
+	return 1 / result;
+}
+
+float
+math_powf(float x, float y)
+{
+	/* 
+	 * Use repeated squaring if exponent is small integer, powf()
+	 * otherwise.
+	 */
+	if (fabsf(y) <= MATH_POWI_MAX && y == (int) y)
+		return math_powif(x, (int) y);
+	return powf(x, y);
+}
+
+float
+math_hornerf(float x, float *coefficients, int degree)
+{
+	float           result;	/* Accumulated polynomial value.  */
+	int             i;	/* Loop counter.  */
+
+	/* 
+	 * Calculate polynomial value by nested multiplication.
+	 */
+	result = coefficients[degree];
+	for (i = degree - 1; i >= 0; i--)
+		result = result * x + coefficients[i];
+	return result;
+}
+
+float
+math_estrinf(float x, float *coefficients, int degree)
+{
+	float           partial[MATH_POLYNOMIAL_MAX / 2 + 1];	/* Partial 
+								 * sums.  */
+	int             count;	/* Number of partial sums.  */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* 
+	 * Combine pairs of coefficients into linear polynomials in x, then
+	 * repeatedly combine pairs of partial sums using successive
+	 * squares of x, until single sum remains.
+	 */
+	count = (degree + 1) / 2;
+	for (i = 0; i < count; i++)
+		partial[i] = coefficients[2 * i] + coefficients[2 * i + 1] * x;
+	if (degree % 2 == 0)
+		partial[count++] = coefficients[degree];
+	while (count > 1) {
+		x *= x;
+		for (i = j = 0; i + 1 < count; i += 2)
+			partial[j++] = partial[i] + partial[i + 1] * x;
+		if (count % 2 == 1)
+			partial[j++] = partial[count - 1];
+		count = j;
+	}
+	return partial[0];
+}
+
+float
+math_polynomialf(float x, float *coefficients, int degree)
+{
+	/* 
+	 * Use Estrin scheme for higher degree polynomials, Horner scheme
+	 * otherwise.
+	 */
+	return (degree >= MATH_ESTRIN_MIN) ?
+	    math_estrinf(x, coefficients, degree) :
+	    math_hornerf(x, coefficients, degree);
+}
+
+float
+math_cotf(float x)
+{
+	/* 
+	 * Calculate cotangent value in single precision.
+	 */
+	return 1 / tanf(x);
+}
+
+float
+math_secf(float x)
+{
+	/* 
+	 * Calculate secant value in single precision.
+	 */
+	return 1 / cosf(x);
+}
+
+float
+math_cscf(float x)
+{
+	/* 
+	 * Calculate cosecant value in single precision.
+	 */
+	return 1 / sinf(x);
+}
+
+float
+math_acotf(float x)
+{
+	/* 
+	 * Calculate inverse cotangent value in single precision.
+	 */
+	return atanf(1 / x);
+}
+
+float
+math_asecf(float x)
+{
+	/* 
+	 * Calculate inverse secant value in single precision.
+	 */
+	return acosf(1 / x);
+}
+
+float
+math_acscf(float x)
+{
+	/* 
+	 * Calculate inverse cosecant value in single precision.
+	 */
+	return asinf(1 / x);
+}
+
+float
+math_cothf(float x)
+{
+	/* 
+	 * Calculate hyperbolic cotangent value in single precision.
+	 */
+	return 1 / tanhf(x);
+}
+
+float
+math_sechf(float x)
+{
+	/* 
+	 * Calculate hyperbolic secant value in single precision.
+	 */
+	return 1 / coshf(x);
+}
+
+float
+math_cschf(float x)
+{
+	/* 
+	 * Calculate hyperbolic cosecant value in single precision.
+	 */
+	return 1 / sinhf(x);
+}
+
+float
+math_asinhf(float x)
+{
+	/* 
+	 * Calculate inverse hyperbolic sine value in single precision.
+	 * Formula used for double precision loses all digits to
+	 * cancellation for large negative arguments and overflows for
+	 * large ones in single precision, so C99 function is used.
+	 */
+	return asinhf(x);
+}
+
+float
+math_acoshf(float x)
+{
+	/* 
+	 * Calculate inverse hyperbolic cosine value in single precision
+	 * (using C99 function, for same reason as above).
+	 */
+	return acoshf(x);
+}
+
+float
+math_atanhf(float x)
+{
+	/* 
+	 * Calculate inverse hyperbolic tangent value in single precision.
+	 */
+	return atanhf(x);
+}
+
+float
+math_acothf(float x)
+{
+	/* 
+	 * Calculate inverse hyperbolic cotangent value in single precision.
+	 */
+	return atanhf(1 / x);
+}
+
+float
+math_asechf(float x)
+{
+	/* 
+	 * Calculate inverse hyperbolic secant value in single precision.
+	 */
+	return math_acoshf(1 / x);
+}
+
+float
+math_acschf(float x)
+{
+	/* 
+	 * Calculate inverse hyperbolic cosecant value in single precision.
+	 */
+	return math_asinhf(1 / x);
+}
+
+float
+math_stepf(float x)
+{
+	/* 
+	 * Calculate step function value in single precision.
+	 */
+	return MATH_ISNAN(x) ? x : ((x < 0) ? 0 : 1);
+}
+
+float
+math_deltaf(float x)
+{
+	/* 
+	 * Calculate delta function value in single precision.
+	 */
+	return MATH_ISNAN(x) ? x : ((x == 0) ? MATH_INFINITY : 0);
+}
+
+float
+math_nandeltaf(float x)
+{
+	/* 
+	 * Calculate modified delta function value in single precision.
+	 */
+	return MATH_ISNAN(x) ? x : ((x == 0) ? MATH_NAN : 0);
+}
+
+float           (*math_float_function(double (*function) (double))) (float) {
+	static struct {
+		double          (*function) (double);	/* Function. */
+		float           (*function_float) (float);	/* Single
+								 * precision
+								 * version. */
+	} functions[] = {
+		{
+		exp, expf}, {
+		log, logf}, {
+		sqrt, sqrtf}, {
+		sin, sinf}, {
+		cos, cosf}, {
+		tan, tanf}, {
+		math_cot, math_cotf}, {
+		math_sec, math_secf}, {
+		math_csc, math_cscf}, {
+		asin, asinf}, {
+		acos, acosf}, {
+		atan, atanf}, {
+		math_acot, math_acotf}, {
+		math_asec, math_asecf}, {
+		math_acsc, math_acscf}, {
+		sinh, sinhf}, {
+		cosh, coshf}, {
+		tanh, tanhf}, {
+		math_coth, math_cothf}, {
+		math_sech, math_sechf}, {
+		math_csch, math_cschf}, {
+		math_asinh, math_asinhf}, {
+		math_acosh, math_acoshf}, {
+		math_atanh, math_atanhf}, {
+		math_acoth, math_acothf}, {
+		math_asech, math_asechf}, {
+		math_acsch, math_acschf}, {
+		fabs, fabsf}, {
+		math_step, math_stepf}, {
+		math_delta, math_deltaf}, {
+		math_nandelta, math_nandeltaf}, {
+		erf, erff}
+	};			/* Functions and their single precision
+				 * versions. */
+	int             i;	/* Loop counter.  */
+
+	/* 
+	 * Look up function among predefined functions.
+	 */
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0])); i++)
+		if (functions[i].function == function)
+			return functions[i].function_float;
+	return NULL;
+}
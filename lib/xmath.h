@@ -54,6 +54,47 @@
 #define MATH_ISNAN(x) ((x) != (x))
 #endif
 
+/* Largest absolute value of integer exponent for which exponentiation
+ * is calculated by repeated squaring instead of calling pow().  Error of
+ * repeated squaring grows with exponent; up to this limit result stays
+ * within 2 ulps of pow() one.  */
+#define MATH_POWI_MAX 4
+
+/* Calculate x raised to integer power n by repeated squaring, calling
+ * pow() instead for negative exponent if power of x overflows or
+ * underflows before its reciprocal is taken.  */
+double          math_powi(double x, int n);
+
+/* Calculate x raised to power y, using repeated squaring when y happens
+ * to be small integer.  */
+double          math_pow(double x, double y);
+
+/* Largest degree of polynomial evaluated from packed array of
+ * coefficients.  */
+#define MATH_POLYNOMIAL_MAX 64
+
+/* Smallest degree of polynomial for which Estrin scheme is used instead
+ * of Horner scheme.  */
+#define MATH_ESTRIN_MIN 8
+
+/* Calculate value of polynomial with given coefficients (starting from
+ * constant term) and degree for value x using Horner scheme.  */
+double          math_horner(double x, double *coefficients, int degree);
+
+/* Same as above using Estrin scheme, that exposes more instruction level
+ * parallelism for higher degree polynomials.  */
+double          math_estrin(double x, double *coefficients, int degree);
+
+/* Calculate value of polynomial with given coefficients and degree for
+ * value x, choosing evaluation scheme according to degree.  */
+double          math_polynomial(double x, double *coefficients,
+				int degree);
+
+/* Check if fused multiply-add is implemented by hardware, so that
+ * calling fma() is not slower than separate multiplication and
+ * addition.  */
+int             math_fast_fma(void);
+
 /* Calculate cotangent of value x.  */
 double          math_cot(double x);
 
@@ -109,4 +150,36 @@ double          math_delta(double x);
  * of infinity value for x= 0) value for given value x. */
 double          math_nandelta(double x);
 
+
+/* Single precision versions of above functions, with f suffix.  */
+float           math_powif(float x, int n);
+float           math_powf(float x, float y);
+float           math_hornerf(float x, float *coefficients, int degree);
+float           math_estrinf(float x, float *coefficients, int degree);
+float           math_polynomialf(float x, float *coefficients,
+				 int degree);
+float           math_cotf(float x);
+float           math_secf(float x);
+float           math_cscf(float x);
+float           math_acotf(float x);
+float           math_asecf(float x);
+float           math_acscf(float x);
+float           math_cothf(float x);
+float           math_sechf(float x);
+float           math_cschf(float x);
+float           math_asinhf(float x);
+float           math_acoshf(float x);
+float           math_atanhf(float x);
+float           math_acothf(float x);
+float           math_asechf(float x);
+float           math_acschf(float x);
+float           math_stepf(float x);
+float           math_deltaf(float x);
+float           math_nandeltaf(float x);
+
+/* Return single precision version of given function of one argument
+ * (one of functions predefined in symbol table), or null pointer if not 
+ * known.  */
+float           (*math_float_function(double (*function) (double))) (float);
+
 #endif
@@ -0,0 +1,178 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Check that approximations of predefined functions selected by
+ * EVALUATOR_APPROXIMATE and EVALUATOR_APPROXIMATE_COARSE flags stay
+ * within documented relative errors (1e-7 and 1e-4) from C library
+ * functions, used by evaluators created without these flags, both for
+ * single point and batch evaluation.  Arguments cover small, moderate,
+ * huge and tiny magnitudes, as well as neighborhoods of zeros and
+ * poles of trigonometric functions; points where exact result is not
+ * finite normal number are skipped.  */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+
+/* Number of points at which each function is evaluated.  */
+#define POINTS 60000
+
+/* Return argument of given index, from one of ranges covered.  */
+static double   argument(int index);
+
+/* Functions approximated.  */
+static char    *functions[] = {
+	"sin", "cos", "tan", "cot", "sec", "csc", "atan", "acot", "sinh",
+	"cosh", "tanh", "coth", "sech", "csch", "erf"
+};
+
+/* Approximation flags, and respective bounds of relative error.  */
+static int      flags[] = {
+	EVALUATOR_APPROXIMATE, EVALUATOR_APPROXIMATE_COARSE
+};
+static double   bounds[] = { 1e-7, 1e-4 };
+
+/* State of pseudo-random number generator, for reproducible
+ * arguments.  */
+static unsigned long state = 1;
+
+int
+main(void)
+{
+	char           *names[] = { "x" };	/* Variable names.  */
+	char            string[16];	/* Function string.  */
+	void           *exact;	/* Evaluator using C library function.  */
+	void           *approximate;	/* Evaluator using
+					 * approximation.  */
+	double         *values;	/* Arguments.  */
+	double         *expected;	/* Exact results.  */
+	double         *results;	/* Approximate batch results.  */
+	double          result;	/* Approximate single point result.  */
+	double          error;	/* Relative error.  */
+	double          worst;	/* Largest relative error.  */
+	int             failures;	/* Number of failed checks.  */
+	int             i,
+	                j,
+	                k;	/* Loop counters.  */
+
+	/* Generate arguments. */
+	values = malloc(POINTS * sizeof(double));
+	expected = malloc(POINTS * sizeof(double));
+	results = malloc(POINTS * sizeof(double));
+	for (j = 0; j < POINTS; j++)
+		values[j] = argument(j);
+
+	failures = 0;
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0]));
+	     i++) {
+		/* Calculate exact results. */
+		sprintf(string, "%s(x)", functions[i]);
+		exact = evaluator_create(string);
+		evaluator_evaluate_batch(exact, 1, names, &values, POINTS,
+					 expected);
+
+		for (k = 0; k < (int) (sizeof(flags) / sizeof(flags[0]));
+		     k++) {
+			/* Calculate approximate results, point by point
+			 * and for whole batch (using vector kernels where
+			 * available), and find largest relative error. */
+			approximate = evaluator_create_flags(string, flags[k]);
+			evaluator_set_engine(approximate,
+					     EVALUATOR_ENGINE_BYTECODE);
+			evaluator_evaluate_batch(approximate, 1, names,
+						 &values, POINTS, results);
+			worst = 0;
+			for (j = 0; j < POINTS; j++) {
+				if (!isfinite(expected[j])
+				    || fabs(expected[j]) < DBL_MIN)
+					continue;
+				result =
+				    evaluator_evaluate(approximate, 1, names,
+						       &values[j]);
+				error =
+				    fabs(result - expected[j]) /
+				    fabs(expected[j]);
+				if (!(error <= worst))
+					worst = error;
+				error =
+				    fabs(results[j] - expected[j]) /
+				    fabs(expected[j]);
+				if (!(error <= worst))
+					worst = error;
+			}
+			if (!(worst <= bounds[k])) {
+				fprintf(stderr,
+					"%s: relative error %g exceeds %g\n",
+					string, worst, bounds[k]);
+				failures++;
+			}
+			evaluator_destroy(approximate);
+		}
+		evaluator_destroy(exact);
+	}
+	free(values);
+	free(expected);
+	free(results);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static double
+argument(int index)
+{
+	double          u,
+	                v;	/* Uniformly distributed numbers from
+				 * [0,1) interval.  */
+
+	/* Draw two numbers from linear congruential generator. */
+	state = (state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+	u = state / 2147483648.0;
+	state = (state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+	v = state / 2147483648.0;
+
+	/* Select range by index. */
+	switch (index % 6) {
+	case 0:
+		return (2 * u - 1) * 4;
+
+	case 1:
+		return (2 * u - 1) * 40;
+
+	case 2:
+		return (v < 0.5 ? -1 : 1) * exp((2 * u - 1) * 700);
+
+	case 3:
+		return (2 * u - 1) * 1.2;
+
+	case 4:
+		/* Neighborhoods of multiples of pi/2. */
+		return floor(u * 2000 - 1000) * M_PI / 2 * (1 +
+							    (v -
+							     0.5) * 1e-12);
+
+	default:
+		/* Tiny arguments. */
+		return (v < 0.5 ? -1 : 1) * pow(2, -u * 50);
+	}
+}
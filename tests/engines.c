@@ -0,0 +1,155 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Check that every engine available gives same results as
+ * EVALUATOR_ENGINE_TREE, for both single point and batch evaluation,
+ * on corpus of functions including polynomials of high degree (whose
+ * coefficient arrays share constant pool with other constants).  */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+
+/* Largest relative difference from tree engine result accepted.  */
+#define TOLERANCE 1e-12
+
+/* Number of points evaluated (not multiple of four, so that remainder
+ * of batch is evaluated too).  */
+#define POINTS 23
+
+/* Engines checked, with their names.  */
+static int      engines[] = {
+	EVALUATOR_ENGINE_JIT, EVALUATOR_ENGINE_LLVM, EVALUATOR_ENGINE_C,
+	EVALUATOR_ENGINE_BYTECODE, EVALUATOR_ENGINE_CLOSURE
+};
+static char    *engine_names[] = {
+	"jit", "llvm", "c", "bytecode", "closure"
+};
+
+/* Functions checked.  */
+static char    *corpus[] = {
+	"x*y+z",
+	"sin(x)*cos(y)+z",
+	"-x/(y-z)+0*x-(-0)",
+	"x^2+x^3+x^(-1)+x^0.5+x^-3+abs(y)^1.5",
+	"exp(-(x^2+y^2)/2)*sqrt(z^2+1)",
+	"(x+y)/(y+z+3)+(y+z)/(z+x+3)+(z+x)/(x+y+3)",
+	"log(1+x^2)*atan(y)-tanh(z)*erf(x*y)",
+	"1+2*x+3*x^2+4*x^3+5*x^4+6*x^5+7*x^6+8*x^7",
+	"sin(y)*(-3)+(1+x^2+x^3+x^4+x^5+x^6+x^7-3*x^8-3*x^9+4*x^10)",
+	"2+x-2*x^2+3*x^3-x^4+2*x^5-3*x^6+x^7+2*x^8-x^9+3*x^10-2*x^11+x^12+2*y",
+	"(1+x*y+(x*y)^2+3*(x*y)^8)*(z-3)+3",
+	"1+x+x^2+x^3+x^4+x^5+x^6+x^7+x^8+x^9+x^10+x^11+x^12+x^13+x^14+x^15+x^16+x^17+x^18+x^19+x^20"
+};
+
+int
+main(void)
+{
+	char           *names[] = { "x", "y", "z" };	/* Variable names. 
+							 */
+	double          point[3];	/* Variable values of single point. 
+					 */
+	double         *values[3];	/* Variable values of all points.  */
+	double          reference[POINTS];	/* Tree engine results.  */
+	double          results[POINTS];	/* Batch results.  */
+	double          result;	/* Single point result.  */
+	void           *evaluator;	/* Evaluator of function.  */
+	int             failures;	/* Number of failed checks.  */
+	int             i,
+	                j,
+	                k;	/* Loop counters.  */
+
+	/* Initialize variable values, covering both signs and magnitudes 
+	 * below and above one. */
+	for (j = 0; j < 3; j++)
+		values[j] = malloc(POINTS * sizeof(double));
+	for (i = 0; i < POINTS; i++) {
+		values[0][i] = -1.3 + 0.11 * i;
+		values[1][i] = 2.1 - 0.17 * i;
+		values[2][i] = 0.05 * i * i - 0.7;
+	}
+
+	failures = 0;
+	for (k = 0; k < (int) (sizeof(corpus) / sizeof(corpus[0])); k++) {
+		/* Calculate reference results using tree engine. */
+		evaluator = evaluator_create(corpus[k]);
+		for (i = 0; i < POINTS; i++) {
+			for (j = 0; j < 3; j++)
+				point[j] = values[j][i];
+			reference[i] =
+			    evaluator_evaluate(evaluator, 3, names, point);
+		}
+		evaluator_destroy(evaluator);
+
+		for (j = 0;
+		     j < (int) (sizeof(engines) / sizeof(engines[0])); j++) {
+			/* Select engine, skipping engines not available. */
+			evaluator = evaluator_create(corpus[k]);
+			if (evaluator_set_engine(evaluator, engines[j]) !=
+			    engines[j]) {
+				evaluator_destroy(evaluator);
+				continue;
+			}
+
+			/* Compare single point and batch results with
+			 * reference ones. */
+			evaluator_evaluate_batch(evaluator, 3, names, values,
+						 POINTS, results);
+			for (i = 0; i < POINTS; i++) {
+				point[0] = values[0][i];
+				point[1] = values[1][i];
+				point[2] = values[2][i];
+				result =
+				    evaluator_evaluate(evaluator, 3, names,
+						       point);
+				if (!
+				    (fabs(result - reference[i]) <=
+				     TOLERANCE * fmax(1, fabs(reference[i])))
+				    && !(isnan(result)
+					 && isnan(reference[i]))) {
+					fprintf(stderr,
+						"%s: %s at point %d is %.17g, expected %.17g\n",
+						corpus[k], engine_names[j],
+						i, result, reference[i]);
+					failures++;
+				}
+				if (!
+				    (fabs(results[i] - reference[i]) <=
+				     TOLERANCE * fmax(1, fabs(reference[i])))
+				    && !(isnan(results[i])
+					 && isnan(reference[i]))) {
+					fprintf(stderr,
+						"%s: %s batch at point %d is %.17g, expected %.17g\n",
+						corpus[k], engine_names[j],
+						i, results[i], reference[i]);
+					failures++;
+				}
+			}
+			evaluator_destroy(evaluator);
+		}
+	}
+	for (j = 0; j < 3; j++)
+		free(values[j]);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Check that results of fast-math evaluation stay within bound from
+ * strict ones.  With EVALUATOR_FAST_MATH, each operation rewritten
+ * changes its result by at most 1 ulp, so for functions whose
+ * evaluation involves no cancellation (sums of positive terms,
+ * products, quotients and well-conditioned functions of them) relative
+ * difference from strict result is bounded by number of operations
+ * times machine epsilon.  Functions of corpus below have at most
+ * OPERATIONS operations each and are evaluated for positive variable
+ * values.  */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+
+/* Largest number of operations of corpus functions.  */
+#define OPERATIONS 32
+
+/* Number of points at which functions are evaluated.  */
+#define POINTS 1000
+
+/* Corpus of functions, exercising reciprocal multiplication,
+ * reassociation and fused multiply-add.  */
+static char    *corpus[] = {
+	"x/3+y/7+z/11",
+	"(x+y)/10-(-z)/5",
+	"x+y+z+x*y+y*z+z*x+x*y*z",
+	"x*y*z*x*y*z*2*3",
+	"1+2*x+3*x^2+4*x^3+5*x^4+6*x^5",
+	"x*y+z*x+y*z+1",
+	"(x*y+z)*(y*z+x)/(z*x+y)",
+	"(x+1)/(y+2)+(y+3)/(z+4)+(z+5)/(x+6)",
+	"sqrt(x*x+y*y+z*z)/3",
+	"exp(x/4)*exp(y/4)+z/9",
+	"log(x+y+z+3)/2+x*0.1",
+	"sin(x/8+0.5)*cos(y/8)+1",
+	"x^2*y+y^2*z+z^2*x+x*y*z/7",
+	"(x+y+z+1)^3/(x*y+1)",
+	"2*x*y/(x+y)+3*y*z/(y+z)+5*z*x/(z+x)",
+	"0.5*x+0.25*y+0.125*z+0.0625*x*y+0.03125*y*z"
+};
+
+int
+main(void)
+{
+	char           *names[] = { "x", "y", "z" };	/* Variable names. 
+							 */
+	void           *strict;	/* Evaluator with strict semantics.  */
+	void           *fast;	/* Evaluator with fast-math flag.  */
+	double          values[3];	/* Variable values.  */
+	double          expected;	/* Strict result.  */
+	double          result;	/* Fast-math result.  */
+	double          error;	/* Relative difference of results.  */
+	double          worst;	/* Largest relative difference.  */
+	int             failures;	/* Number of failed functions.  */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* Evaluate each function at points with variable values spread
+	 * over [0.5,2.5] interval, and compare largest relative
+	 * difference of results with bound. */
+	failures = 0;
+	for (i = 0; i < (int) (sizeof(corpus) / sizeof(corpus[0])); i++) {
+		strict = evaluator_create(corpus[i]);
+		fast = evaluator_create_flags(corpus[i], EVALUATOR_FAST_MATH);
+		worst = 0;
+		for (j = 0; j < POINTS; j++) {
+			values[0] = 1.5 + sin(j);
+			values[1] = 1.5 + cos(0.7 * j);
+			values[2] = 1.5 + sin(1.3 * j + 0.2);
+			expected = evaluator_evaluate(strict, 3, names, values);
+			result = evaluator_evaluate(fast, 3, names, values);
+			error = fabs(result - expected) / fabs(expected);
+			if (!(error <= worst))
+				worst = error;
+		}
+		if (!(worst <= OPERATIONS * DBL_EPSILON)) {
+			fprintf(stderr,
+				"%s: relative difference %g exceeds %g\n",
+				corpus[i], worst, OPERATIONS * DBL_EPSILON);
+			failures++;
+		}
+		evaluator_destroy(fast);
+		evaluator_destroy(strict);
+	}
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Check single precision batch evaluation of every builtin function
+ * against double precision batch evaluation, over arguments of both
+ * signs from tiny to huge magnitudes.  */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+
+/* Largest difference from double precision result accepted, relative
+ * to result magnitude (or absolute for results below one).  */
+#define TOLERANCE 1e-5
+
+/* Builtin functions checked.  */
+static char    *functions[] = {
+	"exp", "log", "sqrt", "sin", "cos", "tan", "cot", "sec", "csc",
+	"asin", "acos", "atan", "acot", "asec", "acsc", "sinh", "cosh",
+	"tanh", "coth", "sech", "csch", "asinh", "acosh", "atanh", "acoth",
+	"asech", "acsch", "abs", "step", "delta", "nandelta", "erf"
+};
+
+/* Arguments, exactly representable in single precision.  Large
+ * negative arguments stop at magnitude where double precision formulas
+ * of inverse hyperbolic functions, used as reference, are still
+ * accurate.  */
+static float    arguments[] = {
+	-1e4f, -5000, -3000, -100, -2, -1, -0.9f, -0.5f, -1e-3f, 0,
+	1e-25f, 1e-20f, 1e-3f, 0.5f, 0.9f, 1, 2, 100, 3000, 5000, 1e4f,
+	1.8e19f, 1e20f, 1e30f
+};
+
+#define COUNT ((int) (sizeof(arguments) / sizeof(arguments[0])))
+
+int
+main(void)
+{
+	char           *names[] = { "x" };	/* Variable names.  */
+	char            string[32];	/* Function string.  */
+	float           values_float[COUNT];	/* Single precision
+						 * arguments.  */
+	double          values_double[COUNT];	/* Double precision
+						 * arguments.  */
+	float          *column_float;	/* Pointer to above array.  */
+	double         *column_double;	/* Pointer to above array.  */
+	float           results_float[COUNT];	/* Single precision
+						 * results.  */
+	double          results_double[COUNT];	/* Double precision
+						 * results.  */
+	double          result;	/* Single precision result, widened.  */
+	double          expected;	/* Double precision result.  */
+	void           *evaluator;	/* Evaluator of function.  */
+	int             failures;	/* Number of failed checks.  */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* Initialize arguments. */
+	for (j = 0; j < COUNT; j++) {
+		values_float[j] = arguments[j];
+		values_double[j] = arguments[j];
+	}
+	column_float = values_float;
+	column_double = values_double;
+
+	failures = 0;
+	for (i = 0; i < (int) (sizeof(functions) / sizeof(functions[0]));
+	     i++) {
+		/* Evaluate function in both precisions. */
+		sprintf(string, "%s(x)", functions[i]);
+		evaluator = evaluator_create(string);
+		evaluator_evaluate_batch_float(evaluator, 1, names,
+					       &column_float, COUNT,
+					       results_float);
+		evaluator_evaluate_batch(evaluator, 1, names, &column_double,
+					 COUNT, results_double);
+		evaluator_destroy(evaluator);
+
+		/* Compare results, skipping ones not representable in
+		 * single precision. */
+		for (j = 0; j < COUNT; j++) {
+			result = results_float[j];
+			expected = results_double[j];
+			if (isfinite(expected) && fabs(expected) > FLT_MAX)
+				continue;
+			if (result == expected
+			    || (isnan(result) && isnan(expected)))
+				continue;
+			if (!(fabs(result - expected) <=
+			      TOLERANCE * fmax(1, fabs(expected)))) {
+				fprintf(stderr,
+					"%s(%g) is %.9g in single precision, %.17g in double\n",
+					functions[i], arguments[j], result,
+					expected);
+				failures++;
+			}
+		}
+	}
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
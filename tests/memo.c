@@ -0,0 +1,105 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Check memoization of function values: values found in table are
+ * same as evaluated ones, variables keep values given for later calls
+ * whether value found or not, and statistics count hits, misses and
+ * evictions.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+
+/* Number of distinct points of grid, and number of evaluations over
+ * it.  */
+#define GRID 64
+#define EVALUATIONS 4096
+
+/* Report failed check, given by condition, and count it.  */
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", \
+				__FILE__, __LINE__, #condition); \
+			failures++; \
+		} \
+	} while (0)
+
+int
+main(void)
+{
+	char           *names[] = { "x", "y" };	/* Variable names.  */
+	void           *memoized;	/* Evaluator with memoization.  */
+	void           *plain;	/* Evaluator without memoization.  */
+	double          values[2];	/* Variable values.  */
+	long            hits,
+	                misses,
+	                evictions;	/* Memoization statistics.  */
+	int             failures;	/* Number of failed checks.  */
+	int             i;	/* Loop counter.  */
+
+	failures = 0;
+
+	/* Value found for point evaluated before should leave variables
+	 * with values of that point, as evaluation would. */
+	memoized = evaluator_create("x+10*y");
+	CHECK(evaluator_set_memo(memoized, 16));
+	values[0] = 1;
+	values[1] = 2;
+	CHECK(evaluator_evaluate(memoized, 2, names, values) == 21);
+	values[0] = 3;
+	values[1] = 4;
+	CHECK(evaluator_evaluate(memoized, 2, names, values) == 43);
+	values[0] = 1;
+	values[1] = 2;
+	CHECK(evaluator_evaluate(memoized, 2, names, values) == 21);
+	values[0] = 5;
+	CHECK(evaluator_evaluate(memoized, 1, names, values) == 25);
+	evaluator_get_memo_statistics(memoized, &hits, &misses, &evictions);
+	CHECK(hits == 1 && misses == 3 && evictions == 0);
+	evaluator_destroy(memoized);
+
+	/* With grid larger than table, values found should still be same
+	 * as evaluated ones, with some values evicted. */
+	memoized = evaluator_create("sin(x)*exp(y)+x*y");
+	plain = evaluator_create("sin(x)*exp(y)+x*y");
+	CHECK(evaluator_set_memo(memoized, 16));
+	for (i = 0; i < EVALUATIONS; i++) {
+		values[0] = (i * 7 % GRID) % 8 * 0.25;
+		values[1] = (i * 7 % GRID) / 8 * 0.5;
+		CHECK(evaluator_evaluate(memoized, 2, names, values) ==
+		      evaluator_evaluate(plain, 2, names, values));
+	}
+	evaluator_get_memo_statistics(memoized, &hits, &misses, &evictions);
+	CHECK(hits + misses == EVALUATIONS);
+	CHECK(misses >= GRID && evictions > 0 && evictions <= misses - 16);
+	evaluator_destroy(plain);
+
+	/* Disabling memoization should reset statistics. */
+	CHECK(evaluator_set_memo(memoized, 0));
+	evaluator_get_memo_statistics(memoized, &hits, &misses, &evictions);
+	CHECK(hits == 0 && misses == 0 && evictions == 0);
+	CHECK(!evaluator_set_memo(memoized, -1));
+	evaluator_destroy(memoized);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/* 
+ * Copyright (C) 1999, 2002, 2003, 2004, 2005, 2006, 2007, 2008, 2011,
+ * 2012, 2013 Free Software Foundation, Inc.
+ * 
+ * This file is part of GNU libmatheval
+ * 
+ * GNU libmatheval is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * GNU libmatheval is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU libmatheval.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <matheval.h>
+
+/* Largest relative difference from reference value accepted.  */
+#define TOLERANCE 1e-12
+
+/* Test case: function, variable of derivative taken (null pointer if
+ * function itself evaluated) and reference implementation of result.  */
+typedef struct {
+	char           *function;	/* Function string.  */
+	char           *variable;	/* Derivative variable.  */
+	double          (*reference) (double *point);	/* Reference result 
+							 * for point given
+							 * as array of
+							 * variable values. 
+							 */
+} Case;
+
+/* Calculate sum of powers of x from zero to given degree, and its
+ * derivative if pointer to store it given.  */
+static double   geometric(double x, int degree, double *derivative);
+
+/* Reference results of test cases.  */
+static double   square_derivative(double *point);
+static double   bivariate_derivative_x(double *point);
+static double   bivariate_derivative_y(double *point);
+static double   reciprocal_derivative(double *point);
+static double   composition_derivative(double *point);
+static double   high_degree(double *point);
+static double   high_degree_derivative(double *point);
+
+/* Functions with polynomial subtrees, written as sums of powers, and
+ * their derivatives.  */
+static Case     cases[] = {
+	{"(1+x+x^2+x^3+x^4+x^5+x^6+x^7+x^8+x^9)^2", "x",
+	 square_derivative},
+	{"7*y+6*x+2*y^2+2*x^3+x^4+9*y^5", "x", bivariate_derivative_x},
+	{"7*y+6*x+2*y^2+2*x^3+x^4+9*y^5", "y", bivariate_derivative_y},
+	{"1/(1+x+x^2+x^3+x^4+x^5+x^6+x^7+x^8+x^9+x^10+x^11+x^12)", "x",
+	 reciprocal_derivative},
+	{"(1+2*(x*y)^2+(x*y)^3)^3", "x", composition_derivative},
+	{"1+x+x^2+x^3+x^4+x^5+x^6+x^7+x^8+x^9+x^10+x^11+x^12+x^13+x^14+x^15+x^16+x^17+x^18+x^19+x^20+x^21+x^22+x^23+x^24+x^25+x^26+x^27+x^28+x^29+x^30+x^31+x^32+x^33+x^34+x^35+x^36+x^37+x^38+x^39+x^40+x^41+x^42+x^43+x^44+x^45+x^46+x^47+x^48+x^49+x^50", NULL, high_degree},
+	{"1+x+x^2+x^3+x^4+x^5+x^6+x^7+x^8+x^9+x^10+x^11+x^12+x^13+x^14+x^15+x^16+x^17+x^18+x^19+x^20+x^21+x^22+x^23+x^24+x^25+x^26+x^27+x^28+x^29+x^30+x^31+x^32+x^33+x^34+x^35+x^36+x^37+x^38+x^39+x^40+x^41+x^42+x^43+x^44+x^45+x^46+x^47+x^48+x^49+x^50", "x", high_degree_derivative}
+};
+
+/* Points at which functions are evaluated.  */
+static double   points[][2] = {
+	{0.7, 0}, {0, 0.7}, {-0.3, 0.4}, {0.9, -0.8}, {-1.1, 0.2}
+};
+
+int
+main(void)
+{
+	char           *names[] = { "x", "y" };	/* Variable names.  */
+	void           *function;	/* Evaluator for function.  */
+	void           *evaluator;	/* Evaluator for result.  */
+	double          result;	/* Evaluated result.  */
+	double          expected;	/* Reference result.  */
+	int             failures;	/* Number of failed checks.  */
+	int             i,
+	                j;	/* Loop counters.  */
+
+	/* Evaluate each function, or its derivative, at each point and
+	 * compare result with reference one. */
+	failures = 0;
+	for (i = 0; i < (int) (sizeof(cases) / sizeof(cases[0])); i++) {
+		function = evaluator_create(cases[i].function);
+		evaluator = cases[i].variable ?
+		    evaluator_derivative(function,
+					 cases[i].variable) : function;
+		for (j = 0;
+		     j < (int) (sizeof(points) / sizeof(points[0])); j++) {
+			result =
+			    evaluator_evaluate(evaluator, 2, names,
+					       points[j]);
+			expected = cases[i].reference(points[j]);
+			if (!(fabs(result - expected) <=
+			      TOLERANCE * fmax(1, fabs(expected)))) {
+				fprintf(stderr,
+					"%s: d/d%s at (%g, %g) is %.17g, expected %.17g\n",
+					cases[i].function,
+					cases[i].variable ? cases[i].
+					variable : "1", points[j][0],
+					points[j][1], result, expected);
+				failures++;
+			}
+		}
+		if (evaluator != function)
+			evaluator_destroy(evaluator);
+		evaluator_destroy(function);
+	}
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static double
+geometric(double x, int degree, double *derivative)
+{
+	double          sum;	/* Sum of powers.  */
+	int             k;	/* Loop counter.  */
+
+	/* Accumulate sums in Horner form. */
+	sum = 0;
+	if (derivative)
+		*derivative = 0;
+	for (k = degree; k >= 0; k--) {
+		if (derivative)
+			*derivative = *derivative * x + sum;
+		sum = sum * x + 1;
+	}
+	return sum;
+}
+
+static double
+square_derivative(double *point)
+{
+	double          sum,
+	                derivative;	/* Inner sum and its derivative.  */
+
+	sum = geometric(point[0], 9, &derivative);
+	return 2 * sum * derivative;
+}
+
+static double
+bivariate_derivative_x(double *point)
+{
+	return 6 + 6 * point[0] * point[0] +
+	    4 * point[0] * point[0] * point[0];
+}
+
+static double
+bivariate_derivative_y(double *point)
+{
+	return 7 + 4 * point[1] +
+	    45 * point[1] * point[1] * point[1] * point[1];
+}
+
+static double
+reciprocal_derivative(double *point)
+{
+	double          sum,
+	                derivative;	/* Denominator and its derivative.  */
+
+	sum = geometric(point[0], 12, &derivative);
+	return -derivative / (sum * sum);
+}
+
+static double
+composition_derivative(double *point)
+{
+	double          t;	/* Product of variables.  */
+	double          inner;	/* Inner polynomial.  */
+
+	t = point[0] * point[1];
+	inner = 1 + 2 * t * t + t * t * t;
+	return 3 * inner * inner * (4 * t + 3 * t * t) * point[1];
+}
+
+static double
+high_degree(double *point)
+{
+	return geometric(point[0], 50, NULL);
+}
+
+static double
+high_degree_derivative(double *point)
+{
+	double          derivative;	/* Derivative of sum.  */
+
+	geometric(point[0], 50, &derivative);
+	return derivative;
+}